@@ -55,4 +55,7 @@ public abstract class AstVisitorClient
 	public abstract void recordComment(Range range);
 
 	public abstract void recordError(String message, boolean fatal, boolean indexed, Range range);
+
+	// hands over all buffered records, called once a file is done
+	public void flush() {}
 }
@@ -7,13 +7,24 @@ import java.io.InputStream;
 import java.io.OutputStream;
 import java.io.PrintWriter;
 import java.io.StringWriter;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
 import java.nio.file.Path;
 import java.nio.file.Paths;
+import java.nio.file.StandardCopyOption;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
 import java.util.ArrayList;
+import java.util.HashMap;
 import java.util.Hashtable;
 import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.jar.JarFile;
 import java.util.zip.ZipEntry;
+import org.eclipse.core.runtime.IProgressMonitor;
+import org.eclipse.core.runtime.NullProgressMonitor;
 import org.eclipse.jdt.core.JavaCore;
 import org.eclipse.jdt.core.compiler.IProblem;
 import org.eclipse.jdt.core.dom.AST;
@@ -22,11 +33,24 @@ import org.eclipse.jdt.core.dom.ASTVisitor;
 import org.eclipse.jdt.core.dom.BlockComment;
 import org.eclipse.jdt.core.dom.Comment;
 import org.eclipse.jdt.core.dom.CompilationUnit;
+import org.eclipse.jdt.core.dom.FileASTRequestor;
 import org.eclipse.jdt.core.dom.LineComment;
 import org.eclipse.jdt.core.dom.PackageDeclaration;
 
 public class JavaIndexer
 {
+	private static class ClassPath
+	{
+		public String[] jarPaths;
+		public String[] sourcePaths;
+	}
+
+	// class paths are shared by all files of a source group, so they are only split once
+	private static final Map<String, ClassPath> s_classPaths = new ConcurrentHashMap<>();
+
+	// classes.jar files extracted from .aar files in this session
+	private static final Map<String, File> s_extractedJarFiles = new ConcurrentHashMap<>();
+
 	public static void processFile(
 		int address,
 		String filePath,
@@ -58,105 +82,218 @@ public class JavaIndexer
 
 			Path path = Paths.get(filePath);
 
-			ASTParser parser = ASTParser.newParser(AST.JLS_Latest);
+			ASTParser parser = createParser(languageStandard, classPath, astVisitorClient);
+			parser.setUnitName(path.getFileName().toString());
+			parser.setSource(fileContent.toCharArray());
 
-			parser.setResolveBindings(
-				true);	  // solve "bindings" like the declaration of the type used in a var decl
-			parser.setKind(
-				ASTParser.K_COMPILATION_UNIT);	  // specify to parse the entire compilation unit
-			parser.setBindingsRecovery(
-				true);	  // also return bindings that are not resolved completely
-			parser.setStatementsRecovery(true);
+			CompilationUnit cu = (CompilationUnit)parser.createAST(null);
 
-			{
-				String convertedLanguageStandard = convertLanguageStandard(languageStandard);
-				astVisitorClient.logInfo("using language standard " + convertedLanguageStandard);
-
-				Hashtable<String, String> options = JavaCore.getOptions();
-				options.put(JavaCore.COMPILER_PB_ENABLE_PREVIEW_FEATURES, JavaCore.DISABLED);
-				options.put(JavaCore.COMPILER_PB_REPORT_PREVIEW_FEATURES, JavaCore.IGNORE);
-				options.put(JavaCore.COMPILER_SOURCE, convertedLanguageStandard);
-				options.put(JavaCore.COMPILER_CODEGEN_TARGET_PLATFORM, convertedLanguageStandard);
-				options.put(JavaCore.COMPILER_COMPLIANCE, convertedLanguageStandard);
-				parser.setCompilerOptions(options);
-			}
+			visitCompilationUnit(astVisitorClient, path, fileContent, cu, verbose);
+		}
+		catch (Exception e)
+		{
+			StringWriter sw = new StringWriter();
+			PrintWriter pw = new PrintWriter(sw);
+			e.printStackTrace(pw);
+			astVisitorClient.logError(sw.toString());
+		}
 
-			parser.setUnitName(path.getFileName().toString());
+		astVisitorClient.flush();
+	}
 
-			List<String> classpath = new ArrayList<>();
-			List<String> sources = new ArrayList<>();
+	// Parses all files with a single name environment, so the class path is only indexed once for
+	// all of them. beginFile is called before the AST of each file is traversed.
+	public static void processFiles(
+		int address, String[] filePaths, String languageStandard, String classPath, int verbose)
+	{
+		AstVisitorClient batchClient = new JavaIndexerAstVisitorClient(address);
 
-			for (String classPathEntry: classPath.split("\\;"))
+		try
+		{
+			batchClient.logInfo("indexing " + filePaths.length + " source files in one batch");
+
+			Map<String, Integer> fileIndices = new HashMap<>();
+			String[] encodings = new String[filePaths.length];
+			for (int i = 0; i < filePaths.length; i++)
 			{
-				if (classPathEntry.endsWith(".jar"))
-				{
-					classpath.add(classPathEntry);
-				}
-				else if (classPathEntry.endsWith(".aar"))
+				fileIndices.put(Paths.get(filePaths[i]).toAbsolutePath().normalize().toString(), i);
+				encodings[i] = StandardCharsets.UTF_8.name();
+			}
+
+			ASTParser parser = createParser(languageStandard, classPath, batchClient);
+
+			FileASTRequestor requestor = new FileASTRequestor() {
+				@Override public void acceptAST(String sourceFilePath, CompilationUnit cu)
 				{
-					File extractedJarFile = extractClassesJarFileFromAarFile(
-						Paths.get(classPathEntry), astVisitorClient);
-					if (extractedJarFile != null)
+					Path path = Paths.get(sourceFilePath);
+					Integer fileIndex = fileIndices.get(
+						path.toAbsolutePath().normalize().toString());
+					if (fileIndex == null)
 					{
-						classpath.add(extractedJarFile.getAbsolutePath());
+						batchClient.logError(
+							"received AST of unknown source file: " + sourceFilePath);
+						return;
 					}
+
+					AstVisitorClient astVisitorClient = new JavaIndexerAstVisitorClient(address);
+					try
+					{
+						beginFile(address, fileIndex);
+						astVisitorClient.logInfo("indexing source file: " + sourceFilePath);
+
+						// tabs are replaced the same way as for single files
+						String fileContent = new String(
+							Files.readAllBytes(path), StandardCharsets.UTF_8).replace('\t', ' ');
+
+						visitCompilationUnit(astVisitorClient, path, fileContent, cu, verbose);
+					}
+					catch (Exception e)
+					{
+						StringWriter sw = new StringWriter();
+						PrintWriter pw = new PrintWriter(sw);
+						e.printStackTrace(pw);
+						astVisitorClient.logError(sw.toString());
+					}
+
+					// all records of a file need to arrive before the next file begins
+					astVisitorClient.flush();
 				}
-				else if (!classPathEntry.isEmpty())
+			};
+
+			IProgressMonitor monitor = new NullProgressMonitor() {
+				@Override public boolean isCanceled()
 				{
-					sources.add(classPathEntry);
+					return getInterrupted(address);
 				}
-			}
+			};
 
-			parser.setEnvironment(
-				classpath.toArray(new String[0]), sources.toArray(new String[0]), null, true);
-			parser.setSource(fileContent.toCharArray());
+			parser.createASTs(filePaths, encodings, new String[0], requestor, monitor);
+		}
+		catch (Exception e)
+		{
+			StringWriter sw = new StringWriter();
+			PrintWriter pw = new PrintWriter(sw);
+			e.printStackTrace(pw);
+			batchClient.logError(sw.toString());
+		}
+	}
 
-			CompilationUnit cu = (CompilationUnit)parser.createAST(null);
+	private static ASTParser createParser(
+		String languageStandard, String classPath, AstVisitorClient astVisitorClient)
+		throws IOException
+	{
+		ASTParser parser = ASTParser.newParser(AST.JLS_Latest);
+
+		parser.setResolveBindings(
+			true);	  // solve "bindings" like the declaration of the type used in a var decl
+		parser.setKind(
+			ASTParser.K_COMPILATION_UNIT);	  // specify to parse the entire compilation unit
+		parser.setBindingsRecovery(
+			true);	  // also return bindings that are not resolved completely
+		parser.setStatementsRecovery(true);
 
-			ASTVisitor visitor;
-			if (verbose != 0)
+		{
+			String convertedLanguageStandard = convertLanguageStandard(languageStandard);
+			astVisitorClient.logInfo("using language standard " + convertedLanguageStandard);
+
+			Hashtable<String, String> options = JavaCore.getOptions();
+			options.put(JavaCore.COMPILER_PB_ENABLE_PREVIEW_FEATURES, JavaCore.DISABLED);
+			options.put(JavaCore.COMPILER_PB_REPORT_PREVIEW_FEATURES, JavaCore.IGNORE);
+			options.put(JavaCore.COMPILER_SOURCE, convertedLanguageStandard);
+			options.put(JavaCore.COMPILER_CODEGEN_TARGET_PLATFORM, convertedLanguageStandard);
+			options.put(JavaCore.COMPILER_COMPLIANCE, convertedLanguageStandard);
+			parser.setCompilerOptions(options);
+		}
+
+		ClassPath splitClassPath = getClassPath(classPath, astVisitorClient);
+		parser.setEnvironment(splitClassPath.jarPaths, splitClassPath.sourcePaths, null, true);
+
+		return parser;
+	}
+
+	private static ClassPath getClassPath(String classPath, AstVisitorClient astVisitorClient)
+		throws IOException
+	{
+		ClassPath splitClassPath = s_classPaths.get(classPath);
+		if (splitClassPath != null)
+		{
+			return splitClassPath;
+		}
+
+		List<String> jarPaths = new ArrayList<>();
+		List<String> sourcePaths = new ArrayList<>();
+
+		for (String classPathEntry: classPath.split("\\;"))
+		{
+			if (classPathEntry.endsWith(".jar"))
 			{
-				visitor = new VerboseContextAwareAstVisitor(
-					astVisitorClient, path.toFile(), fileContent, cu);
+				jarPaths.add(classPathEntry);
 			}
-			else
+			else if (classPathEntry.endsWith(".aar"))
 			{
-				visitor = new ContextAwareAstVisitor(
-					astVisitorClient, path.toFile(), fileContent, cu);
+				File extractedJarFile = getClassesJarFileFromAarFile(
+					Paths.get(classPathEntry), astVisitorClient);
+				if (extractedJarFile != null)
+				{
+					jarPaths.add(extractedJarFile.getAbsolutePath());
+				}
 			}
+			else if (!classPathEntry.isEmpty())
+			{
+				sourcePaths.add(classPathEntry);
+			}
+		}
 
-			astVisitorClient.logInfo("starting AST traversal");
+		splitClassPath = new ClassPath();
+		splitClassPath.jarPaths = jarPaths.toArray(new String[0]);
+		splitClassPath.sourcePaths = sourcePaths.toArray(new String[0]);
+		s_classPaths.put(classPath, splitClassPath);
 
-			cu.accept(visitor);
+		return splitClassPath;
+	}
 
-			for (IProblem problem: cu.getProblems())
-			{
-				if (problem.isError())
-				{
-					Range range = new Range(
-						cu.getLineNumber(problem.getSourceStart()),
-						cu.getColumnNumber(problem.getSourceStart() + 1),
-						cu.getLineNumber(problem.getSourceEnd()),
-						cu.getColumnNumber(problem.getSourceEnd()) + 1);
+	private static void visitCompilationUnit(
+		AstVisitorClient astVisitorClient,
+		Path path,
+		String fileContent,
+		CompilationUnit cu,
+		int verbose)
+	{
+		ASTVisitor visitor;
+		if (verbose != 0)
+		{
+			visitor = new VerboseContextAwareAstVisitor(
+				astVisitorClient, path.toFile(), fileContent, cu);
+		}
+		else
+		{
+			visitor = new ContextAwareAstVisitor(astVisitorClient, path.toFile(), fileContent, cu);
+		}
 
-					astVisitorClient.recordError(problem.getMessage(), false, true, range);
-				}
-			}
+		astVisitorClient.logInfo("starting AST traversal");
+
+		cu.accept(visitor);
 
-			for (Object commentObject: cu.getCommentList())
+		for (IProblem problem: cu.getProblems())
+		{
+			if (problem.isError())
 			{
-				if ((commentObject instanceof LineComment) || (commentObject instanceof BlockComment))
-				{
-					((Comment)commentObject).accept(visitor);
-				}
+				Range range = new Range(
+					cu.getLineNumber(problem.getSourceStart()),
+					cu.getColumnNumber(problem.getSourceStart() + 1),
+					cu.getLineNumber(problem.getSourceEnd()),
+					cu.getColumnNumber(problem.getSourceEnd()) + 1);
+
+				astVisitorClient.recordError(problem.getMessage(), false, true, range);
 			}
 		}
-		catch (Exception e)
+
+		for (Object commentObject: cu.getCommentList())
 		{
-			StringWriter sw = new StringWriter();
-			PrintWriter pw = new PrintWriter(sw);
-			e.printStackTrace(pw);
-			astVisitorClient.logError(sw.toString());
+			if ((commentObject instanceof LineComment) || (commentObject instanceof BlockComment))
+			{
+				((Comment)commentObject).accept(visitor);
+			}
 		}
 	}
 
@@ -179,6 +316,8 @@ public class JavaIndexer
 
 	public static void clearCaches()
 	{
+		s_classPaths.clear();
+		s_extractedJarFiles.clear();
 		Runtime.getRuntime().gc();
 	}
 
@@ -220,143 +359,136 @@ public class JavaIndexer
 		}
 	}
 
-	private static File extractClassesJarFileFromAarFile(
+	// The extracted classes.jar files are kept in the temp directory, named by the hash of the
+	// .aar file, so they are extracted only once across sessions and indexer processes.
+	private static File getClassesJarFileFromAarFile(
 		Path aarFilePath, AstVisitorClient astVisitorClient) throws IOException
 	{
-		JarFile jarFile = new JarFile(aarFilePath.toString());
-		ZipEntry classesJarEntry = jarFile.getEntry("classes.jar");
-		if (classesJarEntry != null)
+		File extractedJarFile = s_extractedJarFiles.get(aarFilePath.toString());
+		if (extractedJarFile != null && extractedJarFile.exists())
 		{
-			InputStream inputStream = jarFile.getInputStream(classesJarEntry);
-			File tempFile = File.createTempFile(
-				"jar_file_from_" + Utility.getFilenameWithoutExtension(aarFilePath) + "_", ".jar");
-			tempFile.deleteOnExit();
+			return extractedJarFile;
+		}
+
+		File cacheDirectory = new File(
+			System.getProperty("java.io.tmpdir"), "sourcetrail_aar_cache");
+		cacheDirectory.mkdirs();
+
+		extractedJarFile = new File(
+			cacheDirectory,
+			Utility.getFilenameWithoutExtension(aarFilePath) + "_" + getFileHash(aarFilePath) +
+				".jar");
 
-			byte[] buffer = new byte[8 * 1024];
+		if (!extractedJarFile.exists())
+		{
+			File tempFile = extractClassesJarFileFromAarFile(
+				aarFilePath, cacheDirectory, astVisitorClient);
+			if (tempFile == null)
+			{
+				return null;
+			}
 
+			// other indexer processes may extract the same file at the same time
 			try
 			{
-				OutputStream output = new FileOutputStream(tempFile);
-				try
-				{
-					int bytesRead;
-					while ((bytesRead = inputStream.read(buffer)) != -1)
-					{
-						output.write(buffer, 0, bytesRead);
-					}
-				}
-				finally
-				{
-					output.close();
-				}
+				Files.move(
+					tempFile.toPath(),
+					extractedJarFile.toPath(),
+					StandardCopyOption.ATOMIC_MOVE,
+					StandardCopyOption.REPLACE_EXISTING);
 			}
-			finally
+			catch (IOException e)
 			{
-				inputStream.close();
+				tempFile.delete();
+				if (!extractedJarFile.exists())
+				{
+					throw e;
+				}
 			}
 
 			astVisitorClient.logInfo(
 				"Extracted classes.jar file from \"" + aarFilePath.toString() + "\" to \"" +
-				tempFile.getAbsolutePath() + "\". "
-				+ "This file will be automatically deleted when the session ends.");
+				extractedJarFile.getAbsolutePath() + "\".");
+		}
 
-			return tempFile;
+		s_extractedJarFiles.put(aarFilePath.toString(), extractedJarFile);
+		return extractedJarFile;
+	}
+
+	private static String getFileHash(Path filePath) throws IOException
+	{
+		try
+		{
+			MessageDigest digest = MessageDigest.getInstance("SHA-1");
+			try (InputStream inputStream = Files.newInputStream(filePath))
+			{
+				byte[] buffer = new byte[64 * 1024];
+				int bytesRead;
+				while ((bytesRead = inputStream.read(buffer)) != -1)
+				{
+					digest.update(buffer, 0, bytesRead);
+				}
+			}
+
+			StringBuilder hash = new StringBuilder();
+			for (byte b: digest.digest())
+			{
+				hash.append(String.format("%02x", b));
+			}
+			return hash.toString();
 		}
-		else
+		catch (NoSuchAlgorithmException e)
 		{
-			astVisitorClient.logError(
-				"Classpath entry \"" + aarFilePath +
-				"\" is malformed. No internal \"classes.jar\" entry could be found.");
+			throw new IOException(e);
 		}
-		jarFile.close();
+	}
+
+	private static File extractClassesJarFileFromAarFile(
+		Path aarFilePath, File directory, AstVisitorClient astVisitorClient) throws IOException
+	{
+		try (JarFile jarFile = new JarFile(aarFilePath.toString()))
+		{
+			ZipEntry classesJarEntry = jarFile.getEntry("classes.jar");
+			if (classesJarEntry == null)
+			{
+				astVisitorClient.logError(
+					"Classpath entry \"" + aarFilePath +
+					"\" is malformed. No internal \"classes.jar\" entry could be found.");
+				return null;
+			}
 
-		return null;
+			File tempFile = File.createTempFile(
+				"jar_file_from_" + Utility.getFilenameWithoutExtension(aarFilePath) + "_",
+				".jar",
+				directory);
+
+			try (InputStream inputStream = jarFile.getInputStream(classesJarEntry);
+				 OutputStream output = new FileOutputStream(tempFile))
+			{
+				byte[] buffer = new byte[8 * 1024];
+				int bytesRead;
+				while ((bytesRead = inputStream.read(buffer)) != -1)
+				{
+					output.write(buffer, 0, bytesRead);
+				}
+			}
+
+			return tempFile;
+		}
 	}
 
 	// the following methods are defined in the native c++ code
 
 	static public native boolean getInterrupted(int address);
 
+	static public native void beginFile(int address, int fileIndex);
+
 	static public native void logInfo(int address, String info);
 
 	static public native void logWarning(int address, String warning);
 
 	static public native void logError(int address, String error);
 
-	static public native void recordSymbol(
-		int address, String symbolName, int symbolType, int access, int definitionKind);
-
-	static public native void recordSymbolWithLocation(
-		int address,
-		String symbolName,
-		int symbolType,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn,
-		int access,
-		int definitionKind);
-
-	static public native void recordSymbolWithLocationAndScope(
-		int address,
-		String symbolName,
-		int symbolType,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn,
-		int scopeBeginLine,
-		int scopeBeginColumn,
-		int scopeEndLine,
-		int scopeEndColumn,
-		int access,
-		int definitionKind);
-
-	static public native void recordSymbolWithLocationAndScopeAndSignature(
-		int address,
-		String symbolName,
-		int symbolType,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn,
-		int scopeBeginLine,
-		int scopeBeginColumn,
-		int scopeEndLine,
-		int scopeEndColumn,
-		int signatureBeginLine,
-		int signatureBeginColumn,
-		int signatureEndLine,
-		int signatureEndColumn,
-		int access,
-		int definitionKind);
-
-	static public native void recordReference(
-		int address,
-		int referenceKind,
-		String referencedName,
-		String contextName,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn);
-
-	static public native void recordQualifierLocation(
-		int address, String qualifierName, int beginLine, int beginColumn, int endLine, int endColumn);
-
-	static public native void recordLocalSymbol(
-		int address, String symbolName, int beginLine, int beginColumn, int endLine, int endColumn);
-
-	static public native void recordComment(
-		int address, int beginLine, int beginColumn, int endLine, int endColumn);
-
-	static public native void recordError(
-		int address,
-		String message,
-		int fatal,
-		int indexed,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn);
+	// the records are encoded as described in JavaIndexerAstVisitorClient
+	static public native void recordBatch(int address, ByteBuffer buffer, int byteCount);
 }
\ No newline at end of file
@@ -2,13 +2,38 @@ package com.sourcetrail;
 
 import com.sourcetrail.name.NameElement;
 import com.sourcetrail.name.NameHierarchy;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.HashMap;
+import java.util.Map;
 
+// Collects all records of a file in a direct buffer, that is handed over to the native code in one
+// call whenever it is full and once the file is done. Every string is only sent once per file and
+// referenced by its index afterwards.
 public class JavaIndexerAstVisitorClient extends AstVisitorClient
 {
+	// the record types need to match the ones defined in JavaParser.h
+	private static final int RECORD_STRING = 0;
+	private static final int RECORD_SYMBOL = 1;
+	private static final int RECORD_SYMBOL_WITH_LOCATION = 2;
+	private static final int RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE = 3;
+	private static final int RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE = 4;
+	private static final int RECORD_REFERENCE = 5;
+	private static final int RECORD_QUALIFIER_LOCATION = 6;
+	private static final int RECORD_LOCAL_SYMBOL = 7;
+	private static final int RECORD_COMMENT = 8;
+	private static final int RECORD_ERROR = 9;
+
+	private static final int BUFFER_SIZE = 1024 * 1024;
+
 	private int m_address;
 	private String m_javaLangPackageName;
 	private boolean m_javaLangPackageRecorded;
 
+	private ByteBuffer m_buffer;
+	private Map<String, Integer> m_stringIndices = new HashMap<>();
+
 	public JavaIndexerAstVisitorClient(int address)
 	{
 		m_address = address;
@@ -40,16 +65,20 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		JavaIndexer.logError(m_address, error);
 	}
 
+	@Override public void flush()
+	{
+		if (m_buffer != null && m_buffer.position() > 0)
+		{
+			JavaIndexer.recordBatch(m_address, m_buffer, m_buffer.position());
+			m_buffer.clear();
+		}
+	}
+
 	@Override
 	public void recordSymbol(
 		NameHierarchy symbolName, SymbolKind symbolKind, AccessKind access, DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbol(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			access.getValue(),
-			definitionKind.getValue());
+		recordSymbol(symbolName.serialize(), symbolKind, access, definitionKind);
 	}
 
 	@Override
@@ -60,16 +89,14 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		AccessKind access,
 		DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbolWithLocation(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column,
-			access.getValue(),
-			definitionKind.getValue());
+		int symbolIndex = getStringIndex(symbolName.serialize());
+
+		beginRecord(RECORD_SYMBOL_WITH_LOCATION, 8);
+		m_buffer.putInt(symbolIndex);
+		m_buffer.putInt(symbolKind.getValue());
+		putRange(range);
+		m_buffer.putInt(access.getValue());
+		m_buffer.putInt(definitionKind.getValue());
 	}
 
 	@Override
@@ -81,20 +108,15 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		AccessKind access,
 		DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbolWithLocationAndScope(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column,
-			scopeRange.begin.line,
-			scopeRange.begin.column,
-			scopeRange.end.line,
-			scopeRange.end.column,
-			access.getValue(),
-			definitionKind.getValue());
+		int symbolIndex = getStringIndex(symbolName.serialize());
+
+		beginRecord(RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE, 12);
+		m_buffer.putInt(symbolIndex);
+		m_buffer.putInt(symbolKind.getValue());
+		putRange(range);
+		putRange(scopeRange);
+		m_buffer.putInt(access.getValue());
+		m_buffer.putInt(definitionKind.getValue());
 	}
 
 	@Override
@@ -107,24 +129,16 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		AccessKind access,
 		DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbolWithLocationAndScopeAndSignature(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column,
-			scopeRange.begin.line,
-			scopeRange.begin.column,
-			scopeRange.end.line,
-			scopeRange.end.column,
-			signatureRange.begin.line,
-			signatureRange.begin.column,
-			signatureRange.end.line,
-			signatureRange.end.column,
-			access.getValue(),
-			definitionKind.getValue());
+		int symbolIndex = getStringIndex(symbolName.serialize());
+
+		beginRecord(RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE, 16);
+		m_buffer.putInt(symbolIndex);
+		m_buffer.putInt(symbolKind.getValue());
+		putRange(range);
+		putRange(scopeRange);
+		putRange(signatureRange);
+		m_buffer.putInt(access.getValue());
+		m_buffer.putInt(definitionKind.getValue());
 	}
 
 	@Override
@@ -134,65 +148,121 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		String serializedReferencedName = referencedName.serialize();
 		if (!m_javaLangPackageRecorded && serializedReferencedName.startsWith(m_javaLangPackageName))
 		{
-			JavaIndexer.recordSymbol(
-				m_address,
-				m_javaLangPackageName,
-				SymbolKind.PACKAGE.getValue(),
-				AccessKind.NONE.getValue(),
-				DefinitionKind.NONE.getValue());
+			recordSymbol(
+				m_javaLangPackageName, SymbolKind.PACKAGE, AccessKind.NONE, DefinitionKind.NONE);
 
 			m_javaLangPackageRecorded = true;
 		}
 
-		JavaIndexer.recordReference(
-			m_address,
-			referenceKind.getValue(),
-			serializedReferencedName,
-			contextName.serialize(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int referencedIndex = getStringIndex(serializedReferencedName);
+		int contextIndex = getStringIndex(contextName.serialize());
+
+		beginRecord(RECORD_REFERENCE, 7);
+		m_buffer.putInt(referenceKind.getValue());
+		m_buffer.putInt(referencedIndex);
+		m_buffer.putInt(contextIndex);
+		putRange(range);
 	}
 
 	@Override public void recordQualifierLocation(NameHierarchy qualifierName, Range range)
 	{
-		JavaIndexer.recordQualifierLocation(
-			m_address,
-			qualifierName.serialize(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int qualifierIndex = getStringIndex(qualifierName.serialize());
+
+		beginRecord(RECORD_QUALIFIER_LOCATION, 5);
+		m_buffer.putInt(qualifierIndex);
+		putRange(range);
 	}
 
 	@Override public void recordLocalSymbol(NameHierarchy symbolName, Range range)
 	{
-		JavaIndexer.recordLocalSymbol(
-			m_address,
-			symbolName.serialize(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int symbolIndex = getStringIndex(symbolName.serialize());
+
+		beginRecord(RECORD_LOCAL_SYMBOL, 5);
+		m_buffer.putInt(symbolIndex);
+		putRange(range);
 	}
 
 	@Override public void recordComment(Range range)
 	{
-		JavaIndexer.recordComment(
-			m_address, range.begin.line, range.begin.column, range.end.line, range.end.column);
+		beginRecord(RECORD_COMMENT, 4);
+		putRange(range);
 	}
 
 	@Override public void recordError(String message, boolean fatal, boolean indexed, Range range)
 	{
-		JavaIndexer.recordError(
-			m_address,
-			message,
-			(fatal ? 1 : 0),
-			(indexed ? 1 : 0),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int messageIndex = getStringIndex(message);
+
+		beginRecord(RECORD_ERROR, 7);
+		m_buffer.putInt(messageIndex);
+		m_buffer.putInt(fatal ? 1 : 0);
+		m_buffer.putInt(indexed ? 1 : 0);
+		putRange(range);
+	}
+
+	private void recordSymbol(
+		String serializedSymbolName,
+		SymbolKind symbolKind,
+		AccessKind access,
+		DefinitionKind definitionKind)
+	{
+		int symbolIndex = getStringIndex(serializedSymbolName);
+
+		beginRecord(RECORD_SYMBOL, 4);
+		m_buffer.putInt(symbolIndex);
+		m_buffer.putInt(symbolKind.getValue());
+		m_buffer.putInt(access.getValue());
+		m_buffer.putInt(definitionKind.getValue());
+	}
+
+	private int getStringIndex(String str)
+	{
+		Integer index = m_stringIndices.get(str);
+		if (index != null)
+		{
+			return index;
+		}
+
+		byte[] bytes = str.getBytes(StandardCharsets.UTF_8);
+
+		beginRecord(RECORD_STRING, 1 + (bytes.length + 3) / 4);
+		m_buffer.putInt(bytes.length);
+		m_buffer.put(bytes);
+
+		// keeps all ints aligned
+		for (int i = bytes.length; i % 4 != 0; i++)
+		{
+			m_buffer.put((byte)0);
+		}
+
+		index = m_stringIndices.size();
+		m_stringIndices.put(str, index);
+		return index;
+	}
+
+	// makes room for the record type and the given number of ints
+	private void beginRecord(int recordType, int intCount)
+	{
+		int byteCount = (1 + intCount) * 4;
+
+		if (m_buffer == null || m_buffer.remaining() < byteCount)
+		{
+			flush();
+
+			if (m_buffer == null || m_buffer.capacity() < byteCount)
+			{
+				m_buffer = ByteBuffer.allocateDirect(Math.max(BUFFER_SIZE, byteCount));
+				m_buffer.order(ByteOrder.nativeOrder());
+			}
+		}
+
+		m_buffer.putInt(recordType);
+	}
+
+	private void putRange(Range range)
+	{
+		m_buffer.putInt(range.begin.line);
+		m_buffer.putInt(range.begin.column);
+		m_buffer.putInt(range.end.line);
+		m_buffer.putInt(range.end.column);
 	}
 }
@@ -24,10 +24,12 @@
 #include "ScopedFunctor.h"
 #include "SourceGroupFactory.h"
 #include "SourceGroupFactoryModuleCustom.h"
+#include "SqliteQueryStatistics.h"
 #include "UserPaths.h"
 #include "Version.h"
 #include "logging.h"
 #include "productVersion.h"
+#include "tracing.h"
 #include "utility.h"
 #include "utilityApp.h"
 #include "utilityQt.h"
@@ -166,15 +168,40 @@ int main(int argc, char* argv[])
 		}
 		else
 		{
+			if (!commandLineParser.getTraceFilePath().empty())
+			{
+				Tracer::getInstance()->setEnabled(true);
+			}
+
+			if (commandLineParser.getQueryStatisticsRequested())
+			{
+				SqliteQueryStatistics::getInstance()->setEnabled(true);
+			}
+
 			MessageLoadProject(
 				commandLineParser.getProjectFilePath(),
 				false,
 				commandLineParser.getRefreshMode(),
-				commandLineParser.getShallowIndexingRequested())
+				commandLineParser.getShallowIndexingRequested(),
+				commandLineParser.getShardIndex(),
+				commandLineParser.getShardCount())
 				.dispatch();
 		}
 
-		return qtApp.exec();
+		const int result = qtApp.exec();
+
+		if (!commandLineParser.getTraceFilePath().empty())
+		{
+			Tracer::getInstance()->setEnabled(false);
+			Tracer::getInstance()->writeChromeTrace(commandLineParser.getTraceFilePath());
+		}
+
+		if (commandLineParser.getQueryStatisticsRequested())
+		{
+			std::cout << SqliteQueryStatistics::getInstance()->getReport() << std::endl;
+		}
+
+		return result;
 	}
 	else
 	{
@@ -1131,6 +1131,17 @@ void CppSQLite3Statement::reset()
 }
 
 
+const char* CppSQLite3Statement::getSql() const
+{
+	if (mpVM)
+	{
+		return sqlite3_sql(mpVM);
+	}
+
+	return "";
+}
+
+
 void CppSQLite3Statement::finalize()
 {
 	if (mpVM)
@@ -261,6 +261,8 @@ public:
 
 	void reset();
 
+	const char* getSql() const;
+
     void finalize();
 
 private:
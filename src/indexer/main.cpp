@@ -101,7 +101,11 @@ int main(int argc, char* argv[])
 #endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
 
 	InterprocessIndexer indexer(instanceUuid, processId);
-	indexer.work();
+	indexer.setMaximumMemoryGrowth(
+		static_cast<size_t>(std::max(0, appSettings->getIndexerProcessMemoryGrowthLimit())) * 1024 *
+		1024);
+	indexer.setForwardTraceEvents(true);
+	indexer.work();	   // returns on shutdown or after exceeding the memory growth limit
 
 	return 0;
 }
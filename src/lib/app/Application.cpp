@@ -19,6 +19,7 @@
 #include "NetworkFactory.h"
 #include "ProjectSettings.h"
 #include "SharedMemoryGarbageCollector.h"
+#include "SqliteQueryStatistics.h"
 #include "StorageCache.h"
 #include "TabId.h"
 #include "TaskManager.h"
@@ -123,6 +124,15 @@ void Application::loadSettings()
 		fileLogger->setFileName(FileLogger::generateDatedFileName(L"log"));
 	}
 
+	// a configured slow query threshold also switches on collecting the statistics
+	const int slowQueryThresholdMs = settings->getSlowQueryThresholdMs();
+	SqliteQueryStatistics::getInstance()->setSlowQueryThresholdMs(
+		slowQueryThresholdMs > 0 ? slowQueryThresholdMs : 0);
+	if (slowQueryThresholdMs > 0)
+	{
+		SqliteQueryStatistics::getInstance()->setEnabled(true);
+	}
+
 	loadStyle(settings->getColorSchemePath());
 }
 
@@ -230,6 +240,9 @@ void Application::handleMessage(MessageCloseProject* message)
 
 void Application::handleMessage(MessageIndexingFinished* message)
 {
+	// query results cached while indexing or before refreshing are outdated now
+	m_storageCache->clearStorageData();
+
 	logStorageStats();
 
 	if (m_hasGUI)
@@ -287,8 +300,12 @@ void Application::handleMessage(MessageLoadProject* message)
 			m_storageCache->setSubject(
 				std::weak_ptr<StorageAccess>());	// TODO: check if this is really required.
 
+			std::shared_ptr<ProjectSettings> projectSettings = std::make_shared<ProjectSettings>(
+				projectSettingsFilePath);
+			projectSettings->setShard(message->shardIndex, message->shardCount);
+
 			m_project = std::make_shared<Project>(
-				std::make_shared<ProjectSettings>(projectSettingsFilePath),
+				projectSettings,
 				m_storageCache.get(),
 				getUUID(),
 				hasGUI());
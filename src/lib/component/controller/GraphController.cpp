@@ -5,18 +5,15 @@
 #include "AccessKind.h"
 #include "Application.h"
 #include "ApplicationSettings.h"
-#include "BucketLayouter.h"
 #include "Graph.h"
 #include "GraphView.h"
-#include "GraphViewStyle.h"
-#include "ListLayouter.h"
 #include "MessageActivateNodes.h"
 #include "MessageStatus.h"
 #include "StorageAccess.h"
+#include "TaskLambda.h"
 #include "TokenComponentAccess.h"
 #include "TokenComponentFilePath.h"
 #include "TokenComponentInheritanceChain.h"
-#include "TrailLayouter.h"
 #include "logging.h"
 #include "tracing.h"
 #include "utility.h"
@@ -26,10 +23,15 @@
 #define LAST(edge, forward) (forward? edge->getFrom(): edge->getTo())
 
 GraphController::GraphController(StorageAccess* storageAccess)
-	: m_storageAccess(storageAccess), m_useBezierEdges(false)
+	: m_storageAccess(storageAccess), m_layoutGeneration(std::make_shared<std::atomic<size_t>>(0))
 {
 }
 
+GraphController::~GraphController()
+{
+	cancelLayout();
+}
+
 Id GraphController::getSchedulerId() const
 {
 	return Controller::getTabId();
@@ -51,6 +53,7 @@ void GraphController::handleMessage(MessageActivateLegend* message)
 
 	createLegendGraph();
 
+	captureLayoutInputs(GroupType::DEFAULT);
 	layoutNesting();
 
 	m_showsLegend = true;
@@ -66,32 +69,50 @@ void GraphController::handleMessage(MessageActivateOverview* message)
 
 	clear();
 
-	if (message->acceptedNodeTypes != NodeTypeSet::all())
+	const bool showsAllNodeTypes = message->acceptedNodeTypes == NodeTypeSet::all();
+	if (!showsAllNodeTypes)
 	{
 		createDummyGraphAndSetActiveAndVisibility(
 			std::vector<Id>(),
 			m_storageAccess->getGraphForNodeTypes(message->acceptedNodeTypes),
 			false);
-
-		addCharacterIndex();
-		layoutNesting();
-		layoutList();
 	}
 	else
 	{
 		createDummyGraphAndSetActiveAndVisibility(
 			std::vector<Id>(), m_storageAccess->getGraphForAll(), false);
-
-		bundleNodesByType();
-
-		layoutNesting();
-		assignBundleIds();
-		layoutGraph();
 	}
 
 	GraphView::GraphParams params;
-	params.scrollToTop = message->acceptedNodeTypes != NodeTypeSet::all();
-	buildGraph(message, params);
+	params.scrollToTop = !showsAllNodeTypes;
+
+	captureLayoutInputs(GroupType::DEFAULT);
+
+	startLayout(
+		message,
+		params,
+		[showsAllNodeTypes](DummyGraph& dummyGraph, std::function<bool()> isCancelled) {
+			TRACE("graph all layout");
+
+			if (!showsAllNodeTypes)
+			{
+				dummyGraph.addCharacterIndex();
+				dummyGraph.layoutNesting();
+				dummyGraph.layoutList();
+				return;
+			}
+
+			dummyGraph.bundleNodesByType();
+			dummyGraph.layoutNesting();
+
+			if (isCancelled())
+			{
+				return;
+			}
+
+			dummyGraph.assignBundleIds();
+			dummyGraph.layoutGraph(false, isCancelled);
+		});
 }
 
 void GraphController::handleMessage(MessageActivateTokens* message)
@@ -100,6 +121,11 @@ void GraphController::handleMessage(MessageActivateTokens* message)
 
 	if (message->isEdge || message->keepContent())
 	{
+		if (deferUntilLayouted(message))
+		{
+			return;
+		}
+
 		m_activeEdgeIds = message->tokenIds;
 		if (message->isBundledEdges)	   // only on redo
 		{
@@ -122,7 +148,10 @@ void GraphController::handleMessage(MessageActivateTokens* message)
 		getView()->activateEdge(edgeId);
 		return;
 	}
-	else if (message->isBundledEdges)
+
+	cancelLayout();
+
+	if (message->isBundledEdges)
 	{
 		m_activeNodeIds.clear();
 		m_activeEdgeIds = message->tokenIds;
@@ -147,73 +176,109 @@ void GraphController::handleMessage(MessageActivateTokens* message)
 
 	createDummyGraphAndSetActiveAndVisibility(tokenIds, graph, !message->isFromSearch);
 
+	GraphView::GraphParams params;
+	params.centerActiveNode = !isNamespace;
+	params.scrollToTop = isNamespace;
+
+	const bool isBundledEdges = message->isBundledEdges;
+	const bool bundleActiveNode = m_activeNodeIds.size() == 1;
+	const Id groupNodeId = tokenIds[0];
+
+	std::wstring namespaceName;
 	if (isNamespace)
 	{
-		addCharacterIndex();
+		namespaceName = m_storageAccess->getNameHierarchyForNodeId(groupNodeId).getQualifiedName();
+	}
 
-		DummyNode* group = groupAllNodes(GroupType::NAMESPACE, tokenIds[0]);
-		group->groupLayout = GroupLayout::LIST;
+	const GroupType grouping = isNamespace ? GroupType::DEFAULT : getView()->getGrouping();
+	captureLayoutInputs(grouping);
 
-		if (!group->name.size())
-		{
-			group->name = m_storageAccess->getNameHierarchyForNodeId(tokenIds[0]).getQualifiedName();
-			group->tokenId = tokenIds[0];
-		}
+	startLayout(
+		message,
+		params,
+		[=](DummyGraph& dummyGraph, std::function<bool()> isCancelled) {
+			TRACE("graph activate layout");
 
-		layoutNesting();
-		layoutList();
-	}
-	else
-	{
-		if (m_activeNodeIds.size() == 1)
-		{
-			bundleNodes();
-		}
-		else if (message->isBundledEdges)
-		{
-			bool isInheritanceChain = true;
-			for (const auto& edge: m_dummyEdges)
+			if (isNamespace)
 			{
-				if (!edge->data->isType(Edge::EDGE_INHERITANCE))
+				dummyGraph.addCharacterIndex();
+
+				DummyNode* group = dummyGraph.groupAllNodes(GroupType::NAMESPACE, groupNodeId);
+				group->groupLayout = GroupLayout::LIST;
+
+				if (!group->name.size())
 				{
-					isInheritanceChain = false;
-					break;
+					group->name = namespaceName;
+					group->tokenId = groupNodeId;
 				}
+
+				dummyGraph.layoutNesting();
+				dummyGraph.layoutList();
+				return;
 			}
 
-			if (isInheritanceChain)
+			if (bundleActiveNode)
 			{
-				for (auto& node: m_dummyNodes)
+				dummyGraph.bundleNodes();
+			}
+			else if (isBundledEdges)
+			{
+				bool isInheritanceChain = true;
+				for (const auto& edge: dummyGraph.m_dummyEdges)
+				{
+					if (!edge->data->isType(Edge::EDGE_INHERITANCE))
+					{
+						isInheritanceChain = false;
+						break;
+					}
+				}
+
+				if (isInheritanceChain)
+				{
+					for (auto& node: dummyGraph.m_dummyNodes)
+					{
+						node->bundleInfo.layoutVertical = true;
+					}
+				}
+
+				dummyGraph.m_useBezierEdges = !isInheritanceChain;
+
+				for (const std::shared_ptr<DummyEdge>& edge: dummyGraph.m_dummyEdges)
 				{
-					node->bundleInfo.layoutVertical = true;
+					edge->active = false;
 				}
 			}
 
-			m_useBezierEdges = !isInheritanceChain;
+			dummyGraph.groupNodesByParents(grouping);
 
-			for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
+			if (isCancelled())
 			{
-				edge->active = false;
+				return;
 			}
-		}
 
-		groupNodesByParents(getView()->getGrouping());
+			dummyGraph.layoutNesting();
 
-		layoutNesting();
-		layoutGraph(true);
-		assignBundleIds();
-	}
+			if (isCancelled())
+			{
+				return;
+			}
 
-	GraphView::GraphParams params;
-	params.centerActiveNode = !isNamespace;
-	params.scrollToTop = isNamespace;
-	buildGraph(message, params);
+			dummyGraph.layoutGraph(true, isCancelled);
+			if (isCancelled())
+			{
+				return;
+			}
+
+			dummyGraph.assignBundleIds();
+		});
 }
 
 void GraphController::handleMessage(MessageActivateTrail* message)
 {
 	TRACE("trail activate");
 
+	cancelLayout();
+
 	MessageStatus(L"Retrieving graph data", false, true).dispatch();
 
 	m_activeEdgeIds.clear();
@@ -368,34 +433,63 @@ void GraphController::handleMessage(MessageActivateTrail* message)
 
 	MessageStatus(L"Layouting graph", false, true).dispatch();
 
-	if (!message->custom && message->edgeTypes & Edge::EDGE_INHERITANCE)
-	{
-		groupTrailNodes(GroupType::INHERITANCE);
-	}
+	GraphView::GraphParams params;
+	params.centerActiveNode = message->isLast();
 
-	layoutNesting();
-	layoutTrail(message->horizontalLayout, message->originId);
+	const bool groupInheritance = !message->custom && message->edgeTypes & Edge::EDGE_INHERITANCE;
+	const bool horizontalLayout = message->horizontalLayout;
+	const Id originId = message->originId;
+	const Id targetId = message->targetId;
 
-	if (message->originId && message->targetId)
-	{
-		DummyNode* targetNode = getDummyGraphNodeById(message->targetId).get();
-		if (targetNode)
-		{
-			targetNode->active = true;
-		}
-	}
+	captureLayoutInputs(GroupType::DEFAULT);
 
-	MessageStatus(L"Displaying graph", false, true).dispatch();
+	startLayout(
+		message,
+		params,
+		[=](DummyGraph& dummyGraph, std::function<bool()> isCancelled) {
+			TRACE("trail activate layout");
 
-	GraphView::GraphParams params;
-	params.centerActiveNode = message->isLast();
-	buildGraph(message, params);
+			if (groupInheritance)
+			{
+				dummyGraph.groupTrailNodes(GroupType::INHERITANCE);
+			}
+
+			dummyGraph.layoutNesting();
+
+			if (isCancelled())
+			{
+				return;
+			}
+
+			dummyGraph.layoutTrail(horizontalLayout, originId, isCancelled);
+
+			if (isCancelled())
+			{
+				return;
+			}
+
+			if (originId && targetId)
+			{
+				DummyNode* targetNode = dummyGraph.getDummyGraphNodeById(targetId).get();
+				if (targetNode)
+				{
+					targetNode->active = true;
+				}
+			}
+
+			MessageStatus(L"Displaying graph", false, true).dispatch();
+		});
 }
 
 void GraphController::handleMessage(MessageActivateTrailEdge* message)
 {
 	TRACE("trail edge activate");
 
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	m_activeEdgeIds = message->edgeIds;
 	setVisibility(setActive(utility::concat(m_activeNodeIds, m_activeEdgeIds), true));
 
@@ -406,6 +500,11 @@ void GraphController::handleMessage(MessageDeactivateEdge* message)
 {
 	TRACE("edge deactivate");
 
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	m_activeEdgeIds.clear();
 	setActive(utility::concat(m_activeNodeIds, m_activeEdgeIds), false);
 
@@ -414,6 +513,11 @@ void GraphController::handleMessage(MessageDeactivateEdge* message)
 
 void GraphController::handleMessage(MessageFocusChanged* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	if (message->isReplayed() && message->isFromGraph())
 	{
 		m_tokenIdToFocus = message->tokenOrLocationId;
@@ -422,6 +526,11 @@ void GraphController::handleMessage(MessageFocusChanged* message)
 
 void GraphController::handleMessage(MessageFlushUpdates* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	GraphView::GraphParams params;
 	params.centerActiveNode = true;
 	params.animatedTransition = !message->keepContent();
@@ -430,6 +539,11 @@ void GraphController::handleMessage(MessageFlushUpdates* message)
 
 void GraphController::handleMessage(MessageScrollGraph* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	if (message->isReplayed())
 	{
 		getView()->scrollToValues(message->xValue, message->yValue);
@@ -438,16 +552,31 @@ void GraphController::handleMessage(MessageScrollGraph* message)
 
 void GraphController::handleMessage(MessageFocusIn* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	getView()->coFocusTokenIds(message->tokenIds);
 }
 
 void GraphController::handleMessage(MessageFocusOut* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	getView()->deCoFocusTokenIds(message->tokenIds);
 }
 
 void GraphController::handleMessage(MessageGraphNodeBundleSplit* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	std::wstring name;
 	if (m_dummyNodes.size() == 1 && m_dummyNodes[0]->isGroupNode())
 	{
@@ -524,6 +653,11 @@ void GraphController::handleMessage(MessageGraphNodeBundleSplit* message)
 
 void GraphController::handleMessage(MessageGraphNodeExpand* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	if (message->ignoreIfNotReplayed && !message->isReplayed())
 	{
 		return;
@@ -606,6 +740,7 @@ void GraphController::handleMessage(MessageGraphNodeExpand* message)
 
 		setActiveAndVisibility(utility::concat(m_activeNodeIds, m_activeEdgeIds));
 
+		captureLayoutInputs(GroupType::DEFAULT);
 		layoutNesting();
 		layoutGraph();
 
@@ -615,6 +750,11 @@ void GraphController::handleMessage(MessageGraphNodeExpand* message)
 
 void GraphController::handleMessage(MessageGraphNodeHide* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	DummyNode* node = getDummyGraphNodeById(message->tokenId).get();
 	DummyEdge* edge = nullptr;
 	if (node)
@@ -697,6 +837,11 @@ void GraphController::handleMessage(MessageGraphNodeHide* message)
 
 void GraphController::handleMessage(MessageGraphNodeMove* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	DummyNode* node = getDummyGraphNodeById(message->tokenId).get();
 	if (node)
 	{
@@ -736,6 +881,11 @@ void GraphController::handleMessage(MessageGraphNodeMove* message)
 
 void GraphController::handleMessage(MessageShowReference* message)
 {
+	if (deferUntilLayouted(message))
+	{
+		return;
+	}
+
 	if (!message->tokenId || !message->fromUser)
 	{
 		return;
@@ -781,6 +931,8 @@ GraphView* GraphController::getView() const
 
 void GraphController::clear()
 {
+	cancelLayout();
+
 	m_dummyNodes.clear();
 	m_dummyEdges.clear();
 
@@ -790,6 +942,7 @@ void GraphController::clear()
 	m_activeEdgeIds.clear();
 
 	m_graph.reset();
+	m_trailLayoutState = TrailLayouter::LayoutState();
 
 	m_useBezierEdges = false;
 	m_showsLegend = false;
@@ -1196,498 +1349,89 @@ void GraphController::hideBuiltinTypes()
 	}
 }
 
-void GraphController::bundleNodes()
+void GraphController::relayoutGraph(
+	MessageBase* message,
+	GraphView::GraphParams params,
+	bool withCharacterIndex,
+	const std::wstring& groupName)
 {
-	TRACE();
-
-	// evaluate top level nodes
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		if (!node->isGraphNode() || !node->visible)
-		{
-			continue;
-		}
-
-		DummyNode::BundleInfo* bundleInfo = &node->bundleInfo;
-		bundleInfo->isActive = node->hasActiveSubNode();
-
-		node->data->forEachNodeRecursive([&bundleInfo](const Node* n) {
-			if (n->isDefined())
-			{
-				bundleInfo->isDefined = true;
-			}
-
-			if (bundleInfo->layoutVertical)
-			{
-				return;
-			}
-
-			n->forEachEdgeOfType(~Edge::EDGE_MEMBER, [&bundleInfo, &n](Edge* e) {
-				if (bundleInfo->layoutVertical)
-				{
-					return;
-				}
+	bool showsTrail = m_graph->getTrailMode() != Graph::TRAIL_NONE;
 
-				if (e->isType(Edge::LAYOUT_VERTICAL))
-				{
-					bundleInfo->layoutVertical = true;
-					bundleInfo->isReferenced = false;
-					bundleInfo->isReferencing = false;
-				}
+	setVisibility(setActive(utility::concat(m_activeNodeIds, m_activeEdgeIds), showsTrail));
 
-				if (e->isType(Edge::EDGE_BUNDLED_EDGES))
-				{
-					TokenComponentBundledEdges::Direction dir =
-						e->getComponent<TokenComponentBundledEdges>()->getDirection();
+	const bool layoutToList = hasCharacterIndex() || withCharacterIndex;
+	const GroupType grouping = (showsTrail || layoutToList) ? GroupType::DEFAULT
+															: getView()->getGrouping();
+	captureLayoutInputs(grouping);
 
-					if (dir == TokenComponentBundledEdges::DIRECTION_NONE)
-					{
-						bundleInfo->isReferenced = true;
-						bundleInfo->isReferencing = true;
-					}
-					else if (
-						(dir == TokenComponentBundledEdges::DIRECTION_FORWARD && e->getFrom() == n) ||
-						(dir == TokenComponentBundledEdges::DIRECTION_BACKWARD && e->getTo() == n))
-					{
-						bundleInfo->isReferencing = true;
-					}
-					else if (
-						(dir == TokenComponentBundledEdges::DIRECTION_FORWARD && e->getTo() == n) ||
-						(dir == TokenComponentBundledEdges::DIRECTION_BACKWARD && e->getFrom() == n))
-					{
-						bundleInfo->isReferenced = true;
-					}
-				}
-				else
-				{
-					if (e->getTo() == n)
-					{
-						bundleInfo->isReferenced = true;
-					}
-					else if (e->getFrom() == n)
-					{
-						bundleInfo->isReferencing = true;
-					}
-				}
-			});
-		});
+	if (layoutToList)
+	{
+		addCharacterIndex();
 
-		if (bundleInfo->isReferenced && bundleInfo->isReferencing)
+		if (withCharacterIndex && m_dummyNodes.size())
 		{
-			bundleInfo->isReferenced = false;
-			bundleInfo->isReferencing = false;
+			// Use token Id of first node and make first 2 bits 1
+			Id groupId = ~(~Id(0) >> 2) + m_dummyNodes[0]->tokenId;
+
+			DummyNode* group = groupAllNodes(GroupType::DEFAULT, groupId);
+			group->groupLayout = GroupLayout::LIST;
+			group->interactive = false;
+			group->name = groupName;
 		}
 
-		if (bundleInfo->isActive)
+		layoutNesting();
+		layoutList();
+	}
+	else
+	{
+		if (!showsTrail)
 		{
-			bundleInfo->layoutVertical = false;
+			groupNodesByParents(grouping);
 		}
-	}
 
-	// Left for debugging
-	// for (std::shared_ptr<DummyNode> node : m_dummyNodes)
-	// {
-	// 	std::cout << node->bundleInfo.isActive << " ";
-	// 	std::cout << node->bundleInfo.isDefined << " ";
-	// 	std::cout << node->bundleInfo.layoutVertical << " ";
-	// 	std::cout << node->bundleInfo.isReferenced << " ";
-	// 	std::cout << node->bundleInfo.isReferencing << " ";
-	// 	std::wcout << node->name << std::endl;
-	// }
+		layoutNesting();
 
-	// bundle
-	bool fileOrMacroActive = false;
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		if (node->bundleInfo.isActive &&
-			(node->data->isType(NODE_FILE | NODE_MACRO) ||
-			 node->data->findEdgeOfType(Edge::EDGE_INCLUDE | Edge::EDGE_MACRO_USAGE) != nullptr))
+		if (showsTrail)
 		{
-			fileOrMacroActive = true;
-			break;
+			layoutTrail(
+				m_graph->getTrailMode() == Graph::TRAIL_HORIZONTAL, m_graph->hasTrailOrigin());
+		}
+		else
+		{
+			layoutGraph();
 		}
 	}
 
-	if (fileOrMacroActive)
-	{
-		return;
-	}
+	buildGraph(message, params);
+}
 
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return data->getType().isFile() && data->findEdgeOfType(Edge::EDGE_IMPORT);
-		},
-		1,
-		false,
-		L"Importing Files");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return !info.isDefined && info.isReferencing && !info.layoutVertical;
-		},
-		2,
-		true,
-		L"Non-indexed Symbols");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return !info.isDefined && info.isReferenced && !info.layoutVertical;
-		},
-		2,
-		true,
-		L"Non-indexed Symbols");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return info.isDefined && info.isReferenced && data->getType().isBuiltin();
-		},
-		3,
-		false,
-		L"Built-in Types");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return info.isDefined && info.isReferencing && !info.layoutVertical;
-		},
-		10,
-		false,
-		L"Referencing Symbols");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return info.isDefined && info.isReferenced && !info.layoutVertical;
-		},
-		10,
-		false,
-		L"Referenced Symbols");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return info.isReferencing && info.layoutVertical &&
-				data->findEdgeOfType(Edge::EDGE_TEMPLATE_SPECIALIZATION);
-		},
-		5,
-		false,
-		L"Specializing Symbols");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return info.isReferencing && info.layoutVertical &&
-				data->findEdgeOfType(Edge::EDGE_INHERITANCE);
-		},
-		5,
-		false,
-		L"Derived Symbols");
-
-	bundleNodesAndEdgesMatching(
-		[](const DummyNode::BundleInfo& info, const Node* data) {
-			return info.isReferenced && info.layoutVertical &&
-				data->findEdgeOfType(Edge::EDGE_INHERITANCE);
-		},
-		5,
-		false,
-		L"Base Symbols");
+void GraphController::buildGraph(MessageBase* message, GraphView::GraphParams params)
+{
+	buildGraph(message->isReplayed(), params);
 }
 
-void GraphController::bundleNodesAndEdgesMatching(
-	std::function<bool(const DummyNode::BundleInfo&, const Node* data)> matcher,
-	size_t count,
-	bool countConnectedNodes,
-	const std::wstring& name)
+void GraphController::buildGraph(bool isReplayed, GraphView::GraphParams params)
 {
-	std::vector<size_t> matchedNodeIndices;
-	size_t connectedNodeCount = 0;
-	for (size_t i = 0; i < m_dummyNodes.size(); i++)
+	if (!isReplayed)
 	{
-		const DummyNode* node = m_dummyNodes[i].get();
-		if (node->bundleInfo.isActive || !node->visible || !node->isGraphNode())
-		{
-			continue;
-		}
+		params.isIndexedList = params.scrollToTop;
+		params.bezierEdges = m_useBezierEdges;
+		params.disableInteraction = m_showsLegend;
+		params.tokenIdToFocus = m_tokenIdToFocus;
 
-		if (matcher(node->bundleInfo, node->data))
-		{
-			matchedNodeIndices.push_back(i);
+		getView()->rebuildGraph(m_graph, m_dummyNodes, m_dummyEdges, params);
 
-			if (countConnectedNodes)
-			{
-				connectedNodeCount += node->getConnectedSubNodes().size();
-			}
-		}
+		m_tokenIdToFocus = 0;
 	}
+}
 
-	size_t matchedNodeCount = countConnectedNodes ? connectedNodeCount : matchedNodeIndices.size();
-	if (!matchedNodeIndices.size() || matchedNodeCount < count ||
-		matchedNodeIndices.size() == m_dummyNodes.size())
-	{
-		return;
-	}
-
-	std::shared_ptr<DummyNode> bundleNode = std::make_shared<DummyNode>(DummyNode::DUMMY_BUNDLE);
-	bundleNode->name = name;
-	bundleNode->visible = true;
-
-	for (int i = static_cast<int>(matchedNodeIndices.size()) - 1; i >= 0; i--)
-	{
-		std::shared_ptr<DummyNode> node = m_dummyNodes[matchedNodeIndices[i]];
-		node->visible = false;
-
-		bundleNode->bundledNodes.insert(node);
-		bundleNode->bundledNodeCount += node->getBundledNodeCount();
-
-		m_dummyNodes.erase(m_dummyNodes.begin() + matchedNodeIndices[i]);
-	}
-
-	if (countConnectedNodes)
-	{
-		bundleNode->bundledNodeCount = connectedNodeCount;
-	}
-
-	DummyNode* firstNode = bundleNode->bundledNodes.begin()->get();
-
-	// Use token Id of first node and make first bit 1
-	bundleNode->tokenId = ~(~Id(0) >> 1) + firstNode->data->getId();
-	bundleNode->bundleInfo.layoutVertical = firstNode->bundleInfo.layoutVertical;
-	bundleNode->bundleInfo.isReferenced = firstNode->bundleInfo.isReferenced;
-	bundleNode->bundleInfo.isReferencing = firstNode->bundleInfo.isReferencing;
-	m_dummyNodes.push_back(bundleNode);
-
-	if (m_dummyEdges.size() == 0)
-	{
-		return;
-	}
-
-	std::vector<std::shared_ptr<DummyEdge>> bundleEdges;
-	std::vector<const DummyNode*> bundledNodes = bundleNode->getAllBundledNodes();
-	for (const DummyNode* node: bundledNodes)
-	{
-		for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
-		{
-			bool owner = (edge->ownerId == node->data->getId());
-			bool target = (edge->targetId == node->data->getId());
-
-			if (!owner && !target)
-			{
-				continue;
-			}
-
-			DummyEdge* bundleEdgePtr = nullptr;
-			for (const std::shared_ptr<DummyEdge>& bundleEdge: bundleEdges)
-			{
-				if ((owner && bundleEdge->ownerId == edge->targetId) ||
-					(target && bundleEdge->ownerId == edge->ownerId))
-				{
-					bundleEdgePtr = bundleEdge.get();
-					break;
-				}
-			}
-
-			if (!bundleEdgePtr)
-			{
-				std::shared_ptr<DummyEdge> bundleEdge = std::make_shared<DummyEdge>();
-				bundleEdge->visible = true;
-				bundleEdge->ownerId = (owner ? edge->targetId : edge->ownerId);
-				bundleEdge->targetId = bundleNode->tokenId;
-				bundleEdges.push_back(bundleEdge);
-				bundleEdgePtr = bundleEdges.back().get();
-			}
-
-			bundleEdgePtr->weight += edge->getWeight();
-			bundleEdgePtr->updateDirection(edge->getDirection(), owner);
-			edge->visible = false;
-		}
-	}
-
-	m_dummyEdges.insert(m_dummyEdges.end(), bundleEdges.begin(), bundleEdges.end());
-}
-
-std::shared_ptr<DummyNode> GraphController::bundleNodesMatching(
-	std::list<std::shared_ptr<DummyNode>>& nodes,
-	std::function<bool(const DummyNode*)> matcher,
-	const std::wstring& name)
-{
-	std::vector<std::list<std::shared_ptr<DummyNode>>::iterator> matchedNodes;
-	for (std::list<std::shared_ptr<DummyNode>>::iterator it = nodes.begin(); it != nodes.end(); it++)
-	{
-		if (matcher(it->get()))
-		{
-			matchedNodes.push_back(it);
-		}
-	}
-
-	if (matchedNodes.empty())
-	{
-		return nullptr;
-	}
-
-	std::shared_ptr<DummyNode> bundleNode = std::make_shared<DummyNode>(DummyNode::DUMMY_BUNDLE);
-	bundleNode->name = name;
-	bundleNode->visible = true;
-
-	for (int i = static_cast<int>(matchedNodes.size()) - 1; i >= 0; i--)
-	{
-		std::shared_ptr<DummyNode> node = *matchedNodes[i];
-		node->visible = false;
-
-		bundleNode->bundledNodes.insert(node);
-		nodes.erase(matchedNodes[i]);
-	}
-
-	// Use token Id of first node and make first bit 1
-	bundleNode->tokenId = ~(~Id(0) >> 1) + (*bundleNode->bundledNodes.begin())->data->getId();
-	return bundleNode;
-}
-
-std::shared_ptr<DummyNode> GraphController::bundleByType(
-	std::list<std::shared_ptr<DummyNode>>& nodes,
-	const NodeType& type,
-	const Tree<NodeType::BundleInfo>& bundleInfoTree,
-	const bool considerInvisibleNodes)
-{
-	std::shared_ptr<DummyNode> bundleNode = bundleNodesMatching(
-		nodes,
-		[&](const DummyNode* node) {
-			return (considerInvisibleNodes || node->visible) && node->isGraphNode() &&
-				node->data->getType() == type && bundleInfoTree.data.nameMatcher(node->name);
-		},
-		bundleInfoTree.data.bundleName);
-
-	if (bundleNode)
-	{
-		bundleNode->bundledNodeType = type;
-		bundleNode->bundledNodeCount = bundleNode->getBundledNodeCount();
-
-		if (!bundleInfoTree.children.empty())
-		{
-			std::list<std::shared_ptr<DummyNode>> bundledNodes(
-				bundleNode->bundledNodes.begin(), bundleNode->bundledNodes.end());
-			bundleNode->bundledNodes.clear();
-
-			// crate a sub-bundle for anonymous namespaces
-			for (const Tree<NodeType::BundleInfo>& childBundleInfoTree: bundleInfoTree.children)
-			{
-				std::shared_ptr<DummyNode> childBundle = bundleByType(
-					bundledNodes, type, childBundleInfoTree, true);
-				if (childBundle)
-				{
-					bundleNode->bundledNodes.insert(childBundle);
-				}
-			}
-
-			bundleNode->bundledNodes.insert(bundledNodes.begin(), bundledNodes.end());
-		}
-	}
-
-	return bundleNode;
-}
-
-void GraphController::bundleNodesByType()
-{
-	TRACE();
-
-	std::list<std::shared_ptr<DummyNode>> nodes(m_dummyNodes.begin(), m_dummyNodes.end());
-	std::vector<std::shared_ptr<DummyNode>> oldNodes = std::move(m_dummyNodes);
-	m_dummyNodes.clear();
-
-	bool hasNonFileBundle = false;
-
-	for (const NodeType& nodeType: NodeType::overviewBundleNodeTypesOrdered)
-	{
-		Tree<NodeType::BundleInfo> bundleInfoTree = nodeType.getOverviewBundleTree();
-		if (bundleInfoTree.data.isValid())
-		{
-			std::shared_ptr<DummyNode> bundleNode = bundleByType(
-				nodes, nodeType, bundleInfoTree, false);
-			if (bundleNode)
-			{
-				m_dummyNodes.push_back(bundleNode);
-
-				if (bundleNode->bundledNodeType.getKind() != NODE_FILE)
-				{
-					hasNonFileBundle = true;
-				}
-			}
-		}
-	}
-
-	if (nodes.size() && !hasNonFileBundle)
-	{
-		Tree<NodeType::BundleInfo> bundleInfoTree(NodeType::BundleInfo(L"Symbols"));
-		std::shared_ptr<DummyNode> bundleNode = bundleByType(
-			nodes, NodeType(NODE_SYMBOL), bundleInfoTree, false);
-		if (bundleNode)
-		{
-			m_dummyNodes.push_back(bundleNode);
-		}
-	}
-
-	if (nodes.size())
-	{
-		LOG_ERROR("Nodes left after bundling for overview");
-	}
-}
-
-void GraphController::addCharacterIndex()
+void GraphController::captureLayoutInputs(GroupType groupType)
 {
-	// Remove index characters from last time
-	DummyNode::BundledNodesSet newNodes;
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		if (!node->isTextNode())
-		{
-			newNodes.insert(node);
-		}
-	}
-	m_dummyNodes.clear();
-	m_dummyNodes.insert(m_dummyNodes.end(), newNodes.begin(), newNodes.end());
-
-	// Add index characters
-	wchar_t character = 0;
-	for (size_t i = 0; i < m_dummyNodes.size(); i++)
-	{
-		if (!m_dummyNodes[i]->visible || !m_dummyNodes[i]->name.size())
-		{
-			continue;
-		}
-
-		if (towupper(m_dummyNodes[i]->name[0]) != character)
-		{
-			character = towupper(m_dummyNodes[i]->name[0]);
-
-			std::shared_ptr<DummyNode> textNode = std::make_shared<DummyNode>(DummyNode::DUMMY_TEXT);
-			textNode->name = character;
-			textNode->visible = true;
-
-			m_dummyNodes.insert(m_dummyNodes.begin() + i, textNode);
-		}
-	}
-}
-
-bool GraphController::hasCharacterIndex() const
-{
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		if (node->isTextNode())
-		{
-			return true;
-		}
-	}
-	return false;
-}
-
-void GraphController::groupNodesByParents(GroupType groupType)
-{
-	TRACE();
-
-	if (groupType != GroupType::FILE && groupType != GroupType::NAMESPACE)
-	{
-		return;
-	}
+	m_viewSize = getView()->getViewSize();
 
-	std::map<std::wstring, std::shared_ptr<DummyNode>> groupNodes;
-	std::map<std::wstring, std::vector<std::shared_ptr<DummyNode>>> nodesToGroup;
+	m_nodeIdToParentFileMap.clear();
+	m_qualifierNameToIdMap.clear();
 
-	std::map<Id, std::pair<Id, NameHierarchy>> nodeIdtoParentMap;
 	if (groupType == GroupType::FILE)
 	{
 		std::vector<Id> nodeIds;
@@ -1699,825 +1443,96 @@ void GraphController::groupNodesByParents(GroupType groupType)
 			}
 		}
 
-		nodeIdtoParentMap = m_storageAccess->getNodeIdToParentFileMap(nodeIds);
-	}
-
-	std::map<std::wstring, Id> qualifierNameToIdMap;
-	for (const std::shared_ptr<DummyNode>& dummyNode: m_dummyNodes)
-	{
-		if (dummyNode->isGroupNode())
-		{
-			groupNodes.emplace(dummyNode->name, dummyNode);
-		}
-		else if (dummyNode->visible)
-		{
-			if (groupType == GroupType::FILE)
-			{
-				if (dummyNode->isGraphNode())
-				{
-					auto it = nodeIdtoParentMap.find(dummyNode->tokenId);
-					if (it != nodeIdtoParentMap.end())
-					{
-						nodesToGroup[it->second.second.getQualifiedName()].push_back(dummyNode);
-					}
-				}
-			}
-			else if (groupType == GroupType::NAMESPACE)
-			{
-				const DummyNode* qualifierNode = dummyNode->getQualifierNode();
-				if (qualifierNode)
-				{
-					Id qualifierId = 0;
-					std::wstring qualifierName = qualifierNode->qualifierName.getQualifiedName();
-					auto it = qualifierNameToIdMap.find(qualifierName);
-					if (it != qualifierNameToIdMap.end())
-					{
-						qualifierId = it->second;
-					}
-					else
-					{
-						qualifierId = m_storageAccess->getNodeIdForNameHierarchy(
-							qualifierNode->qualifierName);
-						qualifierNameToIdMap.emplace(qualifierName, qualifierId);
-					}
-
-					nodesToGroup[qualifierName].push_back(dummyNode);
-					nodeIdtoParentMap.emplace(
-						dummyNode->tokenId,
-						std::make_pair(qualifierId, qualifierNode->qualifierName));
-				}
-			}
-		}
+		m_nodeIdToParentFileMap = m_storageAccess->getNodeIdToParentFileMap(nodeIds);
 	}
-
-	std::set<Id> groupedNodeIds;
-	for (const std::pair<std::wstring, std::vector<std::shared_ptr<DummyNode>>>& p: nodesToGroup)
+	else if (groupType == GroupType::NAMESPACE)
 	{
-		std::shared_ptr<DummyNode> groupNode;
-
-		std::wstring name = p.first;
-		if (groupType == GroupType::FILE)
-		{
-			name = FilePath(p.first).fileName();
-		}
-
-		auto it = groupNodes.find(name);
-		if (it != groupNodes.end())
-		{
-			groupNode = it->second;
-		}
-		else
+		for (const std::shared_ptr<DummyNode>& dummyNode: m_dummyNodes)
 		{
-			groupNode = std::make_shared<DummyNode>(DummyNode::DUMMY_GROUP);
-			groupNode->visible = true;
-			groupNode->groupType = groupType;
-			groupNode->groupLayout = GroupLayout::BUCKET;
-			groupNode->name = name;
-
-			auto it = nodeIdtoParentMap.find(p.second[0]->tokenId);
-			if (it != nodeIdtoParentMap.end())
+			const DummyNode* qualifierNode = dummyNode->visible ? dummyNode->getQualifierNode()
+																: nullptr;
+			if (!qualifierNode)
 			{
-				groupNode->tokenId = it->second.first;
+				continue;
 			}
-			m_topLevelAncestorIds[groupNode->tokenId] = groupNode->tokenId;
-			m_dummyNodes.push_back(groupNode);
-		}
 
-		for (std::shared_ptr<DummyNode> dummyNode: p.second)
-		{
-			if (dummyNode->hasActiveSubNode())
+			std::wstring qualifierName = qualifierNode->qualifierName.getQualifiedName();
+			if (m_qualifierNameToIdMap.find(qualifierName) == m_qualifierNameToIdMap.end())
 			{
-				groupNode->bundleInfo = dummyNode->bundleInfo;
-				groupNode->bundleId = dummyNode->bundleId;
+				m_qualifierNameToIdMap.emplace(
+					qualifierName,
+					m_storageAccess->getNodeIdForNameHierarchy(qualifierNode->qualifierName));
 			}
-
-			groupNode->subNodes.push_back(dummyNode);
-			m_topLevelAncestorIds[dummyNode->tokenId] = groupNode->tokenId;
-			groupedNodeIds.insert(dummyNode->tokenId);
-		}
-
-		if (!groupNode->bundleId)
-		{
-			groupNode->bundleId = groupNode->subNodes[0]->bundleId;
-		}
-
-		groupNode->bundleInfo = DummyNode::BundleInfo::averageBundleInfo(groupNode->getBundleInfos());
-		groupNode->sortSubNodesByName();
-	}
-
-	for (int i = 0; i < int(m_dummyNodes.size()); i++)
-	{
-		if (groupedNodeIds.find(m_dummyNodes[i]->tokenId) != groupedNodeIds.end())
-		{
-			m_dummyNodes.erase(m_dummyNodes.begin() + i);
-			i--;
 		}
 	}
 }
 
-DummyNode* GraphController::groupAllNodes(GroupType groupType, Id groupNodeId)
+void GraphController::startLayout(
+	MessageBase* message,
+	GraphView::GraphParams params,
+	std::function<void(DummyGraph&, std::function<bool()>)> layout)
 {
-	TRACE();
-
-	std::shared_ptr<DummyNode> groupNode = std::make_shared<DummyNode>(DummyNode::DUMMY_GROUP);
-	groupNode->visible = true;
-	groupNode->groupType = groupType;
-	groupNode->tokenId = groupNodeId;
-	m_topLevelAncestorIds[groupNode->tokenId] = groupNode->tokenId;
-
-	for (std::shared_ptr<DummyNode> dummyNode: m_dummyNodes)
-	{
-		groupNode->subNodes.push_back(dummyNode);
-		m_topLevelAncestorIds[dummyNode->tokenId] = groupNode->tokenId;
-	}
-
-	if (groupNode->subNodes.size())
+	const size_t generation = ++(*m_layoutGeneration);
 	{
-		m_dummyNodes = {groupNode};
+		std::lock_guard<std::mutex> lock(m_layoutMutex);
+		m_layoutRunning = true;
 	}
 
-	return groupNode.get();
-}
-
-void GraphController::groupTrailNodes(GroupType groupType)
-{
-	TRACE();
-
-	struct TrailNode
-	{
-		Id nodeId;
-		std::set<Id> targetNodeIds;
-		std::set<Id> originNodeIds;
-
-		std::vector<DummyEdge*> targetEdges;
-		std::vector<DummyEdge*> originEdges;
+	std::shared_ptr<std::atomic<size_t>> layoutGeneration = m_layoutGeneration;
+	std::function<bool()> isCancelled = [layoutGeneration, generation]() {
+		return *layoutGeneration != generation;
 	};
 
-	std::set<Id> possibleNodeIds;
-	for (auto dummyNode: m_dummyNodes)
-	{
-		if (dummyNode->visible && dummyNode->tokenId &&
-			(!dummyNode->subNodes.size() ||
-			 (dummyNode->subNodes.size() == 1 && dummyNode->subNodes[0]->isQualifierNode())))
-		{
-			possibleNodeIds.insert(dummyNode->tokenId);
-		}
-	}
-
-	std::map<Id, TrailNode> nodes;
-
-	for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
-	{
-		if (edge->visible && possibleNodeIds.find(edge->ownerId) != possibleNodeIds.end() &&
-			possibleNodeIds.find(edge->targetId) != possibleNodeIds.end())
-		{
-			TrailNode& fromNode = nodes[edge->ownerId];
-			fromNode.nodeId = edge->ownerId;
-			fromNode.targetNodeIds.insert(edge->targetId);
-			fromNode.targetEdges.push_back(edge.get());
-
-			TrailNode& toNode = nodes[edge->targetId];
-			toNode.nodeId = edge->targetId;
-			toNode.originNodeIds.insert(edge->ownerId);
-			toNode.originEdges.push_back(edge.get());
-		}
-	}
-
-	std::set<Id> groupedNodeIds;
-	while (nodes.size())
-	{
-		TrailNode node = nodes.begin()->second;
-		nodes.erase(nodes.begin());
+	std::shared_ptr<DummyGraph> dummyGraph = std::make_shared<DummyGraph>(DummyGraph::clone());
+	const bool isReplayed = message->isReplayed();
+	const Id schedulerId = getSchedulerId();
 
-		std::vector<TrailNode> group;
-		std::map<Id, TrailNode>::iterator it = nodes.begin();
-		while (it != nodes.end())
-		{
-			if (node.targetNodeIds.size() <= 1 && it->second.targetNodeIds == node.targetNodeIds &&
-				node.originNodeIds.size() <= 1 && it->second.originNodeIds == node.originNodeIds)
-			{
-				group.push_back(it->second);
-				it = nodes.erase(it);
-			}
-			else
-			{
-				it++;
-			}
-		}
+	std::thread([this, dummyGraph, layout, isCancelled, isReplayed, params, schedulerId]() {
+		layout(*dummyGraph, isCancelled);
 
-		group.push_back(node);
-		if (group.size() < 3)
+		if (isCancelled())
 		{
-			continue;
+			return;
 		}
 
-		std::shared_ptr<DummyNode> groupNode = std::make_shared<DummyNode>(DummyNode::DUMMY_GROUP);
-		groupNode->visible = true;
-		groupNode->groupType = groupType;
-		groupNode->groupLayout = GroupLayout::SQUARE;
-
-		// Use token Id of first node and make first 2 bits 1
-		groupNode->tokenId = ~(~Id(0) >> 2) + node.nodeId;
-		m_topLevelAncestorIds[groupNode->tokenId] = groupNode->tokenId;
-
-		std::shared_ptr<DummyEdge> targetEdge = std::make_shared<DummyEdge>();
-		targetEdge->ownerId = groupNode->tokenId;
-
-		std::shared_ptr<DummyEdge> originEdge = std::make_shared<DummyEdge>();
-		originEdge->targetId = groupNode->tokenId;
-
-		std::vector<Id> hiddenEdgeIds;
-
-		for (TrailNode& node: group)
-		{
-			std::shared_ptr<DummyNode> dummyNode = getDummyGraphNodeById(node.nodeId);
-			if (!dummyNode)
-			{
-				continue;
-			}
-
-			groupedNodeIds.insert(node.nodeId);
-			groupNode->subNodes.push_back(dummyNode);
-
-			m_topLevelAncestorIds[node.nodeId] = groupNode->tokenId;
-
-			for (DummyEdge* edge: node.targetEdges)
-			{
-				if (!targetEdge->visible)
-				{
-					targetEdge->visible = true;
-					targetEdge->targetId = edge->targetId;
-					targetEdge->data = edge->data;
-				}
-
-				edge->visible = false;
-				edge->hidden = true;
-
-				if (edge->data)
-				{
-					groupNode->hiddenEdgeIds.push_back(edge->data->getId());
-				}
-			}
-
-			for (DummyEdge* edge: node.originEdges)
-			{
-				if (!originEdge->visible)
-				{
-					originEdge->visible = true;
-					originEdge->ownerId = edge->ownerId;
-					originEdge->data = edge->data;
-				}
-
-				edge->visible = false;
-				edge->hidden = true;
-
-				if (edge->data)
+		Task::dispatch(
+			schedulerId,
+			std::make_shared<TaskLambda>([this, dummyGraph, isCancelled, isReplayed, params]() {
+				if (!isCancelled())
 				{
-					groupNode->hiddenEdgeIds.push_back(edge->data->getId());
+					finishLayout(dummyGraph, isReplayed, params);
 				}
-			}
-		}
+			}));
+	}).detach();
+}
 
-		if (targetEdge->visible)
-		{
-			m_dummyEdges.push_back(targetEdge);
-		}
+void GraphController::finishLayout(
+	std::shared_ptr<DummyGraph> dummyGraph, bool isReplayed, GraphView::GraphParams params)
+{
+	static_cast<DummyGraph&>(*this) = std::move(*dummyGraph);
 
-		if (originEdge->visible)
-		{
-			m_dummyEdges.push_back(originEdge);
-		}
+	buildGraph(isReplayed, params);
 
-		groupNode->sortSubNodesByName();
-		m_dummyNodes.push_back(groupNode);
+	std::vector<std::function<void()>> tasks;
+	{
+		std::lock_guard<std::mutex> lock(m_layoutMutex);
+		m_layoutRunning = false;
+		tasks.swap(m_afterLayoutTasks);
 	}
 
-	for (int i = 0; i < int(m_dummyNodes.size()); i++)
+	for (const std::function<void()>& task: tasks)
 	{
-		if (groupedNodeIds.find(m_dummyNodes[i]->tokenId) != groupedNodeIds.end())
-		{
-			m_dummyNodes.erase(m_dummyNodes.begin() + i);
-			i--;
-		}
+		task();
 	}
 }
 
-void GraphController::layoutNesting()
+void GraphController::cancelLayout()
 {
-	TRACE();
+	(*m_layoutGeneration)++;
 
-	extendEqualFunctionNames(m_dummyNodes);
-
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		layoutNestingRecursive(node.get());
-	}
-
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		layoutToGrid(node.get());
-	}
-}
-
-void GraphController::extendEqualFunctionNames(const std::vector<std::shared_ptr<DummyNode>>& nodes) const
-{
-	std::multimap<std::wstring, std::shared_ptr<DummyNode>> functionNames;
-	for (auto& node: nodes)
-	{
-		if (node->visible && node->isGraphNode() && node->data->isType(NODE_FUNCTION | NODE_METHOD))
-		{
-			functionNames.emplace(node->name, node);
-		}
-	}
-
-	for (auto it: functionNames)
-	{
-		if (functionNames.count(it.first) < 2)
-		{
-			continue;
-		}
-
-		auto ret = functionNames.equal_range(it.first);
-		for (auto it2 = ret.first; it2 != ret.second; it2++)
-		{
-			it2->second->name =
-				it2->second->data->getNameHierarchy().getRawNameWithSignatureParameters();
-		}
-	}
-
-	for (auto& node: nodes)
-	{
-		if (node->subNodes.size())
-		{
-			extendEqualFunctionNames(node->subNodes);
-		}
-	}
-}
-
-Vec4i GraphController::layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth) const
-{
-	if (!node->visible)
-	{
-		return Vec4i(0, 0, 0, 0);
-	}
-
-	GraphViewStyle::NodeMargins margins;
-
-	if (node->isGraphNode())
-	{
-		margins = GraphViewStyle::getMarginsForDataNode(
-			node->data->getType().getNodeStyle(), node->data->getType().hasIcon(), node->childVisible);
-	}
-	else if (node->isAccessNode())
-	{
-		margins = GraphViewStyle::getMarginsOfAccessNode(node->accessKind);
-	}
-	else if (node->isExpandToggleNode())
-	{
-		margins = GraphViewStyle::getMarginsOfExpandToggleNode();
-	}
-	else if (node->isBundleNode())
-	{
-		if (node->bundledNodeType.getKind() != NODE_SYMBOL)
-		{
-			margins = GraphViewStyle::getMarginsForDataNode(
-				node->bundledNodeType.getNodeStyle(), node->bundledNodeType.hasIcon(), false);
-		}
-		else
-		{
-			margins = GraphViewStyle::getMarginsOfBundleNode();
-		}
-	}
-	else if (node->isQualifierNode())
-	{
-		return Vec4i(0, 0, 0, 0);
-	}
-	else if (node->isTextNode())
-	{
-		margins = GraphViewStyle::getMarginsOfTextNode(node->fontSizeDiff);
-	}
-	else if (node->isGroupNode())
-	{
-		margins = GraphViewStyle::getMarginsOfGroupNode(node->groupType, node->name.size());
-	}
-
-	int width = 0;
-	int height = 0;
-
-	if (node->isGraphNode())
-	{
-		node->name = utility::elide(node->name, utility::ELIDE_RIGHT, node->active ? 100 : 50);
-		width = static_cast<int>(margins.charWidth * node->name.size());
-
-		if (node->data->getType().isCollapsible() && node->data->getChildCount() > 0)
-		{
-			addExpandToggleNode(node);
-		}
-	}
-	else if (node->isBundleNode() || node->isTextNode())
-	{
-		width = static_cast<int>(margins.charWidth * node->name.size());
-	}
-	else if (node->isGroupNode())
-	{
-		width = static_cast<int>(margins.charWidth * node->name.size() + 5);
-	}
-
-	width += margins.iconWidth;
-	width = std::max(width, margins.minWidth);
-
-	if (relayoutAccessMaxWidth == -1)
-	{
-		int maxAccessWidth = 0;
-		std::shared_ptr<const DummyNode> maxWidthAccessNode;
-
-		for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-		{
-			if (!subNode->visible)
-			{
-				continue;
-			}
-			else if (subNode->isQualifierNode())
-			{
-				subNode->position.y = static_cast<int>(margins.top + margins.charHeight / 2);
-				width += 5;
-				continue;
-			}
-
-			Vec4i rect = layoutNestingRecursive(subNode.get());
-
-			if (subNode->isExpandToggleNode())
-			{
-				width += margins.spacingX + subNode->size.x;
-			}
-			else if (subNode->isAccessNode() && rect.z() > maxAccessWidth)
-			{
-				maxAccessWidth = rect.z();
-				maxWidthAccessNode = subNode;
-			}
-		}
-
-		if (maxAccessWidth > 0)
-		{
-			for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-			{
-				if (subNode->visible && subNode->isAccessNode() && subNode != maxWidthAccessNode)
-				{
-					layoutNestingRecursive(subNode.get(), maxAccessWidth);
-				}
-			}
-		}
-	}
-
-	if (node->subNodes.size())
-	{
-		if (node->isGroupNode())
-		{
-			Vec2i viewSize = getView()->getViewSize();
-
-			switch (node->groupLayout)
-			{
-			case GroupLayout::LIST:
-				viewSize.x = viewSize.x - 150;	  // prevent horizontal scroll
-				ListLayouter::layoutMultiColumn(viewSize, &node->subNodes);
-				break;
-
-			case GroupLayout::SKEWED:
-				ListLayouter::layoutSkewed(
-					&node->subNodes,
-					margins.spacingX,
-					margins.spacingY,
-					static_cast<int>(viewSize.x() * 1.5));
-				break;
-
-			case GroupLayout::BUCKET:
-				if (node->hasActiveSubNode() || !m_activeNodeIds.size() /* bundled edges */)
-				{
-					BucketLayouter grid(viewSize);
-					grid.createBuckets(node->subNodes, m_dummyEdges);
-					grid.layoutBuckets(m_activeNodeIds.size());
-					node->subNodes = grid.getSortedNodes();
-				}
-				else
-				{
-					ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
-				}
-				break;
-
-			case GroupLayout::SQUARE:
-				ListLayouter::layoutSquare(&node->subNodes, -1);
-				break;
-			}
-		}
-		else if (node->isAccessNode() && !node->hasConnectedSubNode())
-		{
-			ListLayouter::layoutSquare(&node->subNodes, relayoutAccessMaxWidth);
-		}
-		else
-		{
-			ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
-		}
-	}
-
-	Vec2i size = ListLayouter::offsetNodes(
-		node->subNodes,
-		static_cast<int>(margins.top + margins.charHeight + margins.spacingA),
-		margins.left);
-
-	width = std::max(size.x(), width);
-	height = size.y();
-
-	node->size.x = margins.left + width + margins.right;
-	node->size.y = static_cast<int>(
-		margins.top + margins.charHeight + margins.spacingA + height + margins.bottom);
-
-	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-	{
-		if (!subNode->visible)
-		{
-			continue;
-		}
-
-		if (subNode->isAccessNode())
-		{
-			subNode->size.x = width;
-		}
-		else if (subNode->isExpandToggleNode())
-		{
-			subNode->position.x = margins.left + width - subNode->size.x;
-			subNode->position.y = 6;
-		}
-	}
-
-	return ListLayouter::boundingRect(node->subNodes);
-}
-
-void GraphController::addExpandToggleNode(DummyNode* node) const
-{
-	std::shared_ptr<DummyNode> expandNode = std::make_shared<DummyNode>(
-		DummyNode::DUMMY_EXPAND_TOGGLE);
-	expandNode->expanded = node->expanded;
-	expandNode->visible = true;
-
-	size_t visibleSubNodeCount = 0;
-	for (size_t i = 0; i < node->subNodes.size(); i++)
-	{
-		DummyNode* subNode = node->subNodes[i].get();
-
-		if (subNode->isExpandToggleNode())
-		{
-			node->subNodes.erase(node->subNodes.begin() + i);
-			i--;
-			continue;
-		}
-
-		if (subNode->isQualifierNode())
-		{
-			continue;
-		}
-
-		for (const std::shared_ptr<DummyNode>& subSubNode: subNode->subNodes)
-		{
-			if ((subSubNode->visible || subSubNode->hidden) &&
-				(!subSubNode->isGraphNode() || !subSubNode->data->isImplicit() ||
-				 node->data->isImplicit()))
-			{
-				visibleSubNodeCount++;
-			}
-		}
-	}
-
-	expandNode->invisibleSubNodeCount = node->data->getChildCount() - visibleSubNodeCount;
-	if ((expandNode->isExpanded() && visibleSubNodeCount > 0) || expandNode->invisibleSubNodeCount)
-	{
-		node->subNodes.push_back(expandNode);
-	}
-}
-
-void GraphController::layoutToGrid(DummyNode* node) const
-{
-	if (!node->visible || !node->isGraphNode() || !node->hasVisibleSubNode())
-	{
-		return;
-	}
-
-	// Increase size of nodes with visible chilren to cover full grid cells
-
-	size_t width = GraphViewStyle::toGridSize(node->size.x);
-	size_t height = GraphViewStyle::toGridSize(node->size.y);
-
-	size_t incX = width - node->size.x;
-	size_t incY = height - node->size.y;
-
-	DummyNode* lastAccessNode = nullptr;
-	DummyNode* expandToggleNode = nullptr;
-
-	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-	{
-		if (!subNode->visible)
-		{
-			continue;
-		}
-
-		if (subNode->isAccessNode())
-		{
-			subNode->size.x = static_cast<int>(subNode->size.x + incX);
-			lastAccessNode = subNode.get();
-		}
-		else if (subNode->isExpandToggleNode())
-		{
-			expandToggleNode = subNode.get();
-		}
-	}
-
-	if (lastAccessNode)
-	{
-		lastAccessNode->size.y = static_cast<int>(lastAccessNode->size.y + incY);
-
-		if (expandToggleNode)
-		{
-			expandToggleNode->position.x = static_cast<int>(expandToggleNode->position.x + incX);
-		}
-
-		node->size.x = static_cast<int>(width);
-		node->size.y = static_cast<int>(height);
-	}
-}
-
-void GraphController::layoutGraph(bool getSortedNodes)
-{
-	TRACE();
-
-	std::vector<std::shared_ptr<DummyNode>> visibleNodes;
-	for (auto node: m_dummyNodes)
-	{
-		if (node->visible)
-		{
-			visibleNodes.push_back(node);
-		}
-	}
-
-	BucketLayouter grid(getView()->getViewSize());
-	grid.createBuckets(visibleNodes, m_dummyEdges);
-	grid.layoutBuckets(false);
-
-	if (getSortedNodes)
-	{
-		m_dummyNodes = grid.getSortedNodes();
-	}
-}
-
-void GraphController::layoutList()
-{
-	TRACE();
-
-	ListLayouter::layoutMultiColumn(getView()->getViewSize(), &m_dummyNodes);
-}
-
-void GraphController::layoutTrail(bool horizontal, bool hasOrigin)
-{
-	TrailLayouter::LayoutDirection direction;
-	if (horizontal)
-	{
-		if (hasOrigin)
-		{
-			direction = TrailLayouter::LAYOUT_LEFT_RIGHT;
-		}
-		else
-		{
-			direction = TrailLayouter::LAYOUT_RIGHT_LEFT;
-		}
-	}
-	else
-	{
-		if (hasOrigin)
-		{
-			direction = TrailLayouter::LAYOUT_TOP_BOTTOM;
-		}
-		else
-		{
-			direction = TrailLayouter::LAYOUT_BOTTOM_TOP;
-		}
-	}
-
-	std::vector<std::shared_ptr<DummyNode>> visibleNodes;
-	for (auto node: m_dummyNodes)
-	{
-		if (node->visible)
-		{
-			visibleNodes.push_back(node);
-		}
-	}
-
-	TrailLayouter layout(direction);
-	layout.layoutGraph(visibleNodes, m_dummyEdges, m_topLevelAncestorIds);
-}
-
-void GraphController::assignBundleIds()
-{
-	Id bundleId = 0;
-	for (size_t i = m_dummyNodes.size(); i > 0; i--)
-	{
-		bundleId = m_dummyNodes[i - 1]->setBundleIdRecursive(bundleId);
-	}
-}
-
-std::shared_ptr<DummyNode> GraphController::getDummyGraphNodeById(Id tokenId) const
-{
-	std::map<Id, std::shared_ptr<DummyNode>>::const_iterator it = m_dummyGraphNodes.find(tokenId);
-	if (it != m_dummyGraphNodes.end())
-	{
-		return it->second;
-	}
-
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		if (node->tokenId == tokenId)
-		{
-			return node;
-		}
-	}
-
-	return nullptr;
-}
-
-DummyEdge* GraphController::getDummyGraphEdgeById(Id tokenId) const
-{
-	for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
-	{
-		if (edge->data && edge->data->getId() == tokenId)
-		{
-			return edge.get();
-		}
-	}
-
-	return nullptr;
-}
-
-void GraphController::relayoutGraph(
-	MessageBase* message,
-	GraphView::GraphParams params,
-	bool withCharacterIndex,
-	const std::wstring& groupName)
-{
-	bool showsTrail = m_graph->getTrailMode() != Graph::TRAIL_NONE;
-
-	setVisibility(setActive(utility::concat(m_activeNodeIds, m_activeEdgeIds), showsTrail));
-
-	if (hasCharacterIndex() || withCharacterIndex)
-	{
-		addCharacterIndex();
-
-		if (withCharacterIndex && m_dummyNodes.size())
-		{
-			// Use token Id of first node and make first 2 bits 1
-			Id groupId = ~(~Id(0) >> 2) + m_dummyNodes[0]->tokenId;
-
-			DummyNode* group = groupAllNodes(GroupType::DEFAULT, groupId);
-			group->groupLayout = GroupLayout::LIST;
-			group->interactive = false;
-			group->name = groupName;
-		}
-
-		layoutNesting();
-		layoutList();
-	}
-	else
-	{
-		if (!showsTrail)
-		{
-			groupNodesByParents(getView()->getGrouping());
-		}
-
-		layoutNesting();
-
-		if (showsTrail)
-		{
-			layoutTrail(
-				m_graph->getTrailMode() == Graph::TRAIL_HORIZONTAL, m_graph->hasTrailOrigin());
-		}
-		else
-		{
-			layoutGraph();
-		}
-	}
-
-	buildGraph(message, params);
-}
-
-void GraphController::buildGraph(MessageBase* message, GraphView::GraphParams params)
-{
-	if (!message->isReplayed())
-	{
-		params.isIndexedList = params.scrollToTop;
-		params.bezierEdges = m_useBezierEdges;
-		params.disableInteraction = m_showsLegend;
-		params.tokenIdToFocus = m_tokenIdToFocus;
-
-		getView()->rebuildGraph(m_graph, m_dummyNodes, m_dummyEdges, params);
-
-		m_tokenIdToFocus = 0;
-	}
+	std::lock_guard<std::mutex> lock(m_layoutMutex);
+	m_layoutRunning = false;
+	m_afterLayoutTasks.clear();
 }
 
 void GraphController::forEachDummyNodeRecursive(std::function<void(DummyNode*)> func)
@@ -1,7 +1,10 @@
 #ifndef GRAPH_CONTROLLER_H
 #define GRAPH_CONTROLLER_H
 
-#include <list>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "MessageActivateErrors.h"
@@ -26,6 +29,7 @@
 
 #include "Controller.h"
 #include "DummyEdge.h"
+#include "DummyGraph.h"
 #include "DummyNode.h"
 #include "GraphView.h"
 #include "Node.h"
@@ -53,10 +57,11 @@ class GraphController
 	, public MessageListener<MessageGraphNodeMove>
 	, public MessageListener<MessageScrollGraph>
 	, public MessageListener<MessageShowReference>
+	, private DummyGraph
 {
 public:
 	GraphController(StorageAccess* storageAccess);
-	~GraphController() = default;
+	~GraphController();
 
 	Id getSchedulerId() const override;
 
@@ -108,51 +113,31 @@ private:
 
 	void hideBuiltinTypes();
 
-	void bundleNodes();
-	void bundleNodesAndEdgesMatching(
-		std::function<bool(const DummyNode::BundleInfo&, const Node*)> matcher,
-		size_t count,
-		bool countConnectedNodes,
-		const std::wstring& name);
-	std::shared_ptr<DummyNode> bundleNodesMatching(
-		std::list<std::shared_ptr<DummyNode>>& nodes,
-		std::function<bool(const DummyNode*)> matcher,
-		const std::wstring& name);
-	std::shared_ptr<DummyNode> bundleByType(
-		std::list<std::shared_ptr<DummyNode>>& nodes,
-		const NodeType& type,
-		const Tree<NodeType::BundleInfo>& bundleInfoTree,
-		const bool considerInvisibleNodes);
-	void bundleNodesByType();
-
-	void addCharacterIndex();
-	bool hasCharacterIndex() const;
-
-	void groupNodesByParents(GroupType groupType);
-	DummyNode* groupAllNodes(GroupType groupType, Id groupNodeId);
-	void groupTrailNodes(GroupType groupType);
-
-	void layoutNesting();
-	void extendEqualFunctionNames(const std::vector<std::shared_ptr<DummyNode>>& nodes) const;
-	Vec4i layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth = -1) const;
-	void addExpandToggleNode(DummyNode* node) const;
-	void layoutToGrid(DummyNode* node) const;
-
-	void layoutGraph(bool getSortedNodes = false);
-	void layoutList();
-	void layoutTrail(bool horizontal, bool hasOrigin);
-
-	void assignBundleIds();
-
-	std::shared_ptr<DummyNode> getDummyGraphNodeById(Id tokenId) const;
-	DummyEdge* getDummyGraphEdgeById(Id tokenId) const;
-
 	void relayoutGraph(
 		MessageBase* message,
 		GraphView::GraphParams params,
 		bool withCharacterIndex,
 		const std::wstring& groupName);
 	void buildGraph(MessageBase* message, GraphView::GraphParams params);
+	void buildGraph(bool isReplayed, GraphView::GraphParams params);
+
+	// stores the view size and the parents used by groupNodesByParents, so layouts don't need to
+	// access the view or the storage
+	void captureLayoutInputs(GroupType groupType);
+
+	// Layouts of newly activated graphs run on a clone of the dummy graph on a background thread.
+	// The result is posted back to this controller's scheduler and dropped if a newer layout or
+	// clear() came in between. Messages that rely on the layouted graph wait for it.
+	void startLayout(
+		MessageBase* message,
+		GraphView::GraphParams params,
+		std::function<void(DummyGraph&, std::function<bool()>)> layout);
+	void finishLayout(
+		std::shared_ptr<DummyGraph> dummyGraph, bool isReplayed, GraphView::GraphParams params);
+	void cancelLayout();
+
+	template <typename MessageType>
+	bool deferUntilLayouted(MessageType* message);
 
 	void forEachDummyNodeRecursive(std::function<void(DummyNode*)> func);
 	void forEachDummyEdge(std::function<void(DummyEdge*)> func);
@@ -161,21 +146,30 @@ private:
 
 	StorageAccess* m_storageAccess;
 
-	std::vector<std::shared_ptr<DummyNode>> m_dummyNodes;
-	std::vector<std::shared_ptr<DummyEdge>> m_dummyEdges;
-
-	std::map<Id, std::shared_ptr<DummyNode>> m_dummyGraphNodes;
-
-	std::vector<Id> m_activeNodeIds;
 	std::vector<Id> m_activeEdgeIds;
 
-	std::shared_ptr<Graph> m_graph;
-
-	std::map<Id, Id> m_topLevelAncestorIds;
-
-	bool m_useBezierEdges = false;
 	bool m_showsLegend = false;
 	Id m_tokenIdToFocus = 0;
+
+	// the app thread clears components too, so the layout bookkeeping is guarded by a mutex
+	std::shared_ptr<std::atomic<size_t>> m_layoutGeneration;
+	std::mutex m_layoutMutex;
+	bool m_layoutRunning = false;
+	std::vector<std::function<void()>> m_afterLayoutTasks;
 };
 
+template <typename MessageType>
+bool GraphController::deferUntilLayouted(MessageType* message)
+{
+	std::lock_guard<std::mutex> lock(m_layoutMutex);
+	if (!m_layoutRunning)
+	{
+		return false;
+	}
+
+	std::shared_ptr<MessageType> messageCopy = std::make_shared<MessageType>(*message);
+	m_afterLayoutTasks.push_back([this, messageCopy]() { handleMessage(messageCopy.get()); });
+	return true;
+}
+
 #endif	  // GRAPH_CONTROLLER_H
@@ -244,6 +244,11 @@ BucketLayouter::BucketLayouter(Vec2i viewSize)
 	m_buckets[0][0] = Bucket(0, 0);
 }
 
+void BucketLayouter::setIsCancelled(std::function<bool()> isCancelled)
+{
+	m_isCancelled = isCancelled;
+}
+
 void BucketLayouter::createBuckets(
 	std::vector<std::shared_ptr<DummyNode>>& nodes,
 	const std::vector<std::shared_ptr<DummyEdge>>& edges)
@@ -282,6 +287,11 @@ void BucketLayouter::createBuckets(
 
 	while (remainingEdges.size())
 	{
+		if (isCancelled())
+		{
+			return;
+		}
+
 		if (skipCount == remainingEdges.size())
 		{
 			force = true;
@@ -372,6 +382,11 @@ void BucketLayouter::layoutBuckets(bool addVerticalSplit)
 
 	for (int j = m_j1; j <= m_j2; j++)
 	{
+		if (isCancelled())
+		{
+			return;
+		}
+
 		for (int i = m_i1; i <= m_i2; i++)
 		{
 			Bucket* bucket = &m_buckets[j][i];
@@ -587,3 +602,8 @@ Bucket* BucketLayouter::getBucket(std::shared_ptr<DummyNode> node)
 
 	return nullptr;
 }
+
+bool BucketLayouter::isCancelled() const
+{
+	return m_isCancelled && m_isCancelled();
+}
@@ -1,6 +1,7 @@
 #ifndef BUCKET_LAYOUTER_H
 #define BUCKET_LAYOUTER_H
 
+#include <functional>
 #include <map>
 
 #include "Vector2.h"
@@ -46,6 +47,10 @@ class BucketLayouter
 {
 public:
 	BucketLayouter(Vec2i viewSize);
+
+	// stops layouting early once the callback returns true, the result is unusable then
+	void setIsCancelled(std::function<bool()> isCancelled);
+
 	void createBuckets(
 		std::vector<std::shared_ptr<DummyNode>>& nodes,
 		const std::vector<std::shared_ptr<DummyEdge>>& edges);
@@ -60,6 +65,8 @@ private:
 	Bucket* getBucket(int i, int j);
 	Bucket* getBucket(std::shared_ptr<DummyNode> node);
 
+	bool isCancelled() const;
+
 	Vec2i m_viewSize;
 	std::map<int, std::map<int, Bucket>> m_buckets;
 
@@ -69,6 +76,8 @@ private:
 	int m_j2;
 
 	DummyNode* m_activeParentNode = nullptr;
+
+	std::function<bool()> m_isCancelled;
 };
 
 #endif	  // BUCKET_LAYOUTER_H
@@ -0,0 +1,1321 @@
+#include "DummyGraph.h"
+
+#include <set>
+
+#include "BucketLayouter.h"
+#include "FilePath.h"
+#include "Graph.h"
+#include "GraphViewStyle.h"
+#include "ListLayouter.h"
+#include "TokenComponentBundledEdges.h"
+#include "logging.h"
+#include "tracing.h"
+#include "utility.h"
+#include "utilityString.h"
+
+namespace
+{
+std::shared_ptr<DummyNode> cloneNode(
+	const std::shared_ptr<DummyNode>& node,
+	std::map<const DummyNode*, std::shared_ptr<DummyNode>>* clonedNodes)
+{
+	if (!node)
+	{
+		return nullptr;
+	}
+
+	auto it = clonedNodes->find(node.get());
+	if (it != clonedNodes->end())
+	{
+		return it->second;
+	}
+
+	std::shared_ptr<DummyNode> clone = std::make_shared<DummyNode>(*node);
+	clonedNodes->emplace(node.get(), clone);
+
+	for (std::shared_ptr<DummyNode>& subNode: clone->subNodes)
+	{
+		subNode = cloneNode(subNode, clonedNodes);
+	}
+
+	clone->bundledNodes.clear();
+	for (const std::shared_ptr<DummyNode>& bundledNode: node->bundledNodes)
+	{
+		clone->bundledNodes.insert(cloneNode(bundledNode, clonedNodes));
+	}
+
+	return clone;
+}
+}	 // namespace
+
+DummyGraph DummyGraph::clone() const
+{
+	DummyGraph graph(*this);
+
+	std::map<const DummyNode*, std::shared_ptr<DummyNode>> clonedNodes;
+
+	graph.m_dummyNodes.clear();
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		graph.m_dummyNodes.push_back(cloneNode(node, &clonedNodes));
+	}
+
+	graph.m_dummyGraphNodes.clear();
+	for (const std::pair<const Id, std::shared_ptr<DummyNode>>& p: m_dummyGraphNodes)
+	{
+		graph.m_dummyGraphNodes.emplace(p.first, cloneNode(p.second, &clonedNodes));
+	}
+
+	graph.m_dummyEdges.clear();
+	for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
+	{
+		graph.m_dummyEdges.push_back(std::make_shared<DummyEdge>(*edge));
+	}
+
+	return graph;
+}
+
+void DummyGraph::bundleNodes()
+{
+	TRACE();
+
+	// evaluate top level nodes
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		if (!node->isGraphNode() || !node->visible)
+		{
+			continue;
+		}
+
+		DummyNode::BundleInfo* bundleInfo = &node->bundleInfo;
+		bundleInfo->isActive = node->hasActiveSubNode();
+
+		node->data->forEachNodeRecursive([&bundleInfo](const Node* n) {
+			if (n->isDefined())
+			{
+				bundleInfo->isDefined = true;
+			}
+
+			if (bundleInfo->layoutVertical)
+			{
+				return;
+			}
+
+			n->forEachEdgeOfType(~Edge::EDGE_MEMBER, [&bundleInfo, &n](Edge* e) {
+				if (bundleInfo->layoutVertical)
+				{
+					return;
+				}
+
+				if (e->isType(Edge::LAYOUT_VERTICAL))
+				{
+					bundleInfo->layoutVertical = true;
+					bundleInfo->isReferenced = false;
+					bundleInfo->isReferencing = false;
+				}
+
+				if (e->isType(Edge::EDGE_BUNDLED_EDGES))
+				{
+					TokenComponentBundledEdges::Direction dir =
+						e->getComponent<TokenComponentBundledEdges>()->getDirection();
+
+					if (dir == TokenComponentBundledEdges::DIRECTION_NONE)
+					{
+						bundleInfo->isReferenced = true;
+						bundleInfo->isReferencing = true;
+					}
+					else if (
+						(dir == TokenComponentBundledEdges::DIRECTION_FORWARD && e->getFrom() == n) ||
+						(dir == TokenComponentBundledEdges::DIRECTION_BACKWARD && e->getTo() == n))
+					{
+						bundleInfo->isReferencing = true;
+					}
+					else if (
+						(dir == TokenComponentBundledEdges::DIRECTION_FORWARD && e->getTo() == n) ||
+						(dir == TokenComponentBundledEdges::DIRECTION_BACKWARD && e->getFrom() == n))
+					{
+						bundleInfo->isReferenced = true;
+					}
+				}
+				else
+				{
+					if (e->getTo() == n)
+					{
+						bundleInfo->isReferenced = true;
+					}
+					else if (e->getFrom() == n)
+					{
+						bundleInfo->isReferencing = true;
+					}
+				}
+			});
+		});
+
+		if (bundleInfo->isReferenced && bundleInfo->isReferencing)
+		{
+			bundleInfo->isReferenced = false;
+			bundleInfo->isReferencing = false;
+		}
+
+		if (bundleInfo->isActive)
+		{
+			bundleInfo->layoutVertical = false;
+		}
+	}
+
+	// Left for debugging
+	// for (std::shared_ptr<DummyNode> node : m_dummyNodes)
+	// {
+	// 	std::cout << node->bundleInfo.isActive << " ";
+	// 	std::cout << node->bundleInfo.isDefined << " ";
+	// 	std::cout << node->bundleInfo.layoutVertical << " ";
+	// 	std::cout << node->bundleInfo.isReferenced << " ";
+	// 	std::cout << node->bundleInfo.isReferencing << " ";
+	// 	std::wcout << node->name << std::endl;
+	// }
+
+	// bundle
+	bool fileOrMacroActive = false;
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		if (node->bundleInfo.isActive &&
+			(node->data->isType(NODE_FILE | NODE_MACRO) ||
+			 node->data->findEdgeOfType(Edge::EDGE_INCLUDE | Edge::EDGE_MACRO_USAGE) != nullptr))
+		{
+			fileOrMacroActive = true;
+			break;
+		}
+	}
+
+	if (fileOrMacroActive)
+	{
+		return;
+	}
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return data->getType().isFile() && data->findEdgeOfType(Edge::EDGE_IMPORT);
+		},
+		1,
+		false,
+		L"Importing Files");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return !info.isDefined && info.isReferencing && !info.layoutVertical;
+		},
+		2,
+		true,
+		L"Non-indexed Symbols");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return !info.isDefined && info.isReferenced && !info.layoutVertical;
+		},
+		2,
+		true,
+		L"Non-indexed Symbols");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return info.isDefined && info.isReferenced && data->getType().isBuiltin();
+		},
+		3,
+		false,
+		L"Built-in Types");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return info.isDefined && info.isReferencing && !info.layoutVertical;
+		},
+		10,
+		false,
+		L"Referencing Symbols");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return info.isDefined && info.isReferenced && !info.layoutVertical;
+		},
+		10,
+		false,
+		L"Referenced Symbols");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return info.isReferencing && info.layoutVertical &&
+				data->findEdgeOfType(Edge::EDGE_TEMPLATE_SPECIALIZATION);
+		},
+		5,
+		false,
+		L"Specializing Symbols");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return info.isReferencing && info.layoutVertical &&
+				data->findEdgeOfType(Edge::EDGE_INHERITANCE);
+		},
+		5,
+		false,
+		L"Derived Symbols");
+
+	bundleNodesAndEdgesMatching(
+		[](const DummyNode::BundleInfo& info, const Node* data) {
+			return info.isReferenced && info.layoutVertical &&
+				data->findEdgeOfType(Edge::EDGE_INHERITANCE);
+		},
+		5,
+		false,
+		L"Base Symbols");
+}
+
+void DummyGraph::bundleNodesAndEdgesMatching(
+	std::function<bool(const DummyNode::BundleInfo&, const Node* data)> matcher,
+	size_t count,
+	bool countConnectedNodes,
+	const std::wstring& name)
+{
+	std::vector<size_t> matchedNodeIndices;
+	size_t connectedNodeCount = 0;
+	for (size_t i = 0; i < m_dummyNodes.size(); i++)
+	{
+		const DummyNode* node = m_dummyNodes[i].get();
+		if (node->bundleInfo.isActive || !node->visible || !node->isGraphNode())
+		{
+			continue;
+		}
+
+		if (matcher(node->bundleInfo, node->data))
+		{
+			matchedNodeIndices.push_back(i);
+
+			if (countConnectedNodes)
+			{
+				connectedNodeCount += node->getConnectedSubNodes().size();
+			}
+		}
+	}
+
+	size_t matchedNodeCount = countConnectedNodes ? connectedNodeCount : matchedNodeIndices.size();
+	if (!matchedNodeIndices.size() || matchedNodeCount < count ||
+		matchedNodeIndices.size() == m_dummyNodes.size())
+	{
+		return;
+	}
+
+	std::shared_ptr<DummyNode> bundleNode = std::make_shared<DummyNode>(DummyNode::DUMMY_BUNDLE);
+	bundleNode->name = name;
+	bundleNode->visible = true;
+
+	for (int i = static_cast<int>(matchedNodeIndices.size()) - 1; i >= 0; i--)
+	{
+		std::shared_ptr<DummyNode> node = m_dummyNodes[matchedNodeIndices[i]];
+		node->visible = false;
+
+		bundleNode->bundledNodes.insert(node);
+		bundleNode->bundledNodeCount += node->getBundledNodeCount();
+
+		m_dummyNodes.erase(m_dummyNodes.begin() + matchedNodeIndices[i]);
+	}
+
+	if (countConnectedNodes)
+	{
+		bundleNode->bundledNodeCount = connectedNodeCount;
+	}
+
+	DummyNode* firstNode = bundleNode->bundledNodes.begin()->get();
+
+	// Use token Id of first node and make first bit 1
+	bundleNode->tokenId = ~(~Id(0) >> 1) + firstNode->data->getId();
+	bundleNode->bundleInfo.layoutVertical = firstNode->bundleInfo.layoutVertical;
+	bundleNode->bundleInfo.isReferenced = firstNode->bundleInfo.isReferenced;
+	bundleNode->bundleInfo.isReferencing = firstNode->bundleInfo.isReferencing;
+	m_dummyNodes.push_back(bundleNode);
+
+	if (m_dummyEdges.size() == 0)
+	{
+		return;
+	}
+
+	std::vector<std::shared_ptr<DummyEdge>> bundleEdges;
+	std::vector<const DummyNode*> bundledNodes = bundleNode->getAllBundledNodes();
+	for (const DummyNode* node: bundledNodes)
+	{
+		for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
+		{
+			bool owner = (edge->ownerId == node->data->getId());
+			bool target = (edge->targetId == node->data->getId());
+
+			if (!owner && !target)
+			{
+				continue;
+			}
+
+			DummyEdge* bundleEdgePtr = nullptr;
+			for (const std::shared_ptr<DummyEdge>& bundleEdge: bundleEdges)
+			{
+				if ((owner && bundleEdge->ownerId == edge->targetId) ||
+					(target && bundleEdge->ownerId == edge->ownerId))
+				{
+					bundleEdgePtr = bundleEdge.get();
+					break;
+				}
+			}
+
+			if (!bundleEdgePtr)
+			{
+				std::shared_ptr<DummyEdge> bundleEdge = std::make_shared<DummyEdge>();
+				bundleEdge->visible = true;
+				bundleEdge->ownerId = (owner ? edge->targetId : edge->ownerId);
+				bundleEdge->targetId = bundleNode->tokenId;
+				bundleEdges.push_back(bundleEdge);
+				bundleEdgePtr = bundleEdges.back().get();
+			}
+
+			bundleEdgePtr->weight += edge->getWeight();
+			bundleEdgePtr->updateDirection(edge->getDirection(), owner);
+			edge->visible = false;
+		}
+	}
+
+	m_dummyEdges.insert(m_dummyEdges.end(), bundleEdges.begin(), bundleEdges.end());
+}
+
+std::shared_ptr<DummyNode> DummyGraph::bundleNodesMatching(
+	std::list<std::shared_ptr<DummyNode>>& nodes,
+	std::function<bool(const DummyNode*)> matcher,
+	const std::wstring& name)
+{
+	std::vector<std::list<std::shared_ptr<DummyNode>>::iterator> matchedNodes;
+	for (std::list<std::shared_ptr<DummyNode>>::iterator it = nodes.begin(); it != nodes.end(); it++)
+	{
+		if (matcher(it->get()))
+		{
+			matchedNodes.push_back(it);
+		}
+	}
+
+	if (matchedNodes.empty())
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<DummyNode> bundleNode = std::make_shared<DummyNode>(DummyNode::DUMMY_BUNDLE);
+	bundleNode->name = name;
+	bundleNode->visible = true;
+
+	for (int i = static_cast<int>(matchedNodes.size()) - 1; i >= 0; i--)
+	{
+		std::shared_ptr<DummyNode> node = *matchedNodes[i];
+		node->visible = false;
+
+		bundleNode->bundledNodes.insert(node);
+		nodes.erase(matchedNodes[i]);
+	}
+
+	// Use token Id of first node and make first bit 1
+	bundleNode->tokenId = ~(~Id(0) >> 1) + (*bundleNode->bundledNodes.begin())->data->getId();
+	return bundleNode;
+}
+
+std::shared_ptr<DummyNode> DummyGraph::bundleByType(
+	std::list<std::shared_ptr<DummyNode>>& nodes,
+	const NodeType& type,
+	const Tree<NodeType::BundleInfo>& bundleInfoTree,
+	const bool considerInvisibleNodes)
+{
+	std::shared_ptr<DummyNode> bundleNode = bundleNodesMatching(
+		nodes,
+		[&](const DummyNode* node) {
+			return (considerInvisibleNodes || node->visible) && node->isGraphNode() &&
+				node->data->getType() == type && bundleInfoTree.data.nameMatcher(node->name);
+		},
+		bundleInfoTree.data.bundleName);
+
+	if (bundleNode)
+	{
+		bundleNode->bundledNodeType = type;
+		bundleNode->bundledNodeCount = bundleNode->getBundledNodeCount();
+
+		if (!bundleInfoTree.children.empty())
+		{
+			std::list<std::shared_ptr<DummyNode>> bundledNodes(
+				bundleNode->bundledNodes.begin(), bundleNode->bundledNodes.end());
+			bundleNode->bundledNodes.clear();
+
+			// crate a sub-bundle for anonymous namespaces
+			for (const Tree<NodeType::BundleInfo>& childBundleInfoTree: bundleInfoTree.children)
+			{
+				std::shared_ptr<DummyNode> childBundle = bundleByType(
+					bundledNodes, type, childBundleInfoTree, true);
+				if (childBundle)
+				{
+					bundleNode->bundledNodes.insert(childBundle);
+				}
+			}
+
+			bundleNode->bundledNodes.insert(bundledNodes.begin(), bundledNodes.end());
+		}
+	}
+
+	return bundleNode;
+}
+
+void DummyGraph::bundleNodesByType()
+{
+	TRACE();
+
+	std::list<std::shared_ptr<DummyNode>> nodes(m_dummyNodes.begin(), m_dummyNodes.end());
+	std::vector<std::shared_ptr<DummyNode>> oldNodes = std::move(m_dummyNodes);
+	m_dummyNodes.clear();
+
+	bool hasNonFileBundle = false;
+
+	for (const NodeType& nodeType: NodeType::overviewBundleNodeTypesOrdered)
+	{
+		Tree<NodeType::BundleInfo> bundleInfoTree = nodeType.getOverviewBundleTree();
+		if (bundleInfoTree.data.isValid())
+		{
+			std::shared_ptr<DummyNode> bundleNode = bundleByType(
+				nodes, nodeType, bundleInfoTree, false);
+			if (bundleNode)
+			{
+				m_dummyNodes.push_back(bundleNode);
+
+				if (bundleNode->bundledNodeType.getKind() != NODE_FILE)
+				{
+					hasNonFileBundle = true;
+				}
+			}
+		}
+	}
+
+	if (nodes.size() && !hasNonFileBundle)
+	{
+		Tree<NodeType::BundleInfo> bundleInfoTree(NodeType::BundleInfo(L"Symbols"));
+		std::shared_ptr<DummyNode> bundleNode = bundleByType(
+			nodes, NodeType(NODE_SYMBOL), bundleInfoTree, false);
+		if (bundleNode)
+		{
+			m_dummyNodes.push_back(bundleNode);
+		}
+	}
+
+	if (nodes.size())
+	{
+		LOG_ERROR("Nodes left after bundling for overview");
+	}
+}
+
+void DummyGraph::addCharacterIndex()
+{
+	// Remove index characters from last time
+	DummyNode::BundledNodesSet newNodes;
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		if (!node->isTextNode())
+		{
+			newNodes.insert(node);
+		}
+	}
+	m_dummyNodes.clear();
+	m_dummyNodes.insert(m_dummyNodes.end(), newNodes.begin(), newNodes.end());
+
+	// Add index characters
+	wchar_t character = 0;
+	for (size_t i = 0; i < m_dummyNodes.size(); i++)
+	{
+		if (!m_dummyNodes[i]->visible || !m_dummyNodes[i]->name.size())
+		{
+			continue;
+		}
+
+		if (towupper(m_dummyNodes[i]->name[0]) != character)
+		{
+			character = towupper(m_dummyNodes[i]->name[0]);
+
+			std::shared_ptr<DummyNode> textNode = std::make_shared<DummyNode>(DummyNode::DUMMY_TEXT);
+			textNode->name = character;
+			textNode->visible = true;
+
+			m_dummyNodes.insert(m_dummyNodes.begin() + i, textNode);
+		}
+	}
+}
+
+bool DummyGraph::hasCharacterIndex() const
+{
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		if (node->isTextNode())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void DummyGraph::groupNodesByParents(GroupType groupType)
+{
+	TRACE();
+
+	if (groupType != GroupType::FILE && groupType != GroupType::NAMESPACE)
+	{
+		return;
+	}
+
+	std::map<std::wstring, std::shared_ptr<DummyNode>> groupNodes;
+	std::map<std::wstring, std::vector<std::shared_ptr<DummyNode>>> nodesToGroup;
+
+	std::map<Id, std::pair<Id, NameHierarchy>> nodeIdtoParentMap;
+	if (groupType == GroupType::FILE)
+	{
+		nodeIdtoParentMap = m_nodeIdToParentFileMap;
+	}
+
+	for (const std::shared_ptr<DummyNode>& dummyNode: m_dummyNodes)
+	{
+		if (dummyNode->isGroupNode())
+		{
+			groupNodes.emplace(dummyNode->name, dummyNode);
+		}
+		else if (dummyNode->visible)
+		{
+			if (groupType == GroupType::FILE)
+			{
+				if (dummyNode->isGraphNode())
+				{
+					auto it = nodeIdtoParentMap.find(dummyNode->tokenId);
+					if (it != nodeIdtoParentMap.end())
+					{
+						nodesToGroup[it->second.second.getQualifiedName()].push_back(dummyNode);
+					}
+				}
+			}
+			else if (groupType == GroupType::NAMESPACE)
+			{
+				const DummyNode* qualifierNode = dummyNode->getQualifierNode();
+				if (qualifierNode)
+				{
+					Id qualifierId = 0;
+					std::wstring qualifierName = qualifierNode->qualifierName.getQualifiedName();
+					auto it = m_qualifierNameToIdMap.find(qualifierName);
+					if (it != m_qualifierNameToIdMap.end())
+					{
+						qualifierId = it->second;
+					}
+
+					nodesToGroup[qualifierName].push_back(dummyNode);
+					nodeIdtoParentMap.emplace(
+						dummyNode->tokenId,
+						std::make_pair(qualifierId, qualifierNode->qualifierName));
+				}
+			}
+		}
+	}
+
+	std::set<Id> groupedNodeIds;
+	for (const std::pair<std::wstring, std::vector<std::shared_ptr<DummyNode>>>& p: nodesToGroup)
+	{
+		std::shared_ptr<DummyNode> groupNode;
+
+		std::wstring name = p.first;
+		if (groupType == GroupType::FILE)
+		{
+			name = FilePath(p.first).fileName();
+		}
+
+		auto it = groupNodes.find(name);
+		if (it != groupNodes.end())
+		{
+			groupNode = it->second;
+		}
+		else
+		{
+			groupNode = std::make_shared<DummyNode>(DummyNode::DUMMY_GROUP);
+			groupNode->visible = true;
+			groupNode->groupType = groupType;
+			groupNode->groupLayout = GroupLayout::BUCKET;
+			groupNode->name = name;
+
+			auto it = nodeIdtoParentMap.find(p.second[0]->tokenId);
+			if (it != nodeIdtoParentMap.end())
+			{
+				groupNode->tokenId = it->second.first;
+			}
+			m_topLevelAncestorIds[groupNode->tokenId] = groupNode->tokenId;
+			m_dummyNodes.push_back(groupNode);
+		}
+
+		for (std::shared_ptr<DummyNode> dummyNode: p.second)
+		{
+			if (dummyNode->hasActiveSubNode())
+			{
+				groupNode->bundleInfo = dummyNode->bundleInfo;
+				groupNode->bundleId = dummyNode->bundleId;
+			}
+
+			groupNode->subNodes.push_back(dummyNode);
+			m_topLevelAncestorIds[dummyNode->tokenId] = groupNode->tokenId;
+			groupedNodeIds.insert(dummyNode->tokenId);
+		}
+
+		if (!groupNode->bundleId)
+		{
+			groupNode->bundleId = groupNode->subNodes[0]->bundleId;
+		}
+
+		groupNode->bundleInfo = DummyNode::BundleInfo::averageBundleInfo(groupNode->getBundleInfos());
+		groupNode->sortSubNodesByName();
+	}
+
+	for (int i = 0; i < int(m_dummyNodes.size()); i++)
+	{
+		if (groupedNodeIds.find(m_dummyNodes[i]->tokenId) != groupedNodeIds.end())
+		{
+			m_dummyNodes.erase(m_dummyNodes.begin() + i);
+			i--;
+		}
+	}
+}
+
+DummyNode* DummyGraph::groupAllNodes(GroupType groupType, Id groupNodeId)
+{
+	TRACE();
+
+	std::shared_ptr<DummyNode> groupNode = std::make_shared<DummyNode>(DummyNode::DUMMY_GROUP);
+	groupNode->visible = true;
+	groupNode->groupType = groupType;
+	groupNode->tokenId = groupNodeId;
+	m_topLevelAncestorIds[groupNode->tokenId] = groupNode->tokenId;
+
+	for (std::shared_ptr<DummyNode> dummyNode: m_dummyNodes)
+	{
+		groupNode->subNodes.push_back(dummyNode);
+		m_topLevelAncestorIds[dummyNode->tokenId] = groupNode->tokenId;
+	}
+
+	if (groupNode->subNodes.size())
+	{
+		m_dummyNodes = {groupNode};
+	}
+
+	return groupNode.get();
+}
+
+void DummyGraph::groupTrailNodes(GroupType groupType)
+{
+	TRACE();
+
+	struct TrailNode
+	{
+		Id nodeId;
+		std::set<Id> targetNodeIds;
+		std::set<Id> originNodeIds;
+
+		std::vector<DummyEdge*> targetEdges;
+		std::vector<DummyEdge*> originEdges;
+	};
+
+	std::set<Id> possibleNodeIds;
+	for (auto dummyNode: m_dummyNodes)
+	{
+		if (dummyNode->visible && dummyNode->tokenId &&
+			(!dummyNode->subNodes.size() ||
+			 (dummyNode->subNodes.size() == 1 && dummyNode->subNodes[0]->isQualifierNode())))
+		{
+			possibleNodeIds.insert(dummyNode->tokenId);
+		}
+	}
+
+	std::map<Id, TrailNode> nodes;
+
+	for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
+	{
+		if (edge->visible && possibleNodeIds.find(edge->ownerId) != possibleNodeIds.end() &&
+			possibleNodeIds.find(edge->targetId) != possibleNodeIds.end())
+		{
+			TrailNode& fromNode = nodes[edge->ownerId];
+			fromNode.nodeId = edge->ownerId;
+			fromNode.targetNodeIds.insert(edge->targetId);
+			fromNode.targetEdges.push_back(edge.get());
+
+			TrailNode& toNode = nodes[edge->targetId];
+			toNode.nodeId = edge->targetId;
+			toNode.originNodeIds.insert(edge->ownerId);
+			toNode.originEdges.push_back(edge.get());
+		}
+	}
+
+	std::set<Id> groupedNodeIds;
+	while (nodes.size())
+	{
+		TrailNode node = nodes.begin()->second;
+		nodes.erase(nodes.begin());
+
+		std::vector<TrailNode> group;
+		std::map<Id, TrailNode>::iterator it = nodes.begin();
+		while (it != nodes.end())
+		{
+			if (node.targetNodeIds.size() <= 1 && it->second.targetNodeIds == node.targetNodeIds &&
+				node.originNodeIds.size() <= 1 && it->second.originNodeIds == node.originNodeIds)
+			{
+				group.push_back(it->second);
+				it = nodes.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+
+		group.push_back(node);
+		if (group.size() < 3)
+		{
+			continue;
+		}
+
+		std::shared_ptr<DummyNode> groupNode = std::make_shared<DummyNode>(DummyNode::DUMMY_GROUP);
+		groupNode->visible = true;
+		groupNode->groupType = groupType;
+		groupNode->groupLayout = GroupLayout::SQUARE;
+
+		// Use token Id of first node and make first 2 bits 1
+		groupNode->tokenId = ~(~Id(0) >> 2) + node.nodeId;
+		m_topLevelAncestorIds[groupNode->tokenId] = groupNode->tokenId;
+
+		std::shared_ptr<DummyEdge> targetEdge = std::make_shared<DummyEdge>();
+		targetEdge->ownerId = groupNode->tokenId;
+
+		std::shared_ptr<DummyEdge> originEdge = std::make_shared<DummyEdge>();
+		originEdge->targetId = groupNode->tokenId;
+
+		std::vector<Id> hiddenEdgeIds;
+
+		for (TrailNode& node: group)
+		{
+			std::shared_ptr<DummyNode> dummyNode = getDummyGraphNodeById(node.nodeId);
+			if (!dummyNode)
+			{
+				continue;
+			}
+
+			groupedNodeIds.insert(node.nodeId);
+			groupNode->subNodes.push_back(dummyNode);
+
+			m_topLevelAncestorIds[node.nodeId] = groupNode->tokenId;
+
+			for (DummyEdge* edge: node.targetEdges)
+			{
+				if (!targetEdge->visible)
+				{
+					targetEdge->visible = true;
+					targetEdge->targetId = edge->targetId;
+					targetEdge->data = edge->data;
+				}
+
+				edge->visible = false;
+				edge->hidden = true;
+
+				if (edge->data)
+				{
+					groupNode->hiddenEdgeIds.push_back(edge->data->getId());
+				}
+			}
+
+			for (DummyEdge* edge: node.originEdges)
+			{
+				if (!originEdge->visible)
+				{
+					originEdge->visible = true;
+					originEdge->ownerId = edge->ownerId;
+					originEdge->data = edge->data;
+				}
+
+				edge->visible = false;
+				edge->hidden = true;
+
+				if (edge->data)
+				{
+					groupNode->hiddenEdgeIds.push_back(edge->data->getId());
+				}
+			}
+		}
+
+		if (targetEdge->visible)
+		{
+			m_dummyEdges.push_back(targetEdge);
+		}
+
+		if (originEdge->visible)
+		{
+			m_dummyEdges.push_back(originEdge);
+		}
+
+		groupNode->sortSubNodesByName();
+		m_dummyNodes.push_back(groupNode);
+	}
+
+	for (int i = 0; i < int(m_dummyNodes.size()); i++)
+	{
+		if (groupedNodeIds.find(m_dummyNodes[i]->tokenId) != groupedNodeIds.end())
+		{
+			m_dummyNodes.erase(m_dummyNodes.begin() + i);
+			i--;
+		}
+	}
+}
+
+void DummyGraph::layoutNesting()
+{
+	TRACE();
+
+	extendEqualFunctionNames(m_dummyNodes);
+
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		layoutNestingRecursive(node.get());
+	}
+
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		layoutToGrid(node.get());
+	}
+}
+
+void DummyGraph::extendEqualFunctionNames(const std::vector<std::shared_ptr<DummyNode>>& nodes) const
+{
+	std::multimap<std::wstring, std::shared_ptr<DummyNode>> functionNames;
+	for (auto& node: nodes)
+	{
+		if (node->visible && node->isGraphNode() && node->data->isType(NODE_FUNCTION | NODE_METHOD))
+		{
+			functionNames.emplace(node->name, node);
+		}
+	}
+
+	for (auto it: functionNames)
+	{
+		if (functionNames.count(it.first) < 2)
+		{
+			continue;
+		}
+
+		auto ret = functionNames.equal_range(it.first);
+		for (auto it2 = ret.first; it2 != ret.second; it2++)
+		{
+			it2->second->name =
+				it2->second->data->getNameHierarchy().getRawNameWithSignatureParameters();
+		}
+	}
+
+	for (auto& node: nodes)
+	{
+		if (node->subNodes.size())
+		{
+			extendEqualFunctionNames(node->subNodes);
+		}
+	}
+}
+
+Vec4i DummyGraph::layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth) const
+{
+	if (!node->visible)
+	{
+		return Vec4i(0, 0, 0, 0);
+	}
+
+	GraphViewStyle::NodeMargins margins;
+
+	if (node->isGraphNode())
+	{
+		margins = GraphViewStyle::getMarginsForDataNode(
+			node->data->getType().getNodeStyle(), node->data->getType().hasIcon(), node->childVisible);
+	}
+	else if (node->isAccessNode())
+	{
+		margins = GraphViewStyle::getMarginsOfAccessNode(node->accessKind);
+	}
+	else if (node->isExpandToggleNode())
+	{
+		margins = GraphViewStyle::getMarginsOfExpandToggleNode();
+	}
+	else if (node->isBundleNode())
+	{
+		if (node->bundledNodeType.getKind() != NODE_SYMBOL)
+		{
+			margins = GraphViewStyle::getMarginsForDataNode(
+				node->bundledNodeType.getNodeStyle(), node->bundledNodeType.hasIcon(), false);
+		}
+		else
+		{
+			margins = GraphViewStyle::getMarginsOfBundleNode();
+		}
+	}
+	else if (node->isQualifierNode())
+	{
+		return Vec4i(0, 0, 0, 0);
+	}
+	else if (node->isTextNode())
+	{
+		margins = GraphViewStyle::getMarginsOfTextNode(node->fontSizeDiff);
+	}
+	else if (node->isGroupNode())
+	{
+		margins = GraphViewStyle::getMarginsOfGroupNode(node->groupType, node->name.size());
+	}
+
+	int width = 0;
+	int height = 0;
+
+	if (node->isGraphNode())
+	{
+		node->name = utility::elide(node->name, utility::ELIDE_RIGHT, node->active ? 100 : 50);
+		width = static_cast<int>(margins.charWidth * node->name.size());
+
+		if (node->data->getType().isCollapsible() && node->data->getChildCount() > 0)
+		{
+			addExpandToggleNode(node);
+		}
+	}
+	else if (node->isBundleNode() || node->isTextNode())
+	{
+		width = static_cast<int>(margins.charWidth * node->name.size());
+	}
+	else if (node->isGroupNode())
+	{
+		width = static_cast<int>(margins.charWidth * node->name.size() + 5);
+	}
+
+	width += margins.iconWidth;
+	width = std::max(width, margins.minWidth);
+
+	if (relayoutAccessMaxWidth == -1)
+	{
+		int maxAccessWidth = 0;
+		std::shared_ptr<const DummyNode> maxWidthAccessNode;
+
+		for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+		{
+			if (!subNode->visible)
+			{
+				continue;
+			}
+			else if (subNode->isQualifierNode())
+			{
+				subNode->position.y = static_cast<int>(margins.top + margins.charHeight / 2);
+				width += 5;
+				continue;
+			}
+
+			Vec4i rect = layoutNestingRecursive(subNode.get());
+
+			if (subNode->isExpandToggleNode())
+			{
+				width += margins.spacingX + subNode->size.x;
+			}
+			else if (subNode->isAccessNode() && rect.z() > maxAccessWidth)
+			{
+				maxAccessWidth = rect.z();
+				maxWidthAccessNode = subNode;
+			}
+		}
+
+		if (maxAccessWidth > 0)
+		{
+			for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+			{
+				if (subNode->visible && subNode->isAccessNode() && subNode != maxWidthAccessNode)
+				{
+					layoutNestingRecursive(subNode.get(), maxAccessWidth);
+				}
+			}
+		}
+	}
+
+	if (node->subNodes.size())
+	{
+		if (node->isGroupNode())
+		{
+			Vec2i viewSize = m_viewSize;
+
+			switch (node->groupLayout)
+			{
+			case GroupLayout::LIST:
+				viewSize.x = viewSize.x - 150;	  // prevent horizontal scroll
+				ListLayouter::layoutMultiColumn(viewSize, &node->subNodes);
+				break;
+
+			case GroupLayout::SKEWED:
+				ListLayouter::layoutSkewed(
+					&node->subNodes,
+					margins.spacingX,
+					margins.spacingY,
+					static_cast<int>(viewSize.x() * 1.5));
+				break;
+
+			case GroupLayout::BUCKET:
+				if (node->hasActiveSubNode() || !m_activeNodeIds.size() /* bundled edges */)
+				{
+					BucketLayouter grid(viewSize);
+					grid.createBuckets(node->subNodes, m_dummyEdges);
+					grid.layoutBuckets(m_activeNodeIds.size());
+					node->subNodes = grid.getSortedNodes();
+				}
+				else
+				{
+					ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
+				}
+				break;
+
+			case GroupLayout::SQUARE:
+				ListLayouter::layoutSquare(&node->subNodes, -1);
+				break;
+			}
+		}
+		else if (node->isAccessNode() && !node->hasConnectedSubNode())
+		{
+			ListLayouter::layoutSquare(&node->subNodes, relayoutAccessMaxWidth);
+		}
+		else
+		{
+			ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
+		}
+	}
+
+	Vec2i size = ListLayouter::offsetNodes(
+		node->subNodes,
+		static_cast<int>(margins.top + margins.charHeight + margins.spacingA),
+		margins.left);
+
+	width = std::max(size.x(), width);
+	height = size.y();
+
+	node->size.x = margins.left + width + margins.right;
+	node->size.y = static_cast<int>(
+		margins.top + margins.charHeight + margins.spacingA + height + margins.bottom);
+
+	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+	{
+		if (!subNode->visible)
+		{
+			continue;
+		}
+
+		if (subNode->isAccessNode())
+		{
+			subNode->size.x = width;
+		}
+		else if (subNode->isExpandToggleNode())
+		{
+			subNode->position.x = margins.left + width - subNode->size.x;
+			subNode->position.y = 6;
+		}
+	}
+
+	return ListLayouter::boundingRect(node->subNodes);
+}
+
+void DummyGraph::addExpandToggleNode(DummyNode* node) const
+{
+	std::shared_ptr<DummyNode> expandNode = std::make_shared<DummyNode>(
+		DummyNode::DUMMY_EXPAND_TOGGLE);
+	expandNode->expanded = node->expanded;
+	expandNode->visible = true;
+
+	size_t visibleSubNodeCount = 0;
+	for (size_t i = 0; i < node->subNodes.size(); i++)
+	{
+		DummyNode* subNode = node->subNodes[i].get();
+
+		if (subNode->isExpandToggleNode())
+		{
+			node->subNodes.erase(node->subNodes.begin() + i);
+			i--;
+			continue;
+		}
+
+		if (subNode->isQualifierNode())
+		{
+			continue;
+		}
+
+		for (const std::shared_ptr<DummyNode>& subSubNode: subNode->subNodes)
+		{
+			if ((subSubNode->visible || subSubNode->hidden) &&
+				(!subSubNode->isGraphNode() || !subSubNode->data->isImplicit() ||
+				 node->data->isImplicit()))
+			{
+				visibleSubNodeCount++;
+			}
+		}
+	}
+
+	expandNode->invisibleSubNodeCount = node->data->getChildCount() - visibleSubNodeCount;
+	if ((expandNode->isExpanded() && visibleSubNodeCount > 0) || expandNode->invisibleSubNodeCount)
+	{
+		node->subNodes.push_back(expandNode);
+	}
+}
+
+void DummyGraph::layoutToGrid(DummyNode* node) const
+{
+	if (!node->visible || !node->isGraphNode() || !node->hasVisibleSubNode())
+	{
+		return;
+	}
+
+	// Increase size of nodes with visible chilren to cover full grid cells
+
+	size_t width = GraphViewStyle::toGridSize(node->size.x);
+	size_t height = GraphViewStyle::toGridSize(node->size.y);
+
+	size_t incX = width - node->size.x;
+	size_t incY = height - node->size.y;
+
+	DummyNode* lastAccessNode = nullptr;
+	DummyNode* expandToggleNode = nullptr;
+
+	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+	{
+		if (!subNode->visible)
+		{
+			continue;
+		}
+
+		if (subNode->isAccessNode())
+		{
+			subNode->size.x = static_cast<int>(subNode->size.x + incX);
+			lastAccessNode = subNode.get();
+		}
+		else if (subNode->isExpandToggleNode())
+		{
+			expandToggleNode = subNode.get();
+		}
+	}
+
+	if (lastAccessNode)
+	{
+		lastAccessNode->size.y = static_cast<int>(lastAccessNode->size.y + incY);
+
+		if (expandToggleNode)
+		{
+			expandToggleNode->position.x = static_cast<int>(expandToggleNode->position.x + incX);
+		}
+
+		node->size.x = static_cast<int>(width);
+		node->size.y = static_cast<int>(height);
+	}
+}
+
+void DummyGraph::layoutGraph(bool getSortedNodes, std::function<bool()> isCancelled)
+{
+	TRACE();
+
+	std::vector<std::shared_ptr<DummyNode>> visibleNodes;
+	for (auto node: m_dummyNodes)
+	{
+		if (node->visible)
+		{
+			visibleNodes.push_back(node);
+		}
+	}
+
+	BucketLayouter grid(m_viewSize);
+	grid.setIsCancelled(isCancelled);
+	grid.createBuckets(visibleNodes, m_dummyEdges);
+	grid.layoutBuckets(false);
+
+	if (getSortedNodes && !(isCancelled && isCancelled()))
+	{
+		m_dummyNodes = grid.getSortedNodes();
+	}
+}
+
+void DummyGraph::layoutList()
+{
+	TRACE();
+
+	ListLayouter::layoutMultiColumn(m_viewSize, &m_dummyNodes);
+}
+
+void DummyGraph::layoutTrail(
+	bool horizontal, bool hasOrigin, std::function<bool()> isCancelled)
+{
+	TrailLayouter::LayoutDirection direction;
+	if (horizontal)
+	{
+		if (hasOrigin)
+		{
+			direction = TrailLayouter::LAYOUT_LEFT_RIGHT;
+		}
+		else
+		{
+			direction = TrailLayouter::LAYOUT_RIGHT_LEFT;
+		}
+	}
+	else
+	{
+		if (hasOrigin)
+		{
+			direction = TrailLayouter::LAYOUT_TOP_BOTTOM;
+		}
+		else
+		{
+			direction = TrailLayouter::LAYOUT_BOTTOM_TOP;
+		}
+	}
+
+	std::vector<std::shared_ptr<DummyNode>> visibleNodes;
+	for (auto node: m_dummyNodes)
+	{
+		if (node->visible)
+		{
+			visibleNodes.push_back(node);
+		}
+	}
+
+	TrailLayouter layout(direction);
+	layout.setIsCancelled(isCancelled);
+	layout.layoutGraph(visibleNodes, m_dummyEdges, m_topLevelAncestorIds, &m_trailLayoutState);
+}
+
+void DummyGraph::assignBundleIds()
+{
+	Id bundleId = 0;
+	for (size_t i = m_dummyNodes.size(); i > 0; i--)
+	{
+		bundleId = m_dummyNodes[i - 1]->setBundleIdRecursive(bundleId);
+	}
+}
+
+std::shared_ptr<DummyNode> DummyGraph::getDummyGraphNodeById(Id tokenId) const
+{
+	std::map<Id, std::shared_ptr<DummyNode>>::const_iterator it = m_dummyGraphNodes.find(tokenId);
+	if (it != m_dummyGraphNodes.end())
+	{
+		return it->second;
+	}
+
+	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
+	{
+		if (node->tokenId == tokenId)
+		{
+			return node;
+		}
+	}
+
+	return nullptr;
+}
+
+DummyEdge* DummyGraph::getDummyGraphEdgeById(Id tokenId) const
+{
+	for (const std::shared_ptr<DummyEdge>& edge: m_dummyEdges)
+	{
+		if (edge->data && edge->data->getId() == tokenId)
+		{
+			return edge.get();
+		}
+	}
+
+	return nullptr;
+}
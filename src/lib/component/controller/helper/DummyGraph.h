@@ -0,0 +1,92 @@
+#ifndef DUMMY_GRAPH_H
+#define DUMMY_GRAPH_H
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Vector2.h"
+#include "Vector4.h"
+#include "types.h"
+
+#include "DummyEdge.h"
+#include "DummyNode.h"
+#include "GroupType.h"
+#include "NameHierarchy.h"
+#include "TrailLayouter.h"
+
+class Graph;
+
+// temporary data structure for (visual) graph creation process, holds the dummy nodes and edges
+// together with everything their bundling, grouping and layouting depends on. It doesn't access
+// the view or the storage, so a clone of it can get layouted on another thread.
+struct DummyGraph
+{
+	// copies all dummy nodes and edges, the clone shares only the underlying graph data
+	DummyGraph clone() const;
+
+	void bundleNodes();
+	void bundleNodesAndEdgesMatching(
+		std::function<bool(const DummyNode::BundleInfo&, const Node*)> matcher,
+		size_t count,
+		bool countConnectedNodes,
+		const std::wstring& name);
+	std::shared_ptr<DummyNode> bundleNodesMatching(
+		std::list<std::shared_ptr<DummyNode>>& nodes,
+		std::function<bool(const DummyNode*)> matcher,
+		const std::wstring& name);
+	std::shared_ptr<DummyNode> bundleByType(
+		std::list<std::shared_ptr<DummyNode>>& nodes,
+		const NodeType& type,
+		const Tree<NodeType::BundleInfo>& bundleInfoTree,
+		const bool considerInvisibleNodes);
+	void bundleNodesByType();
+
+	void addCharacterIndex();
+	bool hasCharacterIndex() const;
+
+	// uses the parents stored in m_nodeIdToParentFileMap and m_qualifierNameToIdMap
+	void groupNodesByParents(GroupType groupType);
+	DummyNode* groupAllNodes(GroupType groupType, Id groupNodeId);
+	void groupTrailNodes(GroupType groupType);
+
+	void layoutNesting();
+	void extendEqualFunctionNames(const std::vector<std::shared_ptr<DummyNode>>& nodes) const;
+	Vec4i layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth = -1) const;
+	void addExpandToggleNode(DummyNode* node) const;
+	void layoutToGrid(DummyNode* node) const;
+
+	void layoutGraph(bool getSortedNodes = false, std::function<bool()> isCancelled = nullptr);
+	void layoutList();
+	void layoutTrail(bool horizontal, bool hasOrigin, std::function<bool()> isCancelled = nullptr);
+
+	void assignBundleIds();
+
+	std::shared_ptr<DummyNode> getDummyGraphNodeById(Id tokenId) const;
+	DummyEdge* getDummyGraphEdgeById(Id tokenId) const;
+
+	std::vector<std::shared_ptr<DummyNode>> m_dummyNodes;
+	std::vector<std::shared_ptr<DummyEdge>> m_dummyEdges;
+
+	std::map<Id, std::shared_ptr<DummyNode>> m_dummyGraphNodes;
+
+	std::vector<Id> m_activeNodeIds;
+
+	// keeps the nodes and edges referenced by the dummy graph alive
+	std::shared_ptr<Graph> m_graph;
+
+	std::map<Id, Id> m_topLevelAncestorIds;
+
+	// layout of the last shown trail, extended when the trail depth grows
+	TrailLayouter::LayoutState m_trailLayoutState;
+
+	bool m_useBezierEdges = false;
+
+	Vec2i m_viewSize;
+	std::map<Id, std::pair<Id, NameHierarchy>> m_nodeIdToParentFileMap;
+	std::map<std::wstring, Id> m_qualifierNameToIdMap;
+};
+
+#endif	  // DUMMY_GRAPH_H
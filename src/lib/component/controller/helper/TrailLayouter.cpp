@@ -1,13 +1,25 @@
 #include "TrailLayouter.h"
 
+#include <algorithm>
 #include <iostream>
 
+#include "TimeStamp.h"
+
+const size_t TrailLayouter::s_crossingReductionTimeBudgetMs = 200;
+const size_t TrailLayouter::s_crossingReductionMaxSweeps = 24;
+
 TrailLayouter::TrailLayouter(LayoutDirection dir): m_direction(dir) {}
 
+void TrailLayouter::setIsCancelled(std::function<bool()> isCancelled)
+{
+	m_isCancelled = isCancelled;
+}
+
 void TrailLayouter::layoutGraph(
 	std::vector<std::shared_ptr<DummyNode>>& dummyNodes,
 	const std::vector<std::shared_ptr<DummyEdge>>& dummyEdges,
-	const std::map<Id, Id>& topLevelAncestorIds)
+	const std::map<Id, Id>& topLevelAncestorIds,
+	LayoutState* state)
 {
 	buildGraph(dummyNodes, dummyEdges, topLevelAncestorIds);
 
@@ -16,21 +28,53 @@ void TrailLayouter::layoutGraph(
 		return;
 	}
 	removeDeadEnds();
-	for(auto&rootNode:m_rootNodes)
-		makeAcyclicRecursive(rootNode, std::set<TrailNode*>());
+	makeAcyclic();
 	updateRootNodes(); //xxx for check only, could be delete
 
-	assignLongestPathLevels();
-	assignRemainingLevels();
+	if (isCancelled())
+	{
+		return;
+	}
+
+	// a grown trail keeps the levels and orderings of its previous layout
+	const bool incremental = state && assignPreviousLevels(*state);
+	if (!incremental)
+	{
+		assignLongestPathLevels();
+		assignRemainingLevels();
+	}
 
 	addVirtualNodes();
 
+	if (isCancelled())
+	{
+		return;
+	}
+
 	buildColumns();
-	reduceEdgeCrossings();
+	if (incremental)
+	{
+		orderColumnsByPreviousLayout(*state);
+	}
+	else
+	{
+		reduceEdgeCrossings();
+	}
+
+	if (isCancelled())
+	{
+		return;
+	}
+
 	layout();
 
 	retrievePositions(topLevelAncestorIds);
 
+	if (state)
+	{
+		saveLayoutState(state);
+	}
+
 	// print();
 }
 
@@ -138,26 +182,64 @@ void TrailLayouter::removeDeadEnds()
 	}
 }
 
-void TrailLayouter::makeAcyclicRecursive(TrailNode* node, std::set<TrailNode*> predecessors)
+void TrailLayouter::makeAcyclic()
 {
-	predecessors.insert(node);
+	// iterative depth first search, edges leading back to a node on the current path get switched
+	struct PathNode
+	{
+		TrailNode* node;
+		std::vector<TrailEdge*> edges;
+		size_t nextEdgeIndex;
+		std::vector<TrailEdge*> edgesToSwitch;
+	};
 
-	std::set<TrailEdge*> edgesToSwitch;
-	for (TrailEdge* edge: node->outgoingEdges)
+	auto getOutgoingEdges = [](TrailNode* node) {
+		return std::vector<TrailEdge*>(node->outgoingEdges.begin(), node->outgoingEdges.end());
+	};
+
+	std::set<TrailNode*> visitedNodes;
+	std::set<TrailNode*> pathNodes;
+
+	for (TrailNode* rootNode: m_rootNodes)
 	{
-		if (predecessors.find(edge->target) != predecessors.end())
+		if (!visitedNodes.insert(rootNode).second)
 		{
-			edgesToSwitch.insert(edge);
+			continue;
 		}
-		else
+
+		std::vector<PathNode> path;
+		path.push_back({rootNode, getOutgoingEdges(rootNode), 0, {}});
+		pathNodes.insert(rootNode);
+
+		while (path.size())
 		{
-			makeAcyclicRecursive(edge->target, predecessors);
-		}
-	}
+			PathNode& pathNode = path.back();
+			if (pathNode.nextEdgeIndex < pathNode.edges.size())
+			{
+				TrailEdge* edge = pathNode.edges[pathNode.nextEdgeIndex++];
+				TrailNode* target = edge->target;
 
-	for (TrailEdge* edge: edgesToSwitch)
-	{
-		switchEdge(edge);
+				if (pathNodes.find(target) != pathNodes.end())
+				{
+					pathNode.edgesToSwitch.push_back(edge);
+				}
+				else if (visitedNodes.insert(target).second)
+				{
+					pathNodes.insert(target);
+					path.push_back({target, getOutgoingEdges(target), 0, {}});
+				}
+			}
+			else
+			{
+				for (TrailEdge* edge: pathNode.edgesToSwitch)
+				{
+					switchEdge(edge);
+				}
+
+				pathNodes.erase(pathNode.node);
+				path.pop_back();
+			}
+		}
 	}
 }
 
@@ -305,6 +387,41 @@ void TrailLayouter::assignRemainingLevels()
 	}
 }
 
+bool TrailLayouter::assignPreviousLevels(const LayoutState& state)
+{
+	if (state.direction != m_direction || state.rootIds != getRootIds())
+	{
+		return false;
+	}
+
+	for (const std::shared_ptr<TrailNode>& node: m_allNodes)
+	{
+		auto it = state.nodePlacements.find(node->id);
+		if (node->id && it != state.nodePlacements.end())
+		{
+			node->level = it->second.first;
+		}
+	}
+
+	assignRemainingLevels();
+
+	// new nodes may connect previous ones in a way that needs a new level assignment
+	for (const std::shared_ptr<TrailEdge>& edge: m_allEdges)
+	{
+		if (edge->origin->level >= 0 && edge->target->level >= 0 &&
+			edge->origin->level >= edge->target->level)
+		{
+			for (const std::shared_ptr<TrailNode>& node: m_allNodes)
+			{
+				node->level = -1;
+			}
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void TrailLayouter::addVirtualNodes()
 {
 	std::vector<std::shared_ptr<TrailEdge>> newEdges;
@@ -318,6 +435,7 @@ void TrailLayouter::addVirtualNodes()
 			virtualNode->name = L"<virtual>";
 			virtualNode->dummyNode = nullptr;
 			virtualNode->level = i;
+			virtualNode->index = 0;
 
 			virtualNode->size = Vec2i(50, 20);
 
@@ -354,6 +472,7 @@ void TrailLayouter::buildColumns()
 			m_nodesPerCol.push_back(std::vector<TrailNode*>());
 		}
 
+		node->index = m_nodesPerCol[level].size();
 		m_nodesPerCol[level].push_back(node.get());
 	}
 }
@@ -418,9 +537,255 @@ void TrailLayouter::reduceEdgeCrossings()
 			nodes.push_back(p.second);
 		}
 		m_nodesPerCol[i] = nodes;
+		updateColumnIndices(i);
+	}
+
+	// further alternating median sweeps within a time budget, keeping the fewest crossings
+	const TimeStamp startTime = TimeStamp::now();
+
+	std::vector<std::vector<TrailNode*>> bestNodesPerCol = m_nodesPerCol;
+	size_t bestCrossingCount = countEdgeCrossings();
+	size_t sweepsWithoutImprovement = 0;
+
+	for (size_t sweep = 0; sweep < s_crossingReductionMaxSweeps && bestCrossingCount > 0 &&
+		 sweepsWithoutImprovement < 4 && !isCancelled() &&
+		 TimeStamp::now().deltaMS(startTime) < s_crossingReductionTimeBudgetMs;
+		 sweep++)
+	{
+		if (sweep % 2)
+		{
+			for (size_t i = 1; i < m_nodesPerCol.size(); i++)
+			{
+				sortColumnByMedian(i, true);
+			}
+		}
+		else
+		{
+			for (size_t i = m_nodesPerCol.size(); i > 1; i--)
+			{
+				sortColumnByMedian(i - 2, false);
+			}
+		}
+
+		const size_t crossingCount = countEdgeCrossings();
+		if (crossingCount < bestCrossingCount)
+		{
+			bestNodesPerCol = m_nodesPerCol;
+			bestCrossingCount = crossingCount;
+			sweepsWithoutImprovement = 0;
+		}
+		else
+		{
+			sweepsWithoutImprovement++;
+		}
+	}
+
+	m_nodesPerCol = bestNodesPerCol;
+	for (size_t i = 0; i < m_nodesPerCol.size(); i++)
+	{
+		updateColumnIndices(i);
 	}
 }
 
+void TrailLayouter::orderColumnsByPreviousLayout(const LayoutState& state)
+{
+	for (size_t i = 0; i < m_nodesPerCol.size(); i++)
+	{
+		std::vector<std::pair<size_t, TrailNode*>> previousNodes;
+		std::vector<std::pair<float, TrailNode*>> newNodes;
+
+		for (TrailNode* node: m_nodesPerCol[i])
+		{
+			auto it = node->id ? state.nodePlacements.find(node->id) : state.nodePlacements.end();
+			if (it != state.nodePlacements.end() && it->second.first == node->level)
+			{
+				previousNodes.emplace_back(it->second.second, node);
+			}
+			else
+			{
+				newNodes.emplace_back(getNeighborPosition(node, true, false), node);
+			}
+		}
+
+		std::sort(previousNodes.begin(), previousNodes.end());
+		std::stable_sort(
+			newNodes.begin(),
+			newNodes.end(),
+			[](const std::pair<float, TrailNode*>& a, const std::pair<float, TrailNode*>& b) {
+				return a.first < b.first;
+			});
+
+		// previous nodes keep their relative order, new nodes are merged in next to their neighbors
+		std::vector<TrailNode*>& nodes = m_nodesPerCol[i];
+		nodes.clear();
+
+		auto newIt = newNodes.begin();
+		for (const std::pair<size_t, TrailNode*>& p: previousNodes)
+		{
+			const float position = getNeighborPosition(p.second, true, false);
+			while (newIt != newNodes.end() && newIt->first < position)
+			{
+				nodes.push_back((newIt++)->second);
+			}
+			nodes.push_back(p.second);
+		}
+
+		for (; newIt != newNodes.end(); newIt++)
+		{
+			nodes.push_back(newIt->second);
+		}
+
+		updateColumnIndices(i);
+	}
+}
+
+void TrailLayouter::sortColumnByMedian(size_t col, bool usePredecessors)
+{
+	std::vector<std::pair<float, TrailNode*>> newOrder;
+	for (TrailNode* node: m_nodesPerCol[col])
+	{
+		newOrder.emplace_back(getNeighborPosition(node, usePredecessors, true), node);
+	}
+
+	std::stable_sort(
+		newOrder.begin(),
+		newOrder.end(),
+		[](const std::pair<float, TrailNode*>& a, const std::pair<float, TrailNode*>& b) {
+			return a.first < b.first;
+		});
+
+	for (size_t i = 0; i < newOrder.size(); i++)
+	{
+		m_nodesPerCol[col][i] = newOrder[i].second;
+	}
+	updateColumnIndices(col);
+}
+
+void TrailLayouter::updateColumnIndices(size_t col)
+{
+	for (size_t i = 0; i < m_nodesPerCol[col].size(); i++)
+	{
+		m_nodesPerCol[col][i]->index = i;
+	}
+}
+
+float TrailLayouter::getNeighborPosition(
+	const TrailNode* node, bool usePredecessors, bool median) const
+{
+	std::vector<size_t> indices;
+	if (usePredecessors)
+	{
+		for (const TrailEdge* edge: node->incomingEdges)
+		{
+			if (edge->origin->level + 1 == node->level)
+			{
+				indices.push_back(edge->origin->index);
+			}
+		}
+	}
+	else
+	{
+		for (const TrailEdge* edge: node->outgoingEdges)
+		{
+			if (edge->target->level == node->level + 1)
+			{
+				indices.push_back(edge->target->index);
+			}
+		}
+	}
+
+	// nodes without neighbors stay at their current position
+	if (!indices.size())
+	{
+		return float(node->index);
+	}
+
+	if (!median)
+	{
+		size_t sum = 0;
+		for (size_t index: indices)
+		{
+			sum += index;
+		}
+		return float(sum) / indices.size();
+	}
+
+	std::sort(indices.begin(), indices.end());
+	const size_t middle = indices.size() / 2;
+	if (indices.size() % 2)
+	{
+		return float(indices[middle]);
+	}
+	return (indices[middle - 1] + indices[middle]) / 2.0f;
+}
+
+size_t TrailLayouter::countEdgeCrossings() const
+{
+	size_t crossingCount = 0;
+
+	for (size_t i = 0; i + 1 < m_nodesPerCol.size(); i++)
+	{
+		// edges sorted by origin index, crossings are the inversions of their target indices
+		std::vector<std::pair<size_t, size_t>> edges;
+		for (const TrailNode* node: m_nodesPerCol[i])
+		{
+			for (const TrailEdge* edge: node->outgoingEdges)
+			{
+				if (edge->target->level == node->level + 1)
+				{
+					edges.emplace_back(node->index, edge->target->index);
+				}
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		// counted with a binary indexed tree over the target indices
+		std::vector<size_t> tree(m_nodesPerCol[i + 1].size() + 1, 0);
+		for (size_t j = 0; j < edges.size(); j++)
+		{
+			size_t smallerOrEqualCount = 0;
+			for (size_t k = edges[j].second + 1; k > 0; k -= k & (~k + 1))
+			{
+				smallerOrEqualCount += tree[k];
+			}
+			crossingCount += j - smallerOrEqualCount;
+
+			for (size_t k = edges[j].second + 1; k < tree.size(); k += k & (~k + 1))
+			{
+				tree[k]++;
+			}
+		}
+	}
+
+	return crossingCount;
+}
+
+void TrailLayouter::saveLayoutState(LayoutState* state) const
+{
+	state->direction = m_direction;
+	state->rootIds = getRootIds();
+	state->nodePlacements.clear();
+
+	for (const std::shared_ptr<TrailNode>& node: m_allNodes)
+	{
+		if (node->id && node->level >= 0)
+		{
+			state->nodePlacements[node->id] = std::make_pair(node->level, node->index);
+		}
+	}
+}
+
+std::vector<Id> TrailLayouter::getRootIds() const
+{
+	std::vector<Id> rootIds;
+	for (const TrailNode* node: m_rootNodes)
+	{
+		rootIds.push_back(node->id);
+	}
+	std::sort(rootIds.begin(), rootIds.end());
+	return rootIds;
+}
+
 void TrailLayouter::layout()
 {
 	// calculate widths and heights of columns, and find largest column
@@ -696,6 +1061,7 @@ void TrailLayouter::addNode(const std::shared_ptr<DummyNode>& dummyNode)
 	node->name = dummyNode->name;
 	node->dummyNode = dummyNode.get();
 	node->level = -1;
+	node->index = 0;
 
 	node->size = dummyNode->size;
 
@@ -742,16 +1108,15 @@ void TrailLayouter::addEdge(
 	edge->origin = origin->second;
 	edge->target = target->second;
 
-	for (std::shared_ptr<TrailEdge>& e: m_allEdges)
+	// edges between the same nodes in either direction are merged
+	auto it = m_edgesByNodes.find(std::minmax(edge->origin, edge->target));
+	if (it != m_edgesByNodes.end())
 	{
-		if ((e->origin == edge->origin && e->target == edge->target) ||
-			(e->origin == edge->target && e->target == edge->origin))
-		{
-			e->dummyEdges.push_back(dummyEdge.get());
-			return;
-		}
+		it->second->dummyEdges.push_back(dummyEdge.get());
+		return;
 	}
 
+	m_edgesByNodes.emplace(std::minmax(edge->origin, edge->target), edge.get());
 	edge->dummyEdges.push_back(dummyEdge.get());
 
 	edge->origin->outgoingEdges.insert(edge.get());
@@ -771,6 +1136,11 @@ void TrailLayouter::switchEdge(TrailEdge* edge)
 	std::swap(edge->origin, edge->target);
 }
 
+bool TrailLayouter::isCancelled() const
+{
+	return m_isCancelled && m_isCancelled();
+}
+
 bool TrailLayouter::horizontalLayout() const
 {
 	return m_direction == LAYOUT_LEFT_RIGHT || m_direction == LAYOUT_RIGHT_LEFT;
@@ -1,6 +1,7 @@
 #ifndef GRAPH_LAYOUTER_H
 #define GRAPH_LAYOUTER_H
 
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -21,12 +22,25 @@ public:
 		LAYOUT_BOTTOM_TOP
 	};
 
+	// levels and column orderings of a previous layout, that are kept when the same trail grows
+	struct LayoutState
+	{
+		LayoutDirection direction = LAYOUT_LEFT_RIGHT;
+		std::vector<Id> rootIds;
+		std::map<Id, std::pair<int, size_t>> nodePlacements;	// level and index within column
+	};
+
 	TrailLayouter(LayoutDirection dir);
 
+	// stops layouting early once the callback returns true, state is left untouched then
+	void setIsCancelled(std::function<bool()> isCancelled);
+
+	// extends the layout stored in state if possible and stores the new layout in it afterwards
 	void layoutGraph(
 		std::vector<std::shared_ptr<DummyNode>>& dummyNodes,
 		const std::vector<std::shared_ptr<DummyEdge>>& dummyEdges,
-		const std::map<Id, Id>& topLevelAncestorIds);
+		const std::map<Id, Id>& topLevelAncestorIds,
+		LayoutState* state = nullptr);
 
 private:
 	struct TrailEdge;
@@ -35,6 +49,7 @@ private:
 	{
 		Id id;
 		int level;
+		size_t index;
 		std::wstring name;
 
 		Vec2i pos;
@@ -63,15 +78,25 @@ private:
 		const std::map<Id, Id>& topLevelAncestorIds);
 
 	void removeDeadEnds();
-	void makeAcyclicRecursive(TrailNode* node, std::set<TrailNode*> predecessors);
+	void makeAcyclic();
 	void updateRootNodes();
 
 	void assignLongestPathLevels();
 	void assignRemainingLevels();
+	bool assignPreviousLevels(const LayoutState& state);
 
 	void addVirtualNodes();
 	void buildColumns();
 	void reduceEdgeCrossings();
+	void orderColumnsByPreviousLayout(const LayoutState& state);
+
+	void sortColumnByMedian(size_t col, bool usePredecessors);
+	void updateColumnIndices(size_t col);
+	float getNeighborPosition(const TrailNode* node, bool usePredecessors, bool median) const;
+	size_t countEdgeCrossings() const;
+
+	void saveLayoutState(LayoutState* state) const;
+	std::vector<Id> getRootIds() const;
 
 	void layout();
 	void moveNodesToAveragePosition(std::vector<TrailNode*> nodes, bool forward);
@@ -83,18 +108,25 @@ private:
 	void addEdge(const std::shared_ptr<DummyEdge> dummyEdge, const std::map<Id, Id>& topLevelAncestorIds);
 	void switchEdge(TrailEdge* edge);
 
+	bool isCancelled() const;
 	bool horizontalLayout() const;
 	bool invertedLayout() const;
 
+	static const size_t s_crossingReductionTimeBudgetMs;
+	static const size_t s_crossingReductionMaxSweeps;
+
 	LayoutDirection m_direction;
 
 	std::vector<std::shared_ptr<TrailNode>> m_allNodes;
 	std::vector<std::shared_ptr<TrailEdge>> m_allEdges;
 
 	std::map<Id, TrailNode*> m_nodesById;
+	std::map<std::pair<TrailNode*, TrailNode*>, TrailEdge*> m_edgesByNodes;
 	std::vector<TrailNode*> m_rootNodes;
 
 	std::vector<std::vector<TrailNode*>> m_nodesPerCol;
+
+	std::function<bool()> m_isCancelled;
 };
 
 #endif	  // GRAPH_LAYOUTER_H
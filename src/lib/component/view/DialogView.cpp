@@ -53,6 +53,11 @@ void DialogView::updateIndexingDialog(
 {
 }
 
+void DialogView::updateIndexingQueueStatus(
+	size_t queuedStorageCount, size_t spilledStorageCount, size_t queuedByteSize, size_t byteBudget)
+{
+}
+
 void DialogView::updateCustomIndexingDialog(
 	size_t startedFileCount,
 	size_t finishedFileCount,
@@ -61,6 +61,11 @@ Task::TaskState TaskFinishParsing::doUpdate(std::shared_ptr<Blackboard> blackboa
 	bool interruptedIndexing = false;
 	blackboard->get("interrupted_indexing", interruptedIndexing);
 
+	if (!interruptedIndexing)
+	{
+		m_storage->clearIndexingTranslationUnits();
+	}
+
 	bool shallowIndexing = false;
 	blackboard->get("shallow_indexing", shallowIndexing);
 
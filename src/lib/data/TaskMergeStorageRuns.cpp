@@ -0,0 +1,32 @@
+#include "TaskMergeStorageRuns.h"
+
+#include "ExternalStorageMerger.h"
+#include "Storage.h"
+
+TaskMergeStorageRuns::TaskMergeStorageRuns(
+	std::shared_ptr<ExternalStorageMerger> storageMerger, std::weak_ptr<Storage> target)
+	: m_storageMerger(storageMerger), m_target(target)
+{
+}
+
+void TaskMergeStorageRuns::doEnter(std::shared_ptr<Blackboard> blackboard) {}
+
+Task::TaskState TaskMergeStorageRuns::doUpdate(std::shared_ptr<Blackboard> blackboard)
+{
+	if (std::shared_ptr<Storage> target = m_target.lock())
+	{
+		if (m_storageMerger->mergeInto(target.get()))
+		{
+			return STATE_SUCCESS;
+		}
+	}
+
+	return STATE_FAILURE;
+}
+
+void TaskMergeStorageRuns::doExit(std::shared_ptr<Blackboard> blackboard)
+{
+	m_storageMerger->clear();
+}
+
+void TaskMergeStorageRuns::doReset(std::shared_ptr<Blackboard> blackboard) {}
@@ -0,0 +1,27 @@
+#ifndef TASK_MERGE_STORAGE_RUNS_H
+#define TASK_MERGE_STORAGE_RUNS_H
+
+#include <memory>
+
+#include "Task.h"
+
+class ExternalStorageMerger;
+class Storage;
+
+class TaskMergeStorageRuns: public Task
+{
+public:
+	TaskMergeStorageRuns(
+		std::shared_ptr<ExternalStorageMerger> storageMerger, std::weak_ptr<Storage> target);
+
+private:
+	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
+	TaskState doUpdate(std::shared_ptr<Blackboard> blackboard) override;
+	void doExit(std::shared_ptr<Blackboard> blackboard) override;
+	void doReset(std::shared_ptr<Blackboard> blackboard) override;
+
+	std::shared_ptr<ExternalStorageMerger> m_storageMerger;
+	std::weak_ptr<Storage> m_target;
+};
+
+#endif	  // TASK_MERGE_STORAGE_RUNS_H
@@ -0,0 +1,103 @@
+#include "TaskPublishStorageSnapshots.h"
+
+#include <chrono>
+#include <thread>
+
+#include "Blackboard.h"
+#include "PersistentStorage.h"
+#include "logging.h"
+
+TaskPublishStorageSnapshots::TaskPublishStorageSnapshots(
+	const FilePath& dbFilePath,
+	const FilePath& bookmarkDbFilePath,
+	std::function<void(std::shared_ptr<PersistentStorage>, std::function<void()>)> publishCallback,
+	size_t publishIntervalMs)
+	: m_dbFilePath(dbFilePath)
+	, m_bookmarkDbFilePath(bookmarkDbFilePath)
+	, m_publishCallback(publishCallback)
+	, m_publishIntervalMs(publishIntervalMs)
+{
+	for (std::shared_ptr<std::atomic<bool>>& released: m_snapshotsReleased)
+	{
+		released = std::make_shared<std::atomic<bool>>(true);
+	}
+}
+
+void TaskPublishStorageSnapshots::doEnter(std::shared_ptr<Blackboard> blackboard)
+{
+	m_lastPublishTime = TimeStamp::now();
+}
+
+Task::TaskState TaskPublishStorageSnapshots::doUpdate(std::shared_ptr<Blackboard> blackboard)
+{
+	if (m_interrupted)
+	{
+		return STATE_SUCCESS;
+	}
+
+	bool indexerThreadsStopped = false;
+	blackboard->get<bool>("indexer_threads_stopped", indexerThreadsStopped);
+	if (indexerThreadsStopped)
+	{
+		return STATE_SUCCESS;
+	}
+
+	if (TimeStamp::now().deltaMS(m_lastPublishTime) >= m_publishIntervalMs)
+	{
+		publishSnapshot();
+		m_lastPublishTime = TimeStamp::now();
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	return STATE_RUNNING;
+}
+
+void TaskPublishStorageSnapshots::doExit(std::shared_ptr<Blackboard> blackboard)
+{
+	// the published snapshot stays alive as long as it is used by the receiver
+	m_snapshots[0].reset();
+	m_snapshots[1].reset();
+}
+
+void TaskPublishStorageSnapshots::doReset(std::shared_ptr<Blackboard> blackboard)
+{
+	m_interrupted = false;
+}
+
+void TaskPublishStorageSnapshots::handleMessage(MessageIndexingInterrupted* message)
+{
+	m_interrupted = true;
+}
+
+void TaskPublishStorageSnapshots::publishSnapshot()
+{
+	std::shared_ptr<PersistentStorage>& snapshot = m_snapshots[m_nextSnapshotIndex];
+	std::shared_ptr<std::atomic<bool>> released = m_snapshotsReleased[m_nextSnapshotIndex];
+
+	if (!released->load())
+	{
+		// previous snapshot is still in use, it gets updated on the next attempt
+		return;
+	}
+
+	TimeStamp start = TimeStamp::now();
+
+	if (!snapshot)
+	{
+		// the indexing already set up the database, the snapshot never writes to it
+		snapshot = std::make_shared<PersistentStorage>(m_dbFilePath, m_bookmarkDbFilePath);
+		snapshot->setIndexReadOnly();
+		snapshot->openReadConnections();
+	}
+
+	snapshot->updateCaches();
+
+	LOG_INFO(
+		"Published storage snapshot " + std::to_string(m_nextSnapshotIndex) + " in " +
+		std::to_string(TimeStamp::now().deltaMS(start)) + " ms");
+
+	released->store(false);
+	m_publishCallback(snapshot, [released]() { released->store(true); });
+	m_nextSnapshotIndex = 1 - m_nextSnapshotIndex;
+}
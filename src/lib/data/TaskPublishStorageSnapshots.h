@@ -0,0 +1,54 @@
+#ifndef TASK_PUBLISH_STORAGE_SNAPSHOTS_H
+#define TASK_PUBLISH_STORAGE_SNAPSHOTS_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "FilePath.h"
+#include "MessageIndexingInterrupted.h"
+#include "MessageListener.h"
+#include "Task.h"
+#include "TimeStamp.h"
+
+class PersistentStorage;
+
+// Periodically publishes read-only snapshots of the index database while it is still written by
+// the indexing. Two snapshot storages are updated in turns, so the published one is never written
+// to while it is browsed. The receiver calls the release function passed along with a snapshot
+// once it no longer browses it, only then the snapshot gets updated again.
+class TaskPublishStorageSnapshots
+	: public Task
+	, public MessageListener<MessageIndexingInterrupted>
+{
+public:
+	TaskPublishStorageSnapshots(
+		const FilePath& dbFilePath,
+		const FilePath& bookmarkDbFilePath,
+		std::function<void(std::shared_ptr<PersistentStorage>, std::function<void()>)> publishCallback,
+		size_t publishIntervalMs);
+
+private:
+	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
+	TaskState doUpdate(std::shared_ptr<Blackboard> blackboard) override;
+	void doExit(std::shared_ptr<Blackboard> blackboard) override;
+	void doReset(std::shared_ptr<Blackboard> blackboard) override;
+
+	void handleMessage(MessageIndexingInterrupted* message) override;
+
+	void publishSnapshot();
+
+	const FilePath m_dbFilePath;
+	const FilePath m_bookmarkDbFilePath;
+	std::function<void(std::shared_ptr<PersistentStorage>, std::function<void()>)> m_publishCallback;
+	const size_t m_publishIntervalMs;
+
+	std::shared_ptr<PersistentStorage> m_snapshots[2];
+	std::shared_ptr<std::atomic<bool>> m_snapshotsReleased[2];
+	size_t m_nextSnapshotIndex = 0;
+	TimeStamp m_lastPublishTime;
+
+	bool m_interrupted = false;
+};
+
+#endif	  // TASK_PUBLISH_STORAGE_SNAPSHOTS_H
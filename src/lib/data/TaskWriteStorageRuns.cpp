@@ -0,0 +1,28 @@
+#include "TaskWriteStorageRuns.h"
+
+#include "ExternalStorageMerger.h"
+#include "StorageProvider.h"
+
+TaskWriteStorageRuns::TaskWriteStorageRuns(
+	std::shared_ptr<StorageProvider> storageProvider,
+	std::shared_ptr<ExternalStorageMerger> storageMerger)
+	: m_storageProvider(storageProvider), m_storageMerger(storageMerger)
+{
+}
+
+void TaskWriteStorageRuns::doEnter(std::shared_ptr<Blackboard> blackboard) {}
+
+Task::TaskState TaskWriteStorageRuns::doUpdate(std::shared_ptr<Blackboard> blackboard)
+{
+	if (std::shared_ptr<IntermediateStorage> storage = m_storageProvider->consumeLargestStorage())
+	{
+		m_storageMerger->addStorage(storage);
+		return STATE_SUCCESS;
+	}
+
+	return STATE_FAILURE;
+}
+
+void TaskWriteStorageRuns::doExit(std::shared_ptr<Blackboard> blackboard) {}
+
+void TaskWriteStorageRuns::doReset(std::shared_ptr<Blackboard> blackboard) {}
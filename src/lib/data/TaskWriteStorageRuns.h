@@ -0,0 +1,28 @@
+#ifndef TASK_WRITE_STORAGE_RUNS_H
+#define TASK_WRITE_STORAGE_RUNS_H
+
+#include <memory>
+
+#include "Task.h"
+
+class ExternalStorageMerger;
+class StorageProvider;
+
+class TaskWriteStorageRuns: public Task
+{
+public:
+	TaskWriteStorageRuns(
+		std::shared_ptr<StorageProvider> storageProvider,
+		std::shared_ptr<ExternalStorageMerger> storageMerger);
+
+private:
+	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
+	TaskState doUpdate(std::shared_ptr<Blackboard> blackboard) override;
+	void doExit(std::shared_ptr<Blackboard> blackboard) override;
+	void doReset(std::shared_ptr<Blackboard> blackboard) override;
+
+	std::shared_ptr<StorageProvider> m_storageProvider;
+	std::shared_ptr<ExternalStorageMerger> m_storageMerger;
+};
+
+#endif	  // TASK_WRITE_STORAGE_RUNS_H
@@ -18,6 +18,14 @@ public:
 	std::shared_ptr<IntermediateStorage> index(std::shared_ptr<IndexerCommand> indexerCommand) override;
 	void interrupt() override;
 
+protected:
+	std::shared_ptr<IndexerStateInfo> getIndexerStateInfo() const;
+
+	// marks incomplete files and completes the translation unit, returns null if interrupted
+	std::shared_ptr<IntermediateStorage> finishStorage(
+		std::shared_ptr<IntermediateStorage> storage,
+		std::shared_ptr<IndexerCommand> indexerCommand) const;
+
 private:
 	virtual void doIndex(
 		std::shared_ptr<T> indexerCommand,
@@ -66,6 +74,20 @@ std::shared_ptr<IntermediateStorage> Indexer<T>::index(std::shared_ptr<IndexerCo
 
 	doIndex(castCommand, parserClient, m_indexerStateInfo);
 
+	return finishStorage(storage, indexerCommand);
+}
+
+template <typename T>
+std::shared_ptr<IndexerStateInfo> Indexer<T>::getIndexerStateInfo() const
+{
+	return m_indexerStateInfo;
+}
+
+template <typename T>
+std::shared_ptr<IntermediateStorage> Indexer<T>::finishStorage(
+	std::shared_ptr<IntermediateStorage> storage,
+	std::shared_ptr<IndexerCommand> indexerCommand) const
+{
 	if (storage->hasFatalErrors())
 	{
 		storage->setAllFilesIncomplete();
@@ -80,6 +102,8 @@ std::shared_ptr<IntermediateStorage> Indexer<T>::index(std::shared_ptr<IndexerCo
 		return nullptr;
 	}
 
+	storage->addCompletedTranslationUnits({indexerCommand->getSourceFilePath().wstr()});
+
 	return storage;
 }
 
@@ -1,3 +1,29 @@
 #include "IndexerBase.h"
 
+#include "IndexerCommand.h"
+#include "IntermediateStorage.h"
+
 IndexerBase::IndexerBase() {}
+
+size_t IndexerBase::getMaximumBatchSize(const IndexerCommand& indexerCommand) const
+{
+	return 1;
+}
+
+bool IndexerBase::canBatch(const IndexerCommand& first, const IndexerCommand& other) const
+{
+	return false;
+}
+
+void IndexerBase::indexBatch(
+	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands,
+	std::function<void(std::shared_ptr<IndexerCommand>)> onStarted,
+	std::function<void(std::shared_ptr<IndexerCommand>, std::shared_ptr<IntermediateStorage>)>
+		onIndexed)
+{
+	for (const std::shared_ptr<IndexerCommand>& indexerCommand: indexerCommands)
+	{
+		onStarted(indexerCommand);
+		onIndexed(indexerCommand, index(indexerCommand));
+	}
+}
@@ -1,8 +1,10 @@
 #ifndef INDEXER_BASE_H
 #define INDEXER_BASE_H
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "IndexerCommandType.h"
 
@@ -20,6 +22,19 @@ public:
 	virtual std::shared_ptr<IntermediateStorage> index(
 		std::shared_ptr<IndexerCommand> indexerCommand) = 0;
 	virtual void interrupt() = 0;
+
+	// Indexers that share expensive setup between commands, like resolving a class path, can index
+	// several commands in one go. By default every command is indexed on its own.
+	virtual size_t getMaximumBatchSize(const IndexerCommand& indexerCommand) const;
+	virtual bool canBatch(const IndexerCommand& first, const IndexerCommand& other) const;
+
+	// Calls onStarted before and onIndexed after each command, in the order of the commands. The
+	// storage passed to onIndexed is null if indexing was interrupted.
+	virtual void indexBatch(
+		const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands,
+		std::function<void(std::shared_ptr<IndexerCommand>)> onStarted,
+		std::function<void(std::shared_ptr<IndexerCommand>, std::shared_ptr<IntermediateStorage>)>
+			onIndexed);
 };
 
 #endif	  // INDEXER_BASE_H
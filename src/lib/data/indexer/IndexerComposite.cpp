@@ -37,3 +37,49 @@ void IndexerComposite::interrupt()
 		it.second->interrupt();
 	}
 }
+
+size_t IndexerComposite::getMaximumBatchSize(const IndexerCommand& indexerCommand) const
+{
+	auto it = m_indexers.find(indexerCommand.getIndexerCommandType());
+	if (it != m_indexers.end())
+	{
+		return it->second->getMaximumBatchSize(indexerCommand);
+	}
+	return 1;
+}
+
+bool IndexerComposite::canBatch(const IndexerCommand& first, const IndexerCommand& other) const
+{
+	if (first.getIndexerCommandType() != other.getIndexerCommandType())
+	{
+		return false;
+	}
+
+	auto it = m_indexers.find(first.getIndexerCommandType());
+	if (it != m_indexers.end())
+	{
+		return it->second->canBatch(first, other);
+	}
+	return false;
+}
+
+void IndexerComposite::indexBatch(
+	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands,
+	std::function<void(std::shared_ptr<IndexerCommand>)> onStarted,
+	std::function<void(std::shared_ptr<IndexerCommand>, std::shared_ptr<IntermediateStorage>)>
+		onIndexed)
+{
+	if (indexerCommands.empty())
+	{
+		return;
+	}
+
+	auto it = m_indexers.find(indexerCommands.front()->getIndexerCommandType());
+	if (it != m_indexers.end())
+	{
+		it->second->indexBatch(indexerCommands, onStarted, onIndexed);
+		return;
+	}
+
+	IndexerBase::indexBatch(indexerCommands, onStarted, onIndexed);
+}
@@ -19,6 +19,14 @@ public:
 
 	void interrupt() override;
 
+	size_t getMaximumBatchSize(const IndexerCommand& indexerCommand) const override;
+	bool canBatch(const IndexerCommand& first, const IndexerCommand& other) const override;
+	void indexBatch(
+		const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands,
+		std::function<void(std::shared_ptr<IndexerCommand>)> onStarted,
+		std::function<void(std::shared_ptr<IndexerCommand>, std::shared_ptr<IntermediateStorage>)>
+			onIndexed) override;
+
 private:
 	std::map<IndexerCommandType, std::shared_ptr<IndexerBase>> m_indexers;
 };
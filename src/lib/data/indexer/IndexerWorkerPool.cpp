@@ -0,0 +1,263 @@
+#include "IndexerWorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "AppPath.h"
+#include "ApplicationSettings.h"
+#include "FileLogger.h"
+#include "FileSystem.h"
+#include "InterprocessIndexer.h"
+#include "LogManager.h"
+#include "UserPaths.h"
+#include "logging.h"
+#include "utilityApp.h"
+#include "utilityString.h"
+
+IndexerWorkerPool::IndexerWorkerPool(const std::string& appUUID)
+	: m_appUUID(appUUID)
+	, m_interprocessIndexerCommandManager(appUUID, 0, true)
+	, m_interprocessIndexingStatusManager(appUUID, 0, true)
+	, m_shutdown(false)
+	, m_multiProcessIndexing(false)
+{
+}
+
+IndexerWorkerPool::~IndexerWorkerPool()
+{
+	stopWorkers();
+}
+
+bool IndexerWorkerPool::startWorkers(size_t workerCount, bool multiProcessIndexing)
+{
+	const std::wstring logFilePath = getLogFilePath();
+	const TimeStamp appSettingsWriteTime = getAppSettingsWriteTime();
+
+	if (getWorkerCount() &&
+		(multiProcessIndexing != m_multiProcessIndexing || logFilePath != m_logFilePath ||
+		 (multiProcessIndexing && m_appSettingsWriteTime != appSettingsWriteTime)))
+	{
+		LOG_INFO("Restarting indexer workers because their setup changed.");
+		stopWorkers();
+	}
+
+	if (multiProcessIndexing && !AppPath::getCxxIndexerFilePath().exists())
+	{
+		LOG_ERROR(
+			L"Cannot start indexer process because executable is missing at \"" +
+			AppPath::getCxxIndexerFilePath().wstr() + L"\"");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_workerThreadsMutex);
+
+	m_shutdown = false;
+	m_multiProcessIndexing = multiProcessIndexing;
+	m_logFilePath = logFilePath;
+	m_appSettingsWriteTime = appSettingsWriteTime;
+
+	while (m_workerThreads.size() < workerCount)
+	{
+		const Id processId = m_workerThreads.size() + 1;	// 0 remains reserved for the main process
+
+		if (m_interprocessIntermediateStorageManagers.size() < processId)
+		{
+			m_interprocessIntermediateStorageManagers.push_back(
+				std::make_shared<InterprocessIntermediateStorageManager>(m_appUUID, processId, true));
+		}
+
+		if (m_multiProcessIndexing)
+		{
+			m_workerThreads.push_back(new std::thread(
+				&IndexerWorkerPool::runIndexerProcess, this, processId, m_logFilePath));
+		}
+		else
+		{
+			m_workerThreads.push_back(
+				new std::thread(&IndexerWorkerPool::runIndexerThread, this, processId));
+		}
+	}
+
+	return true;
+}
+
+void IndexerWorkerPool::stopWorkers()
+{
+	std::lock_guard<std::mutex> lock(m_workerThreadsMutex);
+
+	if (m_workerThreads.empty())
+	{
+		return;
+	}
+
+	LOG_INFO("Shutting down indexer workers.");
+
+	m_shutdown = true;
+	m_interprocessIndexingStatusManager.setIndexerShutdownRequested(true);
+
+	joinWorkers();
+}
+
+void IndexerWorkerPool::terminateWorkers()
+{
+	std::lock_guard<std::mutex> lock(m_workerThreadsMutex);
+
+	LOG_INFO("Terminating indexer workers.");
+
+	m_shutdown = true;
+	m_interprocessIndexingStatusManager.setIndexingInterrupted(true);
+	m_interprocessIndexingStatusManager.setIndexerShutdownRequested(true);
+	utility::killRunningProcesses();
+
+	joinWorkers();
+
+	// the next indexing run starts new workers with a clean state
+	m_interprocessIndexingStatusManager.setIndexingInterrupted(false);
+}
+
+size_t IndexerWorkerPool::getWorkerCount() const
+{
+	std::lock_guard<std::mutex> lock(m_workerThreadsMutex);
+	return m_workerThreads.size();
+}
+
+size_t IndexerWorkerPool::getBusyWorkerCount()
+{
+	return m_interprocessIndexingStatusManager.getBusyIndexerCount();
+}
+
+bool IndexerWorkerPool::isIdle()
+{
+	// check the queue first, workers mark themselves busy before popping a command
+	return m_interprocessIndexerCommandManager.indexerCommandCount() == 0 &&
+		m_interprocessIndexingStatusManager.getBusyIndexerCount() == 0;
+}
+
+std::shared_ptr<InterprocessIntermediateStorageManager> IndexerWorkerPool::getIntermediateStorageManager(
+	Id processId) const
+{
+	std::lock_guard<std::mutex> lock(m_workerThreadsMutex);
+
+	if (!processId || processId > m_interprocessIntermediateStorageManagers.size())
+	{
+		return nullptr;
+	}
+
+	return m_interprocessIntermediateStorageManagers[processId - 1];
+}
+
+void IndexerWorkerPool::joinWorkers()
+{
+	for (std::thread* workerThread: m_workerThreads)
+	{
+		workerThread->join();
+		delete workerThread;
+	}
+	m_workerThreads.clear();
+
+	m_shutdown = false;
+	m_interprocessIndexingStatusManager.setIndexerShutdownRequested(false);
+}
+
+std::wstring IndexerWorkerPool::getLogFilePath()
+{
+	Logger* logger = LogManager::getInstance()->getLoggerByType("FileLogger");
+	if (logger)
+	{
+		return dynamic_cast<FileLogger*>(logger)->getLogFilePath().wstr();
+	}
+	return L"";
+}
+
+TimeStamp IndexerWorkerPool::getAppSettingsWriteTime()
+{
+	const FilePath appSettingsFilePath = UserPaths::getAppSettingsFilePath();
+	if (appSettingsFilePath.exists())
+	{
+		return FileSystem::getLastWriteTime(appSettingsFilePath);
+	}
+	return TimeStamp();
+}
+
+void IndexerWorkerPool::runIndexerProcess(Id processId, const std::wstring& logFilePath)
+{
+	const FilePath indexerProcessPath = AppPath::getCxxIndexerFilePath();
+
+	std::vector<std::wstring> commandArguments;
+	commandArguments.push_back(std::to_wstring(processId));
+	commandArguments.push_back(utility::decodeFromUtf8(m_appUUID));
+	commandArguments.push_back(AppPath::getSharedDataDirectoryPath().getAbsolute().wstr());
+	commandArguments.push_back(UserPaths::getUserDataDirectoryPath().getAbsolute().wstr());
+
+	if (!logFilePath.empty())
+	{
+		commandArguments.push_back(logFilePath);
+	}
+
+	// delay before relaunching a crashed process, doubled on every crash in a row
+	const size_t minimumRelaunchDelayMS = 100;
+	const size_t maximumRelaunchDelayMS = 10000;
+	size_t relaunchDelayMS = 0;
+
+	while (!m_shutdown)
+	{
+		if (relaunchDelayMS)
+		{
+			LOG_WARNING_STREAM(
+				<< "Relaunching indexer process " << processId << " in " << relaunchDelayMS
+				<< " ms");
+
+			const TimeStamp crashTime = TimeStamp::now();
+			while (!m_shutdown && TimeStamp::now().deltaMS(crashTime) < relaunchDelayMS)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(25));
+			}
+
+			if (m_shutdown)
+			{
+				break;
+			}
+		}
+
+		const int result = utility::executeProcess(
+							   indexerProcessPath.wstr(), commandArguments, FilePath(), false, -1)
+							   .exitCode;
+
+		LOG_INFO_STREAM(<< "Indexer process " << processId << " returned with " + std::to_string(result));
+
+		// the process may have crashed while working on a command, the commands of its batch that
+		// were not started yet are indexed by the next free worker. Requeue them before clearing
+		// the busy flag, so the queue never looks finished in between.
+		if (m_shutdown)
+		{
+			m_interprocessIndexerCommandManager.clearPendingIndexerCommands(processId);
+		}
+		else
+		{
+			const size_t requeuedCount =
+				m_interprocessIndexerCommandManager.requeuePendingIndexerCommands(processId);
+			if (requeuedCount)
+			{
+				LOG_WARNING_STREAM(
+					<< "Requeued " << requeuedCount << " indexer commands of indexer process "
+					<< processId);
+			}
+		}
+		m_interprocessIndexingStatusManager.clearIndexerBusy(processId);
+
+		// the process exits normally on shutdown or when exceeding the memory growth limit
+		relaunchDelayMS = result == 0
+			? 0
+			: std::min(
+				  maximumRelaunchDelayMS, std::max(minimumRelaunchDelayMS, relaunchDelayMS * 2));
+	}
+}
+
+void IndexerWorkerPool::runIndexerThread(Id processId)
+{
+	while (!m_shutdown)
+	{
+		InterprocessIndexer indexer(m_appUUID, processId);
+		indexer.work();	   // this will only return if a shutdown was requested
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef INDEXER_WORKER_POOL_H
+#define INDEXER_WORKER_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InterprocessIndexerCommandManager.h"
+#include "InterprocessIndexingStatusManager.h"
+#include "InterprocessIntermediateStorageManager.h"
+#include "TimeStamp.h"
+
+// Owns the indexer workers (processes or threads) and the shared memory they use, so workers and
+// their warm state survive gaps in the indexer command queue and successive refreshes. Workers
+// only exit on shutdown, on a crash or when exceeding the indexer process memory growth limit and
+// are relaunched in the two latter cases.
+class IndexerWorkerPool
+{
+public:
+	IndexerWorkerPool(const std::string& appUUID);
+	~IndexerWorkerPool();
+
+	// makes sure at least workerCount workers are running. Running workers get restarted if the
+	// indexing mode, the log file or the application settings changed since they were started.
+	bool startWorkers(size_t workerCount, bool multiProcessIndexing);
+	void stopWorkers();
+	// kills running indexer processes and joins all workers, the next start launches new ones
+	void terminateWorkers();
+
+	size_t getWorkerCount() const;
+	size_t getBusyWorkerCount();
+
+	// no indexer commands left in the queue and no worker working on one
+	bool isIdle();
+
+	std::shared_ptr<InterprocessIntermediateStorageManager> getIntermediateStorageManager(
+		Id processId) const;
+
+private:
+	static std::wstring getLogFilePath();
+	static TimeStamp getAppSettingsWriteTime();
+
+	// joins all worker threads and resets the shutdown flags, m_workerThreadsMutex has to be locked
+	void joinWorkers();
+
+	void runIndexerProcess(Id processId, const std::wstring& logFilePath);
+	void runIndexerThread(Id processId);
+
+	const std::string m_appUUID;
+
+	InterprocessIndexerCommandManager m_interprocessIndexerCommandManager;
+	InterprocessIndexingStatusManager m_interprocessIndexingStatusManager;
+	std::vector<std::shared_ptr<InterprocessIntermediateStorageManager>>
+		m_interprocessIntermediateStorageManagers;
+
+	// store as plain pointers to avoid deallocation issues when closing app during indexing
+	std::vector<std::thread*> m_workerThreads;
+	mutable std::mutex m_workerThreadsMutex;
+
+	std::atomic<bool> m_shutdown;
+	bool m_multiProcessIndexing;
+	std::wstring m_logFilePath;
+	TimeStamp m_appSettingsWriteTime;
+};
+
+#endif	  // INDEXER_WORKER_POOL_H
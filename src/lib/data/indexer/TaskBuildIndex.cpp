@@ -1,87 +1,73 @@
 #include "TaskBuildIndex.h"
 
-#include "AppPath.h"
 #include "Blackboard.h"
 #include "DialogView.h"
-#include "FileLogger.h"
-#include "InterprocessIndexer.h"
+#include "IndexerWorkerPool.h"
 #include "MessageIndexingStatus.h"
 #include "MessageStatus.h"
 #include "ParserClientImpl.h"
 #include "StorageProvider.h"
-#include "TimeStamp.h"
-#include "UserPaths.h"
+#include "tracing.h"
 #include "utilityApp.h"
 
+const size_t TaskBuildIndex::s_minimumProviderByteBudget = 64 * 1048576;
+const size_t TaskBuildIndex::s_minimumWorkerByteBudget = 8 * 1048576;
+const size_t TaskBuildIndex::s_workerExitTimeoutMS = 30000;
+const int TaskBuildIndex::s_maximumQueuedStorageCount = 10;
+
 TaskBuildIndex::TaskBuildIndex(
 	size_t processCount,
 	std::shared_ptr<StorageProvider> storageProvider,
 	std::shared_ptr<DialogView> dialogView,
+	std::shared_ptr<IndexerWorkerPool> workerPool,
 	const std::string& appUUID,
-	bool multiProcessIndexing)
+	bool multiProcessIndexing,
+	size_t memoryBudget)
 	: m_storageProvider(storageProvider)
 	, m_dialogView(dialogView)
+	, m_workerPool(workerPool)
 	, m_appUUID(appUUID)
 	, m_multiProcessIndexing(multiProcessIndexing)
-	, m_interprocessIndexingStatusManager(appUUID, 0, true)
+	, m_memoryBudget(memoryBudget)
+	, m_interprocessIndexingStatusManager(appUUID, 0, false)
 	, m_indexerCommandQueueStopped(false)
 	, m_processCount(processCount)
 	, m_interrupted(false)
 	, m_indexingFileCount(0)
-	, m_runningThreadCount(0)
+	, m_tracingEnabled(false)
 {
 }
 
 void TaskBuildIndex::doEnter(std::shared_ptr<Blackboard> blackboard)
 {
-	m_interprocessIndexingStatusManager.setIndexingInterrupted(false);
-
 	m_indexingFileCount = 0;
 	updateIndexingDialog(blackboard, std::vector<FilePath>());
 
-	std::wstring logFilePath;
-	Logger* logger = LogManager::getInstance()->getLoggerByType("FileLogger");
-	if (logger)
+	// start indexer workers or reuse the ones still running from a previous refresh
+	if (!m_workerPool->startWorkers(m_processCount, m_multiProcessIndexing))
 	{
-		logFilePath = dynamic_cast<FileLogger*>(logger)->getLogFilePath().wstr();
+		m_interrupted = true;
 	}
 
-	// start indexer processes
-	for (unsigned int i = 0; i < m_processCount; i++)
+	for (Id processId = 1; processId <= m_workerPool->getWorkerCount(); processId++)
 	{
-		{
-			std::lock_guard<std::mutex> lock(m_runningThreadCountMutex);
-			m_runningThreadCount++;
-		}
+		m_interprocessIntermediateStorageManagers.push_back(
+			m_workerPool->getIntermediateStorageManager(processId));
+	}
 
-		const int processId = i + 1;	// 0 remains reserved for the main process
+	updateMemoryBudgets();
 
-		m_interprocessIntermediateStorageManagers.push_back(
-			std::make_shared<InterprocessIntermediateStorageManager>(m_appUUID, processId, true));
+	// workers idle after an interrupted refresh until the flag gets reset
+	m_interprocessIndexingStatusManager.setIndexingInterrupted(false);
 
-		if (m_multiProcessIndexing)
-		{
-			m_processThreads.push_back(
-				new std::thread(&TaskBuildIndex::runIndexerProcess, this, processId, logFilePath));
-		}
-		else
-		{
-			m_processThreads.push_back(
-				new std::thread(&TaskBuildIndex::runIndexerThread, this, processId));
-		}
-	}
+	m_tracingEnabled = Tracer::isEnabled();
+	m_interprocessIndexingStatusManager.setTracingEnabled(m_tracingEnabled);
 
 	blackboard->set<bool>("indexer_threads_started", true);
 }
 
 Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
 {
-	size_t runningThreadCount = 0;
-	{
-		std::lock_guard<std::mutex> lock(m_runningThreadCountMutex);
-		runningThreadCount = m_runningThreadCount;
-	}
-
 	blackboard->get<bool>("indexer_command_queue_stopped", m_indexerCommandQueueStopped);
 
 	const std::vector<FilePath> indexingFiles =
@@ -91,9 +77,9 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
 		updateIndexingDialog(blackboard, indexingFiles);
 	}
 
-	if (m_indexerCommandQueueStopped && runningThreadCount == 0)
+	if (m_indexerCommandQueueStopped && m_workerPool->isIdle())
 	{
-		LOG_INFO_STREAM(<< "command queue stopped and no running threads. done.");
+		LOG_INFO_STREAM(<< "command queue stopped and no busy indexers. done.");
 		return STATE_SUCCESS;
 	}
 	else if (m_interrupted)
@@ -103,6 +89,13 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
 		return STATE_SUCCESS;
 	}
 
+	if (TimeStamp::now().deltaMS(m_memoryBudgetUpdateTime) > 500)
+	{
+		updateMemoryBudgets();
+	}
+
+	updateTracing();
+
 	if (fetchIntermediateStorages(blackboard))
 	{
 		updateIndexingDialog(blackboard, std::vector<FilePath>());
@@ -115,12 +108,20 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
 
 void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard)
 {
-	for (auto processThread: m_processThreads)
+	// workers stay alive for the next refresh, wait for them to finish their current commands
+	const TimeStamp waitStartTime = TimeStamp::now();
+	while (m_workerPool->getBusyWorkerCount() > 0)
 	{
-		processThread->join();
-		delete processThread;
+		if (TimeStamp::now().deltaMS(waitStartTime) > s_workerExitTimeoutMS)
+		{
+			LOG_WARNING_STREAM(
+				<< "indexer workers still busy after " << s_workerExitTimeoutMS
+				<< " ms, terminating them.");
+			m_workerPool->terminateWorkers();
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
 	}
-	m_processThreads.clear();
 
 	if (!m_interrupted)
 	{
@@ -128,6 +129,8 @@ void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard)
 			;
 	}
 
+	updateTracing();
+
 	std::vector<FilePath> crashedFiles =
 		m_interprocessIndexingStatusManager.getCrashedSourceFilePaths();
 	if (!crashedFiles.empty())
@@ -154,6 +157,15 @@ void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard)
 		m_storageProvider->insert(storage);
 	}
 
+	// leave a clean state for the next refresh, the workers stay alive
+	for (std::shared_ptr<InterprocessIntermediateStorageManager> storageManager:
+		 m_interprocessIntermediateStorageManagers)
+	{
+		storageManager->clearIntermediateStorages();
+	}
+	m_interprocessIntermediateStorageManagers.clear();
+	m_interprocessIndexingStatusManager.clearIndexingStatus();
+
 	blackboard->set<bool>("indexer_threads_stopped", true);
 }
 
@@ -162,7 +174,7 @@ void TaskBuildIndex::doReset(std::shared_ptr<Blackboard> blackboard) {}
 void TaskBuildIndex::terminate()
 {
 	m_interrupted = true;
-	utility::killRunningProcesses();
+	m_workerPool->terminateWorkers();
 }
 
 void TaskBuildIndex::handleMessage(MessageIndexingInterrupted* message)
@@ -176,73 +188,22 @@ void TaskBuildIndex::handleMessage(MessageIndexingInterrupted* message)
 		L"Interrupting Indexing", L"Waiting for indexer\nthreads to finish");
 }
 
-void TaskBuildIndex::runIndexerProcess(int processId, const std::wstring& logFilePath)
-{
-	const FilePath indexerProcessPath = AppPath::getCxxIndexerFilePath();
-	if (!indexerProcessPath.exists())
-	{
-		m_interrupted = true;
-		LOG_ERROR(
-			L"Cannot start indexer process because executable is missing at \"" +
-			indexerProcessPath.wstr() + L"\"");
-		return;
-	}
-
-	std::vector<std::wstring> commandArguments;
-	commandArguments.push_back(std::to_wstring(processId));
-	commandArguments.push_back(utility::decodeFromUtf8(m_appUUID));
-	commandArguments.push_back(AppPath::getSharedDataDirectoryPath().getAbsolute().wstr());
-	commandArguments.push_back(UserPaths::getUserDataDirectoryPath().getAbsolute().wstr());
-
-	if (!logFilePath.empty())
-	{
-		commandArguments.push_back(logFilePath);
-	}
-
-	int result = 1;
-	while ((!m_indexerCommandQueueStopped || result != 0) && !m_interrupted)
-	{
-		result = utility::executeProcess(
-					 indexerProcessPath.wstr(), commandArguments, FilePath(), false, -1)
-					 .exitCode;
-
-		LOG_INFO_STREAM(<< "Indexer process " << processId << " returned with " + std::to_string(result));
-	}
-
-	{
-		std::lock_guard<std::mutex> lock(m_runningThreadCountMutex);
-		m_runningThreadCount--;
-	}
-}
-
-void TaskBuildIndex::runIndexerThread(int processId)
-{
-	do
-	{
-		InterprocessIndexer indexer(m_appUUID, processId);
-		indexer.work();	   // this will only return if there are no indexer commands left in the queue
-		if (!m_interrupted)
-		{
-			// sleeping if interrupted may result in a crash due to objects that are already
-			// destroyed after waking up again
-			std::this_thread::sleep_for(std::chrono::milliseconds(200));
-		}
-	} while (!m_indexerCommandQueueStopped && !m_interrupted);
-
-	{
-		std::lock_guard<std::mutex> lock(m_runningThreadCountMutex);
-		m_runningThreadCount--;
-	}
-}
-
 bool TaskBuildIndex::fetchIntermediateStorages(std::shared_ptr<Blackboard> blackboard)
 {
 	int poppedStorageCount = 0;
 
-	int providerStorageCount = m_storageProvider->getStorageCount();
-	if (providerStorageCount > 10)
+	// storages exceeding the budget get spilled to disk, only wait if that's not possible. Without
+	// a budget wait on the number of storages kept in memory instead.
+	const size_t providerByteBudget = m_storageProvider->getByteBudget();
+	const size_t providerByteSize = m_storageProvider->getByteSize();
+	if ((providerByteBudget && providerByteSize > providerByteBudget &&
+		 !m_storageProvider->canSpill()) ||
+		(!providerByteBudget &&
+		 m_storageProvider->getInMemoryStorageCount() > s_maximumQueuedStorageCount))
 	{
-		LOG_INFO_STREAM(<< "waiting, too many storages queued: " << providerStorageCount);
+		LOG_INFO_STREAM(
+			<< "waiting, too many storages queued: " << m_storageProvider->getStorageCount()
+			<< " with " << providerByteSize << " bytes");
 
 		std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
@@ -284,6 +245,20 @@ bool TaskBuildIndex::fetchIntermediateStorages(std::shared_ptr<Blackboard> black
 	return false;
 }
 
+void TaskBuildIndex::updateTracing()
+{
+	const bool tracingEnabled = Tracer::isEnabled();
+	if (tracingEnabled != m_tracingEnabled)
+	{
+		m_interprocessIndexingStatusManager.setTracingEnabled(tracingEnabled);
+		m_tracingEnabled = tracingEnabled;
+	}
+
+	// only indexer processes forward their events, indexer threads record them directly
+	Tracer::getInstance()->addChromeTraceEvents(
+		m_interprocessIndexingStatusManager.popTraceEvents());
+}
+
 void TaskBuildIndex::updateIndexingDialog(
 	std::shared_ptr<Blackboard> blackboard, const std::vector<FilePath>& sourcePaths)
 {
@@ -297,6 +272,11 @@ void TaskBuildIndex::updateIndexingDialog(
 
 	m_dialogView->updateIndexingDialog(
 		m_indexingFileCount, indexedSourceFileCount, sourceFileCount, sourcePaths);
+	m_dialogView->updateIndexingQueueStatus(
+		m_storageProvider->getStorageCount(),
+		m_storageProvider->getSpilledStorageCount(),
+		m_storageProvider->getByteSize(),
+		m_storageProvider->getByteBudget());
 
 	int progress = 0;
 	if (sourceFileCount)
@@ -305,3 +285,27 @@ void TaskBuildIndex::updateIndexingDialog(
 	}
 	MessageIndexingStatus(true, progress).dispatch();
 }
+
+void TaskBuildIndex::updateMemoryBudgets()
+{
+	m_memoryBudgetUpdateTime = TimeStamp::now();
+
+	if (!m_memoryBudget)
+	{
+		return;
+	}
+
+	const size_t residentSize = utility::getResidentMemorySize();
+	const size_t providerByteSize = m_storageProvider->getByteSize();
+
+	// memory used by everything except the queued storages, e.g. the app and the persistent storage
+	const size_t baseSize = residentSize > providerByteSize ? residentSize - providerByteSize : 0;
+	const size_t availableSize = m_memoryBudget > baseSize ? m_memoryBudget - baseSize : 0;
+
+	// a quarter of the available memory is shared among the workers, the rest is used for merging
+	const size_t workerCount = std::max<size_t>(1, m_interprocessIntermediateStorageManagers.size());
+
+	m_storageProvider->setByteBudget(std::max(s_minimumProviderByteBudget, availableSize / 4 * 3));
+	m_interprocessIndexingStatusManager.setIntermediateStorageByteBudget(
+		std::max(s_minimumWorkerByteBudget, availableSize / 4 / workerCount));
+}
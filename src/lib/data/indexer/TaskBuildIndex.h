@@ -1,17 +1,16 @@
 #ifndef TASK_BUILD_INDEX_H
 #define TASK_BUILD_INDEX_H
 
-#include <thread>
-
 #include "MessageIndexingInterrupted.h"
 #include "MessageListener.h"
 #include "Task.h"
 
-#include "InterprocessIndexerCommandManager.h"
 #include "InterprocessIndexingStatusManager.h"
 #include "InterprocessIntermediateStorageManager.h"
+#include "TimeStamp.h"
 
 class DialogView;
+class IndexerWorkerPool;
 class StorageProvider;
 class IndexerCommandList;
 
@@ -24,8 +23,10 @@ public:
 		size_t processCount,
 		std::shared_ptr<StorageProvider> storageProvider,
 		std::shared_ptr<DialogView> dialogView,
+		std::shared_ptr<IndexerWorkerPool> workerPool,
 		const std::string& appUUID,
-		bool multiProcessIndexing);
+		bool multiProcessIndexing,
+		size_t memoryBudget);
 
 protected:
 	void doEnter(std::shared_ptr<Blackboard> blackboard) override;
@@ -36,33 +37,36 @@ protected:
 
 	void handleMessage(MessageIndexingInterrupted* message) override;
 
-	void runIndexerProcess(int processId, const std::wstring& logFilePath);
-	void runIndexerThread(int processId);
 	bool fetchIntermediateStorages(std::shared_ptr<Blackboard> blackboard);
+	void updateMemoryBudgets();
+	void updateTracing();
 	void updateIndexingDialog(
 		std::shared_ptr<Blackboard> blackboard, const std::vector<FilePath>& sourcePaths);
 
-	static const std::wstring s_processName;
-
 	std::shared_ptr<IndexerCommandList> m_indexerCommandList;
 	std::shared_ptr<StorageProvider> m_storageProvider;
 	std::shared_ptr<DialogView> m_dialogView;
+	std::shared_ptr<IndexerWorkerPool> m_workerPool;
 	const std::string m_appUUID;
 	bool m_multiProcessIndexing;
 
+	static const size_t s_minimumProviderByteBudget;
+	static const size_t s_minimumWorkerByteBudget;
+	static const size_t s_workerExitTimeoutMS;
+	static const int s_maximumQueuedStorageCount;
+
+	const size_t m_memoryBudget;
+	TimeStamp m_memoryBudgetUpdateTime;
+
 	InterprocessIndexingStatusManager m_interprocessIndexingStatusManager;
 	bool m_indexerCommandQueueStopped;
 	size_t m_processCount;
 	bool m_interrupted;
 	size_t m_indexingFileCount;
+	bool m_tracingEnabled;
 
-	// store as plain pointers to avoid deallocation issues when closing app during indexing
-	std::vector<std::thread*> m_processThreads;
 	std::vector<std::shared_ptr<InterprocessIntermediateStorageManager>>
 		m_interprocessIntermediateStorageManagers;
-
-	size_t m_runningThreadCount;
-	std::mutex m_runningThreadCountMutex;
 };
 
 #endif	  // TASK_PARSE_H
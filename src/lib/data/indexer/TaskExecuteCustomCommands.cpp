@@ -34,9 +34,110 @@ void TaskExecuteCustomCommands::runPythonPostProcessing(PersistentStorage& stora
 		}
 	}
 
+	runPythonPostProcessing(storage, storage.getSourceLocationsForLocationIds(unsolvedLocationIds));
+}
+
+void TaskExecuteCustomCommands::runPythonPostProcessing(
+	PersistentStorage& storage, const std::set<FilePath>& filePaths, Id lastPreviousElementId)
+{
 	std::shared_ptr<SourceLocationCollection> locationCollection =
-		storage.getSourceLocationsForLocationIds(unsolvedLocationIds);
+		std::make_shared<SourceLocationCollection>();
+	std::set<std::wstring> filePathStrings;
+	for (const FilePath& filePath: filePaths)
+	{
+		std::shared_ptr<SourceLocationFile> locationFile = storage.getSourceLocationsOfTypeInFile(
+			filePath, LOCATION_UNSOLVED);
+		if (locationFile->getSourceLocationCount() > 0)
+		{
+			locationCollection->addSourceLocationFile(locationFile);
+		}
+		filePathStrings.insert(filePath.wstr());
+	}
+
+	// the unsolved locations of other files have been processed before, but they may refer to nodes
+	// that were added since then
+	std::set<std::wstring> addedNodeNames;
+	for (const StorageNode& node: storage.getStorageNodes())
+	{
+		if (node.id > lastPreviousElementId)
+		{
+			addedNodeNames.insert(NameHierarchy::deserialize(node.serializedName).back().getName());
+		}
+	}
+
+	size_t otherFileCount = 0;
+	if (!addedNodeNames.empty())
+	{
+		std::map<Id, std::vector<StorageSourceLocation>> unsolvedLocationsByFileId;
+		for (const StorageSourceLocation& location: storage.getStorageSourceLocations())
+		{
+			if (intToLocationType(location.type) == LOCATION_UNSOLVED &&
+				location.startLine == location.endLine && location.startCol <= location.endCol)
+			{
+				unsolvedLocationsByFileId[location.fileNodeId].push_back(location);
+			}
+		}
+
+		std::vector<Id> otherLocationIds;
+		for (const StorageFile& file: storage.getStorageFiles())
+		{
+			auto it = unsolvedLocationsByFileId.find(file.id);
+			if (it == unsolvedLocationsByFileId.end() ||
+				filePathStrings.find(file.filePath) != filePathStrings.end())
+			{
+				continue;
+			}
+
+			const FilePath filePath(file.filePath);
+			if (!filePath.exists())
+			{
+				continue;
+			}
+
+			std::shared_ptr<TextAccess> textAccess = TextAccess::createFromFile(filePath);
+			const size_t locationCount = otherLocationIds.size();
+			for (const StorageSourceLocation& location: it->second)
+			{
+				const std::string tokenLine = textAccess->getLine(
+					static_cast<unsigned int>(location.startLine));
+				if (location.startCol == 0 || location.endCol > tokenLine.size())
+				{
+					continue;
+				}
 
+				const std::wstring token = utility::decodeFromUtf8(tokenLine.substr(
+					location.startCol - 1, location.endCol - location.startCol + 1));
+				if (addedNodeNames.find(token) != addedNodeNames.end())
+				{
+					otherLocationIds.push_back(location.id);
+				}
+			}
+
+			if (otherLocationIds.size() > locationCount)
+			{
+				otherFileCount++;
+			}
+		}
+
+		if (!otherLocationIds.empty())
+		{
+			locationCollection->addSourceLocationCopies(
+				storage.getSourceLocationsForLocationIds(otherLocationIds).get());
+		}
+	}
+
+	LOG_INFO(
+		"Python post processing of " +
+		std::to_string(locationCollection->getSourceLocationCount()) + " unsolved locations in " +
+		std::to_string(filePaths.size()) + " indexed and " + std::to_string(otherFileCount) +
+		" other files.");
+
+	runPythonPostProcessing(storage, locationCollection);
+}
+
+void TaskExecuteCustomCommands::runPythonPostProcessing(
+	PersistentStorage& storage, std::shared_ptr<SourceLocationCollection> locationCollection)
+{
 	std::map<std::wstring, std::vector<StorageNode>> nodeNameToStorageNodes;
 	if (locationCollection->getSourceLocationCount() > 0)
 	{
@@ -254,7 +355,6 @@ TaskExecuteCustomCommands::TaskExecuteCustomCommands(
 	, m_indexerThreadCount(indexerThreadCount)
 	, m_projectDirectory(projectDirectory)
 	, m_indexerCommandCount(m_indexerCommandProvider->size())
-	, m_hasPythonCommands(false)
 {
 }
 
@@ -263,6 +363,12 @@ void TaskExecuteCustomCommands::doEnter(std::shared_ptr<Blackboard> blackboard)
 	m_dialogView->hideUnknownProgressDialog();
 	m_start = TimeStamp::now();
 
+	// nodes with higher ids are added by this run, see runPythonPostProcessing()
+	if (m_storage)
+	{
+		m_lastPreviousElementId = m_storage->getLastElementId();
+	}
+
 	if (m_indexerCommandProvider)
 	{
 		for (const FilePath& sourceFilePath:
@@ -279,7 +385,7 @@ void TaskExecuteCustomCommands::doEnter(std::shared_ptr<Blackboard> blackboard)
 #if BUILD_PYTHON_LANGUAGE_PACKAGE
 				if (indexerCommand->getIndexerCommandType() == INDEXER_COMMAND_PYTHON)
 				{
-					m_hasPythonCommands = true;
+					m_pythonSourceFilePaths.insert(sourceFilePath);
 				}
 #endif	  // BUILD_PYTHON_LANGUAGE_PACKAGE
 
@@ -337,22 +443,33 @@ Task::TaskState TaskExecuteCustomCommands::doUpdate(std::shared_ptr<Blackboard>
 	MessageErrorCountClear().dispatch();
 
 	{
+		const FilePath sourceDatabaseFilePath = mergeSourceDatabases(std::vector<FilePath>(
+			m_sourceDatabaseFilePaths.begin(), m_sourceDatabaseFilePaths.end()));
+
 		PersistentStorage targetStorage(m_targetDatabaseFilePath, FilePath());
 		targetStorage.setup();
-		targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
-		targetStorage.buildCaches();
-		for (const FilePath& sourceDatabaseFilePath: m_sourceDatabaseFilePaths)
+		if (!sourceDatabaseFilePath.empty())
 		{
+			targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_MERGE);
+			if (targetStorage.mergeDatabase(sourceDatabaseFilePath))
 			{
-				PersistentStorage sourceStorage(sourceDatabaseFilePath, FilePath());
-				sourceStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
-				sourceStorage.buildCaches();
-				targetStorage.inject(&sourceStorage);
+				FileSystem::remove(sourceDatabaseFilePath);
+			}
+			else
+			{
+				const std::wstring statusText =
+					L"Failed to merge the custom command results in \"" +
+					sourceDatabaseFilePath.wstr() +
+					L"\" into the project database. The file is kept.";
+
+				LOG_ERROR(statusText);
+				MessageShowStatus().dispatch();
+				MessageStatus(statusText, true, false, true).dispatch();
 			}
-			FileSystem::remove(sourceDatabaseFilePath);
 		}
+		targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
 
-		if (m_hasPythonCommands &&
+		if (!m_pythonSourceFilePaths.empty() &&
 			ApplicationSettings::getInstance()->getPythonPostProcessingEnabled())
 		{
 			LOG_INFO("Starting Python post processing.");
@@ -361,7 +478,9 @@ Task::TaskState TaskExecuteCustomCommands::doUpdate(std::shared_ptr<Blackboard>
 
 			targetStorage.clearCaches();
 			targetStorage.buildCaches();
-			runPythonPostProcessing(targetStorage);
+			// unsolved locations of files that were not indexed again have been processed before,
+			// they are only processed again if they refer to a node added in this run
+			runPythonPostProcessing(targetStorage, m_pythonSourceFilePaths, m_lastPreviousElementId);
 		}
 	}
 
@@ -449,6 +568,68 @@ void TaskExecuteCustomCommands::executeParallelIndexerCommands(
 	}
 }
 
+FilePath TaskExecuteCustomCommands::mergeSourceDatabases(std::vector<FilePath> databaseFilePaths)
+{
+	// pairs of databases are merged in parallel, halving their number in each round
+	while (databaseFilePaths.size() > 1)
+	{
+		std::vector<FilePath> mergedDatabaseFilePaths;
+		std::vector<std::thread> mergeThreads;
+		std::vector<char> mergeSucceeded(databaseFilePaths.size() / 2, false);
+		for (size_t i = 0; i + 1 < databaseFilePaths.size(); i += 2)
+		{
+			mergedDatabaseFilePaths.push_back(databaseFilePaths[i]);
+			mergeThreads.emplace_back(
+				[](const FilePath& targetDatabaseFilePath,
+				   const FilePath& sourceDatabaseFilePath,
+				   char& succeeded) {
+					{
+						SqliteIndexStorage targetStorage(targetDatabaseFilePath);
+						targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_MERGE);
+						succeeded = targetStorage.mergeDatabase(sourceDatabaseFilePath);
+					}
+					if (succeeded)
+					{
+						FileSystem::remove(sourceDatabaseFilePath);
+					}
+				},
+				databaseFilePaths[i],
+				databaseFilePaths[i + 1],
+				std::ref(mergeSucceeded[i / 2]));
+		}
+
+		if (databaseFilePaths.size() % 2)
+		{
+			mergedDatabaseFilePaths.push_back(databaseFilePaths.back());
+		}
+
+		for (std::thread& mergeThread: mergeThreads)
+		{
+			mergeThread.join();
+		}
+
+		// a failed merge is rolled back, its source is kept on disk for inspection
+		for (size_t i = 0; i < mergeSucceeded.size(); i++)
+		{
+			if (!mergeSucceeded[i])
+			{
+				const std::wstring statusText =
+					L"Failed to merge the custom command results in \"" +
+					databaseFilePaths[i * 2 + 1].wstr() + L"\" into \"" +
+					databaseFilePaths[i * 2].wstr() + L"\". The file is kept.";
+
+				LOG_ERROR(statusText);
+				MessageShowStatus().dispatch();
+				MessageStatus(statusText, true, false, true).dispatch();
+			}
+		}
+
+		databaseFilePaths = mergedDatabaseFilePaths;
+	}
+
+	return databaseFilePaths.empty() ? FilePath() : databaseFilePaths.front();
+}
+
 void TaskExecuteCustomCommands::runIndexerCommand(
 	std::shared_ptr<IndexerCommandCustom> indexerCommand,
 	std::shared_ptr<Blackboard> blackboard,
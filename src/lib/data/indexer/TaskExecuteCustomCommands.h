@@ -15,6 +15,7 @@ class DialogView;
 class IndexerCommandCustom;
 class IndexerCommandProvider;
 class PersistentStorage;
+class SourceLocationCollection;
 
 class TaskExecuteCustomCommands
 	: public Task
@@ -23,6 +24,11 @@ class TaskExecuteCustomCommands
 public:
 	static void runPythonPostProcessing(PersistentStorage& storage);
 
+	// regards the unsolved locations within the given files and the unsolved locations of other
+	// files that refer to the name of a node added after lastPreviousElementId
+	static void runPythonPostProcessing(
+		PersistentStorage& storage, const std::set<FilePath>& filePaths, Id lastPreviousElementId);
+
 	TaskExecuteCustomCommands(
 		std::unique_ptr<IndexerCommandProvider> indexerCommandProvider,
 		std::shared_ptr<PersistentStorage> storage,
@@ -38,7 +44,14 @@ private:
 
 	void handleMessage(MessageIndexingInterrupted* message) override;
 
+	static void runPythonPostProcessing(
+		PersistentStorage& storage, std::shared_ptr<SourceLocationCollection> locationCollection);
+
 	void executeParallelIndexerCommands(int threadId, std::shared_ptr<Blackboard> blackboard);
+
+	// merges the databases written by the indexer threads into one of them, which is returned
+	static FilePath mergeSourceDatabases(std::vector<FilePath> databaseFilePaths);
+
 	void runIndexerCommand(
 		std::shared_ptr<IndexerCommandCustom> indexerCommand,
 		std::shared_ptr<Blackboard> blackboard,
@@ -59,7 +72,8 @@ private:
 	ErrorCountInfo m_errorCount;
 	std::mutex m_errorCountMutex;
 	FilePath m_targetDatabaseFilePath;
-	bool m_hasPythonCommands;
+	std::set<FilePath> m_pythonSourceFilePaths;
+	Id m_lastPreviousElementId = 0;
 	std::set<FilePath> m_sourceDatabaseFilePaths;
 	std::mutex m_sourceDatabaseFilePathsMutex;
 };
@@ -1,17 +1,28 @@
 #include "TaskFillIndexerCommandQueue.h"
 
+#include <cwctype>
+
 #include "Blackboard.h"
 #include "FileSystem.h"
 #include "IndexerCommandProvider.h"
 #include "logging.h"
 #include "utilityFile.h"
+#include "utilityString.h"
+
+namespace
+{
+std::wstring getLowerCaseFileName(const FilePath& filePath)
+{
+	return utility::toLowerCase(filePath.withoutExtension().fileName());
+}
+}	 // namespace
 
 TaskFillIndexerCommandsQueue::TaskFillIndexerCommandsQueue(
 	const std::string& appUUID,
 	std::unique_ptr<IndexerCommandProvider> indexerCommandProvider,
 	size_t maximumQueueSize)
 	: m_indexerCommandProvider(std::move(indexerCommandProvider))
-	, m_indexerCommandManager(appUUID, 0, true)
+	, m_indexerCommandManager(appUUID, 0, false)
 	, m_maximumQueueSize(maximumQueueSize)
 {
 }
@@ -24,6 +35,7 @@ void TaskFillIndexerCommandsQueue::doEnter(std::shared_ptr<Blackboard> blackboar
 			 utility::partitionFilePathsBySize(m_indexerCommandProvider->getAllSourceFilePaths(), 2))
 		{
 			m_filePathQueue.emplace(filePath);
+			m_sourceFilePathsByName.emplace(getLowerCaseFileName(filePath), filePath);
 		}
 	}
 
@@ -81,6 +93,8 @@ void TaskFillIndexerCommandsQueue::handleMessage(MessageIndexingInterrupted* mes
 
 	std::queue<FilePath> empty;
 	std::swap(m_filePathQueue, empty);
+	std::queue<FilePath> emptyPriority;
+	std::swap(m_priorityFilePathQueue, emptyPriority);
 
 	m_indexerCommandProvider->clear();
 	m_indexerCommandManager.clearIndexerCommands();
@@ -92,9 +106,41 @@ void TaskFillIndexerCommandsQueue::handleMessage(MessageIndexingInterrupted* mes
 		".");
 }
 
+void TaskFillIndexerCommandsQueue::handleMessage(MessageActivateFile* message)
+{
+	prioritizeSourceFiles({getLowerCaseFileName(message->filePath)});
+}
+
+void TaskFillIndexerCommandsQueue::handleMessage(MessageSearch* message)
+{
+	std::vector<std::wstring> fileNames;
+	for (const SearchMatch& match: message->getMatches())
+	{
+		// qualified names and paths are split into their parts
+		std::wstring part;
+		for (const wchar_t c: match.name + L' ')
+		{
+			if (iswalnum(c) || c == L'_')
+			{
+				part.push_back(towlower(c));
+			}
+			else if (!part.empty())
+			{
+				fileNames.push_back(part);
+				part.clear();
+			}
+		}
+	}
+
+	prioritizeSourceFiles(fileNames);
+}
+
 bool TaskFillIndexerCommandsQueue::fillCommandQueue()
 {
-	size_t refillAmount = m_maximumQueueSize - m_indexerCommandManager.indexerCommandCount();
+	// requeued commands of crashed indexers may exceed the maximum
+	const size_t queueSize = m_indexerCommandManager.indexerCommandCount();
+	const size_t refillAmount =
+		queueSize >= m_maximumQueueSize ? 0 : m_maximumQueueSize - queueSize;
 	if (!refillAmount)
 	{
 		return false;
@@ -105,15 +151,28 @@ bool TaskFillIndexerCommandsQueue::fillCommandQueue()
 
 	while (!m_indexerCommandProvider->empty() && commands.size() < refillAmount)
 	{
-		if (!m_filePathQueue.empty())
+		std::shared_ptr<IndexerCommand> command;
+		if (!m_priorityFilePathQueue.empty())
 		{
-			commands.push_back(
-				m_indexerCommandProvider->consumeCommandForSourceFilePath(m_filePathQueue.front()));
+			command = m_indexerCommandProvider->consumeCommandForSourceFilePath(
+				m_priorityFilePathQueue.front());
+			m_priorityFilePathQueue.pop();
+		}
+		else if (!m_filePathQueue.empty())
+		{
+			command = m_indexerCommandProvider->consumeCommandForSourceFilePath(
+				m_filePathQueue.front());
 			m_filePathQueue.pop();
 		}
 		else
 		{
-			commands.push_back(m_indexerCommandProvider->consumeCommand());
+			command = m_indexerCommandProvider->consumeCommand();
+		}
+
+		// prioritized commands were already consumed before
+		if (command)
+		{
+			commands.push_back(command);
 		}
 	}
 
@@ -125,3 +184,25 @@ bool TaskFillIndexerCommandsQueue::fillCommandQueue()
 
 	return false;
 }
+
+void TaskFillIndexerCommandsQueue::prioritizeSourceFiles(const std::vector<std::wstring>& fileNames)
+{
+	std::lock_guard<std::mutex> lock(m_commandsMutex);
+
+	size_t prioritizedCount = 0;
+	for (const std::wstring& fileName: fileNames)
+	{
+		auto range = m_sourceFilePathsByName.equal_range(fileName);
+		for (auto it = range.first; it != range.second; it++)
+		{
+			m_priorityFilePathQueue.push(it->second);
+			prioritizedCount++;
+		}
+		m_sourceFilePathsByName.erase(range.first, range.second);
+	}
+
+	if (prioritizedCount)
+	{
+		LOG_INFO("Prioritizing " + std::to_string(prioritizedCount) + " source files for indexing");
+	}
+}
@@ -1,10 +1,13 @@
 #ifndef TASK_FILL_INDEXER_COMMAND_QUEUE_H
 #define TASK_FILL_INDEXER_COMMAND_QUEUE_H
 
+#include <map>
 #include <queue>
 
+#include "MessageActivateFile.h"
 #include "MessageIndexingInterrupted.h"
 #include "MessageListener.h"
+#include "MessageSearch.h"
 #include "Task.h"
 
 #include "InterprocessIndexerCommandManager.h"
@@ -14,6 +17,8 @@ class IndexerCommandProvider;
 class TaskFillIndexerCommandsQueue
 	: public Task
 	, public MessageListener<MessageIndexingInterrupted>
+	, public MessageListener<MessageActivateFile>
+	, public MessageListener<MessageSearch>
 {
 public:
 	TaskFillIndexerCommandsQueue(
@@ -29,9 +34,14 @@ protected:
 	void terminate() override;
 
 	void handleMessage(MessageIndexingInterrupted* message) override;
+	void handleMessage(MessageActivateFile* message) override;
+	void handleMessage(MessageSearch* message) override;
 
 	bool fillCommandQueue();
 
+	// source files with the given name are indexed next, e.g. "foo" for "foo.h" or "Foo::bar"
+	void prioritizeSourceFiles(const std::vector<std::wstring>& fileNames);
+
 private:
 	std::unique_ptr<IndexerCommandProvider> m_indexerCommandProvider;
 	InterprocessIndexerCommandManager m_indexerCommandManager;
@@ -39,6 +49,8 @@ private:
 	const size_t m_maximumQueueSize;
 
 	std::queue<FilePath> m_filePathQueue;
+	std::queue<FilePath> m_priorityFilePathQueue;
+	std::multimap<std::wstring, FilePath> m_sourceFilePathsByName;
 	std::mutex m_commandsMutex;
 
 	bool m_interrupted = false;
@@ -1,11 +1,17 @@
 #include "InterprocessIndexer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 #include "FileRegister.h"
 #include "IndexerCommand.h"
 #include "IndexerComposite.h"
 #include "LanguagePackageManager.h"
 #include "ScopedFunctor.h"
 #include "logging.h"
+#include "tracing.h"
+#include "utilityApp.h"
 
 InterprocessIndexer::InterprocessIndexer(const std::string& uuid, Id processId)
 	: m_interprocessIndexerCommandManager(uuid, processId, false)
@@ -13,20 +19,37 @@ InterprocessIndexer::InterprocessIndexer(const std::string& uuid, Id processId)
 	, m_interprocessIntermediateStorageManager(uuid, processId, false)
 	, m_uuid(uuid)
 	, m_processId(processId)
+	, m_maximumMemoryGrowth(0)
+	, m_forwardTraceEvents(false)
 {
 }
 
+void InterprocessIndexer::setMaximumMemoryGrowth(size_t byteSize)
+{
+	m_maximumMemoryGrowth = byteSize;
+}
+
+void InterprocessIndexer::setForwardTraceEvents(bool forwardTraceEvents)
+{
+	m_forwardTraceEvents = forwardTraceEvents;
+}
+
 void InterprocessIndexer::work()
 {
-	bool updaterThreadRunning = true;
+	std::atomic<bool> updaterThreadRunning(true);
 	std::shared_ptr<std::thread> updaterThread;
 	std::shared_ptr<IndexerBase> indexer;
+	// set by the updater thread, read by the work loop without locking indexerMutex
+	std::atomic<bool> indexerInterrupted(false);
+	std::mutex indexerMutex;
 
 	try
 	{
 		LOG_INFO_STREAM(<< m_processId << " starting up indexer");
 		indexer = LanguagePackageManager::getInstance()->instantiateSupportedIndexers();
 
+		const size_t initialMemorySize = utility::getResidentMemorySize();
+
 		updaterThread = std::make_shared<std::thread>([&]() {
 			while (updaterThreadRunning)
 			{
@@ -34,11 +57,19 @@ void InterprocessIndexer::work()
 
 				if (m_interprocessIndexingStatusManager.getIndexingInterrupted())
 				{
-					LOG_INFO_STREAM(<< m_processId << " received indexer interrupt command.");
-					if (indexer)
+					std::lock_guard<std::mutex> lock(indexerMutex);
+					if (indexer && !indexerInterrupted)
 					{
+						LOG_INFO_STREAM(<< m_processId << " received indexer interrupt command.");
 						indexer->interrupt();
+						indexerInterrupted = true;
 					}
+				}
+
+				// a shutdown lets the current command finish, so its result is not lost
+				if (m_interprocessIndexingStatusManager.getIndexerShutdownRequested())
+				{
+					LOG_INFO_STREAM(<< m_processId << " received indexer shutdown command.");
 					updaterThreadRunning = false;
 				}
 			}
@@ -53,9 +84,62 @@ void InterprocessIndexer::work()
 			}
 		});
 
-		while (std::shared_ptr<IndexerCommand> indexerCommand =
-				   m_interprocessIndexerCommandManager.popIndexerCommand())
+		bool waitingForCommands = false;
+		while (updaterThreadRunning)
 		{
+			if (m_interprocessIndexingStatusManager.getIndexingInterrupted())
+			{
+				// keep idle until the next indexing run resets the interrupt flag
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				continue;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(indexerMutex);
+				if (indexerInterrupted)
+				{
+					LOG_INFO_STREAM(<< m_processId << " restarting interrupted indexer");
+					indexer = LanguagePackageManager::getInstance()->instantiateSupportedIndexers();
+					indexerInterrupted = false;
+				}
+			}
+
+			// mark busy before popping, so the main process never sees an empty queue and no busy
+			// indexers while a command is in flight
+			m_interprocessIndexingStatusManager.setIndexerBusy(true);
+
+			std::shared_ptr<IndexerCommand> indexerCommand =
+				m_interprocessIndexerCommandManager.popIndexerCommand();
+			if (!indexerCommand)
+			{
+				m_interprocessIndexingStatusManager.setIndexerBusy(false);
+
+				if (!waitingForCommands)
+				{
+					LOG_INFO_STREAM(<< m_processId << " waiting for indexer commands");
+					waitingForCommands = true;
+				}
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				continue;
+			}
+			waitingForCommands = false;
+
+			// popping made the command pending, so a crash requeues it and only the currently
+			// indexed file is lost
+			ScopedFunctor pendingResetter([&]() {
+				m_interprocessIndexerCommandManager.clearPendingIndexerCommands(m_processId);
+			});
+
+			ScopedFunctor busyResetter(
+				[&]() { m_interprocessIndexingStatusManager.setIndexerBusy(false); });
+
+			if (m_forwardTraceEvents)
+			{
+				Tracer::getInstance()->setEnabled(
+					m_interprocessIndexingStatusManager.getTracingEnabled());
+			}
+
 			LOG_INFO_STREAM(
 				<< m_processId << " fetched indexer command for \""
 				<< indexerCommand->getSourceFilePath().str() << "\"");
@@ -63,42 +147,132 @@ void InterprocessIndexer::work()
 				<< m_processId << " indexer commands left: "
 				<< m_interprocessIndexerCommandManager.indexerCommandCount());
 
-			while (updaterThreadRunning)
 			{
-				const size_t storageCount =
-					m_interprocessIntermediateStorageManager.getIntermediateStorageCount();
-				if (storageCount < 2)
+				ScopedTrace trace("indexer", "wait for storage budget");
+				while (!indexerInterrupted)
 				{
-					break;
-				}
+					const size_t storageCount =
+						m_interprocessIntermediateStorageManager.getIntermediateStorageCount();
+					if (storageCount == 0)
+					{
+						break;
+					}
 
-				LOG_INFO_STREAM(<< m_processId << " waits, too many intermediate storages: " << storageCount);
+					const size_t byteBudget =
+						m_interprocessIndexingStatusManager.getIntermediateStorageByteBudget();
+					if (!byteBudget && storageCount < 2)
+					{
+						break;
+					}
 
-				std::this_thread::sleep_for(std::chrono::milliseconds(200));
+					const size_t byteSize =
+						m_interprocessIntermediateStorageManager.getIntermediateStorageByteSize();
+					if (byteBudget && byteSize < byteBudget)
+					{
+						break;
+					}
+
+					LOG_INFO_STREAM(
+						<< m_processId << " waits, too many intermediate storages: " << storageCount
+						<< " with " << byteSize << " bytes");
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(200));
+				}
 			}
 
-			if (!updaterThreadRunning)
+			if (indexerInterrupted)
 			{
-				break;
+				continue;
 			}
 
-			LOG_INFO_STREAM(<< m_processId << " updating indexer status with currently indexed filepath");
-			m_interprocessIndexingStatusManager.startIndexingSourceFile(
-				indexerCommand->getSourceFilePath());
-
-			LOG_INFO_STREAM(<< m_processId << " starting to index current file");
-			std::shared_ptr<IntermediateStorage> result = indexer->index(indexerCommand);
+			// Commands that share setup with the fetched one are indexed together. Each busy indexer
+			// takes at most its share of the queue, so enough commands are left for the others.
+			std::vector<std::shared_ptr<IndexerCommand>> indexerCommands = {indexerCommand};
+			const size_t batchSize = std::min(
+				indexer->getMaximumBatchSize(*indexerCommand),
+				std::max<size_t>(
+					1,
+					(m_interprocessIndexerCommandManager.indexerCommandCount() + 1) /
+						std::max<size_t>(
+							1, m_interprocessIndexingStatusManager.getBusyIndexerCount())));
+			while (indexerCommands.size() < batchSize)
+			{
+				std::shared_ptr<IndexerCommand> nextCommand =
+					m_interprocessIndexerCommandManager.popIndexerCommandIf(
+						[&](const IndexerCommand& command) {
+							return indexer->canBatch(*indexerCommand, command);
+						});
+				if (!nextCommand)
+				{
+					break;
+				}
+				indexerCommands.push_back(nextCommand);
+			}
 
-			if (result)
+			if (indexerCommands.size() > 1)
 			{
-				LOG_INFO_STREAM(<< m_processId << " pushing index to shared memory");
-				m_interprocessIntermediateStorageManager.pushIntermediateStorage(result);
+				LOG_INFO_STREAM(
+					<< m_processId << " indexing " << indexerCommands.size()
+					<< " files in one batch");
 			}
 
-			LOG_INFO_STREAM(<< m_processId << " finalizing indexer status for current file");
-			m_interprocessIndexingStatusManager.finishIndexingSourceFile();
+			{
+				ScopedTrace trace(
+					"indexer", indexerCommands.size() > 1 ? "index files" : "index file");
+				if (trace.isRecording())
+				{
+					trace.setDetail(
+						indexerCommand->getSourceFilePath().str() +
+						(indexerCommands.size() > 1
+							 ? " and " + std::to_string(indexerCommands.size() - 1) + " more"
+							 : ""));
+				}
+
+				indexer->indexBatch(
+					indexerCommands,
+					[&](std::shared_ptr<IndexerCommand> command) {
+						LOG_INFO_STREAM(
+							<< m_processId
+							<< " updating indexer status with currently indexed filepath");
+						m_interprocessIndexingStatusManager.startIndexingSourceFile(
+							command->getSourceFilePath());
+						m_interprocessIndexerCommandManager.removePendingIndexerCommand(
+							command->getSourceFilePath());
+
+						LOG_INFO_STREAM(<< m_processId << " starting to index current file");
+					},
+					[&](std::shared_ptr<IndexerCommand> command,
+						std::shared_ptr<IntermediateStorage> result) {
+						if (result)
+						{
+							LOG_INFO_STREAM(<< m_processId << " pushing index to shared memory");
+							ScopedTrace trace("indexer", "push intermediate storage");
+							m_interprocessIntermediateStorageManager.pushIntermediateStorage(
+								result);
+						}
+
+						LOG_INFO_STREAM(
+							<< m_processId << " finalizing indexer status for current file");
+						m_interprocessIndexingStatusManager.finishIndexingSourceFile();
+					});
+			}
 
 			LOG_INFO_STREAM(<< m_processId << " all done");
+
+			if (m_forwardTraceEvents && Tracer::isEnabled())
+			{
+				m_interprocessIndexingStatusManager.pushTraceEvents(
+					Tracer::getInstance()->takeChromeTraceEvents(
+						static_cast<int>(m_processId), "indexer " + std::to_string(m_processId)));
+			}
+
+			if (exceedsMaximumMemoryGrowth(initialMemorySize))
+			{
+				LOG_INFO_STREAM(
+					<< m_processId << " exceeded maximum memory growth of " << m_maximumMemoryGrowth
+					<< " bytes, restart required");
+				break;
+			}
 		}
 	}
 	catch (boost::interprocess::interprocess_exception& e)
@@ -118,3 +292,14 @@ void InterprocessIndexer::work()
 
 	LOG_INFO_STREAM(<< m_processId << " shutting down indexer");
 }
+
+bool InterprocessIndexer::exceedsMaximumMemoryGrowth(size_t initialMemorySize) const
+{
+	if (!m_maximumMemoryGrowth)
+	{
+		return false;
+	}
+
+	const size_t memorySize = utility::getResidentMemorySize();
+	return memorySize > initialMemorySize && memorySize - initialMemorySize > m_maximumMemoryGrowth;
+}
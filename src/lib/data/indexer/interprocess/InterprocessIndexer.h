@@ -5,20 +5,34 @@
 #include "InterprocessIndexingStatusManager.h"
 #include "InterprocessIntermediateStorageManager.h"
 
+// Keeps indexing commands from the shared queue until a shutdown is requested. Gaps in the queue
+// and interrupted indexing runs are waited out, so the warm indexer state survives successive
+// refreshes. Set a memory growth limit to make the indexer return once it used up too much memory.
 class InterprocessIndexer
 {
 public:
 	InterprocessIndexer(const std::string& uuid, Id processId);
 
+	void setMaximumMemoryGrowth(size_t byteSize);
+
+	// Used when running in a separate process, which then records trace events while tracing is
+	// enabled in the main process and hands them over through shared memory.
+	void setForwardTraceEvents(bool forwardTraceEvents);
+
 	void work();
 
 private:
+	bool exceedsMaximumMemoryGrowth(size_t initialMemorySize) const;
+
 	InterprocessIndexerCommandManager m_interprocessIndexerCommandManager;
 	InterprocessIndexingStatusManager m_interprocessIndexingStatusManager;
 	InterprocessIntermediateStorageManager m_interprocessIntermediateStorageManager;
 
 	const std::string m_uuid;
 	const Id m_processId;
+
+	size_t m_maximumMemoryGrowth;
+	bool m_forwardTraceEvents;
 };
 
 #endif	  // INTERPROCESS_INDEXER_H
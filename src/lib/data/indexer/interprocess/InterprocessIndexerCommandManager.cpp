@@ -6,6 +6,8 @@
 const char* InterprocessIndexerCommandManager::s_sharedMemoryNamePrefix = "icmd_";
 
 const char* InterprocessIndexerCommandManager::s_indexerCommandsKeyName = "indexer_commands";
+const char* InterprocessIndexerCommandManager::s_pendingIndexerCommandsKeyName =
+	"pending_indexer_commands_";
 
 InterprocessIndexerCommandManager::InterprocessIndexerCommandManager(
 	const std::string& instanceUuid, Id processId, bool isOwner)
@@ -19,28 +21,8 @@ InterprocessIndexerCommandManager::~InterprocessIndexerCommandManager() {}
 void InterprocessIndexerCommandManager::pushIndexerCommands(
 	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands)
 {
-	size_t size = 0;
-	{
-		const size_t overestimationMultiplier = 2;
-		for (auto& command: indexerCommands)
-		{
-			size += command->getByteSize(sizeof(SharedMemory::String)) + sizeof(SharedIndexerCommand);
-		}
-		size *= overestimationMultiplier;
-	}
-
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
-	while (access.getFreeMemorySize() < size)
-	{
-		size_t currentSize = access.getMemorySize();
-		LOG_INFO_STREAM(
-			<< "grow memory - est: " << size << " size: " << currentSize
-			<< " free: " << access.getFreeMemorySize() << " alloc: " << (currentSize));
-
-		access.growMemory(currentSize);
-
-		LOG_INFO("growing memory succeeded");
-	}
+	growMemory(access, indexerCommands);
 
 	SharedMemory::Queue<SharedIndexerCommand>* queue =
 		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
@@ -61,6 +43,12 @@ void InterprocessIndexerCommandManager::pushIndexerCommands(
 }
 
 std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCommand()
+{
+	return popIndexerCommandIf([](const IndexerCommand&) { return true; });
+}
+
+std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCommandIf(
+	std::function<bool(const IndexerCommand&)> predicate)
 {
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
 
@@ -73,7 +61,36 @@ std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCom
 	}
 
 	std::shared_ptr<IndexerCommand> command = SharedIndexerCommand::fromShared(queue->front());
+	if (command && !predicate(*command))
+	{
+		return nullptr;
+	}
+
+	if (command)
+	{
+		// growing the memory invalidates the accessed values
+		growMemory(access, {command});
 
+		SharedMemory::Queue<SharedIndexerCommand>* pendingQueue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+				getPendingIndexerCommandsKeyName(getProcessId()));
+		if (!pendingQueue)
+		{
+			return nullptr;
+		}
+
+		pendingQueue->push_back(SharedIndexerCommand(access.getAllocator()));
+		pendingQueue->back().fromLocal(command.get());
+
+		queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+			s_indexerCommandsKeyName);
+		if (!queue || !queue->size())
+		{
+			return nullptr;
+		}
+	}
+
+	// commands that cannot be converted are dropped, like before
 	queue->pop_front();
 
 	return command;
@@ -108,3 +125,115 @@ size_t InterprocessIndexerCommandManager::indexerCommandCount()
 
 	return queue->size();
 }
+
+void InterprocessIndexerCommandManager::removePendingIndexerCommand(const FilePath& sourceFilePath)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Queue<SharedIndexerCommand>* pendingQueue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+			getPendingIndexerCommandsKeyName(getProcessId()));
+	if (!pendingQueue)
+	{
+		return;
+	}
+
+	for (auto it = pendingQueue->begin(); it != pendingQueue->end(); it++)
+	{
+		// FilePath comparison accesses the file system, which shouldn't happen while other
+		// processes wait for the shared memory
+		if (it->getSourceFilePath().wstr() == sourceFilePath.wstr())
+		{
+			pendingQueue->erase(it);
+			return;
+		}
+	}
+}
+
+void InterprocessIndexerCommandManager::clearPendingIndexerCommands(Id processId)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Queue<SharedIndexerCommand>* pendingQueue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+			getPendingIndexerCommandsKeyName(processId));
+	if (pendingQueue)
+	{
+		pendingQueue->clear();
+	}
+}
+
+size_t InterprocessIndexerCommandManager::requeuePendingIndexerCommands(Id processId)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Queue<SharedIndexerCommand>* pendingQueue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+			getPendingIndexerCommandsKeyName(processId));
+	if (!pendingQueue || !pendingQueue->size())
+	{
+		return 0;
+	}
+
+	std::vector<std::shared_ptr<IndexerCommand>> indexerCommands;
+	for (const SharedIndexerCommand& sharedCommand: *pendingQueue)
+	{
+		std::shared_ptr<IndexerCommand> command = SharedIndexerCommand::fromShared(sharedCommand);
+		if (command)
+		{
+			indexerCommands.push_back(command);
+		}
+	}
+	pendingQueue->clear();
+
+	growMemory(access, indexerCommands);
+
+	SharedMemory::Queue<SharedIndexerCommand>* queue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+			s_indexerCommandsKeyName);
+	if (!queue)
+	{
+		return 0;
+	}
+
+	// in reverse, so the commands keep their order at the front of the queue
+	for (auto it = indexerCommands.rbegin(); it != indexerCommands.rend(); it++)
+	{
+		queue->push_front(SharedIndexerCommand(access.getAllocator()));
+		queue->front().fromLocal(it->get());
+	}
+
+	return indexerCommands.size();
+}
+
+std::string InterprocessIndexerCommandManager::getPendingIndexerCommandsKeyName(Id processId)
+{
+	return s_pendingIndexerCommandsKeyName + std::to_string(processId);
+}
+
+void InterprocessIndexerCommandManager::growMemory(
+	SharedMemory::ScopedAccess& access,
+	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands)
+{
+	size_t size = 0;
+	{
+		const size_t overestimationMultiplier = 2;
+		for (auto& command: indexerCommands)
+		{
+			size += command->getByteSize(sizeof(SharedMemory::String)) + sizeof(SharedIndexerCommand);
+		}
+		size *= overestimationMultiplier;
+	}
+
+	while (access.getFreeMemorySize() < size)
+	{
+		size_t currentSize = access.getMemorySize();
+		LOG_INFO_STREAM(
+			<< "grow memory - est: " << size << " size: " << currentSize
+			<< " free: " << access.getFreeMemorySize() << " alloc: " << (currentSize));
+
+		access.growMemory(currentSize);
+
+		LOG_INFO("growing memory succeeded");
+	}
+}
@@ -1,6 +1,8 @@
 #ifndef INTERPROCESS_INDEXER_COMMAND_MANAGER_H
 #define INTERPROCESS_INDEXER_COMMAND_MANAGER_H
 
+#include <functional>
+
 #include "BaseInterprocessDataManager.h"
 #include "SharedIndexerCommand.h"
 
@@ -13,14 +15,34 @@ public:
 	virtual ~InterprocessIndexerCommandManager();
 
 	void pushIndexerCommands(const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands);
+
+	// Commands taken from the queue by this process are moved to its pending commands within the
+	// same shared memory access. They stay pending until their indexing starts, so the ones not
+	// started yet can be requeued if the process crashes at any point.
 	std::shared_ptr<IndexerCommand> popIndexerCommand();
 
+	// pops the next command only if it satisfies the predicate, otherwise it stays in the queue
+	std::shared_ptr<IndexerCommand> popIndexerCommandIf(
+		std::function<bool(const IndexerCommand&)> predicate);
+
 	void clearIndexerCommands();
 	size_t indexerCommandCount();
 
+	void removePendingIndexerCommand(const FilePath& sourceFilePath);
+	void clearPendingIndexerCommands(Id processId);
+
+	// moves the pending commands of the process to the front of the queue, returns their count
+	size_t requeuePendingIndexerCommands(Id processId);
+
 private:
 	static const char* s_sharedMemoryNamePrefix;
 	static const char* s_indexerCommandsKeyName;
+	static const char* s_pendingIndexerCommandsKeyName;
+
+	static std::string getPendingIndexerCommandsKeyName(Id processId);
+	static void growMemory(
+		SharedMemory::ScopedAccess& access,
+		const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands);
 };
 
 #endif	  // INTERPROCESS_INDEXER_COMMAND_MANAGER_H
@@ -11,6 +11,11 @@ const char* InterprocessIndexingStatusManager::s_crashedFilesKeyName = "crashed_
 const char* InterprocessIndexingStatusManager::s_finishedProcessIdsKeyName = "finished_process_ids";
 const char* InterprocessIndexingStatusManager::s_indexingInterruptedKeyName =
 	"indexing_interrupted_flag";
+const char* InterprocessIndexingStatusManager::s_indexerShutdownKeyName = "indexer_shutdown_flag";
+const char* InterprocessIndexingStatusManager::s_busyProcessIdsKeyName = "busy_process_ids";
+const char* InterprocessIndexingStatusManager::s_storageByteBudgetKeyName = "storage_byte_budget";
+const char* InterprocessIndexingStatusManager::s_tracingEnabledKeyName = "tracing_enabled_flag";
+const char* InterprocessIndexingStatusManager::s_traceEventsKeyName = "trace_events";
 
 InterprocessIndexingStatusManager::InterprocessIndexingStatusManager(
 	const std::string& instanceUuid, Id processId, bool isOwner)
@@ -131,6 +136,215 @@ bool InterprocessIndexingStatusManager::getIndexingInterrupted()
 	return false;
 }
 
+void InterprocessIndexingStatusManager::setIndexerShutdownRequested(bool shutdownRequested)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	bool* indexerShutdownPtr = access.accessValue<bool>(s_indexerShutdownKeyName);
+	if (indexerShutdownPtr)
+	{
+		*indexerShutdownPtr = shutdownRequested;
+	}
+}
+
+bool InterprocessIndexingStatusManager::getIndexerShutdownRequested()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	bool* indexerShutdownPtr = access.accessValue<bool>(s_indexerShutdownKeyName);
+	if (indexerShutdownPtr)
+	{
+		return *indexerShutdownPtr;
+	}
+
+	return false;
+}
+
+void InterprocessIndexingStatusManager::setIntermediateStorageByteBudget(size_t byteBudget)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* byteBudgetPtr = access.accessValue<size_t>(s_storageByteBudgetKeyName);
+	if (byteBudgetPtr)
+	{
+		*byteBudgetPtr = byteBudget;
+	}
+}
+
+size_t InterprocessIndexingStatusManager::getIntermediateStorageByteBudget()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t* byteBudgetPtr = access.accessValue<size_t>(s_storageByteBudgetKeyName);
+	if (byteBudgetPtr)
+	{
+		return *byteBudgetPtr;
+	}
+
+	return 0;
+}
+
+void InterprocessIndexingStatusManager::setTracingEnabled(bool enabled)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	bool* tracingEnabledPtr = access.accessValue<bool>(s_tracingEnabledKeyName);
+	if (tracingEnabledPtr)
+	{
+		*tracingEnabledPtr = enabled;
+	}
+}
+
+bool InterprocessIndexingStatusManager::getTracingEnabled()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	bool* tracingEnabledPtr = access.accessValue<bool>(s_tracingEnabledKeyName);
+	if (tracingEnabledPtr)
+	{
+		return *tracingEnabledPtr;
+	}
+
+	return false;
+}
+
+void InterprocessIndexingStatusManager::pushTraceEvents(const std::vector<std::string>& events)
+{
+	if (events.empty())
+	{
+		return;
+	}
+
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	size_t estimatedSize = 262144;
+	for (const std::string& event: events)
+	{
+		estimatedSize += sizeof(SharedMemory::String) + event.size();
+	}
+	estimatedSize *= 2;
+
+	while (access.getFreeMemorySize() < estimatedSize)
+	{
+		access.growMemory(access.getMemorySize());
+	}
+
+	SharedMemory::Queue<SharedMemory::String>* traceEventsPtr =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(
+			s_traceEventsKeyName);
+	if (traceEventsPtr)
+	{
+		for (const std::string& event: events)
+		{
+			SharedMemory::String eventStr(access.getAllocator());
+			eventStr = event.c_str();
+			traceEventsPtr->push_back(eventStr);
+		}
+	}
+}
+
+std::vector<std::string> InterprocessIndexingStatusManager::popTraceEvents()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	std::vector<std::string> events;
+
+	SharedMemory::Queue<SharedMemory::String>* traceEventsPtr =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(
+			s_traceEventsKeyName);
+	if (traceEventsPtr)
+	{
+		while (traceEventsPtr->size())
+		{
+			events.push_back(traceEventsPtr->front().c_str());
+			traceEventsPtr->pop_front();
+		}
+	}
+
+	return events;
+}
+
+void InterprocessIndexingStatusManager::setIndexerBusy(bool busy)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Set<Id>* busyProcessIdsPtr = access.accessValueWithAllocator<SharedMemory::Set<Id>>(
+		s_busyProcessIdsKeyName);
+	if (busyProcessIdsPtr)
+	{
+		if (busy)
+		{
+			busyProcessIdsPtr->insert(m_processId);
+		}
+		else
+		{
+			busyProcessIdsPtr->erase(m_processId);
+		}
+	}
+}
+
+void InterprocessIndexingStatusManager::clearIndexerBusy(Id processId)
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Set<Id>* busyProcessIdsPtr = access.accessValueWithAllocator<SharedMemory::Set<Id>>(
+		s_busyProcessIdsKeyName);
+	if (busyProcessIdsPtr)
+	{
+		busyProcessIdsPtr->erase(processId);
+	}
+}
+
+size_t InterprocessIndexingStatusManager::getBusyIndexerCount()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Set<Id>* busyProcessIdsPtr = access.accessValueWithAllocator<SharedMemory::Set<Id>>(
+		s_busyProcessIdsKeyName);
+	if (busyProcessIdsPtr)
+	{
+		return busyProcessIdsPtr->size();
+	}
+
+	return 0;
+}
+
+void InterprocessIndexingStatusManager::clearIndexingStatus()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Queue<SharedMemory::String>* indexingFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(
+			s_indexingFilesKeyName);
+	if (indexingFilesPtr)
+	{
+		indexingFilesPtr->clear();
+	}
+
+	SharedMemory::Map<Id, SharedMemory::String>* currentFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Map<Id, SharedMemory::String>>(
+			s_currentFilesKeyName);
+	if (currentFilesPtr)
+	{
+		currentFilesPtr->clear();
+	}
+
+	SharedMemory::Vector<SharedMemory::String>* crashedFilesPtr =
+		access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(
+			s_crashedFilesKeyName);
+	if (crashedFilesPtr)
+	{
+		crashedFilesPtr->clear();
+	}
+
+	SharedMemory::Queue<Id>* finishedProcessIdsPtr =
+		access.accessValueWithAllocator<SharedMemory::Queue<Id>>(s_finishedProcessIdsKeyName);
+	if (finishedProcessIdsPtr)
+	{
+		finishedProcessIdsPtr->clear();
+	}
+}
+
 Id InterprocessIndexingStatusManager::getNextFinishedProcessId()
 {
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
@@ -18,6 +18,26 @@ public:
 	void setIndexingInterrupted(bool interrupted);
 	bool getIndexingInterrupted();
 
+	void setIndexerShutdownRequested(bool shutdownRequested);
+	bool getIndexerShutdownRequested();
+
+	// 0 means no budget, indexers then only keep a single intermediate storage queued
+	void setIntermediateStorageByteBudget(size_t byteBudget);
+	size_t getIntermediateStorageByteBudget();
+
+	void setTracingEnabled(bool enabled);
+	bool getTracingEnabled();
+
+	// trace events serialized by the indexer processes, in the Chrome trace event format
+	void pushTraceEvents(const std::vector<std::string>& events);
+	std::vector<std::string> popTraceEvents();
+
+	void setIndexerBusy(bool busy);
+	void clearIndexerBusy(Id processId);
+	size_t getBusyIndexerCount();
+
+	void clearIndexingStatus();
+
 	Id getNextFinishedProcessId();
 
 	std::vector<FilePath> getCurrentlyIndexedSourceFilePaths();
@@ -31,6 +51,11 @@ private:
 	static const char* s_crashedFilesKeyName;
 	static const char* s_finishedProcessIdsKeyName;
 	static const char* s_indexingInterruptedKeyName;
+	static const char* s_indexerShutdownKeyName;
+	static const char* s_busyProcessIdsKeyName;
+	static const char* s_storageByteBudgetKeyName;
+	static const char* s_tracingEnabledKeyName;
+	static const char* s_traceEventsKeyName;
 };
 
 #endif	  // INTERPROCESS_INDEXING_STATUS_MANAGER_H
@@ -74,6 +74,7 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 	storage.setStorageOccurrences(intermediateStorage->getStorageOccurrences());
 	storage.setStorageComponentAccesses(intermediateStorage->getComponentAccesses());
 	storage.setStorageErrors(intermediateStorage->getErrors());
+	storage.setCompletedTranslationUnits(intermediateStorage->getCompletedTranslationUnits());
 
 	storage.setNextId(intermediateStorage->getNextId());
 
@@ -116,6 +117,7 @@ std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::pop
 	storage->setStorageOccurrences(sharedIntermediateStorage.getStorageOccurrences());
 	storage->setComponentAccesses(sharedIntermediateStorage.getStorageComponentAccesses());
 	storage->setErrors(sharedIntermediateStorage.getStorageErrors());
+	storage->setCompletedTranslationUnits(sharedIntermediateStorage.getCompletedTranslationUnits());
 
 	storage->setNextId(sharedIntermediateStorage.getNextId());
 
@@ -139,3 +141,24 @@ size_t InterprocessIntermediateStorageManager::getIntermediateStorageCount()
 
 	return queue->size();
 }
+
+size_t InterprocessIntermediateStorageManager::getIntermediateStorageByteSize()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+	return access.getUsedMemorySize();
+}
+
+void InterprocessIntermediateStorageManager::clearIntermediateStorages()
+{
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	SharedMemory::Queue<SharedIntermediateStorage>* queue =
+		access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
+			s_intermediatStoragesKeyName);
+	if (!queue)
+	{
+		return;
+	}
+
+	queue->clear();
+}
@@ -15,6 +15,8 @@ public:
 	std::shared_ptr<IntermediateStorage> popIntermediateStorage();
 
 	size_t getIntermediateStorageCount();
+	size_t getIntermediateStorageByteSize();
+	void clearIntermediateStorages();
 
 private:
 	static const char* s_sharedMemoryNamePrefix;
@@ -10,6 +10,7 @@ SharedIntermediateStorage::SharedIntermediateStorage(SharedMemory::Allocator* al
 	, m_storageLocalSymbols(allocator)
 	, m_storageSourceLocations(allocator)
 	, m_storageErrors(allocator)
+	, m_completedTranslationUnits(allocator)
 	, m_allocator(allocator)
 	, m_nextId(1)
 {
@@ -223,6 +224,30 @@ void SharedIntermediateStorage::setStorageErrors(const std::vector<StorageError>
 	}
 }
 
+std::set<std::wstring> SharedIntermediateStorage::getCompletedTranslationUnits() const
+{
+	std::set<std::wstring> result;
+
+	for (unsigned int i = 0; i < m_completedTranslationUnits.size(); i++)
+	{
+		result.insert(utility::decodeFromUtf8(m_completedTranslationUnits[i].c_str()));
+	}
+
+	return result;
+}
+
+void SharedIntermediateStorage::setCompletedTranslationUnits(const std::set<std::wstring>& filePaths)
+{
+	m_completedTranslationUnits.clear();
+
+	for (const std::wstring& filePath: filePaths)
+	{
+		SharedMemory::String path(m_completedTranslationUnits.get_allocator());
+		path = utility::encodeToUtf8(filePath).c_str();
+		m_completedTranslationUnits.push_back(path);
+	}
+}
+
 Id SharedIntermediateStorage::getNextId() const
 {
 	return m_nextId;
@@ -40,6 +40,9 @@ public:
 	std::vector<StorageError> getStorageErrors() const;
 	void setStorageErrors(const std::vector<StorageError>& errors);
 
+	std::set<std::wstring> getCompletedTranslationUnits() const;
+	void setCompletedTranslationUnits(const std::set<std::wstring>& filePaths);
+
 	Id getNextId() const;
 	void setNextId(const Id nextId);
 
@@ -53,6 +56,7 @@ private:
 	SharedMemory::Vector<SharedStorageLocalSymbol> m_storageLocalSymbols;
 	SharedMemory::Vector<SharedStorageSourceLocation> m_storageSourceLocations;
 	SharedMemory::Vector<SharedStorageError> m_storageErrors;
+	SharedMemory::Vector<SharedMemory::String> m_completedTranslationUnits;
 
 	SharedMemory::Allocator* m_allocator;
 
@@ -54,13 +54,12 @@ struct SharedStorageNode
 
 inline SharedStorageNode toShared(const StorageNode& node, SharedMemory::Allocator* allocator)
 {
-	return SharedStorageNode(
-		node.id, node.type, utility::encodeToUtf8(node.serializedName), allocator);
+	return SharedStorageNode(node.id, node.type, node.serializedName, allocator);
 }
 
 inline StorageNode fromShared(const SharedStorageNode& node)
 {
-	return StorageNode(node.id, node.type, utility::decodeFromUtf8(node.serializedName.c_str()));
+	return StorageNode(node.id, node.type, node.serializedName.c_str());
 }
 
 
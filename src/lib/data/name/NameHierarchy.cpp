@@ -7,87 +7,89 @@
 
 namespace
 {
-const std::wstring META_DELIMITER = L"\tm";
-const std::wstring NAME_DELIMITER = L"\tn";
-const std::wstring PART_DELIMITER = L"\ts";
-const std::wstring SIGNATURE_DELIMITER = L"\tp";
+const std::string META_DELIMITER = "\tm";
+const std::string NAME_DELIMITER = "\tn";
+const std::string PART_DELIMITER = "\ts";
+const std::string SIGNATURE_DELIMITER = "\tp";
 }	 // namespace
 
-std::wstring NameHierarchy::serialize(const NameHierarchy& nameHierarchy)
+std::string NameHierarchy::serialize(const NameHierarchy& nameHierarchy)
 {
 	return serializeRange(nameHierarchy, 0, nameHierarchy.size());
 }
 
-std::wstring NameHierarchy::serializeRange(const NameHierarchy& nameHierarchy, size_t first, size_t last)
+std::string NameHierarchy::serializeRange(const NameHierarchy& nameHierarchy, size_t first, size_t last)
 {
-	std::wstringstream ss;
-	ss << nameHierarchy.getDelimiter();
-	ss << META_DELIMITER;
+	std::string serializedName = utility::encodeToUtf8(nameHierarchy.getDelimiter());
+	serializedName += META_DELIMITER;
 	for (size_t i = first; i < last && i < nameHierarchy.size(); i++)
 	{
 		if (i > 0)
 		{
-			ss << NAME_DELIMITER;
+			serializedName += NAME_DELIMITER;
 		}
 
-		ss << nameHierarchy[i].getName() << PART_DELIMITER;
-		ss << nameHierarchy[i].getSignature().getPrefix();
-		ss << SIGNATURE_DELIMITER;
-		ss << nameHierarchy[i].getSignature().getPostfix();
+		serializedName += utility::encodeToUtf8(nameHierarchy[i].getName());
+		serializedName += PART_DELIMITER;
+		serializedName += utility::encodeToUtf8(nameHierarchy[i].getSignature().getPrefix());
+		serializedName += SIGNATURE_DELIMITER;
+		serializedName += utility::encodeToUtf8(nameHierarchy[i].getSignature().getPostfix());
 	}
-	return ss.str();
+	return serializedName;
 }
 
-NameHierarchy NameHierarchy::deserialize(const std::wstring& serializedName)
+NameHierarchy NameHierarchy::deserialize(const std::string& serializedName)
 {
+	// all delimiters are ascii, so the utf-8 text can be split bytewise and only the parts are
+	// decoded
 	size_t mpos = serializedName.find(META_DELIMITER);
-	if (mpos == std::wstring::npos)
+	if (mpos == std::string::npos)
 	{
-		LOG_ERROR(L"unable to deserialize name hierarchy: " + serializedName);	  // todo: obfuscate
-																				  // serializedName!
+		LOG_ERROR("unable to deserialize name hierarchy: " + serializedName);	 // todo: obfuscate
+																				 // serializedName!
 		return NameHierarchy(NAME_DELIMITER_UNKNOWN);
 	}
 
-	NameHierarchy nameHierarchy(serializedName.substr(0, mpos));
+	NameHierarchy nameHierarchy(utility::decodeFromUtf8(serializedName.substr(0, mpos)));
 
 	size_t npos = mpos + META_DELIMITER.size();
-	while (npos != std::wstring::npos && npos < serializedName.size())
+	while (npos != std::string::npos && npos < serializedName.size())
 	{
 		// name
 		size_t spos = serializedName.find(PART_DELIMITER, npos);
-		if (spos == std::wstring::npos)
+		if (spos == std::string::npos)
 		{
 			LOG_ERROR(
-				L"unable to deserialize name hierarchy: " +
+				"unable to deserialize name hierarchy: " +
 				serializedName);	// todo: obfuscate serializedName!
 			return NameHierarchy(NAME_DELIMITER_UNKNOWN);
 		}
 
-		std::wstring name = serializedName.substr(npos, spos - npos);
+		std::wstring name = utility::decodeFromUtf8(serializedName.substr(npos, spos - npos));
 		spos += PART_DELIMITER.size();
 
 		// signature
 		size_t ppos = serializedName.find(SIGNATURE_DELIMITER, spos);
-		if (ppos == std::wstring::npos)
+		if (ppos == std::string::npos)
 		{
 			LOG_ERROR(
-				L"unable to deserialize name hierarchy: " +
+				"unable to deserialize name hierarchy: " +
 				serializedName);	// todo: obfuscate serializedName!
 			return NameHierarchy(NAME_DELIMITER_UNKNOWN);
 		}
 
-		std::wstring prefix = serializedName.substr(spos, ppos - spos);
+		std::wstring prefix = utility::decodeFromUtf8(serializedName.substr(spos, ppos - spos));
 		ppos += SIGNATURE_DELIMITER.size();
 
 		std::wstring postfix;
 		npos = serializedName.find(NAME_DELIMITER, ppos);
-		if (npos == std::wstring::npos)
+		if (npos == std::string::npos)
 		{
-			postfix = serializedName.substr(ppos, std::wstring::npos);
+			postfix = utility::decodeFromUtf8(serializedName.substr(ppos, std::string::npos));
 		}
 		else
 		{
-			postfix = serializedName.substr(ppos, npos - ppos);
+			postfix = utility::decodeFromUtf8(serializedName.substr(ppos, npos - ppos));
 			npos += NAME_DELIMITER.size();
 		}
 
@@ -0,0 +1,298 @@
+#include "ExternalStorageMerger.h"
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <queue>
+
+#include "FileSystem.h"
+#include "IntermediateStorage.h"
+#include "IntermediateStorageFile.h"
+#include "Storage.h"
+#include "logging.h"
+#include "tracing.h"
+
+const size_t ExternalStorageMerger::s_nodeBatchSize = 10000;
+const size_t ExternalStorageMerger::s_maximumPendingIdMappingCount = 1048576;
+
+namespace
+{
+struct RunNode
+{
+	StorageNode node;
+	size_t runIndex;
+
+	bool operator>(const RunNode& other) const
+	{
+		if (node.serializedName != other.node.serializedName)
+		{
+			return node.serializedName > other.node.serializedName;
+		}
+		return runIndex > other.runIndex;
+	}
+};
+}	 // namespace
+
+ExternalStorageMerger::ExternalStorageMerger(
+	const FilePath& runDirectoryPath, size_t maximumRunByteSize)
+	: m_runDirectoryPath(runDirectoryPath)
+	, m_maximumRunByteSize(maximumRunByteSize)
+	, m_currentRunByteSize(0)
+	, m_nextRunIndex(0)
+{
+}
+
+ExternalStorageMerger::~ExternalStorageMerger()
+{
+	clear();
+}
+
+void ExternalStorageMerger::addStorage(std::shared_ptr<IntermediateStorage> storage)
+{
+	// estimated from the added storages, overlapping nodes and edges are counted more than once
+	m_currentRunByteSize += storage->getByteSize(sizeof(std::wstring));
+
+	if (!m_currentRun)
+	{
+		m_currentRun = storage;
+	}
+	else
+	{
+		m_currentRun->inject(storage.get());
+	}
+
+	if (m_currentRunByteSize >= m_maximumRunByteSize)
+	{
+		writeRun();
+	}
+}
+
+bool ExternalStorageMerger::flush()
+{
+	if (!m_currentRun)
+	{
+		return true;
+	}
+	return writeRun();
+}
+
+size_t ExternalStorageMerger::getRunCount() const
+{
+	return m_runFilePaths.size();
+}
+
+bool ExternalStorageMerger::mergeInto(Storage* target)
+{
+	TRACE();
+
+	flush();
+
+	const size_t runCount = m_runFilePaths.size();
+	LOG_INFO("Merging " + std::to_string(runCount) + " storage runs");
+
+	std::vector<std::unique_ptr<IntermediateStorageFile::RunReader>> readers;
+	std::priority_queue<RunNode, std::vector<RunNode>, std::greater<RunNode>> nextNodes;
+	bool success = true;
+
+	for (size_t i = 0; i < runCount; i++)
+	{
+		readers.push_back(std::make_unique<IntermediateStorageFile::RunReader>(m_runFilePaths[i]));
+		FileSystem::remove(getIdMapFilePath(i));	// left over from an aborted merge
+
+		RunNode runNode;
+		runNode.runIndex = i;
+		if (readers.back()->readNextNode(runNode.node))
+		{
+			nextNodes.push(runNode);
+		}
+	}
+
+	// the mapping of run ids to own ids grows with the project, so it is appended to one file per
+	// run and only read back for the run that gets injected
+	std::vector<std::vector<std::pair<Id, Id>>> pendingIdMappings(runCount);
+	size_t pendingIdMappingCount = 0;
+
+	auto writePendingIdMappings = [&]() {
+		for (size_t i = 0; i < runCount; i++)
+		{
+			std::vector<std::pair<Id, Id>>& idMappings = pendingIdMappings[i];
+			if (idMappings.empty())
+			{
+				continue;
+			}
+
+			std::ofstream idMapFile(
+				getIdMapFilePath(i).str(), std::ios::binary | std::ios::out | std::ios::app);
+			idMapFile.write(
+				reinterpret_cast<const char*>(idMappings.data()),
+				static_cast<std::streamsize>(idMappings.size() * sizeof(std::pair<Id, Id>)));
+			if (!idMapFile)
+			{
+				LOG_ERROR(L"Writing id map failed: " + getIdMapFilePath(i).wstr());
+				success = false;
+			}
+
+			idMappings.clear();
+			idMappings.shrink_to_fit();
+		}
+		pendingIdMappingCount = 0;
+	};
+
+	// nodes of all runs are merged by name, so every node is added to the target only once
+	std::vector<StorageNode> nodeBatch;
+	std::vector<std::vector<std::pair<size_t, Id>>> nodeBatchRunIds;
+
+	auto injectNodeBatch = [&]() {
+		const std::vector<Id> ownIds = target->injectNodes(nodeBatch);
+		for (size_t i = 0; i < nodeBatch.size() && i < ownIds.size(); i++)
+		{
+			if (!ownIds[i])
+			{
+				continue;
+			}
+
+			for (const std::pair<size_t, Id>& runId: nodeBatchRunIds[i])
+			{
+				pendingIdMappings[runId.first].emplace_back(runId.second, ownIds[i]);
+				pendingIdMappingCount++;
+			}
+		}
+		nodeBatch.clear();
+		nodeBatchRunIds.clear();
+
+		if (pendingIdMappingCount >= s_maximumPendingIdMappingCount)
+		{
+			writePendingIdMappings();
+		}
+	};
+
+	while (!nextNodes.empty())
+	{
+		RunNode runNode = nextNodes.top();
+		nextNodes.pop();
+
+		if (nodeBatch.empty() || nodeBatch.back().serializedName != runNode.node.serializedName)
+		{
+			if (nodeBatch.size() >= s_nodeBatchSize)
+			{
+				injectNodeBatch();
+			}
+
+			nodeBatch.emplace_back(0, runNode.node.type, runNode.node.serializedName);
+			nodeBatchRunIds.emplace_back();
+		}
+		else if (nodeBatch.back().type < runNode.node.type)
+		{
+			nodeBatch.back().type = runNode.node.type;
+		}
+
+		nodeBatchRunIds.back().emplace_back(runNode.runIndex, runNode.node.id);
+
+		if (readers[runNode.runIndex]->readNextNode(runNode.node))
+		{
+			nextNodes.push(runNode);
+		}
+	}
+
+	if (!nodeBatch.empty())
+	{
+		injectNodeBatch();
+	}
+	writePendingIdMappings();
+
+	// all other data only references nodes of its own run and is injected run by run
+	for (size_t i = 0; i < runCount; i++)
+	{
+		std::shared_ptr<IntermediateStorage> storage = readers[i]->readRemainingData();
+		readers[i].reset();
+
+		if (storage)
+		{
+			target->inject(storage.get(), readIdMap(i));
+		}
+		else
+		{
+			LOG_ERROR(L"Merging storage run failed: " + m_runFilePaths[i].wstr());
+			success = false;
+		}
+
+		FileSystem::remove(m_runFilePaths[i]);
+		FileSystem::remove(getIdMapFilePath(i));
+	}
+
+	m_runFilePaths.clear();
+
+	// only kept in memory if writing it failed
+	if (m_currentRun)
+	{
+		target->inject(m_currentRun.get());
+		m_currentRun.reset();
+		m_currentRunByteSize = 0;
+	}
+
+	return success;
+}
+
+void ExternalStorageMerger::clear()
+{
+	for (const FilePath& runFilePath: m_runFilePaths)
+	{
+		FileSystem::remove(runFilePath);
+	}
+	m_runFilePaths.clear();
+
+	m_currentRun.reset();
+	m_currentRunByteSize = 0;
+
+	if (m_runDirectoryPath.recheckExists())
+	{
+		FileSystem::remove(m_runDirectoryPath);	   // only succeeds if empty
+	}
+}
+
+FilePath ExternalStorageMerger::getIdMapFilePath(size_t runIndex) const
+{
+	return m_runDirectoryPath.getConcatenated(L"ids_" + std::to_wstring(runIndex));
+}
+
+std::map<Id, Id> ExternalStorageMerger::readIdMap(size_t runIndex) const
+{
+	std::map<Id, Id> idMap;
+
+	std::ifstream idMapFile(getIdMapFilePath(runIndex).str(), std::ios::binary | std::ios::in);
+	std::pair<Id, Id> idMapping;
+	while (idMapFile.read(reinterpret_cast<char*>(&idMapping), sizeof(idMapping)))
+	{
+		idMap.emplace(idMapping);
+	}
+
+	return idMap;
+}
+
+bool ExternalStorageMerger::writeRun()
+{
+	if (!m_runDirectoryPath.exists())
+	{
+		FileSystem::createDirectory(m_runDirectoryPath);
+	}
+
+	const FilePath runFilePath = m_runDirectoryPath.getConcatenated(
+		L"run_" + std::to_wstring(m_nextRunIndex));
+
+	if (!IntermediateStorageFile::write(*m_currentRun, runFilePath, true))
+	{
+		LOG_ERROR(L"Writing storage run failed, keeping it in memory: " + runFilePath.wstr());
+		return false;
+	}
+
+	LOG_INFO_STREAM(
+		<< "wrote storage run " << m_nextRunIndex << " with " << m_currentRunByteSize
+		<< " estimated bytes");
+
+	m_runFilePaths.push_back(runFilePath);
+	m_nextRunIndex++;
+
+	m_currentRun.reset();
+	m_currentRunByteSize = 0;
+	return true;
+}
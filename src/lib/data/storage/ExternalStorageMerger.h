@@ -0,0 +1,55 @@
+#ifndef EXTERNAL_STORAGE_MERGER_H
+#define EXTERNAL_STORAGE_MERGER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "FilePath.h"
+#include "types.h"
+
+class IntermediateStorage;
+class Storage;
+
+// Collects intermediate storages into runs of bounded size that are written to disk as sorted
+// storage files. All runs are finally merged into the target storage by a k-way merge over the
+// sorted nodes of all runs, so only one run is held in memory at any time. The ids the nodes of
+// each run get in the target are written to a file per run and read back when that run is
+// injected.
+class ExternalStorageMerger
+{
+public:
+	ExternalStorageMerger(const FilePath& runDirectoryPath, size_t maximumRunByteSize);
+	~ExternalStorageMerger();
+
+	void addStorage(std::shared_ptr<IntermediateStorage> storage);
+
+	// writes the storages added since the last run was written
+	bool flush();
+
+	size_t getRunCount() const;
+
+	// merges all written runs into the target and removes them afterwards
+	bool mergeInto(Storage* target);
+
+	void clear();
+
+private:
+	bool writeRun();
+
+	FilePath getIdMapFilePath(size_t runIndex) const;
+	std::map<Id, Id> readIdMap(size_t runIndex) const;
+
+	static const size_t s_nodeBatchSize;
+	static const size_t s_maximumPendingIdMappingCount;
+
+	const FilePath m_runDirectoryPath;
+	const size_t m_maximumRunByteSize;
+
+	std::shared_ptr<IntermediateStorage> m_currentRun;
+	size_t m_currentRunByteSize;
+	std::vector<FilePath> m_runFilePaths;
+	size_t m_nextRunIndex;
+};
+
+#endif	  // EXTERNAL_STORAGE_MERGER_H
@@ -28,6 +28,8 @@ void IntermediateStorage::clear()
 	m_errorsIndex.clear();
 	m_errors.clear();
 
+	m_completedTranslationUnits.clear();
+
 	m_nextId = 1;
 }
 
@@ -61,6 +63,11 @@ size_t IntermediateStorage::getByteSize(size_t stringSize) const
 		byteSize += stringSize + storageLocalSymbol.name.size();
 	}
 
+	for (const std::wstring& translationUnit: getCompletedTranslationUnits())
+	{
+		byteSize += stringSize + translationUnit.size();
+	}
+
 	byteSize += sizeof(StorageEdge) * getStorageEdges().size();
 	byteSize += sizeof(StorageComponentAccess) * getComponentAccesses().size();
 	byteSize += sizeof(StorageOccurrence) * getStorageOccurrences().size();
@@ -322,6 +329,11 @@ Id IntermediateStorage::addError(const StorageErrorData& errorData)
 	return errorId;
 }
 
+void IntermediateStorage::addCompletedTranslationUnits(const std::set<std::wstring>& filePaths)
+{
+	m_completedTranslationUnits.insert(filePaths.begin(), filePaths.end());
+}
+
 const std::vector<StorageNode>& IntermediateStorage::getStorageNodes() const
 {
 	return m_nodes;
@@ -372,6 +384,11 @@ const std::vector<StorageError>& IntermediateStorage::getErrors() const
 	return m_errors;
 }
 
+const std::set<std::wstring>& IntermediateStorage::getCompletedTranslationUnits() const
+{
+	return m_completedTranslationUnits;
+}
+
 void IntermediateStorage::setStorageNodes(std::vector<StorageNode> storageNodes)
 {
 	m_nodes = std::move(storageNodes);
@@ -450,6 +467,11 @@ void IntermediateStorage::setErrors(std::vector<StorageError> errors)
 	}
 }
 
+void IntermediateStorage::setCompletedTranslationUnits(std::set<std::wstring> filePaths)
+{
+	m_completedTranslationUnits = std::move(filePaths);
+}
+
 Id IntermediateStorage::getNextId() const
 {
 	return m_nextId;
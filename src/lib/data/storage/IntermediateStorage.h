@@ -41,6 +41,7 @@ public:
 	void addElementComponent(const StorageElementComponent& component) override;
 	void addElementComponents(const std::vector<StorageElementComponent>& components) override;
 	Id addError(const StorageErrorData& errorData) override;
+	void addCompletedTranslationUnits(const std::set<std::wstring>& filePaths) override;
 
 	const std::vector<StorageNode>& getStorageNodes() const override;
 	const std::vector<StorageFile>& getStorageFiles() const override;
@@ -52,6 +53,7 @@ public:
 	const std::set<StorageComponentAccess>& getComponentAccesses() const override;
 	const std::set<StorageElementComponent>& getElementComponents() const override;
 	const std::vector<StorageError>& getErrors() const override;
+	const std::set<std::wstring>& getCompletedTranslationUnits() const override;
 
 	void setStorageNodes(std::vector<StorageNode> storageNodes);
 	void setStorageFiles(std::vector<StorageFile> storageFiles);
@@ -63,6 +65,7 @@ public:
 	void setComponentAccesses(std::set<StorageComponentAccess> componentAccesses);
 	void setElementComponents(std::set<StorageElementComponent> components);
 	void setErrors(std::vector<StorageError> errors);
+	void setCompletedTranslationUnits(std::set<std::wstring> filePaths);
 
 	Id getNextId() const;
 	void setNextId(const Id nextId);
@@ -93,6 +96,8 @@ private:
 	std::map<StorageErrorData, size_t> m_errorsIndex;	 // this is used to prevent duplicates (unique)
 	std::vector<StorageError> m_errors;
 
+	std::set<std::wstring> m_completedTranslationUnits;
+
 	Id m_nextId;
 };
 
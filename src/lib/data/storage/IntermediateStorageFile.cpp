@@ -0,0 +1,890 @@
+#include "IntermediateStorageFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+#include <QByteArray>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "FilePath.h"
+#include "IntermediateStorage.h"
+#include "logging.h"
+#include "utilityString.h"
+
+const unsigned int IntermediateStorageFile::s_magicNumber = 0x53495453;	   // "STIS"
+const unsigned int IntermediateStorageFile::s_version = 4;
+const unsigned int IntermediateStorageFile::s_compressedFlag = 1;
+
+namespace
+{
+class Writer
+{
+public:
+	void writeNumber(unsigned long long value)
+	{
+		// variable length encoding, 7 bits per byte
+		while (value >= 0x80)
+		{
+			m_data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		m_data.push_back(static_cast<char>(value));
+	}
+
+	void writeSignedNumber(long long value)
+	{
+		// zig zag encoding keeps small negative deltas small
+		writeNumber((static_cast<unsigned long long>(value) << 1) ^ (value < 0 ? ~0ull : 0ull));
+	}
+
+	void writeInt(int value)
+	{
+		writeNumber(static_cast<unsigned int>(value));
+	}
+
+	void writeString(const std::string& value)
+	{
+		writeNumber(value.size());
+		m_data.append(value);
+	}
+
+	void writeBytes(const std::string& bytes)
+	{
+		m_data.append(bytes);
+	}
+
+	const std::string& getData() const
+	{
+		return m_data;
+	}
+
+private:
+	std::string m_data;
+};
+
+class Reader
+{
+public:
+	Reader(const char* data, size_t size): m_data(data), m_size(size), m_position(0), m_good(true)
+	{
+	}
+
+	bool good() const
+	{
+		return m_good;
+	}
+
+	size_t getPosition() const
+	{
+		return m_position;
+	}
+
+	unsigned long long readNumber()
+	{
+		unsigned long long value = 0;
+		for (unsigned int shift = 0; shift < 64; shift += 7)
+		{
+			if (m_position >= m_size)
+			{
+				m_good = false;
+				break;
+			}
+
+			const unsigned char byte = static_cast<unsigned char>(m_data[m_position++]);
+			value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+			{
+				break;
+			}
+		}
+		return value;
+	}
+
+	long long readSignedNumber()
+	{
+		const unsigned long long value = readNumber();
+		return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+	}
+
+	int readInt()
+	{
+		return static_cast<int>(static_cast<unsigned int>(readNumber()));
+	}
+
+	// every row takes at least one byte, so larger counts can only come from a broken file
+	size_t readCount()
+	{
+		const unsigned long long count = readNumber();
+		if (count > m_size - m_position)
+		{
+			m_good = false;
+			return 0;
+		}
+		return static_cast<size_t>(count);
+	}
+
+	std::string readString()
+	{
+		const size_t size = static_cast<size_t>(readNumber());
+		if (!m_good || size > m_size - m_position)
+		{
+			m_good = false;
+			return "";
+		}
+
+		std::string value(m_data + m_position, size);
+		m_position += size;
+		return value;
+	}
+
+private:
+	const char* m_data;
+	size_t m_size;
+	size_t m_position;
+	bool m_good;
+};
+
+class StringTable
+{
+public:
+	size_t add(const std::string& str)
+	{
+		auto it = m_indices.find(str);
+		if (it != m_indices.end())
+		{
+			return it->second;
+		}
+
+		m_strings.push_back(str);
+		return m_indices.emplace(str, m_strings.size() - 1).first->second;
+	}
+
+	size_t add(const std::wstring& str)
+	{
+		return add(utility::encodeToUtf8(str));
+	}
+
+	void write(Writer& writer) const
+	{
+		writer.writeNumber(m_strings.size());
+		for (const std::string& str: m_strings)
+		{
+			writer.writeString(str);
+		}
+	}
+
+	void read(Reader& reader)
+	{
+		m_strings.resize(reader.readCount());
+		for (std::string& str: m_strings)
+		{
+			str = reader.readString();
+		}
+	}
+
+	std::string get(long long index) const
+	{
+		return index >= 0 && static_cast<size_t>(index) < m_strings.size() ? m_strings[index] : "";
+	}
+
+	std::wstring getW(long long index) const
+	{
+		return utility::decodeFromUtf8(get(index));
+	}
+
+private:
+	std::vector<std::string> m_strings;
+	std::unordered_map<std::string, size_t> m_indices;
+};
+
+// writes the values of one member for all rows, each value either as it is or as the difference to
+// the value of the previous row
+template <typename ContainerType, typename GetterType>
+void writeColumn(Writer& writer, const ContainerType& rows, GetterType getValue, bool deltaEncoded)
+{
+	long long previousValue = 0;
+	for (const auto& row: rows)
+	{
+		const long long value = static_cast<long long>(getValue(row));
+		writer.writeSignedNumber(deltaEncoded ? value - previousValue : value);
+		previousValue = value;
+	}
+}
+
+template <typename RowType, typename SetterType>
+void readColumn(Reader& reader, std::vector<RowType>& rows, SetterType setValue, bool deltaEncoded)
+{
+	long long previousValue = 0;
+	for (RowType& row: rows)
+	{
+		long long value = reader.readSignedNumber();
+		if (deltaEncoded)
+		{
+			value += previousValue;
+		}
+		setValue(row, value);
+		previousValue = value;
+	}
+}
+
+template <typename RowType>
+std::set<RowType> toSet(std::vector<RowType>&& rows)
+{
+	// rows were written in set order
+	std::set<RowType> set;
+	for (RowType& row: rows)
+	{
+		set.emplace_hint(set.end(), std::move(row));
+	}
+	return set;
+}
+
+std::string writeData(const IntermediateStorage& storage)
+{
+	StringTable strings;
+	Writer writer;
+
+	const std::vector<StorageFile>& files = storage.getStorageFiles();
+	writer.writeNumber(files.size());
+	writeColumn(writer, files, [](const StorageFile& file) { return file.id; }, true);
+	writeColumn(
+		writer, files, [&](const StorageFile& file) { return strings.add(file.filePath); }, false);
+	writeColumn(
+		writer,
+		files,
+		[&](const StorageFile& file) { return strings.add(file.languageIdentifier); },
+		false);
+	writeColumn(
+		writer,
+		files,
+		[&](const StorageFile& file) { return strings.add(file.modificationTime); },
+		false);
+	writeColumn(writer, files, [](const StorageFile& file) { return file.indexed; }, false);
+	writeColumn(writer, files, [](const StorageFile& file) { return file.complete; }, false);
+
+	const std::vector<StorageSymbol>& symbols = storage.getStorageSymbols();
+	writer.writeNumber(symbols.size());
+	writeColumn(writer, symbols, [](const StorageSymbol& symbol) { return symbol.id; }, true);
+	writeColumn(
+		writer, symbols, [](const StorageSymbol& symbol) { return symbol.definitionKind; }, false);
+
+	const std::vector<StorageEdge>& edges = storage.getStorageEdges();
+	writer.writeNumber(edges.size());
+	writeColumn(writer, edges, [](const StorageEdge& edge) { return edge.id; }, true);
+	writeColumn(writer, edges, [](const StorageEdge& edge) { return edge.type; }, false);
+	writeColumn(writer, edges, [](const StorageEdge& edge) { return edge.sourceNodeId; }, true);
+	writeColumn(writer, edges, [](const StorageEdge& edge) { return edge.targetNodeId; }, true);
+
+	const std::set<StorageLocalSymbol>& localSymbols = storage.getStorageLocalSymbols();
+	writer.writeNumber(localSymbols.size());
+	writeColumn(
+		writer, localSymbols, [](const StorageLocalSymbol& symbol) { return symbol.id; }, true);
+	writeColumn(
+		writer,
+		localSymbols,
+		[&](const StorageLocalSymbol& symbol) { return strings.add(symbol.name); },
+		false);
+
+	// sorted by file and position, so most deltas are small
+	const std::set<StorageSourceLocation>& locations = storage.getStorageSourceLocations();
+	writer.writeNumber(locations.size());
+	writeColumn(
+		writer, locations, [](const StorageSourceLocation& location) { return location.id; }, true);
+	writeColumn(
+		writer,
+		locations,
+		[](const StorageSourceLocation& location) { return location.fileNodeId; },
+		true);
+	writeColumn(
+		writer,
+		locations,
+		[](const StorageSourceLocation& location) { return location.startLine; },
+		true);
+	writeColumn(
+		writer,
+		locations,
+		[](const StorageSourceLocation& location) { return location.startCol; },
+		false);
+	writeColumn(
+		writer,
+		locations,
+		[](const StorageSourceLocation& location) {
+			return static_cast<long long>(location.endLine) -
+				static_cast<long long>(location.startLine);
+		},
+		false);
+	writeColumn(
+		writer,
+		locations,
+		[](const StorageSourceLocation& location) { return location.endCol; },
+		false);
+	writeColumn(
+		writer,
+		locations,
+		[](const StorageSourceLocation& location) { return location.type; },
+		false);
+
+	const std::set<StorageOccurrence>& occurrences = storage.getStorageOccurrences();
+	writer.writeNumber(occurrences.size());
+	writeColumn(
+		writer,
+		occurrences,
+		[](const StorageOccurrence& occurrence) { return occurrence.elementId; },
+		true);
+	writeColumn(
+		writer,
+		occurrences,
+		[](const StorageOccurrence& occurrence) { return occurrence.sourceLocationId; },
+		true);
+
+	const std::set<StorageComponentAccess>& componentAccesses = storage.getComponentAccesses();
+	writer.writeNumber(componentAccesses.size());
+	writeColumn(
+		writer,
+		componentAccesses,
+		[](const StorageComponentAccess& componentAccess) { return componentAccess.nodeId; },
+		true);
+	writeColumn(
+		writer,
+		componentAccesses,
+		[](const StorageComponentAccess& componentAccess) { return componentAccess.type; },
+		false);
+
+	const std::set<StorageElementComponent>& components = storage.getElementComponents();
+	writer.writeNumber(components.size());
+	writeColumn(
+		writer,
+		components,
+		[](const StorageElementComponent& component) { return component.elementId; },
+		true);
+	writeColumn(
+		writer,
+		components,
+		[](const StorageElementComponent& component) { return component.type; },
+		false);
+	writeColumn(
+		writer,
+		components,
+		[&](const StorageElementComponent& component) { return strings.add(component.data); },
+		false);
+
+	const std::vector<StorageError>& errors = storage.getErrors();
+	writer.writeNumber(errors.size());
+	writeColumn(writer, errors, [](const StorageError& error) { return error.id; }, true);
+	writeColumn(
+		writer,
+		errors,
+		[&](const StorageError& error) { return strings.add(error.message); },
+		false);
+	writeColumn(
+		writer,
+		errors,
+		[&](const StorageError& error) { return strings.add(error.translationUnit); },
+		false);
+	writeColumn(writer, errors, [](const StorageError& error) { return error.fatal; }, false);
+	writeColumn(writer, errors, [](const StorageError& error) { return error.indexed; }, false);
+
+	const std::set<std::wstring>& translationUnits = storage.getCompletedTranslationUnits();
+	writer.writeNumber(translationUnits.size());
+	writeColumn(
+		writer,
+		translationUnits,
+		[&](const std::wstring& translationUnit) { return strings.add(translationUnit); },
+		false);
+
+	// the string table is only complete after all columns were written
+	Writer dataWriter;
+	strings.write(dataWriter);
+	dataWriter.writeBytes(writer.getData());
+	return dataWriter.getData();
+}
+
+std::shared_ptr<IntermediateStorage> readData(Reader& reader)
+{
+	std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+
+	StringTable strings;
+	strings.read(reader);
+
+	{
+		std::vector<StorageFile> files(reader.readCount());
+		readColumn(
+			reader,
+			files,
+			[](StorageFile& file, long long value) { file.id = value; },
+			true);
+		readColumn(
+			reader,
+			files,
+			[&](StorageFile& file, long long value) { file.filePath = strings.getW(value); },
+			false);
+		readColumn(
+			reader,
+			files,
+			[&](StorageFile& file, long long value) {
+				file.languageIdentifier = strings.getW(value);
+			},
+			false);
+		readColumn(
+			reader,
+			files,
+			[&](StorageFile& file, long long value) { file.modificationTime = strings.get(value); },
+			false);
+		readColumn(
+			reader, files, [](StorageFile& file, long long value) { file.indexed = value; }, false);
+		readColumn(
+			reader,
+			files,
+			[](StorageFile& file, long long value) { file.complete = value; },
+			false);
+		storage->setStorageFiles(std::move(files));
+	}
+
+	{
+		std::vector<StorageSymbol> symbols(reader.readCount());
+		readColumn(
+			reader,
+			symbols,
+			[](StorageSymbol& symbol, long long value) { symbol.id = value; },
+			true);
+		readColumn(
+			reader,
+			symbols,
+			[](StorageSymbol& symbol, long long value) {
+				symbol.definitionKind = static_cast<int>(value);
+			},
+			false);
+		storage->setStorageSymbols(std::move(symbols));
+	}
+
+	{
+		std::vector<StorageEdge> edges(reader.readCount());
+		readColumn(
+			reader,
+			edges,
+			[](StorageEdge& edge, long long value) { edge.id = value; },
+			true);
+		readColumn(
+			reader,
+			edges,
+			[](StorageEdge& edge, long long value) { edge.type = static_cast<int>(value); },
+			false);
+		readColumn(
+			reader,
+			edges,
+			[](StorageEdge& edge, long long value) { edge.sourceNodeId = value; },
+			true);
+		readColumn(
+			reader,
+			edges,
+			[](StorageEdge& edge, long long value) { edge.targetNodeId = value; },
+			true);
+		storage->setStorageEdges(std::move(edges));
+	}
+
+	{
+		std::vector<StorageLocalSymbol> localSymbols(reader.readCount());
+		readColumn(
+			reader,
+			localSymbols,
+			[](StorageLocalSymbol& symbol, long long value) { symbol.id = value; },
+			true);
+		readColumn(
+			reader,
+			localSymbols,
+			[&](StorageLocalSymbol& symbol, long long value) { symbol.name = strings.getW(value); },
+			false);
+		storage->setStorageLocalSymbols(toSet(std::move(localSymbols)));
+	}
+
+	{
+		std::vector<StorageSourceLocation> locations(reader.readCount());
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) { location.id = value; },
+			true);
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) { location.fileNodeId = value; },
+			true);
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) { location.startLine = value; },
+			true);
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) { location.startCol = value; },
+			false);
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) {
+				location.endLine = location.startLine + value;
+			},
+			false);
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) { location.endCol = value; },
+			false);
+		readColumn(
+			reader,
+			locations,
+			[](StorageSourceLocation& location, long long value) {
+				location.type = static_cast<int>(value);
+			},
+			false);
+		storage->setStorageSourceLocations(toSet(std::move(locations)));
+	}
+
+	{
+		std::vector<StorageOccurrence> occurrences(reader.readCount());
+		readColumn(
+			reader,
+			occurrences,
+			[](StorageOccurrence& occurrence, long long value) { occurrence.elementId = value; },
+			true);
+		readColumn(
+			reader,
+			occurrences,
+			[](StorageOccurrence& occurrence, long long value) {
+				occurrence.sourceLocationId = value;
+			},
+			true);
+		storage->setStorageOccurrences(toSet(std::move(occurrences)));
+	}
+
+	{
+		std::vector<StorageComponentAccess> componentAccesses(reader.readCount());
+		readColumn(
+			reader,
+			componentAccesses,
+			[](StorageComponentAccess& componentAccess, long long value) {
+				componentAccess.nodeId = value;
+			},
+			true);
+		readColumn(
+			reader,
+			componentAccesses,
+			[](StorageComponentAccess& componentAccess, long long value) {
+				componentAccess.type = static_cast<int>(value);
+			},
+			false);
+		storage->setComponentAccesses(toSet(std::move(componentAccesses)));
+	}
+
+	{
+		std::vector<StorageElementComponent> components(reader.readCount());
+		readColumn(
+			reader,
+			components,
+			[](StorageElementComponent& component, long long value) {
+				component.elementId = value;
+			},
+			true);
+		readColumn(
+			reader,
+			components,
+			[](StorageElementComponent& component, long long value) {
+				component.type = static_cast<int>(value);
+			},
+			false);
+		readColumn(
+			reader,
+			components,
+			[&](StorageElementComponent& component, long long value) {
+				component.data = strings.getW(value);
+			},
+			false);
+		storage->setElementComponents(toSet(std::move(components)));
+	}
+
+	{
+		std::vector<StorageError> errors(reader.readCount());
+		readColumn(
+			reader, errors, [](StorageError& error, long long value) { error.id = value; }, true);
+		readColumn(
+			reader,
+			errors,
+			[&](StorageError& error, long long value) { error.message = strings.getW(value); },
+			false);
+		readColumn(
+			reader,
+			errors,
+			[&](StorageError& error, long long value) {
+				error.translationUnit = strings.getW(value);
+			},
+			false);
+		readColumn(
+			reader,
+			errors,
+			[](StorageError& error, long long value) { error.fatal = value; },
+			false);
+		readColumn(
+			reader,
+			errors,
+			[](StorageError& error, long long value) { error.indexed = value; },
+			false);
+		storage->setErrors(std::move(errors));
+	}
+
+	{
+		std::vector<std::wstring> translationUnits(reader.readCount());
+		readColumn(
+			reader,
+			translationUnits,
+			[&](std::wstring& translationUnit, long long value) {
+				translationUnit = strings.getW(value);
+			},
+			false);
+		storage->setCompletedTranslationUnits(toSet(std::move(translationUnits)));
+	}
+
+	if (!reader.good())
+	{
+		return nullptr;
+	}
+
+	return storage;
+}
+}	 // namespace
+
+IntermediateStorageFile::RunReader::RunReader(const FilePath& filePath)
+	: m_data(nullptr)
+	, m_size(0)
+	, m_position(0)
+	, m_dataCompressed(false)
+	, m_dataOffset(0)
+	, m_dataByteSize(0)
+	, m_remainingNodeCount(0)
+	, m_previousNodeId(0)
+	, m_nextId(0)
+	, m_valid(false)
+{
+	try
+	{
+		m_fileMapping = std::make_unique<boost::interprocess::file_mapping>(
+			filePath.str().c_str(), boost::interprocess::read_only);
+		m_region = std::make_unique<boost::interprocess::mapped_region>(
+			*m_fileMapping, boost::interprocess::read_only);
+		m_region->advise(boost::interprocess::mapped_region::advice_sequential);
+	}
+	catch (boost::interprocess::interprocess_exception& e)
+	{
+		LOG_ERROR(
+			L"Could not map storage file for reading: " + filePath.wstr() + L" (" +
+			utility::decodeFromUtf8(e.what()) + L")");
+		return;
+	}
+
+	m_data = static_cast<const char*>(m_region->get_address());
+	m_size = m_region->get_size();
+
+	Reader reader(m_data, m_size);
+	if (reader.readNumber() != s_magicNumber || reader.readNumber() != s_version)
+	{
+		LOG_ERROR(L"Storage file has unknown format: " + filePath.wstr());
+		return;
+	}
+
+	m_dataCompressed = reader.readNumber() & s_compressedFlag;
+	m_nextId = reader.readNumber();
+	m_remainingNodeCount = static_cast<size_t>(reader.readNumber());
+	const unsigned long long nodesByteSize = reader.readNumber();
+	m_dataByteSize = static_cast<size_t>(reader.readNumber());
+	m_position = reader.getPosition();
+	m_dataOffset = m_position + static_cast<size_t>(nodesByteSize);
+
+	if (!reader.good() || m_dataOffset < m_position || m_dataOffset + m_dataByteSize != m_size)
+	{
+		LOG_ERROR(L"Storage file is truncated: " + filePath.wstr());
+		return;
+	}
+
+	m_valid = true;
+}
+
+IntermediateStorageFile::RunReader::~RunReader() {}
+
+bool IntermediateStorageFile::RunReader::isValid() const
+{
+	return m_valid;
+}
+
+bool IntermediateStorageFile::RunReader::readNextNode(StorageNode& node)
+{
+	if (!m_valid || !m_remainingNodeCount)
+	{
+		return false;
+	}
+
+	Reader reader(m_data + m_position, m_dataOffset - m_position);
+	m_previousNodeId += reader.readSignedNumber();
+	node.id = m_previousNodeId;
+	node.type = reader.readInt();
+
+	// names are stored as the length of the prefix shared with the previous name and the rest
+	const size_t sharedPrefixSize = static_cast<size_t>(reader.readNumber());
+	const std::string nameSuffix = reader.readString();
+	if (sharedPrefixSize > m_previousNodeName.size())
+	{
+		m_valid = false;
+	}
+	else
+	{
+		m_previousNodeName.resize(sharedPrefixSize);
+		m_previousNodeName.append(nameSuffix);
+		node.serializedName = m_previousNodeName;
+	}
+
+	m_position += reader.getPosition();
+	m_remainingNodeCount--;
+
+	if (!reader.good() || !m_valid)
+	{
+		LOG_ERROR(L"Storage file is truncated.");
+		m_valid = false;
+		return false;
+	}
+	return true;
+}
+
+std::shared_ptr<IntermediateStorage> IntermediateStorageFile::RunReader::readRemainingData()
+{
+	if (!m_valid || m_remainingNodeCount)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<IntermediateStorage> storage;
+	if (m_dataCompressed)
+	{
+		const QByteArray data = qUncompress(
+			reinterpret_cast<const uchar*>(m_data + m_dataOffset),
+			static_cast<int>(m_dataByteSize));
+		Reader reader(data.constData(), static_cast<size_t>(data.size()));
+		storage = readData(reader);
+	}
+	else
+	{
+		Reader reader(m_data + m_dataOffset, m_dataByteSize);
+		storage = readData(reader);
+	}
+
+	if (!storage)
+	{
+		LOG_ERROR(L"Storage file is truncated.");
+		m_valid = false;
+		return nullptr;
+	}
+
+	storage->setNextId(m_nextId);
+
+	return storage;
+}
+
+bool IntermediateStorageFile::write(
+	const IntermediateStorage& storage, const FilePath& filePath, bool compressed)
+{
+	std::vector<const StorageNode*> nodes;
+	nodes.reserve(storage.getStorageNodes().size());
+	for (const StorageNode& node: storage.getStorageNodes())
+	{
+		nodes.push_back(&node);
+	}
+	std::sort(nodes.begin(), nodes.end(), [](const StorageNode* a, const StorageNode* b) {
+		return a->serializedName < b->serializedName;
+	});
+
+	Writer nodeWriter;
+	{
+		Id previousId = 0;
+		std::string previousName;
+		for (const StorageNode* node: nodes)
+		{
+			const std::string& name = node->serializedName;
+			const size_t sharedPrefixSize = static_cast<size_t>(
+				std::mismatch(
+					previousName.begin(),
+					previousName.begin() + std::min(previousName.size(), name.size()),
+					name.begin())
+					.first -
+				previousName.begin());
+
+			nodeWriter.writeSignedNumber(
+				static_cast<long long>(node->id) - static_cast<long long>(previousId));
+			nodeWriter.writeInt(node->type);
+			nodeWriter.writeNumber(sharedPrefixSize);
+			nodeWriter.writeString(name.substr(sharedPrefixSize));
+
+			previousId = node->id;
+			previousName = name;
+		}
+	}
+
+	std::string data = writeData(storage);
+	if (compressed)
+	{
+		const QByteArray compressedData = qCompress(
+			reinterpret_cast<const uchar*>(data.data()), static_cast<int>(data.size()));
+		data.assign(compressedData.constData(), static_cast<size_t>(compressedData.size()));
+	}
+
+	Writer headerWriter;
+	headerWriter.writeNumber(s_magicNumber);
+	headerWriter.writeNumber(s_version);
+	headerWriter.writeNumber(compressed ? s_compressedFlag : 0);
+	headerWriter.writeNumber(storage.getNextId());
+	headerWriter.writeNumber(nodes.size());
+	headerWriter.writeNumber(nodeWriter.getData().size());
+	headerWriter.writeNumber(data.size());
+
+	std::ofstream stream(filePath.str(), std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		LOG_ERROR(L"Could not open file for writing storage: " + filePath.wstr());
+		return false;
+	}
+
+	stream.write(headerWriter.getData().data(), headerWriter.getData().size());
+	stream.write(nodeWriter.getData().data(), nodeWriter.getData().size());
+	stream.write(data.data(), data.size());
+
+	stream.flush();
+	if (!stream.good())
+	{
+		LOG_ERROR(L"Could not write storage to file: " + filePath.wstr());
+		return false;
+	}
+
+	return true;
+}
+
+std::shared_ptr<IntermediateStorage> IntermediateStorageFile::read(const FilePath& filePath)
+{
+	RunReader runReader(filePath);
+
+	std::vector<StorageNode> nodes;
+	StorageNode node;
+	while (runReader.readNextNode(node))
+	{
+		nodes.push_back(std::move(node));
+	}
+
+	std::shared_ptr<IntermediateStorage> storage = runReader.readRemainingData();
+	if (!storage)
+	{
+		LOG_ERROR(L"Could not read storage file: " + filePath.wstr());
+		return nullptr;
+	}
+
+	storage->setStorageNodes(std::move(nodes));
+	return storage;
+}
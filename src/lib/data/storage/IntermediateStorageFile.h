@@ -0,0 +1,80 @@
+#ifndef INTERMEDIATE_STORAGE_FILE_H
+#define INTERMEDIATE_STORAGE_FILE_H
+
+#include <memory>
+#include <string>
+
+#include "StorageNode.h"
+
+namespace boost
+{
+namespace interprocess
+{
+class file_mapping;
+class mapped_region;
+}	 // namespace interprocess
+}	 // namespace boost
+
+class FilePath;
+class IntermediateStorage;
+
+// Compact binary file representation of an IntermediateStorage, used to move storages that don't
+// fit into the indexing memory budget out to disk. Nodes are written sorted by serialized name with
+// the prefix shared with the previous name left out, so several files can be merged as sorted runs.
+// All other data is stored column by column with delta encoded values and a string table, which
+// can optionally be compressed.
+// Only the spill files of the StorageProvider and the runs of the ExternalStorageMerger use this
+// format. Indexer processes still hand over their results in shared memory, whose size the
+// indexing budget is based on, and custom command output, snapshots and shards stay SQLite
+// databases that are merged with SQL.
+class IntermediateStorageFile
+{
+public:
+	// Reads a memory mapped file in two steps: first the nodes one by one in serialized name order,
+	// then all the remaining data at once.
+	class RunReader
+	{
+	public:
+		RunReader(const FilePath& filePath);
+		~RunReader();
+
+		bool isValid() const;
+
+		// returns false when all nodes were read
+		bool readNextNode(StorageNode& node);
+
+		// returns empty shared_ptr if the file could not be read or not all nodes were read yet.
+		// The returned storage contains no nodes.
+		std::shared_ptr<IntermediateStorage> readRemainingData();
+
+	private:
+		std::unique_ptr<boost::interprocess::file_mapping> m_fileMapping;
+		std::unique_ptr<boost::interprocess::mapped_region> m_region;
+		const char* m_data;
+		size_t m_size;
+		size_t m_position;
+
+		bool m_dataCompressed;
+		size_t m_dataOffset;
+		size_t m_dataByteSize;
+
+		size_t m_remainingNodeCount;
+		Id m_previousNodeId;
+		std::string m_previousNodeName;
+		Id m_nextId;
+		bool m_valid;
+	};
+
+	static bool write(
+		const IntermediateStorage& storage, const FilePath& filePath, bool compressed = false);
+
+	// returns empty shared_ptr if the file could not be read
+	static std::shared_ptr<IntermediateStorage> read(const FilePath& filePath);
+
+private:
+	static const unsigned int s_magicNumber;
+	static const unsigned int s_version;
+	static const unsigned int s_compressedFlag;
+};
+
+#endif	  // INTERMEDIATE_STORAGE_FILE_H
@@ -1,5 +1,6 @@
 #include "PersistentStorage.h"
 
+#include <algorithm>
 #include <queue>
 #include <sstream>
 
@@ -8,6 +9,7 @@
 #include "ElementComponentKind.h"
 #include "FileInfo.h"
 #include "FilePath.h"
+#include "FileSystem.h"
 #include "Graph.h"
 #include "MessageErrorCountUpdate.h"
 #include "MessageStatus.h"
@@ -28,6 +30,7 @@
 #include "tracing.h"
 #include "utility.h"
 #include "utilityApp.h"
+#include "utilityString.h"
 
 PersistentStorage::PersistentStorage(const FilePath& dbPath, const FilePath& bookmarkPath)
 	: m_sqliteIndexStorage(dbPath), m_sqliteBookmarkStorage(bookmarkPath)
@@ -155,6 +158,11 @@ Id PersistentStorage::addError(const StorageErrorData& data)
 	return m_sqliteIndexStorage.addError(data).id;
 }
 
+void PersistentStorage::addCompletedTranslationUnits(const std::set<std::wstring>& filePaths)
+{
+	m_sqliteIndexStorage.setTranslationUnitsCompleted(filePaths);
+}
+
 void PersistentStorage::removeElement(const Id id)
 {
 	m_sqliteIndexStorage.removeElement(id);
@@ -239,6 +247,11 @@ const std::vector<StorageError>& PersistentStorage::getErrors() const
 	return m_storageData.errors = errors;
 }
 
+const std::set<std::wstring>& PersistentStorage::getCompletedTranslationUnits() const
+{
+	return m_storageData.translationUnits = m_sqliteIndexStorage.getIndexingTranslationUnits(true);
+}
+
 void PersistentStorage::startInjection()
 {
 	beforeErrorRecording();
@@ -260,6 +273,66 @@ void PersistentStorage::rollbackInjection()
 	afterErrorRecording();
 }
 
+bool PersistentStorage::mergeDatabase(const FilePath& sourceDbFilePath)
+{
+	beforeErrorRecording();
+
+	const bool success = m_sqliteIndexStorage.mergeDatabase(sourceDbFilePath);
+
+	afterErrorRecording();
+
+	return success;
+}
+
+bool PersistentStorage::mergeDatabases(
+	std::vector<FilePath> sourceDbFilePaths, const FilePath& targetDbFilePath)
+{
+	std::sort(sourceDbFilePaths.begin(), sourceDbFilePaths.end());
+
+	for (const FilePath& sourceDbFilePath: sourceDbFilePaths)
+	{
+		if (!sourceDbFilePath.exists() || sourceDbFilePath == targetDbFilePath)
+		{
+			LOG_ERROR(L"Cannot merge database: " + sourceDbFilePath.wstr());
+			return false;
+		}
+	}
+
+	FileSystem::remove(targetDbFilePath);
+
+	PersistentStorage targetStorage(targetDbFilePath, FilePath());
+	targetStorage.setup();
+	targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_MERGE);
+
+	for (const FilePath& sourceDbFilePath: sourceDbFilePaths)
+	{
+		{
+			PersistentStorage sourceStorage(sourceDbFilePath, FilePath());
+			if (sourceStorage.isIncompatible())
+			{
+				LOG_ERROR(L"Cannot merge database of other version: " + sourceDbFilePath.wstr());
+				return false;
+			}
+
+			if (targetStorage.getProjectSettingsText().empty())
+			{
+				targetStorage.setProjectSettingsText(sourceStorage.getProjectSettingsText());
+			}
+		}
+
+		LOG_INFO(L"Merging database: " + sourceDbFilePath.wstr());
+		if (!targetStorage.mergeDatabase(sourceDbFilePath))
+		{
+			return false;
+		}
+	}
+
+	targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+	targetStorage.updateVersion();
+
+	return true;
+}
+
 const std::vector<ErrorInfo> PersistentStorage::getErrorInfos() const
 {
 	return m_sqliteIndexStorage.getAllErrorInfos();
@@ -289,6 +362,23 @@ void PersistentStorage::afterErrorRecording()
 	}
 }
 
+void PersistentStorage::setWriteAheadLogEnabled(bool enabled)
+{
+	m_sqliteIndexStorage.setWriteAheadLogEnabled(enabled);
+}
+
+void PersistentStorage::openReadConnections()
+{
+	const int maximumReadConnectionCount = 4;
+	m_sqliteIndexStorage.setReadConnectionCount(
+		std::max(1, std::min(maximumReadConnectionCount, utility::getIdealThreadCount())));
+}
+
+void PersistentStorage::setIndexReadOnly()
+{
+	m_sqliteIndexStorage.setReadOnly();
+}
+
 void PersistentStorage::setMode(const SqliteIndexStorage::StorageModeType mode)
 {
 	m_sqliteIndexStorage.setMode(mode);
@@ -304,6 +394,11 @@ FilePath PersistentStorage::getBookmarkDbFilePath() const
 	return m_sqliteBookmarkStorage.getDbFilePath();
 }
 
+Id PersistentStorage::getLastElementId() const
+{
+	return m_sqliteIndexStorage.getLastElementId();
+}
+
 bool PersistentStorage::isEmpty() const
 {
 	return m_sqliteIndexStorage.isEmpty();
@@ -353,17 +448,13 @@ void PersistentStorage::clearCaches()
 	m_symbolIndex.clear();
 	m_fileIndex.clear();
 
-	m_fileNodeIds.clear();
-	m_lowerCasefileNodeIds.clear();
-	m_fileNodePaths.clear();
-	m_fileNodeComplete.clear();
-	m_fileNodeIndexed.clear();
-	m_fileNodeLanguage.clear();
-	m_symbolDefinitionKinds.clear();
+	clearFilePathMaps();
 
 	m_hierarchyCache.clear();
 	m_fullTextSearchIndex.clear();
 	m_fullTextSearchCodec = "";
+
+	m_lastCachedElementId = 0;
 }
 
 std::set<FilePath> PersistentStorage::getReferenced(const std::set<FilePath>& filePaths) const
@@ -451,6 +542,34 @@ std::set<FilePath> PersistentStorage::getIncompleteFiles() const
 	return incompleteFiles;
 }
 
+void PersistentStorage::setIndexingTranslationUnits(const std::set<FilePath>& filePaths)
+{
+	std::set<std::wstring> translationUnits;
+	for (const FilePath& filePath: filePaths)
+	{
+		translationUnits.insert(filePath.wstr());
+	}
+
+	m_sqliteIndexStorage.beginTransaction();
+	m_sqliteIndexStorage.setIndexingTranslationUnits(translationUnits);
+	m_sqliteIndexStorage.commitTransaction();
+}
+
+std::set<FilePath> PersistentStorage::getUnfinishedTranslationUnits() const
+{
+	std::set<FilePath> filePaths;
+	for (const std::wstring& translationUnit: m_sqliteIndexStorage.getIndexingTranslationUnits(false))
+	{
+		filePaths.insert(FilePath(translationUnit));
+	}
+	return filePaths;
+}
+
+void PersistentStorage::clearIndexingTranslationUnits()
+{
+	m_sqliteIndexStorage.clearIndexingTranslationUnits();
+}
+
 bool PersistentStorage::getFilePathIndexed(const FilePath& path) const
 {
 	Id fileId = getFileNodeId(path);
@@ -474,6 +593,45 @@ void PersistentStorage::buildCaches()
 	buildHierarchyCache();
 }
 
+void PersistentStorage::updateCaches()
+{
+	TRACE();
+
+	// all reads happen within one transaction to see a consistent state of the database
+	m_sqliteIndexStorage.beginTransaction();
+
+	const Id lastElementId = m_sqliteIndexStorage.getLastElementId();
+
+	std::vector<Id> nonIndexedFileIds;
+	for (const auto& p: m_fileNodeIndexed)
+	{
+		if (!p.second)
+		{
+			nonIndexedFileIds.push_back(p.first);
+		}
+	}
+
+	// files and definition kinds are few and may change for elements already cached
+	clearFilePathMaps();
+	buildFilePathMaps();
+
+	const FilePath dbPath = getIndexDbFilePath();
+	for (Id fileId: nonIndexedFileIds)
+	{
+		if (getFileNodeIndexed(fileId))
+		{
+			addFileNodeToSearchIndex(fileId, dbPath);
+		}
+	}
+
+	buildSearchIndex();
+	buildHierarchyCache();
+
+	m_lastCachedElementId = lastElementId;
+
+	m_sqliteIndexStorage.commitTransaction();
+}
+
 void PersistentStorage::optimizeMemory()
 {
 	TRACE();
@@ -1794,13 +1952,7 @@ std::shared_ptr<TextAccess> PersistentStorage::getFileContent(
 
 bool PersistentStorage::hasContentForFile(const FilePath& filePath) const
 {
-	std::shared_ptr<TextAccess> fileContent = m_sqliteIndexStorage.getFileContentByPath(
-		filePath.wstr());
-	if (fileContent->getLineCount() > 0)
-	{
-		return true;
-	}
-	return false;
+	return m_sqliteIndexStorage.hasFileContentForPath(filePath.wstr());
 }
 
 FileInfo PersistentStorage::getFileInfoForFileId(Id id) const
@@ -1964,8 +2116,8 @@ Id PersistentStorage::addNodeBookmark(const NodeBookmark& bookmark)
 
 	for (const Id& nodeId: bookmark.getNodeIds())
 	{
-		m_sqliteBookmarkStorage.addBookmarkedNode(
-			StorageBookmarkedNodeData(id, m_sqliteIndexStorage.getNodeById(nodeId).serializedName));
+		m_sqliteBookmarkStorage.addBookmarkedNode(StorageBookmarkedNodeData(
+			id, utility::decodeFromUtf8(m_sqliteIndexStorage.getNodeById(nodeId).serializedName)));
 	}
 
 	return id;
@@ -1989,8 +2141,10 @@ Id PersistentStorage::addEdgeBookmark(const EdgeBookmark& bookmark)
 		m_sqliteBookmarkStorage.addBookmarkedEdge(StorageBookmarkedEdgeData(
 			id,
 			// todo: optimization for multiple edges in same bookmark: use a local cache here
-			m_sqliteIndexStorage.getNodeById(storageEdge.sourceNodeId).serializedName,
-			m_sqliteIndexStorage.getNodeById(storageEdge.targetNodeId).serializedName,
+			utility::decodeFromUtf8(
+				m_sqliteIndexStorage.getNodeById(storageEdge.sourceNodeId).serializedName),
+			utility::decodeFromUtf8(
+				m_sqliteIndexStorage.getNodeById(storageEdge.targetNodeId).serializedName),
 			storageEdge.type,
 			sourceNodeActive));
 	}
@@ -2046,7 +2200,9 @@ std::vector<NodeBookmark> PersistentStorage::getAllNodeBookmarks() const
 	for (const StorageBookmarkedNode& bookmarkedNode: m_sqliteBookmarkStorage.getAllBookmarkedNodes())
 	{
 		bookmarkIdToBookmarkedNodeIds[bookmarkedNode.bookmarkId].push_back(
-			m_sqliteIndexStorage.getNodeBySerializedName(bookmarkedNode.serializedNodeName).id);
+			m_sqliteIndexStorage
+				.getNodeBySerializedName(utility::encodeToUtf8(bookmarkedNode.serializedNodeName))
+				.id);
 	}
 
 	std::vector<NodeBookmark> nodeBookmarks;
@@ -2091,7 +2247,9 @@ std::vector<EdgeBookmark> PersistentStorage::getAllEdgeBookmarks() const
 	std::vector<EdgeBookmark> edgeBookmarks;
 
 	UnorderedCache<std::wstring, Id> nodeIdCache([&](const std::wstring& serializedNodeName) {
-		return m_sqliteIndexStorage.getNodeBySerializedName(serializedNodeName).id;
+		return m_sqliteIndexStorage
+			.getNodeBySerializedName(utility::encodeToUtf8(serializedNodeName))
+			.id;
 	});
 
 	for (const StorageBookmark& storageBookmark: m_sqliteBookmarkStorage.getAllBookmarks())
@@ -3246,6 +3404,17 @@ void PersistentStorage::addInheritanceChainsToGraph(const std::vector<Id>& activ
 	}
 }
 
+void PersistentStorage::clearFilePathMaps()
+{
+	m_fileNodeIds.clear();
+	m_lowerCasefileNodeIds.clear();
+	m_fileNodePaths.clear();
+	m_fileNodeComplete.clear();
+	m_fileNodeIndexed.clear();
+	m_fileNodeLanguage.clear();
+	m_symbolDefinitionKinds.clear();
+}
+
 void PersistentStorage::buildFilePathMaps()
 {
 	TRACE();
@@ -3271,60 +3440,65 @@ void PersistentStorage::buildFilePathMaps()
 	});
 }
 
+void PersistentStorage::addFileNodeToSearchIndex(Id fileId, const FilePath& dbPath)
+{
+	auto it = m_fileNodePaths.find(fileId);
+	if (it != m_fileNodePaths.end())
+	{
+		FilePath filePath(it->second);
+
+		if (filePath.exists())
+		{
+			filePath.makeRelativeTo(dbPath);
+		}
+
+		m_fileIndex.addNode(fileId, filePath.wstr(), NodeType(NODE_FILE));
+	}
+}
+
 void PersistentStorage::buildSearchIndex()
 {
 	TRACE();
 
 	const FilePath dbPath = getIndexDbFilePath();
 
-	m_sqliteIndexStorage.forEach<StorageNode>([&](StorageNode&& node) {
-		const NodeType type(intToNodeKind(node.type));
-		if (type.isFile())
-		{
-			bool indexed = getFileNodeIndexed(node.id);
-			if (!indexed)
+	m_sqliteIndexStorage.forEachAfterId<StorageNode>(
+		m_lastCachedElementId, [&](StorageNode&& node) {
+			const NodeType type(intToNodeKind(node.type));
+			if (type.isFile())
 			{
-				return;
-			}
-
-			auto it = m_fileNodePaths.find(node.id);
-			if (it != m_fileNodePaths.end())
-			{
-				FilePath filePath(it->second);
-
-				if (filePath.exists())
+				if (getFileNodeIndexed(node.id))
 				{
-					filePath.makeRelativeTo(dbPath);
+					addFileNodeToSearchIndex(node.id, dbPath);
 				}
-
-				m_fileIndex.addNode(node.id, filePath.wstr(), type);
 			}
-		}
-		else
-		{
-			auto it = m_symbolDefinitionKinds.find(node.id);
-			const DefinitionKind defKind =
-				(it != m_symbolDefinitionKinds.end() ? it->second : DEFINITION_NONE);
-			if (defKind != DEFINITION_IMPLICIT)
+			else
 			{
-				const NameHierarchy nameHierarchy = NameHierarchy::deserialize(node.serializedName);
+				auto it = m_symbolDefinitionKinds.find(node.id);
+				const DefinitionKind defKind =
+					(it != m_symbolDefinitionKinds.end() ? it->second : DEFINITION_NONE);
+				if (defKind != DEFINITION_IMPLICIT)
+				{
+					const NameHierarchy nameHierarchy = NameHierarchy::deserialize(
+						node.serializedName);
 
-				// we don't use the signature here, so elements with the same signature share the
-				// same node.
-				std::wstring name = nameHierarchy.getQualifiedName();
+					// we don't use the signature here, so elements with the same signature share
+					// the same node.
+					std::wstring name = nameHierarchy.getQualifiedName();
 
-				// replace template arguments with .. to avoid clutter in search results and have
-				// different template specializations share the same node.
-				if (defKind == DEFINITION_NONE &&
-					nameHierarchy.getDelimiter() == nameDelimiterTypeToString(NAME_DELIMITER_CXX))
-				{
-					name = utility::replaceBetween(name, L'<', L'>', L"..");
-				}
+					// replace template arguments with .. to avoid clutter in search results and
+					// have different template specializations share the same node.
+					if (defKind == DEFINITION_NONE &&
+						nameHierarchy.getDelimiter() ==
+							nameDelimiterTypeToString(NAME_DELIMITER_CXX))
+					{
+						name = utility::replaceBetween(name, L'<', L'>', L"..");
+					}
 
-				m_symbolIndex.addNode(node.id, std::move(name), type);
+					m_symbolIndex.addNode(node.id, std::move(name), type);
+				}
 			}
-		}
-	});
+		});
 
 	m_symbolIndex.finishSetup();
 	m_fileIndex.finishSetup();
@@ -3359,7 +3533,7 @@ void PersistentStorage::buildFullTextSearchIndex() const
 					{
 						m_fullTextSearchIndex.addFile(
 							file.id,
-							codec.decode(m_sqliteIndexStorage.getFileContentById(file.id)->getText()));
+							codec.decode(m_sqliteIndexStorage.getFileContentTextById(file.id)));
 					}
 				},
 				part);
@@ -3451,8 +3625,10 @@ void PersistentStorage::buildHierarchyCache()
 	std::vector<Id> sourceNodeIds;
 	std::vector<StorageEdge> memberEdges;
 
-	m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-		Edge::typeToInt(Edge::EDGE_MEMBER), [&sourceNodeIds, &memberEdges](StorageEdge&& edge) {
+	m_sqliteIndexStorage.forEachOfTypeAfterId<StorageEdge>(
+		Edge::typeToInt(Edge::EDGE_MEMBER),
+		m_lastCachedElementId,
+		[&sourceNodeIds, &memberEdges](StorageEdge&& edge) {
 			sourceNodeIds.push_back(edge.sourceNodeId);
 			memberEdges.emplace_back(edge);
 		});
@@ -3498,8 +3674,8 @@ void PersistentStorage::buildHierarchyCache()
 			targetIsImplicit);
 	}
 
-	m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-		Edge::typeToInt(Edge::EDGE_INHERITANCE), [this](StorageEdge&& edge) {
+	m_sqliteIndexStorage.forEachOfTypeAfterId<StorageEdge>(
+		Edge::typeToInt(Edge::EDGE_INHERITANCE), m_lastCachedElementId, [this](StorageEdge&& edge) {
 			m_hierarchyCache.createInheritance(edge.id, edge.sourceNodeId, edge.targetNodeId);
 		});
 }
@@ -37,6 +37,7 @@ public:
 	void addElementComponent(const StorageElementComponent& component) override;
 	void addElementComponents(const std::vector<StorageElementComponent>& components) override;
 	Id addError(const StorageErrorData& data) override;
+	void addCompletedTranslationUnits(const std::set<std::wstring>& filePaths) override;
 
 	void removeElement(const Id id);
 	void removeElements(const std::vector<Id>& ids);
@@ -54,17 +55,34 @@ public:
 	const std::set<StorageComponentAccess>& getComponentAccesses() const override;
 	const std::set<StorageElementComponent>& getElementComponents() const override;
 	const std::vector<StorageError>& getErrors() const override;
+	const std::set<std::wstring>& getCompletedTranslationUnits() const override;
 
 	void startInjection() override;
 	void finishInjection() override;
 	void rollbackInjection();
 
+	// merges another index database without loading it into memory, see
+	// SqliteIndexStorage::mergeDatabase
+	bool mergeDatabase(const FilePath& sourceDbFilePath);
+
+	// Combines the databases of independently indexed shards into a new database. The shards are
+	// merged in path order, so the resulting ids don't depend on the order they are passed in.
+	static bool mergeDatabases(
+		std::vector<FilePath> sourceDbFilePaths, const FilePath& targetDbFilePath);
+
 	const std::vector<ErrorInfo> getErrorInfos() const;
 
 	void beforeErrorRecording();
 	void afterErrorRecording();
 
 	void setMode(const SqliteIndexStorage::StorageModeType mode);
+	void setWriteAheadLogEnabled(bool enabled);
+
+	// lets queries from different threads read from the index database in parallel
+	void openReadConnections();
+
+	// only allows reading from the index database, which doesn't need to be set up for that
+	void setIndexReadOnly();
 
 	FilePath getIndexDbFilePath() const;
 	FilePath getBookmarkDbFilePath() const;
@@ -88,10 +106,21 @@ public:
 
 	std::vector<FileInfo> getFileInfoForAllFiles() const;
 	std::set<FilePath> getIncompleteFiles() const;
+
+	void setIndexingTranslationUnits(const std::set<FilePath>& filePaths);
+	std::set<FilePath> getUnfinishedTranslationUnits() const;
+	void clearIndexingTranslationUnits();
 	bool getFilePathIndexed(const FilePath& path) const;
 
+	// elements added later on get higher ids
+	Id getLastElementId() const;
+
 	void buildCaches();
 
+	// adds the data written since the last update to the caches, used for snapshots of a storage
+	// that is still being written while indexing
+	void updateCaches();
+
 	void optimizeMemory();
 
 	// StorageAccess implementation
@@ -211,6 +240,7 @@ private:
 		std::set<StorageComponentAccess> accesses;
 		std::set<StorageElementComponent> components;
 		std::vector<StorageError> errors;
+		std::set<std::wstring> translationUnits;
 	} m_storageData;
 
 	Id getFileNodeId(const FilePath& filePath) const;
@@ -256,7 +286,9 @@ private:
 	void addCompleteFlagsToSourceLocationCollection(SourceLocationCollection* collection) const;
 	void addInheritanceChainsToGraph(const std::vector<Id>& nodeIds, Graph* graph) const;
 
+	void clearFilePathMaps();
 	void buildFilePathMaps();
+	void addFileNodeToSearchIndex(Id fileId, const FilePath& dbPath);
 	void buildSearchIndex();
 	void buildFullTextSearchIndex() const;
 	void buildMemberEdgeIdOrderMap();
@@ -289,6 +321,9 @@ private:
 
 	HierarchyCache m_hierarchyCache;
 
+	// elements up to this id are contained in the caches
+	Id m_lastCachedElementId = 0;
+
 	bool m_hasJavaFiles = false;
 };
 
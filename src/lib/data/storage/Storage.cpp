@@ -6,11 +6,16 @@
 Storage::Storage() {}
 
 void Storage::inject(Storage* injected)
+{
+	inject(injected, std::map<Id, Id>());
+}
+
+void Storage::inject(Storage* injected, std::map<Id, Id> injectedIdToOwnElementId)
 {
 	std::lock_guard<std::mutex> lock(m_dataMutex);
 
-	std::map<Id, Id> injectedIdToOwnElementId;
 	std::map<Id, Id> injectedIdToOwnSourceLocationId;
+	const bool hasMappedNodes = !injectedIdToOwnElementId.empty();
 
 	TRACE();
 	startInjection();
@@ -28,7 +33,20 @@ void Storage::inject(Storage* injected)
 	{
 		// TRACE("inject nodes");
 
-		const std::vector<StorageNode>& nodes = injected->getStorageNodes();
+		std::vector<StorageNode> unmappedNodes;
+		if (hasMappedNodes)
+		{
+			for (const StorageNode& node: injected->getStorageNodes())
+			{
+				if (injectedIdToOwnElementId.find(node.id) == injectedIdToOwnElementId.end())
+				{
+					unmappedNodes.push_back(node);
+				}
+			}
+		}
+
+		const std::vector<StorageNode>& nodes = hasMappedNodes ? unmappedNodes
+															   : injected->getStorageNodes();
 
 		std::vector<Id> nodeIds = addNodes(nodes);
 
@@ -270,9 +288,26 @@ void Storage::inject(Storage* injected)
 		addComponentAccesses(accesses);
 	}
 
+	{
+		// TRACE("inject translation units");
+
+		addCompletedTranslationUnits(injected->getCompletedTranslationUnits());
+	}
+
 	finishInjection();
 }
 
+std::vector<Id> Storage::injectNodes(const std::vector<StorageNode>& nodes)
+{
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+
+	startInjection();
+	std::vector<Id> nodeIds = addNodes(nodes);
+	finishInjection();
+
+	return nodeIds;
+}
+
 void Storage::startInjection()
 {
 	// may be implemented in derived
@@ -2,6 +2,7 @@
 #define STORAGE_H
 
 #include <functional>
+#include <map>
 #include <mutex>
 #include <set>
 #include <string>
@@ -42,6 +43,7 @@ public:
 	virtual void addElementComponent(const StorageElementComponent& component) = 0;
 	virtual void addElementComponents(const std::vector<StorageElementComponent>& components) = 0;
 	virtual Id addError(const StorageErrorData& data) = 0;
+	virtual void addCompletedTranslationUnits(const std::set<std::wstring>& filePaths) = 0;
 
 	virtual const std::vector<StorageNode>& getStorageNodes() const = 0;
 	virtual const std::vector<StorageFile>& getStorageFiles() const = 0;
@@ -53,9 +55,16 @@ public:
 	virtual const std::set<StorageComponentAccess>& getComponentAccesses() const = 0;
 	virtual const std::set<StorageElementComponent>& getElementComponents() const = 0;
 	virtual const std::vector<StorageError>& getErrors() const = 0;
+	virtual const std::set<std::wstring>& getCompletedTranslationUnits() const = 0;
 
 	void inject(Storage* injected);
 
+	// nodes of the injected storage that already have an entry in the id map are not added again
+	void inject(Storage* injected, std::map<Id, Id> injectedIdToOwnElementId);
+
+	// adds the nodes within their own injection, returns the own ids in the same order
+	std::vector<Id> injectNodes(const std::vector<StorageNode>& nodes);
+
 private:
 	virtual void startInjection();
 	virtual void finishInjection();
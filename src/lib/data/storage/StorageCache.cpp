@@ -1,17 +1,72 @@
 #include "StorageCache.h"
 
+#include "Graph.h"
 #include "SourceLocationCollection.h"
 #include "SourceLocationFile.h"
 #include "TextAccess.h"
 #include "utility.h"
 
+namespace
+{
+std::shared_ptr<Graph> copyGraph(const std::shared_ptr<Graph>& graph)
+{
+	if (!graph)
+	{
+		return graph;
+	}
+
+	std::shared_ptr<Graph> copy = std::make_shared<Graph>();
+	graph->forEachNode([&copy](Node* node) { copy->addNodeAsPlainCopy(node); });
+	graph->forEachEdge([&copy](Edge* edge) { copy->addEdgeAsPlainCopy(edge); });
+	copy->setTrailMode(graph->getTrailMode());
+	copy->setHasTrailOrigin(graph->hasTrailOrigin());
+	return copy;
+}
+
+std::shared_ptr<SourceLocationCollection> copySourceLocations(
+	const std::shared_ptr<SourceLocationCollection>& collection)
+{
+	if (!collection)
+	{
+		return collection;
+	}
+
+	std::shared_ptr<SourceLocationCollection> copy = std::make_shared<SourceLocationCollection>();
+	copy->addSourceLocationCopies(collection.get());
+	return copy;
+}
+}	 // namespace
+
+const size_t StorageCache::s_queryCacheSize = 20;
+
+StorageCache::StorageCache()
+	: m_activeTokenGraphs(s_queryCacheSize)
+	, m_childrenGraphs(s_queryCacheSize)
+	, m_trailGraphs(s_queryCacheSize)
+	, m_tokenSourceLocations(s_queryCacheSize)
+	, m_tokenTooltipInfos(s_queryCacheSize)
+{
+}
+
 void StorageCache::clear()
+{
+	clearStorageData();
+
+	setUseErrorCache(false);
+}
+
+void StorageCache::clearStorageData()
 {
 	m_graphForAll.reset();
 
 	m_storageStats = StorageStats();
 
-	setUseErrorCache(false);
+	std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+	m_activeTokenGraphs.clear();
+	m_childrenGraphs.clear();
+	m_trailGraphs.clear();
+	m_tokenSourceLocations.clear();
+	m_tokenTooltipInfos.clear();
 }
 
 std::shared_ptr<Graph> StorageCache::getGraphForAll() const
@@ -24,6 +79,135 @@ std::shared_ptr<Graph> StorageCache::getGraphForAll() const
 	return m_graphForAll;
 }
 
+std::shared_ptr<Graph> StorageCache::getGraphForActiveTokenIds(
+	const std::vector<Id>& tokenIds,
+	const std::vector<Id>& expandedNodeIds,
+	bool* isActiveNamespace) const
+{
+	const ActiveTokenQuery query(tokenIds, expandedNodeIds);
+
+	std::pair<std::shared_ptr<Graph>, bool> result(nullptr, false);
+	bool isCached = false;
+	{
+		std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+		isCached = m_activeTokenGraphs.getValue(query, &result);
+	}
+
+	if (isCached)
+	{
+		result.first = copyGraph(result.first);
+	}
+	else
+	{
+		result.first = StorageAccessProxy::getGraphForActiveTokenIds(
+			tokenIds, expandedNodeIds, &result.second);
+
+		std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+		m_activeTokenGraphs.setValue(query, std::make_pair(copyGraph(result.first), result.second));
+	}
+
+	if (isActiveNamespace)
+	{
+		*isActiveNamespace = result.second;
+	}
+	return result.first;
+}
+
+std::shared_ptr<Graph> StorageCache::getGraphForChildrenOfNodeId(Id nodeId) const
+{
+	std::shared_ptr<Graph> graph;
+	{
+		std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+		if (m_childrenGraphs.getValue(nodeId, &graph))
+		{
+			return copyGraph(graph);
+		}
+	}
+
+	graph = StorageAccessProxy::getGraphForChildrenOfNodeId(nodeId);
+
+	std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+	m_childrenGraphs.setValue(nodeId, copyGraph(graph));
+	return graph;
+}
+
+std::shared_ptr<Graph> StorageCache::getGraphForTrail(
+	Id originId,
+	Id targetId,
+	NodeKindMask nodeTypes,
+	Edge::TypeMask edgeTypes,
+	bool nodeNonIndexed,
+	size_t depth,
+	bool directed,
+	std::vector<Id>* others) const
+{
+	const TrailQuery query(
+		originId,
+		targetId,
+		nodeTypes,
+		edgeTypes,
+		nodeNonIndexed,
+		depth,
+		directed,
+		others ? *others : std::vector<Id>());
+
+	std::shared_ptr<Graph> graph;
+	{
+		std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+		if (m_trailGraphs.getValue(query, &graph))
+		{
+			return copyGraph(graph);
+		}
+	}
+
+	graph = StorageAccessProxy::getGraphForTrail(
+		originId, targetId, nodeTypes, edgeTypes, nodeNonIndexed, depth, directed, others);
+
+	std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+	m_trailGraphs.setValue(query, copyGraph(graph));
+	return graph;
+}
+
+std::shared_ptr<SourceLocationCollection> StorageCache::getSourceLocationsForTokenIds(
+	const std::vector<Id>& tokenIds) const
+{
+	std::shared_ptr<SourceLocationCollection> collection;
+	{
+		std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+		if (m_tokenSourceLocations.getValue(tokenIds, &collection))
+		{
+			return copySourceLocations(collection);
+		}
+	}
+
+	collection = StorageAccessProxy::getSourceLocationsForTokenIds(tokenIds);
+
+	std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+	m_tokenSourceLocations.setValue(tokenIds, copySourceLocations(collection));
+	return collection;
+}
+
+TooltipInfo StorageCache::getTooltipInfoForTokenIds(
+	const std::vector<Id>& tokenIds, TooltipOrigin origin) const
+{
+	const std::pair<std::vector<Id>, TooltipOrigin> query(tokenIds, origin);
+
+	TooltipInfo info;
+	{
+		std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+		if (m_tokenTooltipInfos.getValue(query, &info))
+		{
+			return info;
+		}
+	}
+
+	info = StorageAccessProxy::getTooltipInfoForTokenIds(tokenIds, origin);
+
+	std::lock_guard<std::mutex> lock(m_queryCacheMutex);
+	m_tokenTooltipInfos.setValue(query, info);
+	return info;
+}
+
 StorageStats StorageCache::getStorageStats() const
 {
 	if (!m_storageStats.nodeCount)
@@ -2,16 +2,47 @@
 #define STORAGE_CACHE_H
 
 #include <map>
+#include <mutex>
+#include <tuple>
 
+#include "LruCache.h"
 #include "StorageAccessProxy.h"
+#include "TooltipInfo.h"
 
 class StorageCache: public StorageAccessProxy
 {
 public:
+	StorageCache();
+
 	void clear();
 
+	// drops data cached from the subject but keeps the errors collected while indexing
+	void clearStorageData();
+
 	std::shared_ptr<Graph> getGraphForAll() const override;
 
+	// results of recent queries are kept, so navigating back and forth needs no storage access
+	std::shared_ptr<Graph> getGraphForActiveTokenIds(
+		const std::vector<Id>& tokenIds,
+		const std::vector<Id>& expandedNodeIds,
+		bool* isActiveNamespace = nullptr) const override;
+	std::shared_ptr<Graph> getGraphForChildrenOfNodeId(Id nodeId) const override;
+	std::shared_ptr<Graph> getGraphForTrail(
+		Id originId,
+		Id targetId,
+		NodeKindMask nodeTypes,
+		Edge::TypeMask edgeTypes,
+		bool nodeNonIndexed,
+		size_t depth,
+		bool directed,
+		std::vector<Id>* others = nullptr) const override;
+
+	std::shared_ptr<SourceLocationCollection> getSourceLocationsForTokenIds(
+		const std::vector<Id>& tokenIds) const override;
+
+	TooltipInfo getTooltipInfoForTokenIds(
+		const std::vector<Id>& tokenIds, TooltipOrigin origin) const override;
+
 	StorageStats getStorageStats() const override;
 
 	std::shared_ptr<TextAccess> getFileContent(const FilePath& filePath, bool showsErrors) const override;
@@ -28,12 +59,27 @@ public:
 		const std::vector<ErrorInfo>& newErrors, const ErrorCountInfo& errorCount) override;
 
 private:
+	typedef std::pair<std::vector<Id>, std::vector<Id>> ActiveTokenQuery;
+	typedef std::tuple<Id, Id, NodeKindMask, Edge::TypeMask, bool, size_t, bool, std::vector<Id>>
+		TrailQuery;
+
+	static const size_t s_queryCacheSize;
+
 	mutable std::shared_ptr<Graph> m_graphForAll;
 	mutable StorageStats m_storageStats;
 
 	bool m_useErrorCache = false;
 	ErrorCountInfo m_errorCount;
 	std::vector<ErrorInfo> m_cachedErrors;
+
+	// cached graphs and collections are copied on access, because callers modify them
+	mutable std::mutex m_queryCacheMutex;
+	mutable LruCache<ActiveTokenQuery, std::pair<std::shared_ptr<Graph>, bool>> m_activeTokenGraphs;
+	mutable LruCache<Id, std::shared_ptr<Graph>> m_childrenGraphs;
+	mutable LruCache<TrailQuery, std::shared_ptr<Graph>> m_trailGraphs;
+	mutable LruCache<std::vector<Id>, std::shared_ptr<SourceLocationCollection>>
+		m_tokenSourceLocations;
+	mutable LruCache<std::pair<std::vector<Id>, TooltipOrigin>, TooltipInfo> m_tokenTooltipInfos;
 };
 
 #endif	  // STORAGE_CACHE_H
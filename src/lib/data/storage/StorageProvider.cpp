@@ -1,64 +1,173 @@
 #include "StorageProvider.h"
 
+#include <algorithm>
+
+#include "FileSystem.h"
+#include "IntermediateStorageFile.h"
 #include "logging.h"
 
+StorageProvider::StorageProvider()
+	: m_byteBudget(0)
+	, m_byteSize(0)
+	, m_spilledStorageCount(0)
+	, m_nextInsertIndex(0)
+	, m_spilling(false)
+{
+}
+
+StorageProvider::~StorageProvider()
+{
+	clear();
+
+	if (!m_spillDirectoryPath.empty() && m_spillDirectoryPath.recheckExists())
+	{
+		FileSystem::remove(m_spillDirectoryPath);	 // only succeeds if empty
+	}
+}
+
+void StorageProvider::setSpillDirectoryPath(const FilePath& spillDirectoryPath)
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	m_spillDirectoryPath = spillDirectoryPath;
+}
+
+bool StorageProvider::canSpill() const
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return !m_spillDirectoryPath.empty();
+}
+
+void StorageProvider::setByteBudget(size_t byteBudget)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_storagesMutex);
+		m_byteBudget = byteBudget;
+	}
+	spillStorages();
+}
+
+size_t StorageProvider::getByteBudget() const
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return m_byteBudget;
+}
+
+size_t StorageProvider::getByteSize() const
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return m_byteSize;
+}
+
 int StorageProvider::getStorageCount() const
 {
 	std::lock_guard<std::mutex> lock(m_storagesMutex);
 	return static_cast<int>(m_storages.size());
 }
 
+int StorageProvider::getInMemoryStorageCount() const
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return static_cast<int>(m_storages.size() - m_spilledStorageCount);
+}
+
+int StorageProvider::getSpilledStorageCount() const
+{
+	std::lock_guard<std::mutex> lock(m_storagesMutex);
+	return static_cast<int>(m_spilledStorageCount);
+}
+
 void StorageProvider::clear()
 {
 	std::lock_guard<std::mutex> lock(m_storagesMutex);
-	return m_storages.clear();
+	for (const StorageEntry& entry: m_storages)
+	{
+		if (!entry.storage)
+		{
+			FileSystem::remove(entry.spillFilePath);
+		}
+	}
+
+	m_storages.clear();
+	m_byteSize = 0;
+	m_spilledStorageCount = 0;
 }
 
 void StorageProvider::insert(std::shared_ptr<IntermediateStorage> storage)
 {
-	const std::size_t storageSize = storage->getSourceLocationCount();
-	std::list<std::shared_ptr<IntermediateStorage>>::iterator it;
+	StorageEntry entry;
+	entry.storage = storage;
+	entry.sourceLocationCount = storage->getSourceLocationCount();
+	entry.byteSize = storage->getByteSize(sizeof(std::wstring));
 
-	std::lock_guard<std::mutex> lock(m_storagesMutex);
-	for (it = m_storages.begin(); it != m_storages.end(); it++)
 	{
-		if ((*it)->getSourceLocationCount() < storageSize)
+		std::lock_guard<std::mutex> lock(m_storagesMutex);
+		entry.insertIndex = m_nextInsertIndex++;
+
+		std::list<StorageEntry>::iterator it;
+		for (it = m_storages.begin(); it != m_storages.end(); it++)
 		{
-			break;
+			if (it->sourceLocationCount < entry.sourceLocationCount)
+			{
+				break;
+			}
 		}
+		m_storages.insert(it, entry);
+		m_byteSize += entry.byteSize;
 	}
-	m_storages.insert(it, storage);
+
+	spillStorages();
 }
 
 std::shared_ptr<IntermediateStorage> StorageProvider::consumeSecondLargestStorage()
 {
-	std::shared_ptr<IntermediateStorage> ret;
+	StorageEntry entry;
 	{
 		std::lock_guard<std::mutex> lock(m_storagesMutex);
-		if (m_storages.size() > 1)
+		if (m_storages.size() <= 1)
 		{
-			std::list<std::shared_ptr<IntermediateStorage>>::iterator it = m_storages.begin();
-			it++;
-			ret = *it;
-			m_storages.erase(it);
+			return nullptr;
+		}
+
+		std::list<StorageEntry>::iterator it = m_storages.begin();
+		it++;
+		entry = *it;
+		m_storages.erase(it);
+
+		if (entry.storage)
+		{
+			m_byteSize -= entry.byteSize;
+		}
+		else
+		{
+			m_spilledStorageCount--;
 		}
 	}
-	return ret;
+	return restoreStorage(entry);
 }
 
 std::shared_ptr<IntermediateStorage> StorageProvider::consumeLargestStorage()
 {
-	std::shared_ptr<IntermediateStorage> ret;
+	StorageEntry entry;
 	{
 		std::lock_guard<std::mutex> lock(m_storagesMutex);
-		if (!m_storages.empty())
+		if (m_storages.empty())
 		{
-			ret = m_storages.front();
-			m_storages.pop_front();
+			return nullptr;
 		}
-	}
 
-	return ret;
+		entry = m_storages.front();
+		m_storages.pop_front();
+
+		if (entry.storage)
+		{
+			m_byteSize -= entry.byteSize;
+		}
+		else
+		{
+			m_spilledStorageCount--;
+		}
+	}
+	return restoreStorage(entry);
 }
 
 void StorageProvider::logCurrentState() const
@@ -66,10 +175,105 @@ void StorageProvider::logCurrentState() const
 	std::string logString = "Storages waiting for injection:";
 	{
 		std::lock_guard<std::mutex> lock(m_storagesMutex);
-		for (const std::shared_ptr<IntermediateStorage>& storage: m_storages)
+		for (const StorageEntry& entry: m_storages)
 		{
-			logString += " " + std::to_string(storage->getSourceLocationCount()) + ";";
+			logString += " " + std::to_string(entry.sourceLocationCount) +
+				(entry.storage ? ";" : " (spilled);");
 		}
 	}
 	LOG_INFO(logString);
 }
+
+void StorageProvider::spillStorages()
+{
+	std::unique_lock<std::mutex> lock(m_storagesMutex);
+
+	// one spilling thread is enough, the others keep producing and consuming storages meanwhile
+	if (m_spilling)
+	{
+		return;
+	}
+
+	while (m_byteBudget && !m_spillDirectoryPath.empty() && m_byteSize > m_byteBudget)
+	{
+		// the largest storage is consumed next, so it is never spilled
+		std::list<StorageEntry>::iterator oldestIt = m_storages.end();
+		for (std::list<StorageEntry>::iterator it = std::next(m_storages.begin());
+			 it != m_storages.end();
+			 it++)
+		{
+			if (it->storage && (oldestIt == m_storages.end() || it->insertIndex < oldestIt->insertIndex))
+			{
+				oldestIt = it;
+			}
+		}
+
+		if (oldestIt == m_storages.end())
+		{
+			return;
+		}
+
+		const std::shared_ptr<IntermediateStorage> storage = oldestIt->storage;
+		const size_t insertIndex = oldestIt->insertIndex;
+		const FilePath spillDirectoryPath = m_spillDirectoryPath;
+		const FilePath spillFilePath = spillDirectoryPath.getConcatenated(
+			L"storage_" + std::to_wstring(insertIndex));
+
+		// write the file without holding the lock, the storage may get consumed in the meantime
+		m_spilling = true;
+		lock.unlock();
+
+		if (!spillDirectoryPath.exists())
+		{
+			FileSystem::createDirectory(spillDirectoryPath);
+		}
+		const bool success = IntermediateStorageFile::write(*storage, spillFilePath);
+
+		lock.lock();
+		m_spilling = false;
+
+		if (!success)
+		{
+			LOG_ERROR(L"Spilling storage failed, keeping it in memory.");
+			FileSystem::remove(spillFilePath);
+			m_spillDirectoryPath = FilePath();
+			return;
+		}
+
+		std::list<StorageEntry>::iterator it = std::find_if(
+			m_storages.begin(), m_storages.end(), [insertIndex](const StorageEntry& entry) {
+				return entry.insertIndex == insertIndex;
+			});
+		if (it == m_storages.end() || !it->storage)
+		{
+			FileSystem::remove(spillFilePath);
+			continue;
+		}
+
+		LOG_INFO_STREAM(
+			<< "spilled storage with " << it->sourceLocationCount
+			<< " locations, bytes in memory: " << m_byteSize << " budget: " << m_byteBudget);
+
+		it->storage.reset();
+		it->spillFilePath = spillFilePath;
+		m_byteSize -= it->byteSize;
+		m_spilledStorageCount++;
+	}
+}
+
+std::shared_ptr<IntermediateStorage> StorageProvider::restoreStorage(const StorageEntry& entry) const
+{
+	if (entry.storage)
+	{
+		return entry.storage;
+	}
+
+	std::shared_ptr<IntermediateStorage> storage = IntermediateStorageFile::read(entry.spillFilePath);
+	FileSystem::remove(entry.spillFilePath);
+
+	if (!storage)
+	{
+		LOG_ERROR(L"Restoring spilled storage failed: " + entry.spillFilePath.wstr());
+	}
+	return storage;
+}
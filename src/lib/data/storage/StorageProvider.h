@@ -1,6 +1,7 @@
 #ifndef STORAGE_PROVIDER_H
 #define STORAGE_PROVIDER_H
 
+#include "FilePath.h"
 #include "IntermediateStorage.h"
 #include <list>
 #include <memory>
@@ -9,7 +10,23 @@
 class StorageProvider
 {
 public:
+	StorageProvider();
+	~StorageProvider();
+
+	// storages exceeding the byte budget are moved to files in this directory, oldest first
+	void setSpillDirectoryPath(const FilePath& spillDirectoryPath);
+	bool canSpill() const;
+
+	// 0 means unlimited
+	void setByteBudget(size_t byteBudget);
+	size_t getByteBudget() const;
+
+	// estimated size of all storages kept in memory
+	size_t getByteSize() const;
+
 	int getStorageCount() const;
+	int getInMemoryStorageCount() const;
+	int getSpilledStorageCount() const;
 
 	void clear();
 
@@ -24,8 +41,29 @@ public:
 	void logCurrentState() const;
 
 private:
-	std::list<std::shared_ptr<IntermediateStorage>> m_storages;	   // larger storages are in front
+	struct StorageEntry
+	{
+		std::shared_ptr<IntermediateStorage> storage;	 // empty if spilled
+		FilePath spillFilePath;
+		size_t sourceLocationCount;
+		size_t byteSize;
+		size_t insertIndex;
+	};
+
+	// locks the storages mutex itself and releases it while writing files
+	void spillStorages();
+
+	std::shared_ptr<IntermediateStorage> restoreStorage(const StorageEntry& entry) const;
+
+	std::list<StorageEntry> m_storages;	   // larger storages are in front
 	mutable std::mutex m_storagesMutex;
+
+	FilePath m_spillDirectoryPath;
+	size_t m_byteBudget;
+	size_t m_byteSize;
+	size_t m_spilledStorageCount;
+	size_t m_nextInsertIndex;
+	bool m_spilling;
 };
 
 #endif	  // STORAGE_PROVIDER_H
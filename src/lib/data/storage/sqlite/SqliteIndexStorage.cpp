@@ -1,17 +1,24 @@
 #include "SqliteIndexStorage.h"
 
+#include <algorithm>
 #include <sstream>
 #include <unordered_map>
 
+#include <QByteArray>
+#include <QCryptographicHash>
+
 #include "FileSystem.h"
 #include "LocationType.h"
 #include "SourceLocationCollection.h"
 #include "SourceLocationFile.h"
 #include "TextAccess.h"
 #include "logging.h"
+#include "tracing.h"
 #include "utilityString.h"
 
-const size_t SqliteIndexStorage::s_storageVersion = 25;
+const size_t SqliteIndexStorage::s_storageVersion = 26;
+// default value of SQLITE_MAX_VARIABLE_NUMBER
+const size_t SqliteIndexStorage::s_maxBoundIdCount = 999;
 
 namespace
 {
@@ -25,6 +32,20 @@ std::pair<std::wstring, std::wstring> splitLocalSymbolName(const std::wstring& n
 
 	return std::make_pair(name.substr(0, pos), name.substr(pos + 1, name.size() - pos - 2));
 }
+
+// expects the plain content and the compressed data as first and second column
+std::string getFileContentFromQuery(CppSQLite3Query& q)
+{
+	if (q.fieldIsNull(1))
+	{
+		return q.getStringField(0, "");
+	}
+
+	int size = 0;
+	const unsigned char* data = q.getBlobField(1, size);
+	const QByteArray content = qUncompress(data, size);
+	return std::string(content.constData(), static_cast<size_t>(content.size()));
+}
 }	 // namespace
 
 size_t SqliteIndexStorage::getStorageVersion()
@@ -44,12 +65,7 @@ size_t SqliteIndexStorage::getStaticVersion() const
 
 void SqliteIndexStorage::setMode(const StorageModeType mode)
 {
-	m_tempNodeNameIndex.clear();
-	m_tempWNodeNameIndex.clear();
-	m_tempNodeTypes.clear();
-	m_tempEdgeIndex.clear();
-	m_tempLocalSymbolIndex.clear();
-	m_tempSourceLocationIndices.clear();
+	clearTempIndices();
 
 	std::vector<std::pair<int, SqliteDatabaseIndex>> indices = getIndices();
 	for (size_t i = 0; i < indices.size(); i++)
@@ -83,19 +99,10 @@ Id SqliteIndexStorage::addNode(const StorageNodeData& data)
 
 std::vector<Id> SqliteIndexStorage::addNodes(const std::vector<StorageNode>& nodes)
 {
-	if (m_tempNodeNameIndex.empty() && m_tempWNodeNameIndex.empty())
+	if (m_tempNodeNameIndex.empty())
 	{
 		forEach<StorageNode>([this](StorageNode&& node) {
-			std::string name = utility::encodeToUtf8(node.serializedName);
-			if (name.size() != node.serializedName.size())
-			{
-				m_tempWNodeNameIndex.add(node.serializedName, static_cast<uint32_t>(node.id));
-			}
-			else
-			{
-				m_tempNodeNameIndex.add(name, static_cast<uint32_t>(node.id));
-			}
-
+			m_tempNodeNameIndex.add(node.serializedName, static_cast<uint32_t>(node.id));
 			m_tempNodeTypes.emplace(static_cast<uint32_t>(node.id), node.type);
 		});
 	}
@@ -105,47 +112,28 @@ std::vector<Id> SqliteIndexStorage::addNodes(const std::vector<StorageNode>& nod
 	for (size_t i = 0; i < nodes.size(); i++)
 	{
 		const StorageNodeData& data = nodes[i];
-		std::string name = utility::encodeToUtf8(data.serializedName);
+		const Id nodeId = m_tempNodeNameIndex.find(data.serializedName);
+		if (nodeId)
 		{
-			Id nodeId;
-			if (name.size() != data.serializedName.size())
+			auto it = m_tempNodeTypes.find(static_cast<uint32_t>(nodeId));
+			if (it != m_tempNodeTypes.end() && it->second < data.type)
 			{
-				nodeId = m_tempWNodeNameIndex.find(data.serializedName);
-			}
-			else
-			{
-				nodeId = m_tempNodeNameIndex.find(name);
+				setNodeType(data.type, nodeId);
+				m_tempNodeTypes[static_cast<uint32_t>(nodeId)] = data.type;
 			}
 
-			if (nodeId)
-			{
-				auto it = m_tempNodeTypes.find(static_cast<uint32_t>(nodeId));
-				if (it != m_tempNodeTypes.end() && it->second < data.type)
-				{
-					setNodeType(data.type, nodeId);
-					m_tempNodeTypes[static_cast<uint32_t>(nodeId)] = data.type;
-				}
-
-				nodeIds[i] = nodeId;
-			}
-			else
-			{
-				executeStatement(m_insertElementStmt);
-				const Id id = static_cast<Id>(m_database.lastRowId());
+			nodeIds[i] = nodeId;
+		}
+		else
+		{
+			executeStatement(m_insertElementStmt);
+			const Id id = static_cast<Id>(m_database.lastRowId());
 
-				nodesToInsert.emplace_back(id, data);
-				nodeIds[i] = id;
+			nodesToInsert.emplace_back(id, data);
+			nodeIds[i] = id;
 
-				if (name.size() != data.serializedName.size())
-				{
-					m_tempWNodeNameIndex.add(data.serializedName, static_cast<uint32_t>(id));
-				}
-				else
-				{
-					m_tempNodeNameIndex.add(name, static_cast<uint32_t>(id));
-				}
-				m_tempNodeTypes.emplace(static_cast<uint32_t>(id), data.type);
-			}
+			m_tempNodeNameIndex.add(data.serializedName, static_cast<uint32_t>(id));
+			m_tempNodeTypes.emplace(static_cast<uint32_t>(id), data.type);
 		}
 	}
 
@@ -204,14 +192,43 @@ bool SqliteIndexStorage::addFile(const StorageFile& data)
 
 	if (success && content)
 	{
-		m_insertFileContentStmt.bind(1, int(data.id));
-		m_insertFileContentStmt.bind(2, content->getText().c_str());
-		success = executeStatement(m_insertFileContentStmt);
+		success = addFileContent(
+			data.id, content->getText(), m_insertFileContentDataStmt, m_insertFileContentStmt);
 	}
 
 	return success;
 }
 
+bool SqliteIndexStorage::addFileContent(
+	Id fileId,
+	const std::string& content,
+	CppSQLite3Statement& insertDataStmt,
+	CppSQLite3Statement& insertStmt)
+{
+	// equal contents, e.g. of vendored copies of a header, share their compressed data
+	const QByteArray hash = QCryptographicHash::hash(
+								QByteArray::fromRawData(content.data(), int(content.size())),
+								QCryptographicHash::Sha1)
+								.toHex();
+	const QByteArray compressedContent = qCompress(
+		reinterpret_cast<const uchar*>(content.data()), int(content.size()));
+
+	insertDataStmt.bind(1, hash.constData());
+	insertDataStmt.bind(2, int(content.size()));
+	insertDataStmt.bind(
+		3,
+		reinterpret_cast<const unsigned char*>(compressedContent.constData()),
+		compressedContent.size());
+	if (!executeStatement(insertDataStmt))
+	{
+		return false;
+	}
+
+	insertStmt.bind(1, int(fileId));
+	insertStmt.bind(2, hash.constData());
+	return executeStatement(insertStmt);
+}
+
 Id SqliteIndexStorage::addEdge(const StorageEdgeData& data)
 {
 	std::vector<Id> ids = addEdges({StorageEdge(0, data)});
@@ -463,6 +480,193 @@ StorageError SqliteIndexStorage::addError(const StorageErrorData& data)
 	return StorageError(id, data);
 }
 
+bool SqliteIndexStorage::mergeDatabase(const FilePath& sourceDbFilePath)
+{
+	TRACE();
+
+	// attaching is not possible within a transaction
+	{
+		CppSQLite3Statement attachStmt = m_database.compileStatement(
+			"ATTACH DATABASE ? AS merge_source;");
+		attachStmt.bind(1, utility::encodeToUtf8(sourceDbFilePath.wstr()).c_str());
+		if (!executeStatement(attachStmt))
+		{
+			LOG_ERROR(L"Could not attach database for merging: " + sourceDbFilePath.wstr());
+			return false;
+		}
+	}
+
+	beginTransaction();
+
+	// new elements and source locations keep their ids shifted behind the ones already taken,
+	// everything that already exists in this database is mapped onto the existing id
+	const std::string elementIdOffset = std::to_string(
+		executeStatementScalar("SELECT MAX(id) FROM main.element;", 0));
+	const std::string locationIdOffset = std::to_string(
+		executeStatementScalar("SELECT MAX(id) FROM main.source_location;", 0));
+
+	const std::vector<std::string> statements = {
+		"CREATE TEMP TABLE merge_element_id("
+		"source_id INTEGER NOT NULL, target_id INTEGER NOT NULL, PRIMARY KEY(source_id));",
+		"CREATE TEMP TABLE merge_location_id("
+		"source_id INTEGER NOT NULL, target_id INTEGER NOT NULL, PRIMARY KEY(source_id));",
+		"CREATE TEMP TABLE merge_new_file(id INTEGER NOT NULL, PRIMARY KEY(id));",
+
+		// errors
+		"INSERT OR IGNORE INTO temp.merge_element_id "
+		"SELECT s.id, IFNULL(t.id, s.id + " + elementIdOffset + ") FROM merge_source.error s "
+		"LEFT JOIN main.error t ON t.message = s.message AND t.fatal = s.fatal;",
+
+		// nodes, existing nodes take over the more specific type
+		"INSERT OR IGNORE INTO temp.merge_element_id "
+		"SELECT s.id, IFNULL(t.id, s.id + " + elementIdOffset + ") FROM merge_source.node s "
+		"LEFT JOIN main.node t ON t.serialized_name = s.serialized_name;",
+		"UPDATE main.node SET type = ("
+		"SELECT MAX(s.type) FROM merge_source.node s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id WHERE m.target_id = node.id) "
+		"WHERE id IN ("
+		"SELECT m.target_id FROM temp.merge_element_id m "
+		"INNER JOIN merge_source.node s ON s.id = m.source_id "
+		"INNER JOIN main.node t ON t.id = m.target_id WHERE s.type > t.type);",
+
+		// edges between the mapped nodes
+		"INSERT OR IGNORE INTO temp.merge_element_id "
+		"SELECT s.id, IFNULL(t.id, s.id + " + elementIdOffset + ") FROM merge_source.edge s "
+		"INNER JOIN temp.merge_element_id ms ON ms.source_id = s.source_node_id "
+		"INNER JOIN temp.merge_element_id mt ON mt.source_id = s.target_node_id "
+		"LEFT JOIN main.edge t ON t.source_node_id = ms.target_id "
+		"AND t.target_node_id = mt.target_id AND t.type = s.type;",
+
+		// local symbols, only the ones with a location in their name are shared
+		"INSERT OR IGNORE INTO temp.merge_element_id "
+		"SELECT s.id, IFNULL(t.id, s.id + " + elementIdOffset + ") "
+		"FROM merge_source.local_symbol s "
+		"LEFT JOIN main.local_symbol t ON t.name = s.name AND s.name GLOB '*<?*>';",
+
+		"INSERT INTO main.element(id) "
+		"SELECT target_id FROM temp.merge_element_id WHERE target_id > " + elementIdOffset + ";",
+
+		"INSERT INTO main.error(id, message, fatal, indexed, translation_unit) "
+		"SELECT m.target_id, s.message, s.fatal, s.indexed, s.translation_unit "
+		"FROM merge_source.error s INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"WHERE m.target_id > " + elementIdOffset + ";",
+		"INSERT INTO main.node(id, type, serialized_name) "
+		"SELECT m.target_id, s.type, s.serialized_name "
+		"FROM merge_source.node s INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"WHERE m.target_id > " + elementIdOffset + ";",
+		"INSERT INTO main.edge(id, type, source_node_id, target_node_id) "
+		"SELECT m.target_id, s.type, ms.target_id, mt.target_id "
+		"FROM merge_source.edge s INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"INNER JOIN temp.merge_element_id ms ON ms.source_id = s.source_node_id "
+		"INNER JOIN temp.merge_element_id mt ON mt.source_id = s.target_node_id "
+		"WHERE m.target_id > " + elementIdOffset + ";",
+		"INSERT INTO main.local_symbol(id, name) "
+		"SELECT m.target_id, s.name "
+		"FROM merge_source.local_symbol s INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"WHERE m.target_id > " + elementIdOffset + ";",
+		"INSERT OR IGNORE INTO main.symbol(id, definition_kind) "
+		"SELECT m.target_id, s.definition_kind "
+		"FROM merge_source.symbol s INNER JOIN temp.merge_element_id m ON m.source_id = s.id;",
+
+		// files, existing files only get their state updated like in PersistentStorage::addFile
+		"UPDATE main.file SET indexed = 1 WHERE indexed = 0 AND id IN ("
+		"SELECT m.target_id FROM merge_source.file s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id WHERE s.indexed = 1);",
+		"UPDATE main.file SET complete = NOT complete WHERE id IN ("
+		"SELECT t.id FROM merge_source.file s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"INNER JOIN main.file t ON t.id = m.target_id "
+		"WHERE s.complete != t.complete AND s.complete = NOT EXISTS("
+		"SELECT * FROM main.source_location l WHERE l.file_node_id = t.id AND l.type = " +
+			std::to_string(locationTypeToInt(LOCATION_ERROR)) + "));",
+		"INSERT INTO temp.merge_new_file(id) "
+		"SELECT m.target_id FROM merge_source.file s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"WHERE NOT EXISTS(SELECT * FROM main.file t WHERE t.id = m.target_id OR t.path = s.path);",
+		"INSERT INTO main.file("
+		"id, path, language, modification_time, indexed, complete, line_count) "
+		"SELECT m.target_id, s.path, s.language, s.modification_time, s.indexed, s.complete, "
+		"s.line_count FROM merge_source.file s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"INNER JOIN temp.merge_new_file n ON n.id = m.target_id;",
+		"INSERT OR IGNORE INTO main.filecontent_data(hash, size, data) "
+		"SELECT d.hash, d.size, d.data FROM merge_source.filecontent_data d "
+		"INNER JOIN merge_source.filecontent s ON s.data_id = d.id "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"INNER JOIN temp.merge_new_file n ON n.id = m.target_id;",
+		"INSERT INTO main.filecontent(id, data_id, content) "
+		"SELECT m.target_id, t.id, s.content FROM merge_source.filecontent s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.id "
+		"INNER JOIN temp.merge_new_file n ON n.id = m.target_id "
+		"LEFT JOIN merge_source.filecontent_data d ON d.id = s.data_id "
+		"LEFT JOIN main.filecontent_data t ON t.hash = d.hash;",
+
+		// source locations of the mapped files
+		"INSERT OR IGNORE INTO temp.merge_location_id "
+		"SELECT s.id, IFNULL(t.id, s.id + " + locationIdOffset + ") "
+		"FROM merge_source.source_location s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.file_node_id "
+		"LEFT JOIN main.source_location t ON t.file_node_id = m.target_id "
+		"AND t.start_line = s.start_line AND t.start_column = s.start_column "
+		"AND t.end_line = s.end_line AND t.end_column = s.end_column AND t.type = s.type;",
+		"INSERT INTO main.source_location("
+		"id, file_node_id, start_line, start_column, end_line, end_column, type) "
+		"SELECT l.target_id, m.target_id, s.start_line, s.start_column, s.end_line, "
+		"s.end_column, s.type FROM merge_source.source_location s "
+		"INNER JOIN temp.merge_location_id l ON l.source_id = s.id "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.file_node_id "
+		"WHERE l.target_id > " + locationIdOffset + ";",
+
+		"INSERT OR IGNORE INTO main.occurrence(element_id, source_location_id) "
+		"SELECT m.target_id, l.target_id FROM merge_source.occurrence s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.element_id "
+		"INNER JOIN temp.merge_location_id l ON l.source_id = s.source_location_id;",
+		"INSERT INTO main.element_component(element_id, type, data) "
+		"SELECT m.target_id, s.type, s.data FROM merge_source.element_component s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.element_id;",
+		"INSERT OR IGNORE INTO main.component_access(node_id, type) "
+		"SELECT m.target_id, s.type FROM merge_source.component_access s "
+		"INNER JOIN temp.merge_element_id m ON m.source_id = s.node_id;",
+		"UPDATE main.indexing_translation_unit SET completed = 1 WHERE path IN ("
+		"SELECT path FROM merge_source.indexing_translation_unit WHERE completed = 1);",
+
+		"DROP TABLE temp.merge_element_id;",
+		"DROP TABLE temp.merge_location_id;",
+		"DROP TABLE temp.merge_new_file;"};
+
+	bool success = true;
+	for (const std::string& statement: statements)
+	{
+		if (!executeStatement(statement))
+		{
+			success = false;
+			break;
+		}
+	}
+
+	if (success)
+	{
+		success = compressPlainFileContents();
+	}
+
+	if (success)
+	{
+		commitTransaction();
+	}
+	else
+	{
+		LOG_ERROR(L"Merging database failed, rolling back: " + sourceDbFilePath.wstr());
+		rollbackTransaction();
+	}
+
+	executeStatement("DETACH DATABASE merge_source;");
+
+	// the in-memory lookup tables used for adding elements don't know the merged data
+	clearTempIndices();
+
+	return success;
+}
+
 void SqliteIndexStorage::removeElement(Id id)
 {
 	std::vector<Id> ids;
@@ -699,8 +903,7 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceId(Id sourceId) con
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceIds(const std::vector<Id>& sourceIds) const
 {
-	return doGetAll<StorageEdge>(
-		"WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') + ")");
+	return doGetAllByIds<StorageEdge>("source_node_id", sourceIds);
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetId(Id targetId) const
@@ -710,8 +913,7 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetId(Id targetId) con
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetIds(const std::vector<Id>& targetIds) const
 {
-	return doGetAll<StorageEdge>(
-		"WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') + ")");
+	return doGetAllByIds<StorageEdge>("target_node_id", targetIds);
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceOrTargetId(Id id) const
@@ -736,11 +938,8 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceType(Id sourceId, i
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourcesType(
 	const std::vector<Id>& sourceIds, int type) const
 {
-	return doGetAll<StorageEdge>(
-		"WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') +
-		")"
-		" AND type == " +
-		std::to_string(type));
+	return doGetAllByIds<StorageEdge>(
+		"source_node_id", sourceIds, " AND type == " + std::to_string(type));
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetType(Id targetId, int type) const
@@ -753,11 +952,8 @@ std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetType(Id targetId, i
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetsType(
 	const std::vector<Id>& targetIds, int type) const
 {
-	return doGetAll<StorageEdge>(
-		"WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') +
-		")"
-		" AND type == " +
-		std::to_string(type));
+	return doGetAllByIds<StorageEdge>(
+		"target_node_id", targetIds, " AND type == " + std::to_string(type));
 }
 
 StorageNode SqliteIndexStorage::getNodeById(Id id) const
@@ -772,23 +968,22 @@ StorageNode SqliteIndexStorage::getNodeById(Id id) const
 	return StorageNode();
 }
 
-StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& serializedName) const
+StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::string& serializedName) const
 {
-	CppSQLite3Statement stmt = m_database.compileStatement(
+	CppSQLite3Statement stmt = getReadDatabase().compileStatement(
 		"SELECT id, type, serialized_name FROM node WHERE serialized_name == ? LIMIT 1;");
 
-	stmt.bind(1, utility::encodeToUtf8(serializedName).c_str());
+	stmt.bind(1, serializedName.c_str());
 	CppSQLite3Query q = executeQuery(stmt);
 
 	if (!q.eof())
 	{
 		const Id id = q.getIntField(0, 0);
 		const int type = q.getIntField(1, -1);
-		const std::string name = q.getStringField(2, "");
 
 		if (id != 0 && type != -1)
 		{
-			return StorageNode(id, type, utility::decodeFromUtf8(name));
+			return StorageNode(id, type, q.getStringField(2, ""));
 		}
 	}
 
@@ -799,12 +994,17 @@ StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& seri
 
 std::vector<int> SqliteIndexStorage::getAvailableNodeTypes() const
 {
-	CppSQLite3Query q = executeQuery("SELECT DISTINCT type FROM node;");
+	const std::string statement = "SELECT DISTINCT type FROM node;";
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+	CppSQLite3Query q = executeQuery(statement);
 
 	std::vector<int> types;
 
 	while (!q.eof())
 	{
+		scopedQuery.addRows(1);
+
 		const int type = q.getIntField(0, -1);
 		if (type != -1)
 		{
@@ -819,12 +1019,17 @@ std::vector<int> SqliteIndexStorage::getAvailableNodeTypes() const
 
 std::vector<int> SqliteIndexStorage::getAvailableEdgeTypes() const
 {
-	CppSQLite3Query q = executeQuery("SELECT DISTINCT type FROM edge;");
+	const std::string statement = "SELECT DISTINCT type FROM edge;";
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+	CppSQLite3Query q = executeQuery(statement);
 
 	std::vector<int> types;
 
 	while (!q.eof())
 	{
+		scopedQuery.addRows(1);
+
 		const int type = q.getIntField(0, -1);
 		if (type != -1)
 		{
@@ -850,30 +1055,47 @@ std::vector<StorageFile> SqliteIndexStorage::getFilesByPaths(const std::vector<F
 
 std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentById(Id fileId) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT content FROM filecontent WHERE id = '" + std::to_string(fileId) + "';");
+	return TextAccess::createFromString(getFileContentTextById(fileId));
+}
+
+std::string SqliteIndexStorage::getFileContentTextById(Id fileId) const
+{
+	const std::string statement =
+		"SELECT filecontent.content, filecontent_data.data "
+		"FROM filecontent "
+		"LEFT JOIN filecontent_data ON filecontent_data.id = filecontent.data_id "
+		"WHERE filecontent.id = " +
+		std::to_string(fileId) + ";";
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+	CppSQLite3Query q = executeQuery(statement);
 	if (!q.eof())
 	{
-		return TextAccess::createFromString(q.getStringField(0, ""));
+		scopedQuery.addRows(1);
+		return getFileContentFromQuery(q);
 	}
 
-	return TextAccess::createFromString("");
+	return "";
 }
 
 std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::wstring& filePath) const
 {
 	try
 	{
-		CppSQLite3Query q = executeQuery(
-			"SELECT filecontent.content "
+		const std::string statement =
+			"SELECT filecontent.content, filecontent_data.data "
 			"FROM filecontent "
 			"INNER JOIN file ON filecontent.id = file.id "
+			"LEFT JOIN filecontent_data ON filecontent_data.id = filecontent.data_id "
 			"WHERE file.path = '" +
-			utility::encodeToUtf8(filePath) + "';");
+			utility::encodeToUtf8(filePath) + "';";
+		SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
 
+		CppSQLite3Query q = executeQuery(statement);
 		if (!q.eof())
 		{
-			return TextAccess::createFromString(q.getStringField(0, ""));
+			scopedQuery.addRows(1);
+			return TextAccess::createFromString(getFileContentFromQuery(q));
 		}
 	}
 	catch (CppSQLite3Exception& e)
@@ -884,6 +1106,78 @@ std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::
 	return TextAccess::createFromString("");
 }
 
+bool SqliteIndexStorage::hasFileContentForPath(const std::wstring& filePath) const
+{
+	// checks the stored size, so the content doesn't need to be decompressed
+	return executeStatementScalar(
+			   "SELECT COUNT(*) FROM filecontent "
+			   "INNER JOIN file ON filecontent.id = file.id "
+			   "LEFT JOIN filecontent_data ON filecontent_data.id = filecontent.data_id "
+			   "WHERE file.path = '" +
+				   utility::encodeToUtf8(filePath) +
+				   "' AND (filecontent_data.size > 0 OR LENGTH(filecontent.content) > 0);",
+			   0) > 0;
+}
+
+bool SqliteIndexStorage::compressPlainFileContents()
+{
+	// the precompiled statements are not available when merging without setup
+	CppSQLite3Statement insertDataStmt;
+	CppSQLite3Statement insertStmt;
+	bool statementsCompiled = false;
+
+	// contents are loaded in bounded batches, so memory use doesn't depend on the database size
+	const size_t batchSize = 64;
+
+	Id lastId = 0;
+	while (true)
+	{
+		std::vector<std::pair<Id, std::string>> plainContents;
+		{
+			const std::string statement =
+				"SELECT id, content FROM filecontent WHERE content IS NOT NULL AND id > " +
+				std::to_string(lastId) + " ORDER BY id LIMIT " + std::to_string(batchSize) + ";";
+			SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+			CppSQLite3Query q = executeQuery(statement);
+			while (!q.eof())
+			{
+				scopedQuery.addRows(1);
+				plainContents.emplace_back(q.getIntField(0, 0), q.getStringField(1, ""));
+				q.nextRow();
+			}
+		}
+
+		if (plainContents.empty())
+		{
+			return true;
+		}
+
+		if (!statementsCompiled)
+		{
+			statementsCompiled = true;
+			insertDataStmt = m_database.compileStatement(
+				"INSERT OR IGNORE INTO filecontent_data(hash, size, data) VALUES(?, ?, ?);");
+			insertStmt = m_database.compileStatement(
+				"INSERT INTO filecontent(id, data_id) SELECT ?, id FROM filecontent_data WHERE "
+				"hash = ?;");
+		}
+
+		for (const std::pair<Id, std::string>& plainContent: plainContents)
+		{
+			if (!executeStatement(
+					"DELETE FROM filecontent WHERE id = " + std::to_string(plainContent.first) +
+					";") ||
+				!addFileContent(plainContent.first, plainContent.second, insertDataStmt, insertStmt))
+			{
+				return false;
+			}
+		}
+
+		lastId = plainContents.back().first;
+	}
+}
+
 void SqliteIndexStorage::setFileIndexed(Id fileId, bool indexed)
 {
 	executeStatement(
@@ -912,6 +1206,60 @@ void SqliteIndexStorage::setNodeType(int type, Id nodeId)
 		" WHERE id == " + std::to_string(nodeId) + ";");
 }
 
+void SqliteIndexStorage::setIndexingTranslationUnits(const std::set<std::wstring>& filePaths)
+{
+	clearIndexingTranslationUnits();
+
+	CppSQLite3Statement stmt = m_database.compileStatement(
+		"INSERT OR IGNORE INTO indexing_translation_unit(path, completed) VALUES(?, 0);");
+	for (const std::wstring& filePath: filePaths)
+	{
+		stmt.bind(1, utility::encodeToUtf8(filePath).c_str());
+		executeStatement(stmt);
+	}
+}
+
+void SqliteIndexStorage::setTranslationUnitsCompleted(const std::set<std::wstring>& filePaths)
+{
+	if (filePaths.empty())
+	{
+		return;
+	}
+
+	CppSQLite3Statement stmt = m_database.compileStatement(
+		"UPDATE indexing_translation_unit SET completed = 1 WHERE path == ?;");
+	for (const std::wstring& filePath: filePaths)
+	{
+		stmt.bind(1, utility::encodeToUtf8(filePath).c_str());
+		executeStatement(stmt);
+	}
+}
+
+std::set<std::wstring> SqliteIndexStorage::getIndexingTranslationUnits(bool completed) const
+{
+	std::set<std::wstring> filePaths;
+
+	const std::string statement =
+		"SELECT path FROM indexing_translation_unit WHERE completed == " +
+		std::to_string(completed) + ";";
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+	CppSQLite3Query q = executeQuery(statement);
+	while (!q.eof())
+	{
+		scopedQuery.addRows(1);
+		filePaths.insert(utility::decodeFromUtf8(q.getStringField(0, "")));
+		q.nextRow();
+	}
+
+	return filePaths;
+}
+
+void SqliteIndexStorage::clearIndexingTranslationUnits()
+{
+	executeStatement("DELETE FROM indexing_translation_unit;");
+}
+
 std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForFile(
 	const FilePath& filePath, const std::string& query) const
 {
@@ -988,42 +1336,49 @@ std::shared_ptr<SourceLocationCollection> SqliteIndexStorage::getSourceLocations
 		sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
 	}
 
-	CppSQLite3Query q = executeQuery(
+	std::shared_ptr<SourceLocationCollection> ret = std::make_shared<SourceLocationCollection>();
+
+	executeQueryForIds(
 		"SELECT source_location.id, file.path, source_location.start_line, "
 		"source_location.start_column, "
 		"source_location.end_line, source_location.end_column, source_location.type "
 		"FROM source_location INNER JOIN file ON (file.id = source_location.file_node_id) "
-		"WHERE source_location.id IN (" +
-		utility::join(utility::toStrings(sourceLocationIds), ',') + ");");
-
-	std::shared_ptr<SourceLocationCollection> ret = std::make_shared<SourceLocationCollection>();
-
-	while (!q.eof())
-	{
-		const Id id = q.getIntField(0, 0);
-		const std::string filePath = q.getStringField(1, "");
-		const int startLineNumber = q.getIntField(2, -1);
-		const int startColNumber = q.getIntField(3, -1);
-		const int endLineNumber = q.getIntField(4, -1);
-		const int endColNumber = q.getIntField(5, -1);
-		const int type = q.getIntField(6, -1);
+		"WHERE source_location.id IN ",
+		sourceLocationIds,
+		"",
+		[&](CppSQLite3Query& q) {
+			size_t rowCount = 0;
+			while (!q.eof())
+			{
+				rowCount++;
+
+				const Id id = q.getIntField(0, 0);
+				const std::string filePath = q.getStringField(1, "");
+				const int startLineNumber = q.getIntField(2, -1);
+				const int startColNumber = q.getIntField(3, -1);
+				const int endLineNumber = q.getIntField(4, -1);
+				const int endColNumber = q.getIntField(5, -1);
+				const int type = q.getIntField(6, -1);
+
+				if (id != 0 && filePath.size() && startLineNumber != -1 && startColNumber != -1 &&
+					endLineNumber != -1 && endColNumber != -1 && type != -1)
+				{
+					ret->addSourceLocation(
+						intToLocationType(type),
+						id,
+						sourceLocationIdToElementIds[id],
+						FilePath(utility::decodeFromUtf8(filePath)),
+						startLineNumber,
+						startColNumber,
+						endLineNumber,
+						endColNumber);
+				}
 
-		if (id != 0 && filePath.size() && startLineNumber != -1 && startColNumber != -1 &&
-			endLineNumber != -1 && endColNumber != -1 && type != -1)
-		{
-			ret->addSourceLocation(
-				intToLocationType(type),
-				id,
-				sourceLocationIdToElementIds[id],
-				FilePath(utility::decodeFromUtf8(filePath)),
-				startLineNumber,
-				startColNumber,
-				endLineNumber,
-				endColNumber);
-		}
+				q.nextRow();
+			}
 
-		q.nextRow();
-	}
+			return rowCount;
+		});
 
 	return ret;
 }
@@ -1037,15 +1392,13 @@ std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationId(I
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationIds(
 	const std::vector<Id>& locationIds) const
 {
-	return doGetAll<StorageOccurrence>(
-		"WHERE source_location_id IN (" + utility::join(utility::toStrings(locationIds), ',') + ")");
+	return doGetAllByIds<StorageOccurrence>("source_location_id", locationIds);
 }
 
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForElementIds(
 	const std::vector<Id>& elementIds) const
 {
-	return doGetAll<StorageOccurrence>(
-		"WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+	return doGetAllByIds<StorageOccurrence>("element_id", elementIds);
 }
 
 StorageComponentAccess SqliteIndexStorage::getComponentAccessByNodeId(Id nodeId) const
@@ -1056,33 +1409,36 @@ StorageComponentAccess SqliteIndexStorage::getComponentAccessByNodeId(Id nodeId)
 std::vector<StorageComponentAccess> SqliteIndexStorage::getComponentAccessesByNodeIds(
 	const std::vector<Id>& nodeIds) const
 {
-	return doGetAll<StorageComponentAccess>(
-		"WHERE node_id IN (" + utility::join(utility::toStrings(nodeIds), ',') + ")");
+	return doGetAllByIds<StorageComponentAccess>("node_id", nodeIds);
 }
 
 std::vector<StorageElementComponent> SqliteIndexStorage::getElementComponentsByElementIds(
 	const std::vector<Id>& elementIds) const
 {
-	return doGetAll<StorageElementComponent>(
-		"WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+	return doGetAllByIds<StorageElementComponent>("element_id", elementIds);
 }
 
 std::vector<ErrorInfo> SqliteIndexStorage::getAllErrorInfos() const
 {
 	std::vector<ErrorInfo> errorInfos;
 
-	CppSQLite3Query q = executeQuery(
+	const std::string statement =
 		"SELECT error.id, error.message, error.fatal, error.indexed, error.translation_unit, "
 		"file.path, source_location.start_line, source_location.start_column "
 		"FROM occurrence "
 		"INNER JOIN error ON (error.id = occurrence.element_id) "
 		"INNER JOIN source_location ON (source_location.id = occurrence.source_location_id) "
-		"INNER JOIN file ON (file.id = source_location.file_node_id);");
+		"INNER JOIN file ON (file.id = source_location.file_node_id);";
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+	CppSQLite3Query q = executeQuery(statement);
 
 	std::map<Id, size_t> errorIdCount;
 
 	while (!q.eof())
 	{
+		scopedQuery.addRows(1);
+
 		const Id id = q.getIntField(0, 0);
 		const std::string message = q.getStringField(1, "");
 		const bool fatal = q.getIntField(2, 0);
@@ -1124,6 +1480,11 @@ std::vector<ErrorInfo> SqliteIndexStorage::getAllErrorInfos() const
 	return errorInfos;
 }
 
+Id SqliteIndexStorage::getLastElementId() const
+{
+	return executeStatementScalar("SELECT MAX(id) FROM element;", 0);
+}
+
 int SqliteIndexStorage::getNodeCount() const
 {
 	return executeStatementScalar("SELECT COUNT(*) FROM node;", 0);
@@ -1164,21 +1525,25 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 {
 	std::vector<std::pair<int, SqliteDatabaseIndex>> indices;
 	indices.push_back(std::make_pair(
-		STORAGE_MODE_CLEAR,
+		STORAGE_MODE_READ | STORAGE_MODE_CLEAR | STORAGE_MODE_MERGE,
 		SqliteDatabaseIndex("edge_source_node_id_index", "edge(source_node_id)")));
 	indices.push_back(std::make_pair(
-		STORAGE_MODE_CLEAR,
+		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex("edge_target_node_id_index", "edge(target_node_id)")));
 	indices.push_back(std::make_pair(
-		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
+		STORAGE_MODE_READ | STORAGE_MODE_CLEAR | STORAGE_MODE_MERGE,
 		SqliteDatabaseIndex("node_serialized_name_index", "node(serialized_name)")));
 	indices.push_back(std::make_pair(
-		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
+		STORAGE_MODE_READ | STORAGE_MODE_CLEAR | STORAGE_MODE_MERGE,
 		SqliteDatabaseIndex("source_location_file_node_id_index", "source_location(file_node_id)")));
 	indices.push_back(std::make_pair(
-		STORAGE_MODE_WRITE, SqliteDatabaseIndex("error_all_data_index", "error(message, fatal)")));
-	indices.push_back(
-		std::make_pair(STORAGE_MODE_WRITE, SqliteDatabaseIndex("file_path_index", "file(path)")));
+		STORAGE_MODE_WRITE | STORAGE_MODE_MERGE,
+		SqliteDatabaseIndex("error_all_data_index", "error(message, fatal)")));
+	indices.push_back(std::make_pair(
+		STORAGE_MODE_WRITE | STORAGE_MODE_MERGE,
+		SqliteDatabaseIndex("file_path_index", "file(path)")));
+	indices.push_back(std::make_pair(
+		STORAGE_MODE_MERGE, SqliteDatabaseIndex("local_symbol_name_index", "local_symbol(name)")));
 	indices.push_back(std::make_pair(
 		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex("occurrence_element_id_index", "occurrence(element_id)")));
@@ -1187,7 +1552,7 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 		SqliteDatabaseIndex(
 			"occurrence_source_location_id_index", "occurrence(source_location_id)")));
 	indices.push_back(std::make_pair(
-		STORAGE_MODE_CLEAR,
+		STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex(
 			"element_component_foreign_key_index", "element_component(element_id)")));
 	indices.push_back(std::make_pair(
@@ -1206,20 +1571,34 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 		STORAGE_MODE_CLEAR,
 		SqliteDatabaseIndex(
 			"occurrence_source_location_foreign_key_index", "occurrence(source_location_id)")));
+	indices.push_back(std::make_pair(
+		STORAGE_MODE_CLEAR,
+		SqliteDatabaseIndex("filecontent_data_foreign_key_index", "filecontent(data_id)")));
 
 	return indices;
 }
 
+void SqliteIndexStorage::clearTempIndices()
+{
+	m_tempNodeNameIndex.clear();
+	m_tempNodeTypes.clear();
+	m_tempEdgeIndex.clear();
+	m_tempLocalSymbolIndex.clear();
+	m_tempSourceLocationIndices.clear();
+}
+
 void SqliteIndexStorage::clearTables()
 {
 	try
 	{
+		m_database.execDML("DROP TABLE IF EXISTS main.indexing_translation_unit;");
 		m_database.execDML("DROP TABLE IF EXISTS main.error;");
 		m_database.execDML("DROP TABLE IF EXISTS main.component_access;");
 		m_database.execDML("DROP TABLE IF EXISTS main.occurrence;");
 		m_database.execDML("DROP TABLE IF EXISTS main.source_location;");
 		m_database.execDML("DROP TABLE IF EXISTS main.local_symbol;");
 		m_database.execDML("DROP TABLE IF EXISTS main.filecontent;");
+		m_database.execDML("DROP TABLE IF EXISTS main.filecontent_data;");
 		m_database.execDML("DROP TABLE IF EXISTS main.file;");
 		m_database.execDML("DROP TABLE IF EXISTS main.symbol;");
 		m_database.execDML("DROP TABLE IF EXISTS main.node;");
@@ -1291,14 +1670,34 @@ void SqliteIndexStorage::setupTables()
 			"PRIMARY KEY(id), "
 			"FOREIGN KEY(id) REFERENCES node(id) ON DELETE CASCADE);");
 
+		// zlib compressed file contents, shared by all files with the same content
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS filecontent_data("
+			"id INTEGER NOT NULL, "
+			"hash TEXT NOT NULL UNIQUE, "
+			"size INTEGER, "
+			"data BLOB, "
+			"PRIMARY KEY(id));");
+
+		// content holds plain text written by other tools, it gets compressed when merged
 		m_database.execDML(
 			"CREATE TABLE IF NOT EXISTS filecontent("
 			"id INTERGER, "
+			"data_id INTEGER, "
 			"content TEXT, "
 			"PRIMARY KEY(id), "
 			"FOREIGN KEY(id) REFERENCES file(id)"
 			"ON DELETE CASCADE "
-			"ON UPDATE CASCADE);");
+			"ON UPDATE CASCADE, "
+			"FOREIGN KEY(data_id) REFERENCES filecontent_data(id));");
+
+		m_database.execDML(
+			"CREATE TRIGGER IF NOT EXISTS filecontent_data_cleanup "
+			"AFTER DELETE ON filecontent WHEN OLD.data_id IS NOT NULL "
+			"BEGIN "
+			"DELETE FROM filecontent_data WHERE id = OLD.data_id "
+			"AND NOT EXISTS(SELECT * FROM filecontent WHERE data_id = OLD.data_id); "
+			"END;");
 
 		m_database.execDML(
 			"CREATE TABLE IF NOT EXISTS local_symbol("
@@ -1343,6 +1742,12 @@ void SqliteIndexStorage::setupTables()
 			"translation_unit TEXT, "
 			"PRIMARY KEY(id), "
 			"FOREIGN KEY(id) REFERENCES element(id) ON DELETE CASCADE);");
+
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS indexing_translation_unit("
+			"path TEXT NOT NULL, "
+			"completed INTEGER NOT NULL, "
+			"PRIMARY KEY(path));");
 	}
 	catch (CppSQLite3Exception& e)
 	{
@@ -1362,7 +1767,7 @@ void SqliteIndexStorage::setupPrecompiledStatements()
 			[](CppSQLite3Statement& stmt, const StorageNode& node, size_t index) {
 				stmt.bind(int(index) * 3 + 1, int(node.id));
 				stmt.bind(int(index) * 3 + 2, int(node.type));
-				stmt.bind(int(index) * 3 + 3, utility::encodeToUtf8(node.serializedName).c_str());
+				stmt.bind(int(index) * 3 + 3, node.serializedName.c_str());
 			},
 			m_database);
 		m_insertEdgeBatchStatement.compile(
@@ -1427,8 +1832,11 @@ void SqliteIndexStorage::setupPrecompiledStatements()
 		m_insertFileStmt = m_database.compileStatement(
 			"INSERT INTO file(id, path, language, modification_time, indexed, complete, "
 			"line_count) VALUES(?, ?, ?, ?, ?, ?, ?);");
+		m_insertFileContentDataStmt = m_database.compileStatement(
+			"INSERT OR IGNORE INTO filecontent_data(hash, size, data) VALUES(?, ?, ?);");
 		m_insertFileContentStmt = m_database.compileStatement(
-			"INSERT INTO filecontent(id, content) VALUES(?, ?);");
+			"INSERT INTO filecontent(id, data_id) "
+			"SELECT ?, id FROM filecontent_data WHERE hash = ?;");
 		m_checkErrorExistsStmt = m_database.compileStatement(
 			"SELECT id FROM error WHERE "
 			"message = ? AND "
@@ -1448,15 +1856,71 @@ void SqliteIndexStorage::setupPrecompiledStatements()
 	}
 }
 
+void SqliteIndexStorage::executeQueryForIds(
+	const std::string& statementHead,
+	const std::vector<Id>& ids,
+	const std::string& statementTail,
+	std::function<size_t(CppSQLite3Query&)> func) const
+{
+	if (ids.empty())
+	{
+		return;
+	}
+
+	std::vector<Id> sortedIds = ids;
+	std::sort(sortedIds.begin(), sortedIds.end());
+	sortedIds.erase(std::unique(sortedIds.begin(), sortedIds.end()), sortedIds.end());
+
+	const size_t chunkSize = std::min(sortedIds.size(), s_maxBoundIdCount);
+
+	const std::string statement = statementHead + '(' +
+		utility::join(std::vector<std::string>(chunkSize, "?"), ',') + ')' + statementTail + ';';
+
+	CppSQLite3DB& database = getReadDatabase();
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &database);
+
+	try
+	{
+		CppSQLite3Statement stmt = database.compileStatement(statement.c_str());
+
+		for (size_t chunkStart = 0; chunkStart < sortedIds.size(); chunkStart += chunkSize)
+		{
+			// repeating the last id to fill up the last chunk does not change the result
+			for (size_t i = 0; i < chunkSize; i++)
+			{
+				stmt.bind(
+					int(i) + 1, int(sortedIds[std::min(chunkStart + i, sortedIds.size() - 1)]));
+			}
+
+			{
+				CppSQLite3Query q = stmt.execQuery();
+				scopedQuery.addRows(func(q));
+			}
+
+			stmt.reset();
+		}
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+	}
+}
+
 template <>
-void SqliteIndexStorage::forEach<StorageEdge>(
-	const std::string& query, std::function<void(StorageEdge&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageEdge>()
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, type, source_node_id, target_node_id FROM edge " + query + ";");
+	return "SELECT id, type, source_node_id, target_node_id FROM edge ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageEdge>(
+	CppSQLite3Query& q, std::function<void(StorageEdge&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const int type = q.getIntField(1, -1);
 		const Id sourceId = q.getIntField(2, 0);
@@ -1469,37 +1933,54 @@ void SqliteIndexStorage::forEach<StorageEdge>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageNode>(
-	const std::string& query, std::function<void(StorageNode&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageNode>()
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node " + query + ";");
+	return "SELECT id, type, serialized_name FROM node ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageNode>(
+	CppSQLite3Query& q, std::function<void(StorageNode&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const int type = q.getIntField(1, -1);
-		const std::string serializedName = q.getStringField(2, "");
 
 		if (id != 0 && type != -1)
 		{
-			func(StorageNode(id, type, utility::decodeFromUtf8(serializedName)));
+			func(StorageNode(id, type, q.getStringField(2, "")));
 		}
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageSymbol>(
-	const std::string& query, std::function<void(StorageSymbol&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageSymbol>()
 {
-	CppSQLite3Query q = executeQuery("SELECT id, definition_kind FROM symbol " + query + ";");
+	return "SELECT id, definition_kind FROM symbol ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageSymbol>(
+	CppSQLite3Query& q, std::function<void(StorageSymbol&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const int definitionKind = q.getIntField(1, 0);
 
@@ -1510,17 +1991,25 @@ void SqliteIndexStorage::forEach<StorageSymbol>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageFile>(
-	const std::string& query, std::function<void(StorageFile&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageFile>()
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, path, language, modification_time, indexed, complete FROM file " + query + ";");
+	return "SELECT id, path, language, modification_time, indexed, complete FROM file ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageFile>(
+	CppSQLite3Query& q, std::function<void(StorageFile&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const std::string filePath = q.getStringField(1, "");
 		const std::string languageIdentifier = q.getStringField(2, "");
@@ -1540,16 +2029,25 @@ void SqliteIndexStorage::forEach<StorageFile>(
 		}
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageLocalSymbol>(
-	const std::string& query, std::function<void(StorageLocalSymbol&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageLocalSymbol>()
 {
-	CppSQLite3Query q = executeQuery("SELECT id, name FROM local_symbol " + query + ";");
+	return "SELECT id, name FROM local_symbol ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageLocalSymbol>(
+	CppSQLite3Query& q, std::function<void(StorageLocalSymbol&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const std::string name = q.getStringField(1, "");
 
@@ -1560,19 +2058,26 @@ void SqliteIndexStorage::forEach<StorageLocalSymbol>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageSourceLocation>(
-	const std::string& query, std::function<void(StorageSourceLocation&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageSourceLocation>()
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, file_node_id, start_line, start_column, end_line, end_column, type FROM "
-		"source_location " +
-		query + ";");
+	return "SELECT id, file_node_id, start_line, start_column, end_line, end_column, type FROM "
+		   "source_location ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageSourceLocation>(
+	CppSQLite3Query& q, std::function<void(StorageSourceLocation&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const Id fileNodeId = q.getIntField(1, 0);
 		const int startLineNumber = q.getIntField(2, -1);
@@ -1590,17 +2095,25 @@ void SqliteIndexStorage::forEach<StorageSourceLocation>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageOccurrence>(
-	const std::string& query, std::function<void(StorageOccurrence&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageOccurrence>()
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT element_id, source_location_id FROM occurrence " + query + ";");
+	return "SELECT element_id, source_location_id FROM occurrence ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageOccurrence>(
+	CppSQLite3Query& q, std::function<void(StorageOccurrence&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id elementId = q.getIntField(0, 0);
 		const Id sourceLocationId = q.getIntField(1, 0);
 
@@ -1611,16 +2124,25 @@ void SqliteIndexStorage::forEach<StorageOccurrence>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageComponentAccess>(
-	const std::string& query, std::function<void(StorageComponentAccess&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageComponentAccess>()
 {
-	CppSQLite3Query q = executeQuery("SELECT node_id, type FROM component_access " + query + ";");
+	return "SELECT node_id, type FROM component_access ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageComponentAccess>(
+	CppSQLite3Query& q, std::function<void(StorageComponentAccess&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id nodeId = q.getIntField(0, 0);
 		const int type = q.getIntField(1, -1);
 
@@ -1631,17 +2153,25 @@ void SqliteIndexStorage::forEach<StorageComponentAccess>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageElementComponent>(
-	const std::string& query, std::function<void(StorageElementComponent&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageElementComponent>()
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT element_id, type, data FROM element_component " + query + ";");
+	return "SELECT element_id, type, data FROM element_component ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageElementComponent>(
+	CppSQLite3Query& q, std::function<void(StorageElementComponent&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id elementId = q.getIntField(0, 0);
 		const int type = q.getIntField(1, -1);
 		const std::string data = q.getStringField(2, "");
@@ -1653,17 +2183,25 @@ void SqliteIndexStorage::forEach<StorageElementComponent>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
 
 template <>
-void SqliteIndexStorage::forEach<StorageError>(
-	const std::string& query, std::function<void(StorageError&&)> func) const
+std::string SqliteIndexStorage::getSelectStatement<StorageError>()
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, message, fatal, indexed, translation_unit FROM error " + query + ";");
+	return "SELECT id, message, fatal, indexed, translation_unit FROM error ";
+}
 
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageError>(
+	CppSQLite3Query& q, std::function<void(StorageError&&)> func) const
+{
+	size_t rowCount = 0;
 	while (!q.eof())
 	{
+		rowCount++;
+
 		const Id id = q.getIntField(0, 0);
 		const std::string message = q.getStringField(1, "");
 		const bool fatal = q.getIntField(2, 0);
@@ -1682,4 +2220,6 @@ void SqliteIndexStorage::forEach<StorageError>(
 
 		q.nextRow();
 	}
+
+	return rowCount;
 }
@@ -2,6 +2,7 @@
 #define SQLITE_INDEX_STORAGE_H
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -9,6 +10,7 @@
 #include "LocationType.h"
 #include "LowMemoryStringMap.h"
 #include "SqliteDatabaseIndex.h"
+#include "SqliteQueryStatistics.h"
 #include "SqliteStorage.h"
 #include "StorageComponentAccess.h"
 #include "StorageEdge.h"
@@ -38,7 +40,8 @@ public:
 	{
 		STORAGE_MODE_READ = 1,
 		STORAGE_MODE_WRITE = 2,
-		STORAGE_MODE_CLEAR = 4
+		STORAGE_MODE_CLEAR = 4,
+		STORAGE_MODE_MERGE = 8
 	};
 
 	SqliteIndexStorage(const FilePath& dbFilePath);
@@ -69,6 +72,11 @@ public:
 	void addElementComponents(const std::vector<StorageElementComponent>& components);
 	StorageError addError(const StorageErrorData& data);
 
+	// copies all data of another index database into this one within the database engine, so the
+	// memory use does not depend on the size of the merged database. Runs its own transaction, the
+	// storage should be in merge mode.
+	bool mergeDatabase(const FilePath& sourceDbFilePath);
+
 	void removeElement(Id id);
 	void removeElements(const std::vector<Id>& ids);
 	void removeOccurrence(const StorageOccurrence& occurrence);
@@ -99,7 +107,7 @@ public:
 	std::vector<StorageEdge> getEdgesByTargetsType(const std::vector<Id>& targetIds, int type) const;
 
 	StorageNode getNodeById(Id id) const;
-	StorageNode getNodeBySerializedName(const std::wstring& serializedName) const;
+	StorageNode getNodeBySerializedName(const std::string& serializedName) const;
 
 	std::vector<int> getAvailableNodeTypes() const;
 	std::vector<int> getAvailableEdgeTypes() const;
@@ -109,11 +117,20 @@ public:
 	std::vector<StorageFile> getFilesByPaths(const std::vector<FilePath>& filePaths) const;
 	std::shared_ptr<TextAccess> getFileContentByPath(const std::wstring& filePath) const;
 	std::shared_ptr<TextAccess> getFileContentById(Id fileId) const;
+	std::string getFileContentTextById(Id fileId) const;
+	bool hasFileContentForPath(const std::wstring& filePath) const;
 
 	void setFileIndexed(Id fileId, bool indexed);
 	void setFileCompleteIfNoError(Id fileId, const std::wstring& filePath, bool complete);
 	void setNodeType(int type, Id nodeId);
 
+	// translation units of an indexing run are kept until the run finished, so an interrupted run
+	// can be continued later on
+	void setIndexingTranslationUnits(const std::set<std::wstring>& filePaths);
+	void setTranslationUnitsCompleted(const std::set<std::wstring>& filePaths);
+	std::set<std::wstring> getIndexingTranslationUnits(bool completed) const;
+	void clearIndexingTranslationUnits();
+
 	std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(
 		const FilePath& filePath, const std::string& query = "") const;
 	std::shared_ptr<SourceLocationFile> getSourceLocationsForLinesInFile(
@@ -156,12 +173,7 @@ public:
 	template <typename ResultType>
 	std::vector<ResultType> getAllByIds(const std::vector<Id>& ids) const
 	{
-		if (ids.size())
-		{
-			return doGetAll<ResultType>(
-				"WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")");
-		}
-		return std::vector<ResultType>();
+		return doGetAllByIds<ResultType>("id", ids);
 	}
 
 	template <typename StorageType>
@@ -176,15 +188,25 @@ public:
 		forEach("WHERE type == " + std::to_string(type), func);
 	}
 
+	template <typename StorageType>
+	void forEachAfterId(Id id, std::function<void(StorageType&&)> func) const
+	{
+		forEach("WHERE id > " + std::to_string(id), func);
+	}
+
+	template <typename StorageType>
+	void forEachOfTypeAfterId(int type, Id id, std::function<void(StorageType&&)> func) const
+	{
+		forEach("WHERE type == " + std::to_string(type) + " AND id > " + std::to_string(id), func);
+	}
+
 	template <typename StorageType>
 	void forEachByIds(const std::vector<Id> ids, std::function<void(StorageType&&)> func) const
 	{
-		if (ids.size())
-		{
-			forEach("WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")", func);
-		}
+		forEachByIds("id", ids, "", func);
 	}
 
+	Id getLastElementId() const;
 	int getNodeCount() const;
 	int getEdgeCount() const;
 	int getFileCount() const;
@@ -195,6 +217,7 @@ public:
 
 private:
 	static const size_t s_storageVersion;
+	static const size_t s_maxBoundIdCount;
 
 	struct TempSourceLocation
 	{
@@ -236,6 +259,15 @@ private:
 	};
 
 	std::vector<std::pair<int, SqliteDatabaseIndex>> getIndices() const;
+	void clearTempIndices();
+
+	bool addFileContent(
+		Id fileId,
+		const std::string& content,
+		CppSQLite3Statement& insertDataStmt,
+		CppSQLite3Statement& insertStmt);
+	// compresses the plain file contents written by other tools
+	bool compressPlainFileContents();
 
 	virtual void clearTables();
 	virtual void setupTables();
@@ -261,11 +293,60 @@ private:
 		return ResultType();
 	}
 
+	template <typename ResultType>
+	std::vector<ResultType> doGetAllByIds(
+		const std::string& idColumnName,
+		const std::vector<Id>& ids,
+		const std::string& condition = "") const
+	{
+		std::vector<ResultType> elements;
+		forEachByIds<ResultType>(idColumnName, ids, condition, [&elements](ResultType&& element) {
+			elements.emplace_back(element);
+		});
+		return elements;
+	}
+
 	template <typename StorageType>
-	void forEach(const std::string& query, std::function<void(StorageType&&)> func) const;
+	void forEach(const std::string& query, std::function<void(StorageType&&)> func) const
+	{
+		const std::string statement = getSelectStatement<StorageType>() + query + ";";
+		SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &getReadDatabase());
+
+		CppSQLite3Query q = executeQuery(statement);
+		scopedQuery.addRows(forEachRow(q, func));
+	}
+
+	template <typename StorageType>
+	void forEachByIds(
+		const std::string& idColumnName,
+		const std::vector<Id>& ids,
+		const std::string& condition,
+		std::function<void(StorageType&&)> func) const
+	{
+		executeQueryForIds(
+			getSelectStatement<StorageType>() + "WHERE " + idColumnName + " IN ",
+			ids,
+			condition,
+			[this, &func](CppSQLite3Query& q) { return forEachRow(q, func); });
+	}
+
+	// Runs "statementHead (?, ?, ...) statementTail" for chunks of the ids with a single prepared
+	// statement that binds the ids, instead of parsing a new statement containing all ids.
+	// Duplicate ids are only queried once. func returns the number of visited rows.
+	void executeQueryForIds(
+		const std::string& statementHead,
+		const std::vector<Id>& ids,
+		const std::string& statementTail,
+		std::function<size_t(CppSQLite3Query&)> func) const;
+
+	template <typename StorageType>
+	static std::string getSelectStatement();
+
+	// returns the number of visited rows
+	template <typename StorageType>
+	size_t forEachRow(CppSQLite3Query& q, std::function<void(StorageType&&)> func) const;
 
 	LowMemoryStringMap<std::string, uint32_t, 0> m_tempNodeNameIndex;
-	LowMemoryStringMap<std::wstring, uint32_t, 0> m_tempWNodeNameIndex;
 	std::map<uint32_t, int> m_tempNodeTypes;
 	std::map<StorageEdgeData, uint32_t> m_tempEdgeIndex;
 	std::map<std::wstring, std::map<std::wstring, uint32_t>> m_tempLocalSymbolIndex;
@@ -363,40 +444,61 @@ private:
 	CppSQLite3Statement m_insertElementStmt;
 	CppSQLite3Statement m_insertElementComponentStmt;
 	CppSQLite3Statement m_insertFileStmt;
+	CppSQLite3Statement m_insertFileContentDataStmt;
 	CppSQLite3Statement m_insertFileContentStmt;
 	CppSQLite3Statement m_checkErrorExistsStmt;
 	CppSQLite3Statement m_insertErrorStmt;
 };
 
 template <>
-void SqliteIndexStorage::forEach<StorageEdge>(
-	const std::string& query, std::function<void(StorageEdge&&)> func) const;
+std::string SqliteIndexStorage::getSelectStatement<StorageEdge>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageNode>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageSymbol>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageFile>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageLocalSymbol>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageSourceLocation>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageOccurrence>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageComponentAccess>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageElementComponent>();
+template <>
+std::string SqliteIndexStorage::getSelectStatement<StorageError>();
+template <>
+size_t SqliteIndexStorage::forEachRow<StorageEdge>(
+	CppSQLite3Query& q, std::function<void(StorageEdge&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageNode>(
-	const std::string& query, std::function<void(StorageNode&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageNode>(
+	CppSQLite3Query& q, std::function<void(StorageNode&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageSymbol>(
-	const std::string& query, std::function<void(StorageSymbol&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageSymbol>(
+	CppSQLite3Query& q, std::function<void(StorageSymbol&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageFile>(
-	const std::string& query, std::function<void(StorageFile&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageFile>(
+	CppSQLite3Query& q, std::function<void(StorageFile&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageLocalSymbol>(
-	const std::string& query, std::function<void(StorageLocalSymbol&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageLocalSymbol>(
+	CppSQLite3Query& q, std::function<void(StorageLocalSymbol&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageSourceLocation>(
-	const std::string& query, std::function<void(StorageSourceLocation&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageSourceLocation>(
+	CppSQLite3Query& q, std::function<void(StorageSourceLocation&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageOccurrence>(
-	const std::string& query, std::function<void(StorageOccurrence&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageOccurrence>(
+	CppSQLite3Query& q, std::function<void(StorageOccurrence&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageComponentAccess>(
-	const std::string& query, std::function<void(StorageComponentAccess&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageComponentAccess>(
+	CppSQLite3Query& q, std::function<void(StorageComponentAccess&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageElementComponent>(
-	const std::string& query, std::function<void(StorageElementComponent&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageElementComponent>(
+	CppSQLite3Query& q, std::function<void(StorageElementComponent&&)> func) const;
 template <>
-void SqliteIndexStorage::forEach<StorageError>(
-	const std::string& query, std::function<void(StorageError&&)> func) const;
+size_t SqliteIndexStorage::forEachRow<StorageError>(
+	CppSQLite3Query& q, std::function<void(StorageError&&)> func) const;
 
 #endif	  // SQLITE_INDEX_STORAGE_H
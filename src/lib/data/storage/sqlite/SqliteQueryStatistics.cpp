@@ -0,0 +1,464 @@
+#include "SqliteQueryStatistics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+#include "CppSQLite3.h"
+
+#include "logging.h"
+
+struct SqliteQueryStatistics::ThreadStats
+{
+	// only contended while a report is created or the statistics get cleared
+	std::mutex mutex;
+	std::unordered_map<std::string, QueryStats> queries;
+
+	// sql and normalized sql of the prepared statements executed on this thread, only accessed by
+	// the owning thread
+	std::unordered_map<const CppSQLite3Statement*, std::pair<std::string, std::string>>
+		preparedStatements;
+};
+
+// created on startup, because statements are executed on several threads
+std::shared_ptr<SqliteQueryStatistics> SqliteQueryStatistics::s_instance(
+	new SqliteQueryStatistics());
+std::atomic<bool> SqliteQueryStatistics::s_enabled(false);
+const std::vector<size_t> SqliteQueryStatistics::s_histogramBucketLimitsMs = {
+	1, 4, 16, 64, 256, 1024};
+
+SqliteQueryStatistics::ScopedQuery::ScopedQuery(
+	const std::string& statement, CppSQLite3DB* database)
+	: m_recording(SqliteQueryStatistics::isEnabled())
+	, m_statement(&statement)
+	, m_preparedStatement(nullptr)
+	, m_database(database)
+	, m_rowCount(0)
+{
+	if (m_recording)
+	{
+		m_startTime = std::chrono::steady_clock::now();
+	}
+}
+
+SqliteQueryStatistics::ScopedQuery::ScopedQuery(
+	CppSQLite3Statement& statement, CppSQLite3DB* database)
+	: m_recording(SqliteQueryStatistics::isEnabled())
+	, m_statement(nullptr)
+	, m_preparedStatement(&statement)
+	, m_database(database)
+	, m_rowCount(0)
+{
+	if (m_recording)
+	{
+		m_startTime = std::chrono::steady_clock::now();
+	}
+}
+
+SqliteQueryStatistics::ScopedQuery::~ScopedQuery()
+{
+	if (!m_recording)
+	{
+		return;
+	}
+
+	const size_t durationMicroseconds = static_cast<size_t>(
+		std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - m_startTime)
+			.count());
+
+	if (m_preparedStatement)
+	{
+		SqliteQueryStatistics::getInstance()->addPreparedQuery(
+			*m_preparedStatement, durationMicroseconds, m_rowCount, m_database);
+	}
+	else
+	{
+		SqliteQueryStatistics::getInstance()->addQuery(
+			*m_statement, durationMicroseconds, m_rowCount, m_database);
+	}
+}
+
+void SqliteQueryStatistics::ScopedQuery::addRows(size_t rowCount)
+{
+	m_rowCount += rowCount;
+}
+
+SqliteQueryStatistics* SqliteQueryStatistics::getInstance()
+{
+	return s_instance.get();
+}
+
+std::string SqliteQueryStatistics::normalizeStatement(const std::string& statement)
+{
+	std::string normalized;
+	normalized.reserve(statement.size());
+
+	auto appendPlaceholder = [&normalized]() {
+		// lists of literals like "IN (1, 2, 3)" are collapsed into a single placeholder
+		const size_t commaPos = normalized.find_last_not_of(' ');
+		if (commaPos != std::string::npos && commaPos > 0 && normalized[commaPos] == ',')
+		{
+			const size_t placeholderPos = normalized.find_last_not_of(' ', commaPos - 1);
+			if (placeholderPos != std::string::npos && normalized[placeholderPos] == '?')
+			{
+				normalized.resize(placeholderPos + 1);
+				return;
+			}
+		}
+		normalized.push_back('?');
+	};
+
+	for (size_t i = 0; i < statement.size(); i++)
+	{
+		const char c = statement[i];
+		if (c == '\'')
+		{
+			for (i++; i < statement.size(); i++)
+			{
+				if (statement[i] == '\'')
+				{
+					if (i + 1 < statement.size() && statement[i + 1] == '\'')
+					{
+						i++;	// escaped quote
+						continue;
+					}
+					break;
+				}
+			}
+			appendPlaceholder();
+		}
+		else if (
+			std::isdigit(static_cast<unsigned char>(c)) &&
+			(normalized.empty() ||
+			 (!std::isalnum(static_cast<unsigned char>(normalized.back())) &&
+			  normalized.back() != '_')))
+		{
+			while (i + 1 < statement.size() &&
+				   (std::isalnum(static_cast<unsigned char>(statement[i + 1])) ||
+					statement[i + 1] == '.'))
+			{
+				i++;
+			}
+			appendPlaceholder();
+		}
+		else if (c == '?')
+		{
+			appendPlaceholder();
+		}
+		else
+		{
+			normalized.push_back(c);
+		}
+	}
+
+	return normalized;
+}
+
+void SqliteQueryStatistics::setEnabled(bool enabled)
+{
+	if (s_enabled.exchange(enabled) != enabled)
+	{
+		LOG_INFO(std::string("Query statistics ") + (enabled ? "enabled" : "disabled"));
+	}
+}
+
+void SqliteQueryStatistics::setSlowQueryThresholdMs(size_t thresholdMs)
+{
+	m_slowQueryThresholdMs = thresholdMs;
+}
+
+size_t SqliteQueryStatistics::getSlowQueryThresholdMs() const
+{
+	return m_slowQueryThresholdMs;
+}
+
+void SqliteQueryStatistics::addQuery(
+	const std::string& statement,
+	size_t durationMicroseconds,
+	size_t rowCount,
+	CppSQLite3DB* database)
+{
+	addNormalizedQuery(
+		getThreadStats(),
+		normalizeStatement(statement),
+		statement,
+		durationMicroseconds,
+		rowCount,
+		database);
+}
+
+void SqliteQueryStatistics::addPreparedQuery(
+	CppSQLite3Statement& statement,
+	size_t durationMicroseconds,
+	size_t rowCount,
+	CppSQLite3DB* database)
+{
+	const char* sql = statement.getSql();
+	if (!sql)
+	{
+		return;
+	}
+
+	ThreadStats* threadStats = getThreadStats();
+
+	// statements can be recompiled at the same address, so the sql is compared without copying it
+	std::pair<std::string, std::string>& sqls = threadStats->preparedStatements[&statement];
+	if (sqls.first != sql)
+	{
+		sqls.first = sql;
+		sqls.second = normalizeStatement(sqls.first);
+	}
+
+	addNormalizedQuery(
+		threadStats, sqls.second, sqls.first, durationMicroseconds, rowCount, database);
+}
+
+std::string SqliteQueryStatistics::getReport() const
+{
+	std::vector<std::shared_ptr<ThreadStats>> threadStatsList;
+	std::map<std::string, std::vector<std::string>> queryPlans;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		threadStatsList = m_threadStats;
+		queryPlans = m_queryPlans;
+	}
+
+	std::map<std::string, QueryStats> mergedQueries;
+	for (const std::shared_ptr<ThreadStats>& threadStats: threadStatsList)
+	{
+		std::lock_guard<std::mutex> lock(threadStats->mutex);
+		for (const auto& p: threadStats->queries)
+		{
+			QueryStats& stats = mergedQueries[p.first];
+			if (stats.histogram.empty())
+			{
+				stats.histogram.resize(p.second.histogram.size(), 0);
+			}
+
+			stats.count += p.second.count;
+			stats.rowCount += p.second.rowCount;
+			stats.totalMicroseconds += p.second.totalMicroseconds;
+			stats.maxMicroseconds = std::max(stats.maxMicroseconds, p.second.maxMicroseconds);
+			for (size_t i = 0; i < p.second.histogram.size(); i++)
+			{
+				stats.histogram[i] += p.second.histogram[i];
+			}
+		}
+	}
+
+	std::vector<std::pair<const std::string*, const QueryStats*>> queries;
+	for (const auto& p: mergedQueries)
+	{
+		queries.emplace_back(&p.first, &p.second);
+	}
+
+	std::sort(queries.begin(), queries.end(), [](const auto& a, const auto& b) {
+		return a.second->totalMicroseconds > b.second->totalMicroseconds;
+	});
+
+	const size_t slowQueryThresholdMs = m_slowQueryThresholdMs;
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "SQLite query statistics of " << queries.size() << " statements\n";
+
+	if (!isEnabled())
+	{
+		ss << "Collecting query statistics is disabled\n";
+	}
+
+	if (slowQueryThresholdMs > 0)
+	{
+		ss << "Query plans are captured for statements slower than " << slowQueryThresholdMs
+		   << " ms\n";
+	}
+	else
+	{
+		ss << "Capturing query plans is disabled\n";
+	}
+
+	ss << "Duration histogram buckets:";
+	for (size_t limit: s_histogramBucketLimitsMs)
+	{
+		ss << " <" << limit << "ms";
+	}
+	ss << " >=" << s_histogramBucketLimitsMs.back() << "ms\n";
+
+	std::vector<const std::string*> tableScanStatements;
+
+	for (const auto& query: queries)
+	{
+		const QueryStats& stats = *query.second;
+
+		ss << "\n"
+		   << stats.count << " calls, " << stats.totalMicroseconds / 1000.0 << " ms total, "
+		   << stats.totalMicroseconds / 1000.0 / stats.count << " ms average, "
+		   << stats.maxMicroseconds / 1000.0 << " ms max, " << stats.rowCount << " rows\n";
+
+		ss << "\thistogram:";
+		for (size_t count: stats.histogram)
+		{
+			ss << " " << count;
+		}
+		ss << "\n";
+
+		ss << "\t" << *query.first << "\n";
+
+		auto it = queryPlans.find(*query.first);
+		if (it != queryPlans.end() && !it->second.empty())
+		{
+			bool scansTable = false;
+
+			ss << "\tquery plan:\n";
+			for (const std::string& detail: it->second)
+			{
+				ss << "\t\t" << detail;
+				if (isTableScan(detail))
+				{
+					ss << " (no index used)";
+					scansTable = true;
+				}
+				ss << "\n";
+			}
+
+			if (scansTable)
+			{
+				tableScanStatements.push_back(query.first);
+			}
+		}
+	}
+
+	if (!tableScanStatements.empty())
+	{
+		ss << "\nSlow statements scanning tables without using an index:\n";
+		for (const std::string* statement: tableScanStatements)
+		{
+			ss << "\t" << *statement << "\n";
+		}
+	}
+
+	return ss.str();
+}
+
+void SqliteQueryStatistics::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const std::shared_ptr<ThreadStats>& threadStats: m_threadStats)
+	{
+		std::lock_guard<std::mutex> threadLock(threadStats->mutex);
+		threadStats->queries.clear();
+	}
+	m_queryPlans.clear();
+}
+
+std::vector<std::string> SqliteQueryStatistics::getQueryPlan(
+	const std::string& statement, CppSQLite3DB* database)
+{
+	std::vector<std::string> queryPlan;
+
+	try
+	{
+		CppSQLite3Query q = database->execQuery(("EXPLAIN QUERY PLAN " + statement).c_str());
+		while (!q.eof())
+		{
+			queryPlan.push_back(q.getStringField(3, ""));
+			q.nextRow();
+		}
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_WARNING(
+			"Capturing query plan failed: " + std::to_string(e.errorCode()) + ": " +
+			e.errorMessage());
+	}
+
+	return queryPlan;
+}
+
+bool SqliteQueryStatistics::isTableScan(const std::string& queryPlanDetail)
+{
+	return queryPlanDetail.compare(0, 5, "SCAN ") == 0 &&
+		queryPlanDetail.find("INDEX") == std::string::npos &&
+		queryPlanDetail.find("PRIMARY KEY") == std::string::npos &&
+		queryPlanDetail.find("SUBQUERY") == std::string::npos &&
+		queryPlanDetail.find("CONSTANT ROW") == std::string::npos;
+}
+
+SqliteQueryStatistics::SqliteQueryStatistics(): m_slowQueryThresholdMs(0) {}
+
+SqliteQueryStatistics::ThreadStats* SqliteQueryStatistics::getThreadStats()
+{
+	thread_local std::shared_ptr<ThreadStats> threadStats;
+
+	if (!threadStats)
+	{
+		threadStats = std::make_shared<ThreadStats>();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threadStats.push_back(threadStats);
+	}
+
+	return threadStats.get();
+}
+
+void SqliteQueryStatistics::addNormalizedQuery(
+	ThreadStats* threadStats,
+	const std::string& normalizedStatement,
+	const std::string& statement,
+	size_t durationMicroseconds,
+	size_t rowCount,
+	CppSQLite3DB* database)
+{
+	const size_t slowQueryThresholdMs = m_slowQueryThresholdMs.load(std::memory_order_relaxed);
+	bool captureQueryPlan = false;
+
+	{
+		std::lock_guard<std::mutex> lock(threadStats->mutex);
+
+		QueryStats& stats = threadStats->queries[normalizedStatement];
+		if (stats.histogram.empty())
+		{
+			stats.histogram.resize(s_histogramBucketLimitsMs.size() + 1, 0);
+		}
+
+		stats.count++;
+		stats.rowCount += rowCount;
+		stats.totalMicroseconds += durationMicroseconds;
+		stats.maxMicroseconds = std::max(stats.maxMicroseconds, durationMicroseconds);
+
+		size_t bucket = 0;
+		while (bucket < s_histogramBucketLimitsMs.size() &&
+			   durationMicroseconds >= s_histogramBucketLimitsMs[bucket] * 1000)
+		{
+			bucket++;
+		}
+		stats.histogram[bucket]++;
+
+		if (slowQueryThresholdMs > 0 && database && !stats.queryPlanRequested &&
+			durationMicroseconds >= slowQueryThresholdMs * 1000)
+		{
+			stats.queryPlanRequested = true;
+			captureQueryPlan = true;
+		}
+	}
+
+	if (captureQueryPlan)
+	{
+		{
+			// another thread may have captured the plan already
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_queryPlans.emplace(normalizedStatement, std::vector<std::string>()).second)
+			{
+				return;
+			}
+		}
+
+		std::vector<std::string> queryPlan = getQueryPlan(statement, database);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queryPlans[normalizedStatement] = std::move(queryPlan);
+	}
+}
@@ -0,0 +1,117 @@
+#ifndef SQLITE_QUERY_STATISTICS_H
+#define SQLITE_QUERY_STATISTICS_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class CppSQLite3DB;
+class CppSQLite3Statement;
+
+// Collects execution counts, latencies and row counts of the statements run on the sqlite
+// storages, grouped by statement with all literals replaced by "?". If a slow query threshold is
+// set, the query plan of every statement exceeding it is captured once. Collecting is switched on
+// at runtime, while disabled a statement only costs a check of the flag. Every thread accumulates
+// into its own statistics, which are only locked by other threads while creating a report.
+class SqliteQueryStatistics
+{
+public:
+	class ScopedQuery
+	{
+	public:
+		// the statement needs to outlive the scoped query
+		ScopedQuery(const std::string& statement, CppSQLite3DB* database);
+		ScopedQuery(CppSQLite3Statement& statement, CppSQLite3DB* database);
+		~ScopedQuery();
+
+		void addRows(size_t rowCount);
+
+	private:
+		const bool m_recording;
+		const std::string* m_statement;
+		CppSQLite3Statement* m_preparedStatement;
+		CppSQLite3DB* m_database;
+		size_t m_rowCount;
+		std::chrono::steady_clock::time_point m_startTime;
+	};
+
+	static SqliteQueryStatistics* getInstance();
+
+	static bool isEnabled()
+	{
+		return s_enabled.load(std::memory_order_relaxed);
+	}
+
+	static std::string normalizeStatement(const std::string& statement);
+
+	void setEnabled(bool enabled);
+
+	// 0 disables capturing query plans
+	void setSlowQueryThresholdMs(size_t thresholdMs);
+	size_t getSlowQueryThresholdMs() const;
+
+	void addQuery(
+		const std::string& statement,
+		size_t durationMicroseconds,
+		size_t rowCount,
+		CppSQLite3DB* database);
+
+	// normalizes the sql of each prepared statement only once per thread
+	void addPreparedQuery(
+		CppSQLite3Statement& statement,
+		size_t durationMicroseconds,
+		size_t rowCount,
+		CppSQLite3DB* database);
+
+	// statements sorted by total duration, statements whose plan scans a table without using an
+	// index are listed separately
+	std::string getReport() const;
+
+	void clear();
+
+private:
+	struct QueryStats
+	{
+		size_t count = 0;
+		size_t rowCount = 0;
+		size_t totalMicroseconds = 0;
+		size_t maxMicroseconds = 0;
+		std::vector<size_t> histogram;
+		bool queryPlanRequested = false;
+	};
+
+	struct ThreadStats;
+
+	static std::vector<std::string> getQueryPlan(
+		const std::string& statement, CppSQLite3DB* database);
+	static bool isTableScan(const std::string& queryPlanDetail);
+
+	static std::shared_ptr<SqliteQueryStatistics> s_instance;
+	static std::atomic<bool> s_enabled;
+	static const std::vector<size_t> s_histogramBucketLimitsMs;
+
+	SqliteQueryStatistics();
+	SqliteQueryStatistics(const SqliteQueryStatistics&) = delete;
+	void operator=(const SqliteQueryStatistics&) = delete;
+
+	ThreadStats* getThreadStats();
+
+	void addNormalizedQuery(
+		ThreadStats* threadStats,
+		const std::string& normalizedStatement,
+		const std::string& statement,
+		size_t durationMicroseconds,
+		size_t rowCount,
+		CppSQLite3DB* database);
+
+	std::vector<std::shared_ptr<ThreadStats>> m_threadStats;
+	std::map<std::string, std::vector<std::string>> m_queryPlans;
+	std::atomic<size_t> m_slowQueryThresholdMs;
+	mutable std::mutex m_mutex;
+};
+
+#endif	  // SQLITE_QUERY_STATISTICS_H
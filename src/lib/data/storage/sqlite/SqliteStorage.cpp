@@ -1,10 +1,24 @@
 #include "SqliteStorage.h"
 
+#include <atomic>
+
 #include "FileSystem.h"
+#include "SqliteQueryStatistics.h"
 #include "TimeStamp.h"
 #include "logging.h"
 #include "utilityString.h"
 
+namespace
+{
+// index assigned to each thread on its first read, so no per thread state outlives the thread
+size_t getThreadIndex()
+{
+	static std::atomic<size_t> s_nextThreadIndex(0);
+	thread_local const size_t threadIndex = s_nextThreadIndex++;
+	return threadIndex;
+}
+}	 // namespace
+
 SqliteStorage::SqliteStorage(const FilePath& dbFilePath): m_dbFilePath(dbFilePath.getCanonical())
 {
 	if (!m_dbFilePath.getParentDirectory().empty() && !m_dbFilePath.getParentDirectory().exists())
@@ -29,6 +43,8 @@ SqliteStorage::SqliteStorage(const FilePath& dbFilePath): m_dbFilePath(dbFilePat
 
 SqliteStorage::~SqliteStorage()
 {
+	setReadConnectionCount(0);
+
 	try
 	{
 		m_database.close();
@@ -84,17 +100,28 @@ void SqliteStorage::setVersion(size_t version)
 
 void SqliteStorage::beginTransaction()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_readDatabasesMutex);
+		m_transactionThreadId = std::this_thread::get_id();
+	}
+
 	executeStatement("BEGIN TRANSACTION;");
 }
 
 void SqliteStorage::commitTransaction()
 {
 	executeStatement("COMMIT TRANSACTION;");
+
+	std::lock_guard<std::mutex> lock(m_readDatabasesMutex);
+	m_transactionThreadId = std::thread::id();
 }
 
 void SqliteStorage::rollbackTransaction()
 {
 	executeStatement("ROLLBACK TRANSACTION;");
+
+	std::lock_guard<std::mutex> lock(m_readDatabasesMutex);
+	m_transactionThreadId = std::thread::id();
 }
 
 void SqliteStorage::optimizeMemory() const
@@ -102,6 +129,48 @@ void SqliteStorage::optimizeMemory() const
 	executeStatement("VACUUM;");
 }
 
+void SqliteStorage::setWriteAheadLogEnabled(bool enabled)
+{
+	executeStatement(enabled ? "PRAGMA journal_mode=WAL;" : "PRAGMA journal_mode=DELETE;");
+}
+
+void SqliteStorage::setReadOnly()
+{
+	executeStatement("PRAGMA query_only=ON;");
+}
+
+void SqliteStorage::setReadConnectionCount(size_t count)
+{
+	std::lock_guard<std::mutex> lock(m_readDatabasesMutex);
+
+	m_readDatabases.clear();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		std::shared_ptr<CppSQLite3DB> database = std::make_shared<CppSQLite3DB>();
+		try
+		{
+			database->open(utility::encodeToUtf8(m_dbFilePath.wstr()).c_str());
+			database->execDML("PRAGMA query_only=ON;");
+		}
+		catch (CppSQLite3Exception& e)
+		{
+			LOG_ERROR(
+				L"Failed to open read connection to database file \"" + m_dbFilePath.wstr() +
+				L"\" with message: " + utility::decodeFromUtf8(e.errorMessage()));
+			break;
+		}
+
+		m_readDatabases.push_back(database);
+	}
+}
+
+size_t SqliteStorage::getReadConnectionCount() const
+{
+	std::lock_guard<std::mutex> lock(m_readDatabasesMutex);
+	return m_readDatabases.size();
+}
+
 FilePath SqliteStorage::getDbFilePath() const
 {
 	return m_dbFilePath;
@@ -167,9 +236,10 @@ void SqliteStorage::clearMetaTable()
 
 bool SqliteStorage::executeStatement(const std::string& statement) const
 {
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &m_database);
 	try
 	{
-		m_database.execDML(statement.c_str());
+		scopedQuery.addRows(m_database.execDML(statement.c_str()));
 	}
 	catch (CppSQLite3Exception e)
 	{
@@ -181,9 +251,10 @@ bool SqliteStorage::executeStatement(const std::string& statement) const
 
 bool SqliteStorage::executeStatement(CppSQLite3Statement& statement) const
 {
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &m_database);
 	try
 	{
-		statement.execDML();
+		scopedQuery.addRows(statement.execDML());
 	}
 	catch (CppSQLite3Exception e)
 	{
@@ -197,10 +268,14 @@ bool SqliteStorage::executeStatement(CppSQLite3Statement& statement) const
 
 int SqliteStorage::executeStatementScalar(const std::string& statement, const int nullValue) const
 {
+	CppSQLite3DB& database = getReadDatabase();
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &database);
+
 	int ret = 0;
 	try
 	{
-		ret = m_database.execScalar(statement.c_str(), nullValue);
+		ret = database.execScalar(statement.c_str(), nullValue);
+		scopedQuery.addRows(1);
 	}
 	catch (CppSQLite3Exception e)
 	{
@@ -236,7 +311,7 @@ CppSQLite3Query SqliteStorage::executeQuery(const std::string& statement) const
 {
 	try
 	{
-		return m_database.execQuery(statement.c_str());
+		return getReadDatabase().execQuery(statement.c_str());
 	}
 	catch (CppSQLite3Exception e)
 	{
@@ -247,9 +322,13 @@ CppSQLite3Query SqliteStorage::executeQuery(const std::string& statement) const
 
 CppSQLite3Query SqliteStorage::executeQuery(CppSQLite3Statement& statement) const
 {
+	// prepared queries only look up single rows, so executing the first step is the whole query
+	SqliteQueryStatistics::ScopedQuery scopedQuery(statement, &m_database);
 	try
 	{
-		return statement.execQuery();
+		CppSQLite3Query q = statement.execQuery();
+		scopedQuery.addRows(q.eof() ? 0 : 1);
+		return q;
 	}
 	catch (CppSQLite3Exception e)
 	{
@@ -271,6 +350,19 @@ bool SqliteStorage::hasTable(const std::string& tableName) const
 	return false;
 }
 
+CppSQLite3DB& SqliteStorage::getReadDatabase() const
+{
+	std::lock_guard<std::mutex> lock(m_readDatabasesMutex);
+
+	const std::thread::id threadId = std::this_thread::get_id();
+	if (m_readDatabases.empty() || threadId == m_transactionThreadId)
+	{
+		return m_database;
+	}
+
+	return *m_readDatabases[getThreadIndex() % m_readDatabases.size()];
+}
+
 std::string SqliteStorage::getMetaValue(const std::string& key) const
 {
 	if (hasTable("meta"))
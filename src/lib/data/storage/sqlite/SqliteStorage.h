@@ -1,6 +1,11 @@
 #ifndef SQLITE_STORAGE_H
 #define SQLITE_STORAGE_H
 
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "CppSQLite3.h"
 
 #include "FilePath.h"
@@ -27,6 +32,17 @@ public:
 
 	void optimizeMemory() const;
 
+	// allows reading from other connections while this one is writing
+	void setWriteAheadLogEnabled(bool enabled);
+
+	// rejects all writes on the main connection
+	void setReadOnly();
+
+	// opens read-only connections that queries from different threads are spread across, must not
+	// be called while other threads are accessing the storage
+	void setReadConnectionCount(size_t count);
+	size_t getReadConnectionCount() const;
+
 	FilePath getDbFilePath() const;
 
 	bool isEmpty() const;
@@ -48,6 +64,10 @@ protected:
 
 	bool hasTable(const std::string& tableName) const;
 
+	// connection used for reading on the calling thread, which is the writing connection if this
+	// thread has started a transaction
+	CppSQLite3DB& getReadDatabase() const;
+
 	std::string getMetaValue(const std::string& key) const;
 	void insertOrUpdateMetaValue(const std::string& key, const std::string& value);
 
@@ -64,6 +84,10 @@ private:
 
 	bool m_precompiledStatementsInitialized = false;
 
+	std::vector<std::shared_ptr<CppSQLite3DB>> m_readDatabases;
+	std::thread::id m_transactionThreadId;
+	mutable std::mutex m_readDatabasesMutex;
+
 	friend SqliteStorageMigration;
 };
 
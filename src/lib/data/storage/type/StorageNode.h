@@ -7,9 +7,9 @@
 
 struct StorageNodeData
 {
-	StorageNodeData(): type(0), serializedName(L"") {}
+	StorageNodeData(): type(0), serializedName("") {}
 
-	StorageNodeData(int type, std::wstring serializedName)
+	StorageNodeData(int type, std::string serializedName)
 		: type(type), serializedName(std::move(serializedName))
 	{
 	}
@@ -20,14 +20,14 @@ struct StorageNodeData
 	}
 
 	int type;
-	std::wstring serializedName;
+	std::string serializedName;	   // utf-8 encoded, see NameHierarchy::serialize
 };
 
 struct StorageNode: public StorageNodeData
 {
 	StorageNode(): StorageNodeData(), id(0) {}
 
-	StorageNode(Id id, int type, std::wstring serializedName)
+	StorageNode(Id id, int type, std::string serializedName)
 		: StorageNodeData(type, std::move(serializedName)), id(id)
 	{
 	}
@@ -3,8 +3,10 @@
 #include "ApplicationSettings.h"
 #include "CombinedIndexerCommandProvider.h"
 #include "DialogView.h"
+#include "ExternalStorageMerger.h"
 #include "IndexerCommand.h"
 #include "IndexerCommandCustom.h"
+#include "IndexerWorkerPool.h"
 #include "PersistentStorage.h"
 #include "ProjectSettings.h"
 #include "RefreshInfoGenerator.h"
@@ -19,8 +21,11 @@
 #include "TaskFillIndexerCommandQueue.h"
 #include "TaskFinishParsing.h"
 #include "TaskInjectStorage.h"
+#include "TaskMergeStorageRuns.h"
 #include "TaskMergeStorages.h"
 #include "TaskParseWrapper.h"
+#include "TaskPublishStorageSnapshots.h"
+#include "TaskWriteStorageRuns.h"
 
 #include "FilePath.h"
 #include "FileSystem.h"
@@ -30,6 +35,7 @@
 #include "MessageIndexingStarted.h"
 #include "MessageIndexingStatus.h"
 #include "MessageRefresh.h"
+#include "MessageRefreshUI.h"
 #include "MessageStatus.h"
 #include "MessagePluginPortChange.h"
 #include "TabId.h"
@@ -47,6 +53,31 @@
 #include "utilityFile.h"
 #include "utilityString.h"
 
+namespace
+{
+// a database that was written while publishing snapshots keeps committed data in its write-ahead
+// log until the log is checkpointed, which has to happen before the database file is moved
+void checkpointWriteAheadLog(const FilePath& dbFilePath)
+{
+	if (FilePath(dbFilePath.wstr() + L"-wal").exists())
+	{
+		SqliteIndexStorage(dbFilePath).setWriteAheadLogEnabled(false);
+	}
+}
+
+void removeWriteAheadLog(const FilePath& dbFilePath)
+{
+	for (const wchar_t* suffix: {L"-wal", L"-shm"})
+	{
+		const FilePath filePath(dbFilePath.wstr() + suffix);
+		if (filePath.exists())
+		{
+			FileSystem::remove(filePath);
+		}
+	}
+}
+}	 // namespace
+
 Project::Project(
 	std::shared_ptr<ProjectSettings> settings,
 	StorageCache* storageCache,
@@ -160,6 +191,7 @@ void Project::load(std::shared_ptr<DialogView> dialogView)
 				{
 					LOG_INFO("Discarding temporary indexing data on user's decision");
 					FileSystem::remove(tempDbPath);
+					removeWriteAheadLog(tempDbPath);
 				}
 			}
 			else
@@ -167,6 +199,7 @@ void Project::load(std::shared_ptr<DialogView> dialogView)
 				LOG_INFO(
 					"Switching to temporary indexing data because no other persistent data was "
 					"found");
+				checkpointWriteAheadLog(tempDbPath);
 				FileSystem::rename(tempDbPath, dbPath);
 			}
 		}
@@ -228,6 +261,7 @@ void Project::load(std::shared_ptr<DialogView> dialogView)
 	{
 		m_storage->setMode(SqliteIndexStorage::STORAGE_MODE_READ);
 		m_storage->buildCaches();
+		m_storage->openReadConnections();
 		m_storageCache->setSubject(m_storage);
 
 		if (m_hasGUI)
@@ -438,21 +472,43 @@ void Project::refresh(
 
 RefreshInfo Project::getRefreshInfo(RefreshMode mode) const
 {
+	RefreshInfo info;
 	switch (mode)
 	{
 	case REFRESH_NONE:
-		return RefreshInfo();
+		return info;
 
 	case REFRESH_UPDATED_FILES:
-		return RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(m_sourceGroups, m_storage);
+		info = RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(m_sourceGroups, m_storage);
+		break;
 
 	case REFRESH_UPDATED_AND_INCOMPLETE_FILES:
-		return RefreshInfoGenerator::getRefreshInfoForIncompleteFiles(m_sourceGroups, m_storage);
+		info = RefreshInfoGenerator::getRefreshInfoForIncompleteFiles(m_sourceGroups, m_storage);
+		break;
 
 	case REFRESH_ALL_FILES:
 	default:
-		return RefreshInfoGenerator::getRefreshInfoForAllFiles(m_sourceGroups);
+		info = RefreshInfoGenerator::getRefreshInfoForAllFiles(m_sourceGroups);
+		break;
+	}
+
+	if (m_settings->isSharded())
+	{
+		// the other shards index the remaining files into their own databases
+		for (auto it = info.filesToIndex.begin(); it != info.filesToIndex.end();)
+		{
+			if (m_settings->isInShard(*it))
+			{
+				++it;
+			}
+			else
+			{
+				it = info.filesToIndex.erase(it);
+			}
+		}
 	}
+
+	return info;
 }
 
 void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogView)
@@ -578,6 +634,19 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 		TextAccess::createFromFile(getProjectSettingsFilePath())->getText());
 	tempStorage->updateVersion();
 
+	// translation units are marked completed when their storage gets injected, so an interrupted
+	// run can be continued from the remaining ones
+	tempStorage->setIndexingTranslationUnits(info.filesToIndex);
+
+	const int snapshotInterval = m_hasGUI
+		? ApplicationSettings::getInstance()->getIndexingSnapshotInterval()
+		: 0;
+	if (snapshotInterval > 0)
+	{
+		// snapshots read from the database while it is written
+		tempStorage->setWriteAheadLogEnabled(true);
+	}
+
 	std::unique_ptr<CombinedIndexerCommandProvider> indexerCommandProvider =
 		std::make_unique<CombinedIndexerCommandProvider>();
 	std::unique_ptr<CombinedIndexerCommandProvider> customIndexerCommandProvider =
@@ -629,7 +698,21 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 		const int adjustedIndexerThreadCount = std::min<int>(
 			indexerThreadCount, static_cast<int>(indexerCommandProvider->size()));
 
+		const int memoryBudgetMb = ApplicationSettings::getInstance()->getIndexingMemoryBudget();
+		const size_t memoryBudget = static_cast<size_t>(std::max(0, memoryBudgetMb)) * 1048576;
+
 		std::shared_ptr<StorageProvider> storageProvider = std::make_shared<StorageProvider>();
+		storageProvider->setSpillDirectoryPath(FilePath(tempIndexDbFilePath.wstr() + L"_spill"));
+
+		// bounds the memory used for merging by writing sorted runs and merging them at the end
+		std::shared_ptr<ExternalStorageMerger> storageMerger;
+		if (ApplicationSettings::getInstance()->getIndexingExternalMergeEnabled())
+		{
+			storageMerger = std::make_shared<ExternalStorageMerger>(
+				FilePath(tempIndexDbFilePath.wstr() + L"_runs"),
+				memoryBudget ? std::max<size_t>(memoryBudget / 4, 64 * 1048576) : 256 * 1048576);
+		}
+
 		// add tasks for setting some variables on the blackboard that are used during indexing
 		taskSequential->addTask(
 			std::make_shared<TaskSetValue<bool>>("indexer_threads_started", false));
@@ -658,9 +741,40 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 			std::make_shared<TaskGroupParallel>();
 		taskParserWrapper->setTask(taskParallelIndexing);
 
-		// add task for refilling the indexer command queue
+		// the pool owns the shared memory used by the indexer tasks
+		if (!m_indexerWorkerPool)
+		{
+			m_indexerWorkerPool = std::make_shared<IndexerWorkerPool>(m_appUUID);
+		}
+
+		// add task for refilling the indexer command queue. Java files are indexed in batches of up
+		// to 32 files, so the queue has to hold a full batch for every indexer.
+		size_t maximumQueueSize = 20;
+		if (hasJavaSourceGroup())
+		{
+			maximumQueueSize = std::max<size_t>(
+				maximumQueueSize, static_cast<size_t>(adjustedIndexerThreadCount) * 32);
+		}
 		taskParallelIndexing->addTask(std::make_shared<TaskFillIndexerCommandsQueue>(
-			m_appUUID, std::move(indexerCommandProvider), 20));
+			m_appUUID, std::move(indexerCommandProvider), maximumQueueSize));
+
+		if (snapshotInterval > 0)
+		{
+			// add task for publishing snapshots of the partially built index for browsing
+			taskParallelIndexing->addTask(std::make_shared<TaskPublishStorageSnapshots>(
+				tempIndexDbFilePath,
+				m_storage->getBookmarkDbFilePath(),
+				[this](
+					std::shared_ptr<PersistentStorage> snapshot,
+					std::function<void()> releaseSnapshot) {
+					Task::dispatch(
+						TabId::app(),
+						std::make_shared<TaskLambda>([this, snapshot, releaseSnapshot]() {
+							publishStorageSnapshot(snapshot, releaseSnapshot);
+						}));
+				},
+				static_cast<size_t>(snapshotInterval) * 1000));
+		}
 
 		// add task for indexing
 		bool multiProcess = ApplicationSettings::getInstance()->getMultiProcessIndexingEnabled() &&
@@ -672,41 +786,70 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 				->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
 					"indexer_command_queue_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
 			std::make_shared<TaskBuildIndex>(
-				adjustedIndexerThreadCount, storageProvider, dialogView, m_appUUID, multiProcess)));
-
-		// add task for merging the intermediate storages
-		taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
-			// block until there are indexers running
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
-				->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
-					"indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
-			// merge until all indexers stopped and nothing left to merge
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 250)
-				->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
-					std::make_shared<TaskMergeStorages>(storageProvider),
-					std::make_shared<TaskReturnSuccessIf<bool>>(
-						"indexer_threads_stopped",
-						TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
-						false)))));
-
-		// add task for injecting the intermediate storages into the persistent storage
-		taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
-			// block until there are indexers running
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
-				->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
-					"indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
-				->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
-					std::make_shared<TaskInjectStorage>(storageProvider, tempStorage),
-					// continuing when indexers still running, even if there are no storages right now.
-					std::make_shared<TaskReturnSuccessIf<bool>>(
-						"indexer_threads_stopped",
-						TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
-						false)))));
+				adjustedIndexerThreadCount,
+				storageProvider,
+				dialogView,
+				m_indexerWorkerPool,
+				m_appUUID,
+				multiProcess,
+				memoryBudget)));
+
+		if (storageMerger)
+		{
+			// add task for collecting the intermediate storages into sorted runs on disk
+			taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
+				// block until there are indexers running
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
+						"indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
+				// write runs until all indexers stopped and nothing left to write
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
+						std::make_shared<TaskWriteStorageRuns>(storageProvider, storageMerger),
+						std::make_shared<TaskReturnSuccessIf<bool>>(
+							"indexer_threads_stopped",
+							TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
+							false)))));
+		}
+		else
+		{
+			// add task for merging the intermediate storages
+			taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
+				// block until there are indexers running
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
+						"indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
+				// merge until all indexers stopped and nothing left to merge
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 250)
+					->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
+						std::make_shared<TaskMergeStorages>(storageProvider),
+						std::make_shared<TaskReturnSuccessIf<bool>>(
+							"indexer_threads_stopped",
+							TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
+							false)))));
+
+			// add task for injecting the intermediate storages into the persistent storage
+			taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
+				// block until there are indexers running
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
+						"indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
+						std::make_shared<TaskInjectStorage>(storageProvider, tempStorage),
+						// continuing when indexers still running, even if there are no storages right
+						// now.
+						std::make_shared<TaskReturnSuccessIf<bool>>(
+							"indexer_threads_stopped",
+							TaskReturnSuccessIf<bool>::CONDITION_EQUALS,
+							false)))));
+		}
 
 		// add task that notifies the user of what's going on
 		taskSequential->addTask(	// we don't need to hide this dialog again, because it's
@@ -715,11 +858,26 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 				dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Saving\nRemaining Data");
 			}));
 
-		// add task that injects the remaining intermediate storages into the persistent storage
-		taskSequential->addTask(
-			std::make_shared<TaskDecoratorRepeat>(
-				TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
-				->addChildTask(std::make_shared<TaskInjectStorage>(storageProvider, tempStorage)));
+		if (storageMerger)
+		{
+			// add tasks that write the remaining intermediate storages and merge all runs into the
+			// persistent storage
+			taskSequential->addTask(
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(
+						std::make_shared<TaskWriteStorageRuns>(storageProvider, storageMerger)));
+			taskSequential->addTask(
+				std::make_shared<TaskMergeStorageRuns>(storageMerger, tempStorage));
+		}
+		else
+		{
+			// add task that injects the remaining intermediate storages into the persistent storage
+			taskSequential->addTask(
+				std::make_shared<TaskDecoratorRepeat>(
+					TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+					->addChildTask(std::make_shared<TaskInjectStorage>(storageProvider, tempStorage)));
+		}
 	}
 	else
 	{
@@ -793,6 +951,7 @@ void Project::swapToTempStorage(std::shared_ptr<DialogView> dialogView)
 	const FilePath bookmarkDbFilePath = m_settings->getBookmarkDBFilePath();
 
 	m_storage.reset();
+	releaseStorageSnapshot();
 
 	if (!swapToTempStorageFile(indexDbFilePath, tempIndexDbFilePath, dialogView))
 	{
@@ -807,8 +966,10 @@ void Project::swapToTempStorage(std::shared_ptr<DialogView> dialogView)
 	// Application::getInstance()->getDialogView(DialogView::UseCase::INDEXING);
 	// dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Building caches");
 	m_storage->buildCaches();
+	m_storage->openReadConnections();
 	// dialogView->hideUnknownProgressDialog();
 
+	m_storageCache->clearStorageData();
 	m_storageCache->setSubject(m_storage);
 	m_state = PROJECT_STATE_LOADED;
 }
@@ -820,6 +981,7 @@ bool Project::swapToTempStorageFile(
 {
 	try
 	{
+		checkpointWriteAheadLog(tempIndexDbFilePath);
 		FileSystem::remove(indexDbFilePath);
 		FileSystem::rename(tempIndexDbFilePath, indexDbFilePath);
 	}
@@ -841,11 +1003,63 @@ bool Project::swapToTempStorageFile(
 
 void Project::discardTempStorage()
 {
+	if (m_storageSnapshot)
+	{
+		releaseStorageSnapshot();
+		m_storageCache->clearStorageData();
+		m_storageCache->setSubject(m_storage);
+	}
+
 	const FilePath tempIndexDbPath = m_settings->getTempDBFilePath();
 	if (tempIndexDbPath.exists())
 	{
 		LOG_INFO("Discarding temporary indexing data");
 		FileSystem::remove(tempIndexDbPath);
+		removeWriteAheadLog(tempIndexDbPath);
+	}
+}
+
+void Project::publishStorageSnapshot(
+	std::shared_ptr<PersistentStorage> snapshot, std::function<void()> releaseSnapshot)
+{
+	if (m_refreshStage != RefreshStageType::INDEXING)
+	{
+		releaseSnapshot();
+		return;
+	}
+
+	const bool firstSnapshot = !m_storageSnapshot;
+
+	std::function<void()> releasePreviousSnapshot = m_releaseStorageSnapshot;
+
+	m_storageSnapshot = snapshot;
+	m_releaseStorageSnapshot = releaseSnapshot;
+	m_storageCache->clearStorageData();
+	m_storageCache->setSubject(m_storageSnapshot);
+
+	// the previous snapshot may get updated by the indexing again once it is no longer browsed
+	if (releasePreviousSnapshot)
+	{
+		releasePreviousSnapshot();
+	}
+
+	MessageStatus(L"Browsing the partially built index", false, true).dispatch();
+
+	if (firstSnapshot)
+	{
+		// views still show the previous index, further snapshots are picked up by the next query
+		MessageRefreshUI().noStyleReload().dispatch();
+	}
+}
+
+void Project::releaseStorageSnapshot()
+{
+	m_storageSnapshot.reset();
+
+	if (m_releaseStorageSnapshot)
+	{
+		m_releaseStorageSnapshot();
+		m_releaseStorageSnapshot = nullptr;
 	}
 }
 
@@ -865,3 +1079,18 @@ bool Project::hasCxxSourceGroup() const
 #endif	  // BUILD_CXX_LANGUAGE_PACKAGE
 	return false;
 }
+
+bool Project::hasJavaSourceGroup() const
+{
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+	for (const std::shared_ptr<SourceGroup>& sourceGroup: m_sourceGroups)
+	{
+		if (sourceGroup->getStatus() == SOURCE_GROUP_STATUS_ENABLED &&
+			sourceGroup->getLanguage() == LANGUAGE_JAVA)
+		{
+			return true;
+		}
+	}
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
+	return false;
+}
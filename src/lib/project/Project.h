@@ -1,6 +1,7 @@
 #ifndef PROJECT_H
 #define PROJECT_H
 
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
@@ -12,6 +13,7 @@
 struct FileInfo;
 class DialogView;
 class FilePath;
+class IndexerWorkerPool;
 class PersistentStorage;
 class ProjectSettings;
 class StorageCache;
@@ -72,8 +74,12 @@ private:
 		const FilePath& tempIndexDbFilePath,
 		std::shared_ptr<DialogView> dialogView);
 	void discardTempStorage();
+	void publishStorageSnapshot(
+		std::shared_ptr<PersistentStorage> snapshot, std::function<void()> releaseSnapshot);
+	void releaseStorageSnapshot();
 
 	bool hasCxxSourceGroup() const;
+	bool hasJavaSourceGroup() const;
 
 	std::shared_ptr<ProjectSettings> m_settings;
 	StorageCache* const m_storageCache;
@@ -82,8 +88,15 @@ private:
 	RefreshStageType m_refreshStage;
 
 	std::shared_ptr<PersistentStorage> m_storage;
+
+	// snapshot of the index that is currently built, used for browsing while indexing
+	std::shared_ptr<PersistentStorage> m_storageSnapshot;
+	std::function<void()> m_releaseStorageSnapshot;
 	std::vector<std::shared_ptr<SourceGroup>> m_sourceGroups;
 
+	// kept across refreshes to reuse running indexer workers
+	std::shared_ptr<IndexerWorkerPool> m_indexerWorkerPool;
+
 	std::string m_appUUID;
 	bool m_hasGUI;
 };
@@ -127,6 +127,16 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 		}
 	}
 
+	// 3.1) Add translation units of an interrupted indexing run that were not completed. These may
+	// already be known as indexed, e.g. if they were included by a completed translation unit.
+	for (const FilePath& path: storage->getUnfinishedTranslationUnits())
+	{
+		if (allSourceFilePathsFromSourcegroups.find(path) != allSourceFilePathsFromSourcegroups.end())
+		{
+			filesToIndex.insert(path);
+		}
+	}
+
 	// 4) Store and return this information
 	RefreshInfo info;
 	info.mode = REFRESH_UPDATED_FILES;
@@ -244,22 +254,7 @@ bool RefreshInfoGenerator::didFileChange(
 		std::shared_ptr<TextAccess> storedFileContent = storage->getFileContent(info.path, false);
 		std::shared_ptr<TextAccess> diskFileContent = TextAccess::createFromFile(diskFileInfo.path);
 
-		const std::vector<std::string>& diskFileLines = diskFileContent->getAllLines();
-		const std::vector<std::string>& storedFileLines = storedFileContent->getAllLines();
-
-		if (diskFileLines.size() != storedFileLines.size())
-		{
-			return true;
-		}
-
-		for (size_t i = 0; i < diskFileLines.size(); i++)
-		{
-			if (diskFileLines[i] != storedFileLines[i])
-			{
-				return true;
-			}
-		}
-		return false;
+		return diskFileContent->getTextView() != storedFileContent->getTextView();
 	}
 	return false;
 }
@@ -338,6 +338,16 @@ void ApplicationSettings::setVerboseIndexerLoggingEnabled(bool value)
 	setValue<bool>("application/verbose_indexer_logging_enabled", value);
 }
 
+int ApplicationSettings::getSlowQueryThresholdMs() const
+{
+	return getValue<int>("application/slow_query_threshold_ms", 0);
+}
+
+void ApplicationSettings::setSlowQueryThresholdMs(int thresholdMs)
+{
+	setValue<int>("application/slow_query_threshold_ms", thresholdMs);
+}
+
 FilePath ApplicationSettings::getLogDirectoryPath() const
 {
 	return FilePath(getValue<std::wstring>(
@@ -390,6 +400,46 @@ void ApplicationSettings::setMultiProcessIndexingEnabled(bool enabled)
 	setValue<bool>("indexing/multi_process_indexing", enabled);
 }
 
+int ApplicationSettings::getIndexerProcessMemoryGrowthLimit() const
+{
+	return getValue<int>("indexing/indexer_process_memory_growth_limit", 4096);
+}
+
+void ApplicationSettings::setIndexerProcessMemoryGrowthLimit(int size)
+{
+	setValue<int>("indexing/indexer_process_memory_growth_limit", size);
+}
+
+int ApplicationSettings::getIndexingMemoryBudget() const
+{
+	return getValue<int>("indexing/memory_budget", 4096);
+}
+
+void ApplicationSettings::setIndexingMemoryBudget(int size)
+{
+	setValue<int>("indexing/memory_budget", size);
+}
+
+bool ApplicationSettings::getIndexingExternalMergeEnabled() const
+{
+	return getValue<bool>("indexing/external_merge", false);
+}
+
+void ApplicationSettings::setIndexingExternalMergeEnabled(bool enabled)
+{
+	setValue<bool>("indexing/external_merge", enabled);
+}
+
+int ApplicationSettings::getIndexingSnapshotInterval() const
+{
+	return getValue<int>("indexing/snapshot_interval", 0);
+}
+
+void ApplicationSettings::setIndexingSnapshotInterval(int seconds)
+{
+	setValue<int>("indexing/snapshot_interval", seconds);
+}
+
 FilePath ApplicationSettings::getJavaPath() const
 {
 	return FilePath(getValue<std::wstring>("indexing/java/java_path", L""));
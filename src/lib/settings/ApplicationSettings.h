@@ -82,6 +82,10 @@ public:
 	bool getVerboseIndexerLoggingEnabled() const;
 	void setVerboseIndexerLoggingEnabled(bool loggingEnabled);
 
+	// query plans of storage statements taking longer are captured, 0 disables capturing
+	int getSlowQueryThresholdMs() const;
+	void setSlowQueryThresholdMs(int thresholdMs);
+
 	FilePath getLogDirectoryPath() const;
 	void setLogDirectoryPath(const FilePath& path);
 
@@ -98,6 +102,18 @@ public:
 	bool getMultiProcessIndexingEnabled() const;
 	void setMultiProcessIndexingEnabled(bool enabled);
 
+	int getIndexerProcessMemoryGrowthLimit() const;
+	void setIndexerProcessMemoryGrowthLimit(int size);
+
+	int getIndexingMemoryBudget() const;
+	void setIndexingMemoryBudget(int size);
+
+	bool getIndexingExternalMergeEnabled() const;
+	void setIndexingExternalMergeEnabled(bool enabled);
+
+	int getIndexingSnapshotInterval() const;
+	void setIndexingSnapshotInterval(int seconds);
+
 	FilePath getJavaPath() const;
 	void setJavaPath(const FilePath& path);
 
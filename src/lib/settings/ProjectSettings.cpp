@@ -1,5 +1,7 @@
 #include "ProjectSettings.h"
 
+#include <algorithm>
+
 #include "SettingsMigrationDeleteKey.h"
 #include "SettingsMigrationLambda.h"
 #include "SettingsMigrationMoveKey.h"
@@ -164,17 +166,46 @@ void ProjectSettings::setSourcetrailPort(const int sourcetrailPort)
 
 FilePath ProjectSettings::getDBFilePath() const
 {
-	return getFilePath().replaceExtension(INDEX_DB_FILE_EXTENSION);
+	return getFilePathWithExtension(INDEX_DB_FILE_EXTENSION);
 }
 
 FilePath ProjectSettings::getTempDBFilePath() const
 {
-	return getFilePath().replaceExtension(TEMP_INDEX_DB_FILE_EXTENSION);
+	return getFilePathWithExtension(TEMP_INDEX_DB_FILE_EXTENSION);
 }
 
 FilePath ProjectSettings::getBookmarkDBFilePath() const
 {
-	return getFilePath().replaceExtension(BOOKMARK_DB_FILE_EXTENSION);
+	return getFilePathWithExtension(BOOKMARK_DB_FILE_EXTENSION);
+}
+
+void ProjectSettings::setShard(size_t shardIndex, size_t shardCount)
+{
+	m_shardCount = std::max<size_t>(shardCount, 1);
+	m_shardIndex = std::min(shardIndex, m_shardCount - 1);
+}
+
+bool ProjectSettings::isSharded() const
+{
+	return m_shardCount > 1;
+}
+
+bool ProjectSettings::isInShard(const FilePath& sourceFilePath) const
+{
+	if (!isSharded())
+	{
+		return true;
+	}
+
+	// FNV-1a of the path relative to the project, so shards computed on different machines agree
+	const std::string relativePath = sourceFilePath.getRelativeTo(getProjectDirectoryPath()).str();
+	unsigned long long hash = 14695981039346656037ull;
+	for (const char c: relativePath)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash % m_shardCount == m_shardIndex;
 }
 
 std::wstring ProjectSettings::getProjectName() const
@@ -300,6 +331,18 @@ FilePath ProjectSettings::makePathExpandedAndAbsolute(const FilePath& path) cons
 	return utility::getExpandedAndAbsolutePath(path, getProjectDirectoryPath());
 }
 
+FilePath ProjectSettings::getFilePathWithExtension(const std::wstring& extension) const
+{
+	if (!isSharded())
+	{
+		return getFilePath().replaceExtension(extension);
+	}
+
+	return FilePath(
+		getFilePath().withoutExtension().wstr() + L"_shard_" + std::to_wstring(m_shardIndex + 1) +
+		L"_of_" + std::to_wstring(m_shardCount) + extension);
+}
+
 SettingsMigrator ProjectSettings::getMigrations() const
 {
 	SettingsMigrator migrator;
@@ -45,6 +45,12 @@ public:
 	FilePath getTempDBFilePath() const;
 	FilePath getBookmarkDBFilePath() const;
 
+	// Restricts indexing to one of shardCount parts of the source files. Each shard writes to its
+	// own database files, which can be combined afterwards.
+	void setShard(size_t shardIndex, size_t shardCount);
+	bool isSharded() const;
+	bool isInShard(const FilePath& sourceFilePath) const;
+
 	std::wstring getProjectName() const;
 	FilePath getProjectDirectoryPath() const;
 
@@ -58,6 +64,10 @@ public:
 
 private:
 	SettingsMigrator getMigrations() const;
+	FilePath getFilePathWithExtension(const std::wstring& extension) const;
+
+	size_t m_shardIndex = 0;
+	size_t m_shardCount = 1;
 };
 
 #endif	  // PROJECT_SETTINGS_H
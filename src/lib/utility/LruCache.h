@@ -0,0 +1,86 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <list>
+#include <map>
+
+// keeps the values of the most recently used keys, the least recently used one is dropped first
+template <typename KeyType, typename ValType>
+class LruCache
+{
+public:
+	LruCache(size_t maximumSize);
+
+	bool getValue(const KeyType& key, ValType* value);
+	void setValue(const KeyType& key, const ValType& value);
+
+	size_t size() const;
+	void clear();
+
+private:
+	typedef std::list<std::pair<KeyType, ValType>> EntryList;
+
+	const size_t m_maximumSize;
+	EntryList m_entries;
+	std::map<KeyType, typename EntryList::iterator> m_entryIterators;
+};
+
+template <typename KeyType, typename ValType>
+LruCache<KeyType, ValType>::LruCache(size_t maximumSize): m_maximumSize(maximumSize)
+{
+}
+
+template <typename KeyType, typename ValType>
+bool LruCache<KeyType, ValType>::getValue(const KeyType& key, ValType* value)
+{
+	auto it = m_entryIterators.find(key);
+	if (it == m_entryIterators.end())
+	{
+		return false;
+	}
+
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+	*value = it->second->second;
+	return true;
+}
+
+template <typename KeyType, typename ValType>
+void LruCache<KeyType, ValType>::setValue(const KeyType& key, const ValType& value)
+{
+	auto it = m_entryIterators.find(key);
+	if (it != m_entryIterators.end())
+	{
+		it->second->second = value;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return;
+	}
+
+	if (!m_maximumSize)
+	{
+		return;
+	}
+
+	if (m_entries.size() >= m_maximumSize)
+	{
+		m_entryIterators.erase(m_entries.back().first);
+		m_entries.pop_back();
+	}
+
+	m_entries.emplace_front(key, value);
+	m_entryIterators.emplace(key, m_entries.begin());
+}
+
+template <typename KeyType, typename ValType>
+size_t LruCache<KeyType, ValType>::size() const
+{
+	return m_entries.size();
+}
+
+template <typename KeyType, typename ValType>
+void LruCache<KeyType, ValType>::clear()
+{
+	m_entries.clear();
+	m_entryIterators.clear();
+}
+
+#endif	  // LRU_CACHE_H
@@ -7,6 +7,7 @@
 
 #include "CommandlineCommandConfig.h"
 #include "CommandlineCommandIndex.h"
+#include "CommandlineCommandMerge.h"
 #include "CommandlineHelper.h"
 #include "ConfigManager.h"
 #include "TextAccess.h"
@@ -28,6 +29,7 @@ CommandLineParser::CommandLineParser(const std::string& version): m_version(vers
 
 	m_commands.push_back(std::make_unique<commandline::CommandlineCommandConfig>(this));
 	m_commands.push_back(std::make_unique<commandline::CommandlineCommandIndex>(this));
+	m_commands.push_back(std::make_unique<commandline::CommandlineCommandMerge>(this));
 
 	for (auto& command: m_commands)
 	{
@@ -235,6 +237,22 @@ void CommandLineParser::setShallowIndexingRequested(bool enabled)
 	m_shallowIndexingRequested = enabled;
 }
 
+void CommandLineParser::setQueryStatisticsRequested(bool enabled)
+{
+	m_queryStatisticsRequested = enabled;
+}
+
+void CommandLineParser::setTraceFilePath(const FilePath& filePath)
+{
+	m_traceFilePath = filePath;
+}
+
+void CommandLineParser::setShard(size_t shardIndex, size_t shardCount)
+{
+	m_shardIndex = shardIndex;
+	m_shardCount = shardCount;
+}
+
 const FilePath& CommandLineParser::getProjectFilePath() const
 {
 	return m_projectFile;
@@ -250,4 +268,24 @@ bool CommandLineParser::getShallowIndexingRequested() const
 	return m_shallowIndexingRequested;
 }
 
+bool CommandLineParser::getQueryStatisticsRequested() const
+{
+	return m_queryStatisticsRequested;
+}
+
+const FilePath& CommandLineParser::getTraceFilePath() const
+{
+	return m_traceFilePath;
+}
+
+size_t CommandLineParser::getShardIndex() const
+{
+	return m_shardIndex;
+}
+
+size_t CommandLineParser::getShardCount() const
+{
+	return m_shardCount;
+}
+
 }	 // namespace commandline
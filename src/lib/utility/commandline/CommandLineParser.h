@@ -35,12 +35,19 @@ public:
 	void fullRefresh();
 	void incompleteRefresh();
 	void setShallowIndexingRequested(bool enabled = true);
+	void setQueryStatisticsRequested(bool enabled = true);
+	void setTraceFilePath(const FilePath& filePath);
+	void setShard(size_t shardIndex, size_t shardCount);
 
 	const FilePath& getProjectFilePath() const;
 	void setProjectFile(const FilePath& filepath);
 
 	RefreshMode getRefreshMode() const;
 	bool getShallowIndexingRequested() const;
+	bool getQueryStatisticsRequested() const;
+	const FilePath& getTraceFilePath() const;
+	size_t getShardIndex() const;
+	size_t getShardCount() const;
 
 private:
 	void processProjectfile();
@@ -56,6 +63,10 @@ private:
 	FilePath m_projectFile;
 	RefreshMode m_refreshMode = REFRESH_UPDATED_FILES;
 	bool m_shallowIndexingRequested = false;
+	bool m_queryStatisticsRequested = false;
+	FilePath m_traceFilePath;
+	size_t m_shardIndex = 0;
+	size_t m_shardCount = 1;
 
 	bool m_quit = false;
 	bool m_withoutGUI = false;
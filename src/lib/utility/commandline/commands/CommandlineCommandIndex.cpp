@@ -23,6 +23,13 @@ void CommandlineCommandIndex::setup()
 		"incomplete,i", "Also reindex incomplete files (files with errors)")(
 		"full,f", "Index full project (omit to only index new/changed files)")(
 		"shallow,s", "Build a shallow index is supported by the project")(
+		"query-statistics,q", "Print statistics of all database queries when done")(
+		"trace,t",
+		po::value<std::string>(),
+		"Record a trace of the indexing run and write it to this file (Chrome trace format)")(
+		"shard",
+		po::value<std::string>(),
+		"Only index shard i of n (given as i/n) into its own database, see the merge command")(
 		"project-file", po::value<std::string>(), "Project file to index (.srctrlprj)");
 
 	m_options.add(options);
@@ -67,6 +74,44 @@ CommandlineCommand::ReturnStatus CommandlineCommandIndex::parse(std::vector<std:
 		m_parser->setShallowIndexingRequested();
 	}
 
+	if (vm.count("query-statistics"))
+	{
+		m_parser->setQueryStatisticsRequested();
+	}
+
+	if (vm.count("trace"))
+	{
+		m_parser->setTraceFilePath(FilePath(vm["trace"].as<std::string>()).makeAbsolute());
+	}
+
+	if (vm.count("shard"))
+	{
+		const std::string shard = vm["shard"].as<std::string>();
+		size_t shardIndex = 0;
+		size_t shardCount = 0;
+		const size_t separatorPos = shard.find('/');
+		try
+		{
+			if (separatorPos != std::string::npos)
+			{
+				shardIndex = std::stoul(shard.substr(0, separatorPos));
+				shardCount = std::stoul(shard.substr(separatorPos + 1));
+			}
+		}
+		catch (std::exception&)
+		{
+		}
+
+		if (shardIndex < 1 || shardIndex > shardCount)
+		{
+			std::cerr << "ERROR: Invalid shard \"" << shard << "\", expected i/n with 1 <= i <= n"
+					  << std::endl;
+			return ReturnStatus::CMD_FAILURE;
+		}
+
+		m_parser->setShard(shardIndex - 1, shardCount);
+	}
+
 	if (vm.count("project-file"))
 	{
 		m_parser->setProjectFile(FilePath(vm["project-file"].as<std::string>()));
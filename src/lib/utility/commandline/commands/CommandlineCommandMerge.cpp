@@ -0,0 +1,84 @@
+#include "CommandlineCommandMerge.h"
+
+#include <iostream>
+
+#include "CommandLineParser.h"
+#include "FilePath.h"
+#include "PersistentStorage.h"
+
+namespace po = boost::program_options;
+
+namespace commandline
+{
+CommandlineCommandMerge::CommandlineCommandMerge(CommandLineParser* parser)
+	: CommandlineCommand("merge", "Merge the databases of indexed shards.", parser)
+{
+}
+
+CommandlineCommandMerge::~CommandlineCommandMerge() {}
+
+void CommandlineCommandMerge::setup()
+{
+	po::options_description options("Config Options");
+	options.add_options()("help,h", "Print this help message")(
+		"output,o",
+		po::value<std::string>(),
+		"Database file to write the merged index to (.srctrldb), gets overwritten")(
+		"shard-files",
+		po::value<std::vector<std::string>>()->multitoken(),
+		"Databases written by \"index --shard\" (.srctrldb)");
+
+	m_options.add(options);
+	m_positional.add("shard-files", -1);
+}
+
+CommandlineCommand::ReturnStatus CommandlineCommandMerge::parse(std::vector<std::string>& args)
+{
+	po::variables_map vm;
+	try
+	{
+		po::store(
+			po::command_line_parser(args).options(m_options).positional(m_positional).run(), vm);
+		po::notify(vm);
+	}
+	catch (po::error& e)
+	{
+		std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+		std::cerr << m_options << std::endl;
+		return ReturnStatus::CMD_FAILURE;
+	}
+
+	if (vm.count("help") || args.size() == 0 || args[0] == "help")
+	{
+		printHelp();
+		return ReturnStatus::CMD_QUIT;
+	}
+
+	if (!vm.count("output") || !vm.count("shard-files"))
+	{
+		std::cerr << "ERROR: An output file and at least one shard database are required."
+				  << std::endl;
+		return ReturnStatus::CMD_FAILURE;
+	}
+
+	std::vector<FilePath> shardFilePaths;
+	for (const std::string& shardFile: vm["shard-files"].as<std::vector<std::string>>())
+	{
+		shardFilePaths.push_back(FilePath(shardFile).makeAbsolute());
+	}
+	const FilePath outputFilePath = FilePath(vm["output"].as<std::string>()).makeAbsolute();
+
+	if (!PersistentStorage::mergeDatabases(shardFilePaths, outputFilePath))
+	{
+		std::cerr << "ERROR: Merging the shard databases failed." << std::endl;
+		return ReturnStatus::CMD_FAILURE;
+	}
+
+	std::cout << "Merged " << shardFilePaths.size() << " databases into " << outputFilePath.str()
+			  << std::endl;
+
+	// nothing left to do for the application
+	return ReturnStatus::CMD_QUIT;
+}
+
+}	 // namespace commandline
@@ -11,6 +11,7 @@
 #include "TaskGroupSequence.h"
 #include "TaskLambda.h"
 #include "logging.h"
+#include "tracing.h"
 
 std::shared_ptr<MessageQueue> MessageQueue::getInstance()
 {
@@ -241,6 +242,12 @@ void MessageQueue::processMessages()
 
 void MessageQueue::sendMessage(std::shared_ptr<MessageBase> message)
 {
+	ScopedTrace trace("message", "");
+	if (trace.isRecording())
+	{
+		trace.setName(message->getType());
+	}
+
 	std::lock_guard<std::mutex> lock(m_listenersMutex);
 
 	// m_listenersLength is saved, so that new listeners registered whithin message handling don't
@@ -294,6 +301,13 @@ void MessageQueue::sendMessageAsTask(std::shared_ptr<MessageBase> message, bool
 						listenerId);
 					if (listener)
 					{
+						ScopedTrace trace("message", "");
+						if (trace.isRecording())
+						{
+							trace.setName(message->getType());
+							trace.setDetail("as task");
+						}
+
 						listener->handleMessageBase(message.get());
 					}
 				}));
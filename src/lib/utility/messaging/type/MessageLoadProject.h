@@ -13,11 +13,15 @@ public:
 		const FilePath& filePath,
 		bool settingsChanged = false,
 		RefreshMode refreshMode = REFRESH_NONE,
-		bool shallowIndexingRequested = false)
+		bool shallowIndexingRequested = false,
+		size_t shardIndex = 0,
+		size_t shardCount = 1)
 		: projectSettingsFilePath(filePath)
 		, settingsChanged(settingsChanged)
 		, refreshMode(refreshMode)
 		, shallowIndexingRequested(shallowIndexingRequested)
+		, shardIndex(shardIndex)
+		, shardCount(shardCount)
 	{
 	}
 
@@ -31,12 +35,18 @@ public:
 		os << projectSettingsFilePath.wstr();
 		os << L", settingsChanged: " << std::boolalpha << settingsChanged;
 		os << L", refreshMode: " << refreshMode;
+		if (shardCount > 1)
+		{
+			os << L", shard: " << shardIndex + 1 << L"/" << shardCount;
+		}
 	}
 
 	const FilePath projectSettingsFilePath;
 	const bool settingsChanged;
 	const RefreshMode refreshMode;
 	const bool shallowIndexingRequested;
+	const size_t shardIndex;
+	const size_t shardCount;
 };
 
 #endif	  // MESSAGE_LOAD_PROJECT_H
@@ -5,6 +5,7 @@
 
 #include "ScopedFunctor.h"
 #include "logging.h"
+#include "tracing.h"
 
 TaskScheduler::TaskScheduler(Id schedulerId)
 	: m_schedulerId(schedulerId)
@@ -143,6 +144,12 @@ void TaskScheduler::processTasks()
 			m_tasksMutex.unlock();
 			ScopedFunctor functor([this]() { m_tasksMutex.lock(); });
 
+			ScopedTrace trace("scheduler", "task");
+			if (trace.isRecording())
+			{
+				trace.setDetail("scheduler " + std::to_string(m_schedulerId));
+			}
+
 			while (true)
 			{
 				{
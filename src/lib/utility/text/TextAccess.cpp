@@ -1,66 +1,26 @@
 #include "TextAccess.h"
 
+#include <cstring>
 #include <fstream>
+#include <limits>
 
 #include "logging.h"
 
-namespace
-{
-std::istream& safeGetline(std::istream& is, std::string& t)
-{
-	t.clear();
-
-	// The characters in the stream are read one-by-one using a std::streambuf.
-	// That is faster than reading them one-by-one using the std::istream.
-	// Code that uses streambuf this way must be guarded by a sentry object.
-	// The sentry object performs various tasks,
-	// such as thread synchronization and updating the stream state.
-
-	std::istream::sentry se(is, true);
-	std::streambuf* sb = is.rdbuf();
-
-	while (true)
-	{
-		int c = sb->sbumpc();
-		switch (c)
-		{
-		case '\n':
-			return is;
-		case '\r':
-			if (sb->sgetc() == '\n')
-			{
-				sb->sbumpc();
-			}
-			return is;
-		case std::streambuf::traits_type::eof():
-			// Also handle the case when the last line has no line ending
-			if (t.empty())
-			{
-				is.setstate(std::ios::eofbit);
-			}
-			return is;
-		default:
-			t += (char)c;
-		}
-	}
-}
-}	 // namespace
-
 std::shared_ptr<TextAccess> TextAccess::createFromFile(const FilePath& filePath)
 {
 	std::shared_ptr<TextAccess> result(new TextAccess());
 
 	result->m_filePath = filePath;
-	result->m_lines = readFile(filePath);
+	result->readFile(filePath);
 
 	return result;
 }
 
-std::shared_ptr<TextAccess> TextAccess::createFromString(const std::string& text, const FilePath& filePath)
+std::shared_ptr<TextAccess> TextAccess::createFromString(std::string text, const FilePath& filePath)
 {
 	std::shared_ptr<TextAccess> result(new TextAccess());
 
-	result->m_lines = splitStringByLines(text);
+	result->setBuffer(std::move(text));
 	result->m_filePath = filePath;
 
 	return result;
@@ -71,9 +31,33 @@ std::shared_ptr<TextAccess> TextAccess::createFromLines(
 {
 	std::shared_ptr<TextAccess> result(new TextAccess());
 
-	result->m_lines = lines;
+	size_t size = 0;
+	for (const std::string& line: lines)
+	{
+		size += line.size();
+	}
+
+	std::string text;
+	text.reserve(size);
+	for (const std::string& line: lines)
+	{
+		text += line;
+	}
+	result->setBuffer(std::move(text));
 	result->m_filePath = filePath;
 
+	// keep the original partition, lines may contain line breaks or be empty
+	std::call_once(result->m_lineOffsetsFlag, [&]() {
+		uint32_t offset = 0;
+		for (const std::string& line: lines)
+		{
+			result->m_lineOffsets.push_back(offset);
+			offset += static_cast<uint32_t>(line.size());
+		}
+		result->m_lineOffsets.push_back(offset);
+	});
+	std::call_once(result->m_linesFlag, [&]() { result->m_lines = lines; });
+
 	return result;
 }
 
@@ -81,12 +65,12 @@ TextAccess::~TextAccess() {}
 
 unsigned int TextAccess::getLineCount() const
 {
-	return static_cast<unsigned int>(m_lines.size());
+	return static_cast<unsigned int>(getLineOffsets().size() - 1);
 }
 
 bool TextAccess::isEmpty() const
 {
-	return m_lines.empty();
+	return getLineCount() == 0;
 }
 
 FilePath TextAccess::getFilePath() const
@@ -95,13 +79,20 @@ FilePath TextAccess::getFilePath() const
 }
 
 std::string TextAccess::getLine(const unsigned int lineNumber) const
+{
+	return std::string(getLineView(lineNumber));
+}
+
+std::string_view TextAccess::getLineView(const unsigned int lineNumber) const
 {
 	if (!checkIndexInRange(lineNumber))
 	{
-		return "";
+		return std::string_view();
 	}
 
-	return m_lines[lineNumber - 1];	   // -1 to correct for use as index
+	const std::vector<uint32_t>& offsets = getLineOffsets();
+	const uint32_t begin = offsets[lineNumber - 1];	   // -1 to correct for use as index
+	return m_text.substr(begin, offsets[lineNumber] - begin);
 }
 
 std::vector<std::string> TextAccess::getLines(
@@ -112,98 +103,135 @@ std::vector<std::string> TextAccess::getLines(
 		return std::vector<std::string>();
 	}
 
-	std::vector<std::string>::iterator first = m_lines.begin() + firstLineNumber -
-		1;	  // -1 to correct for use as index
-	std::vector<std::string>::iterator last = m_lines.begin() + lastLineNumber;
-	return std::vector<std::string>(first, last);
+	std::vector<std::string> result;
+	result.reserve(lastLineNumber - firstLineNumber + 1);
+	for (unsigned int lineNumber = firstLineNumber; lineNumber <= lastLineNumber; lineNumber++)
+	{
+		result.emplace_back(getLineView(lineNumber));
+	}
+	return result;
 }
 
 const std::vector<std::string>& TextAccess::getAllLines() const
 {
+	std::call_once(m_linesFlag, [this]() {
+		const unsigned int lineCount = getLineCount();
+		m_lines.reserve(lineCount);
+		for (unsigned int lineNumber = 1; lineNumber <= lineCount; lineNumber++)
+		{
+			m_lines.emplace_back(getLineView(lineNumber));
+		}
+	});
 	return m_lines;
 }
 
 std::string TextAccess::getText() const
 {
-	std::string result = "";
+	return std::string(m_text);
+}
 
-	for (unsigned int i = 0; i < m_lines.size(); i++)
+std::string_view TextAccess::getTextView() const
+{
+	return m_text;
+}
+
+void TextAccess::normalizeLineEndings(std::string& text)
+{
+	if (text.find('\r') != std::string::npos)
 	{
-		result += m_lines[i];
+		size_t target = 0;
+		for (size_t source = 0; source < text.size(); source++)
+		{
+			if (text[source] == '\r')
+			{
+				if (source + 1 < text.size() && text[source + 1] == '\n')
+				{
+					source++;
+				}
+				text[target++] = '\n';
+			}
+			else
+			{
+				text[target++] = text[source];
+			}
+		}
+		text.resize(target);
 	}
 
-	return result;
+	if (!text.empty() && text.back() != '\n')
+	{
+		text.push_back('\n');
+	}
 }
 
-std::vector<std::string> TextAccess::readFile(const FilePath& filePath)
+void TextAccess::readFile(const FilePath& filePath)
 {
-	std::vector<std::string> result;
-
 	try
 	{
 		std::ifstream srcFile;
-		srcFile.open(filePath.str(), std::ios::binary | std::ios::in);
+		srcFile.open(filePath.str(), std::ios::binary | std::ios::in | std::ios::ate);
 
 		if (srcFile.fail())
 		{
 			LOG_ERROR(L"Could not open file " + filePath.wstr());
-			return result;
-		}
-
-		while (!srcFile.eof())
-		{
-			std::string line;
-			safeGetline(srcFile, line);
-			result.push_back(line + '\n');
+			return;
 		}
 
+		// the file is read at once instead of being mapped, a mapping would fault if another
+		// process truncates the file and would keep it locked on Windows
+		const size_t size = static_cast<size_t>(srcFile.tellg());
+		std::string text(size, '\0');
+		srcFile.seekg(0);
+		srcFile.read(&text[0], static_cast<std::streamsize>(size));
+		text.resize(static_cast<size_t>(srcFile.gcount()));
 		srcFile.close();
+
+		normalizeLineEndings(text);
+		setBuffer(std::move(text));
 	}
 	catch (std::exception& e)
 	{
 		LOG_ERROR_STREAM(
 			<< "Exception thrown while reading file \"" << filePath.str() << "\": " << e.what());
-		result.clear();
+		setBuffer(std::string());
 	}
 	catch (...)
 	{
 		LOG_ERROR_STREAM(<< "Unknown exception thrown while reading file \"" << filePath.str() << "\"");
-		result.clear();
-	}
-
-	if (!result.empty())
-	{
-		std::string last = result.back().substr(0, result.back().size() - 1);
-		result.pop_back();
-		if (!last.empty())
-		{
-			result.push_back(last);
-		}
+		setBuffer(std::string());
 	}
-
-	return result;
 }
 
-std::vector<std::string> TextAccess::splitStringByLines(const std::string& text)
+void TextAccess::setBuffer(std::string&& text)
 {
-	std::vector<std::string> result;
-	size_t prevIndex = 0;
-	size_t index = text.find('\n');
-
-	while (index != std::string::npos)
-	{
-		result.push_back(text.substr(prevIndex, index - prevIndex) + '\n');
-
-		prevIndex = index + 1;
-		index = text.find('\n', prevIndex);
-	}
+	m_buffer = std::move(text);
+	m_text = m_buffer;
+}
 
-	if (prevIndex < text.length())
-	{
-		result.push_back(text.substr(prevIndex));
-	}
+const std::vector<uint32_t>& TextAccess::getLineOffsets() const
+{
+	std::call_once(m_lineOffsetsFlag, [this]() {
+		if (m_text.size() > std::numeric_limits<uint32_t>::max())
+		{
+			LOG_ERROR_STREAM(
+				<< "Text of file \"" << m_filePath.str() << "\" is too large to split into lines");
+			m_lineOffsets.push_back(0);
+			return;
+		}
 
-	return result;
+		// memchr is vectorized by the standard library, so this scan runs at memory speed
+		const char* begin = m_text.data();
+		const char* end = begin + m_text.size();
+		const char* lineBegin = begin;
+		while (lineBegin < end)
+		{
+			m_lineOffsets.push_back(static_cast<uint32_t>(lineBegin - begin));
+			const void* lineBreak = std::memchr(lineBegin, '\n', end - lineBegin);
+			lineBegin = lineBreak ? static_cast<const char*>(lineBreak) + 1 : end;
+		}
+		m_lineOffsets.push_back(static_cast<uint32_t>(m_text.size()));
+	});
+	return m_lineOffsets;
 }
 
 TextAccess::TextAccess(): m_filePath(L"") {}
@@ -215,10 +243,10 @@ bool TextAccess::checkIndexInRange(const unsigned int index) const
 		LOG_WARNING_STREAM(<< "Line numbers start with one, is " << index);
 		return false;
 	}
-	else if (index > m_lines.size())
+	else if (index > getLineCount())
 	{
 		LOG_WARNING_STREAM(
-			<< "Tried to access index " << index << ". Maximum index is " << m_lines.size());
+			<< "Tried to access index " << index << ". Maximum index is " << getLineCount());
 		return false;
 	}
 
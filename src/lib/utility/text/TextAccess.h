@@ -1,18 +1,23 @@
 #ifndef TEXT_ACCESS_H
 #define TEXT_ACCESS_H
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "FilePath.h"
 
+// Gives line based access to a text that is kept in one buffer. The offsets of the lines are only
+// computed when lines are accessed.
 class TextAccess
 {
 public:
 	static std::shared_ptr<TextAccess> createFromFile(const FilePath& filePath);
 	static std::shared_ptr<TextAccess> createFromString(
-		const std::string& text, const FilePath& filePath = FilePath());
+		std::string text, const FilePath& filePath = FilePath());
 	static std::shared_ptr<TextAccess> createFromLines(
 		const std::vector<std::string>& lines, const FilePath& filePath = FilePath());
 
@@ -27,28 +32,49 @@ public:
 	 * @param lineNumber: starts with 1
 	 */
 	std::string getLine(const unsigned int lineNumber) const;
+	/**
+	 * @param lineNumber: starts with 1
+	 * The view stays valid as long as this TextAccess exists.
+	 */
+	std::string_view getLineView(const unsigned int lineNumber) const;
 	/**
 	 * @param firstLineNumber: starts with 1
 	 * @param lastLineNumber: starts with 1
 	 */
 	std::vector<std::string> getLines(
 		const unsigned int firstLineNumber, const unsigned int lastLineNumber);
+	// copies all lines on first use, prefer getLineView or getTextView
 	const std::vector<std::string>& getAllLines() const;
 	std::string getText() const;
+	std::string_view getTextView() const;
 
 private:
-	static std::vector<std::string> readFile(const FilePath& filePath);
-	static std::vector<std::string> splitStringByLines(const std::string& text);
+	// uses the line endings of std::getline and ends the last line with a line break
+	static void normalizeLineEndings(std::string& text);
 
 	TextAccess();
 	TextAccess(const TextAccess&);
 	TextAccess operator=(const TextAccess&);
 
+	void readFile(const FilePath& filePath);
+	void setBuffer(std::string&& text);
+
+	const std::vector<uint32_t>& getLineOffsets() const;
+
 	bool checkIndexInRange(const unsigned int index) const;
 	bool checkIndexIntervalInRange(const unsigned int firstIndex, const unsigned int lastIndex) const;
 
 	FilePath m_filePath;
-	std::vector<std::string> m_lines;
+
+	std::string m_buffer;
+	std::string_view m_text;
+
+	// start of each line followed by the end of the text
+	mutable std::once_flag m_lineOffsetsFlag;
+	mutable std::vector<uint32_t> m_lineOffsets;
+
+	mutable std::once_flag m_linesFlag;
+	mutable std::vector<std::string> m_lines;
 };
 
 #endif	  // TEXT_ACCESS_H
@@ -1,272 +1,412 @@
 #include "tracing.h"
 
-#include <set>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+#include "FilePath.h"
+#include "logging.h"
+
+namespace
+{
+std::string getFileName(const char* filePath)
+{
+	const std::string str(filePath);
+	const size_t pos = str.find_last_of("/\\");
+	return pos == std::string::npos ? str : str.substr(pos + 1);
+}
+}	 // namespace
 
-std::shared_ptr<Tracer> Tracer::s_instance;
-Id Tracer::s_nextTraceId = 0;
+struct Tracer::EventChunk
+{
+	EventChunk(): events(s_chunkSize), eventCount(0), nextChunk(nullptr) {}
 
-Tracer* Tracer::getInstance()
+	std::vector<TraceEvent> events;
+	std::atomic<size_t> eventCount;
+	std::atomic<EventChunk*> nextChunk;
+};
+
+struct Tracer::ThreadBuffer
 {
-	if (!s_instance)
+	ThreadBuffer(size_t threadIndex, size_t generation)
+		: threadIndex(threadIndex)
+		, generation(generation)
+		, firstChunk(new EventChunk())
+		, lastChunk(firstChunk)
+		, chunkCount(1)
+		, droppedEventCount(0)
 	{
-		s_instance = std::shared_ptr<Tracer>(new Tracer());
 	}
 
-	return s_instance.get();
-}
+	~ThreadBuffer()
+	{
+		EventChunk* chunk = firstChunk;
+		while (chunk)
+		{
+			EventChunk* nextChunk = chunk->nextChunk.load();
+			delete chunk;
+			chunk = nextChunk;
+		}
+	}
 
-std::shared_ptr<TraceEvent> Tracer::startEvent(const std::string& eventName)
-{
-	std::lock_guard<std::mutex> lock(m_mutex);
+	const size_t threadIndex;
+	const size_t generation;
 
-	const std::thread::id id = std::this_thread::get_id();
+	EventChunk* const firstChunk;
 
-	std::shared_ptr<TraceEvent> event = std::make_shared<TraceEvent>(
-		eventName, s_nextTraceId++, m_startedEvents[id].size());
+	// only accessed by the recording thread
+	EventChunk* lastChunk;
+	size_t chunkCount;
 
-	m_events[id].push_back(event);
-	m_startedEvents[id].push(event.get());
+	std::atomic<size_t> droppedEventCount;
+};
 
-	return event;
+template <typename FuncType>
+void Tracer::forEachEvent(FuncType func) const
+{
+	for (const std::shared_ptr<ThreadBuffer>& buffer: getThreadBuffers())
+	{
+		const EventChunk* chunk = buffer->firstChunk;
+		while (chunk)
+		{
+			const size_t eventCount = chunk->eventCount.load(std::memory_order_acquire);
+			for (size_t i = 0; i < eventCount; i++)
+			{
+				func(chunk->events[i], buffer->threadIndex);
+			}
+
+			chunk = chunk->nextChunk.load(std::memory_order_acquire);
+		}
+	}
 }
 
-void Tracer::finishEvent(std::shared_ptr<TraceEvent> event)
+// created on startup, because events are recorded on all threads
+std::shared_ptr<Tracer> Tracer::s_instance(new Tracer());
+#ifdef TRACING_ENABLED
+std::atomic<bool> Tracer::s_enabled(true);
+#else
+std::atomic<bool> Tracer::s_enabled(false);
+#endif
+const size_t Tracer::s_chunkSize = 1024;
+const size_t Tracer::s_maxChunkCountPerThread = 256;
+
+Tracer* Tracer::getInstance()
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
+	return s_instance.get();
+}
 
-	const std::thread::id id = std::this_thread::get_id();
+long long Tracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
 
-	m_startedEvents[id].pop();
+void Tracer::setEnabled(bool enabled)
+{
+	if (s_enabled.exchange(enabled) != enabled)
+	{
+		LOG_INFO(std::string("Tracing ") + (enabled ? "enabled" : "disabled"));
+	}
 }
 
-void Tracer::printTraces()
+void Tracer::recordEvent(TraceEvent&& event)
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
+	ThreadBuffer* buffer = getThreadBuffer();
 
-	size_t unfinishEvents = 0;
-	for (auto& p: m_startedEvents)
+	EventChunk* chunk = buffer->lastChunk;
+	size_t eventCount = chunk->eventCount.load(std::memory_order_relaxed);
+
+	if (eventCount == s_chunkSize)
 	{
-		unfinishEvents += p.second.size();
+		if (buffer->chunkCount == s_maxChunkCountPerThread)
+		{
+			buffer->droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		EventChunk* nextChunk = new EventChunk();
+		chunk->nextChunk.store(nextChunk, std::memory_order_release);
+		buffer->lastChunk = nextChunk;
+		buffer->chunkCount++;
+
+		chunk = nextChunk;
+		eventCount = 0;
 	}
 
-	if (unfinishEvents > 0)
+	chunk->events[eventCount] = std::move(event);
+
+	// publishes the event to reading threads
+	chunk->eventCount.store(eventCount + 1, std::memory_order_release);
+}
+
+void Tracer::addChromeTraceEvents(std::vector<std::string> events)
+{
+	if (events.empty())
 	{
-		std::cout << "TRACING: Trace events are still running." << std::endl;
 		return;
 	}
-	else if (m_events.empty())
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_externalEvents.insert(
+		m_externalEvents.end(),
+		std::make_move_iterator(events.begin()),
+		std::make_move_iterator(events.end()));
+}
+
+std::vector<std::string> Tracer::takeChromeTraceEvents(
+	int processId, const std::string& processName)
+{
+	std::vector<std::string> events;
+	forEachEvent([&](const TraceEvent& event, size_t threadIndex) {
+		events.push_back(serializeEvent(event, processId, threadIndex));
+	});
+
+	if (!events.empty())
 	{
-		std::cout << "TRACING: No trace events collected." << std::endl;
-		return;
+		events.push_back(serializeProcessName(processId, processName));
 	}
 
+	clear();
 
-	std::cout << "TRACING\n--------------------------\n" << std::endl;
+	return events;
+}
 
-	std::cout << "HISTORY:\n\n";
-	std::cout << "    time                 name                     function";
-	std::cout << "                                          location\n";
-	std::cout << "-----------------------------------------------------------------";
-	std::cout << "------------------------------------------------------------\n";
+std::string Tracer::getChromeTrace() const
+{
+	std::stringstream ss;
+	ss << "{\"traceEvents\":[\n" << serializeProcessName(0, "Sourcetrail");
 
-	for (auto& p: m_events)
+	size_t droppedEventCount = 0;
+	for (const std::shared_ptr<ThreadBuffer>& buffer: getThreadBuffers())
 	{
-		std::cout << "thread: " << p.first << std::endl;
+		droppedEventCount += buffer->droppedEventCount.load(std::memory_order_relaxed);
+	}
 
-		for (const std::shared_ptr<TraceEvent>& event: p.second)
+	forEachEvent([&](const TraceEvent& event, size_t threadIndex) {
+		ss << ",\n" << serializeEvent(event, 0, threadIndex);
+	});
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const std::string& event: m_externalEvents)
 		{
-			std::cout.width(8 + 2 * event->depth);
-			std::cout << std::right << std::setprecision(3) << std::fixed << event->time;
+			ss << ",\n" << event;
+		}
+	}
 
-			std::cout.width(17 - 2 * event->depth);
-			std::cout << " ";
+	ss << "\n],\"displayTimeUnit\":\"ms\"}\n";
 
-			std::cout.width(25);
-			std::cout << std::left << event->eventName;
+	if (droppedEventCount)
+	{
+		LOG_WARNING(
+			"Trace buffers were full, dropped " + std::to_string(droppedEventCount) + " events");
+	}
 
-			std::cout.width(50);
-			std::cout << (event->functionName + "()") << event->locationName << std::endl;
-		}
+	return ss.str();
+}
+
+bool Tracer::writeChromeTrace(const FilePath& filePath) const
+{
+	std::ofstream stream(filePath.str(), std::ios::trunc);
+	stream << getChromeTrace();
+	stream.close();
 
-		std::cout << std::endl;
+	if (stream.fail())
+	{
+		LOG_ERROR(L"Failed to write trace to: " + filePath.wstr());
+		return false;
 	}
 
-	std::cout << "\nREPORT:\n\n";
-	std::cout << "    time      count      name                     function";
-	std::cout << "                                          location\n";
-	std::cout << "-----------------------------------------------------------------";
-	std::cout << "------------------------------------------------------------\n";
+	LOG_INFO(L"Wrote trace to: " + filePath.wstr());
+	return true;
+}
 
+void Tracer::printTraces() const
+{
 	struct AccumulatedTraceEvent
 	{
-		TraceEvent* event;
-		size_t count;
-		float time;
+		std::string name;
+		std::string functionName;
+		std::string locationName;
+		size_t count = 0;
+		long long durationMicroseconds = 0;
 	};
 
 	std::map<std::string, AccumulatedTraceEvent> accumulatedEvents;
 
-	for (auto& p: m_events)
-	{
-		for (const std::shared_ptr<TraceEvent>& event: p.second)
+	forEachEvent([&](const TraceEvent& event, size_t threadIndex) {
+		const std::string name = event.name.empty() ? event.staticName : event.name;
+		const std::string locationName = getFileName(event.fileName) + ":" +
+			std::to_string(event.lineNumber);
+
+		AccumulatedTraceEvent& acc = accumulatedEvents[name + event.functionName + locationName];
+		if (!acc.count)
 		{
-			const std::string name = event->eventName + event->functionName + event->locationName;
+			acc.name = name;
+			acc.functionName = event.functionName;
+			acc.locationName = locationName;
+		}
 
-			std::pair<std::map<std::string, AccumulatedTraceEvent>::iterator, bool> p =
-				accumulatedEvents.emplace(name, AccumulatedTraceEvent());
+		acc.count++;
+		acc.durationMicroseconds += event.durationMicroseconds;
+	});
 
-			AccumulatedTraceEvent* acc = &p.first->second;
-			if (p.second)
-			{
-				acc->event = event.get();
-				acc->time = static_cast<float>(event->time);
-				acc->count = 1;
-			}
-			else
-			{
-				acc->time += static_cast<float>(event->time);
-				acc->count++;
-			}
-		}
+	std::vector<const AccumulatedTraceEvent*> sortedEvents;
+	for (const auto& p: accumulatedEvents)
+	{
+		sortedEvents.push_back(&p.second);
 	}
 
-	std::multiset<
-		AccumulatedTraceEvent,
-		std::function<bool(const AccumulatedTraceEvent&, const AccumulatedTraceEvent&)>>
-		sortedEvents([](const AccumulatedTraceEvent& a, const AccumulatedTraceEvent& b) {
-			return a.time > b.time;
+	std::sort(
+		sortedEvents.begin(),
+		sortedEvents.end(),
+		[](const AccumulatedTraceEvent* a, const AccumulatedTraceEvent* b) {
+			return a->durationMicroseconds > b->durationMicroseconds;
 		});
 
-	for (const std::pair<std::string, AccumulatedTraceEvent>& p: accumulatedEvents)
-	{
-		sortedEvents.insert(p.second);
-	}
+	std::cout << "\nREPORT:\n\n";
+	std::cout << "    time      count      name                     function";
+	std::cout << "                                          location\n";
+	std::cout << "-----------------------------------------------------------------";
+	std::cout << "------------------------------------------------------------\n";
 
-	for (const AccumulatedTraceEvent& acc: sortedEvents)
+	for (const AccumulatedTraceEvent* acc: sortedEvents)
 	{
 		std::cout.width(8);
-		std::cout << std::right << std::setprecision(3) << std::fixed << acc.time;
+		std::cout << std::right << std::setprecision(3) << std::fixed
+				  << acc->durationMicroseconds / 1000000.0;
 
 		std::cout.width(10);
-		std::cout << acc.count << "       ";
+		std::cout << acc->count << "       ";
 
 		std::cout.width(25);
-		std::cout << std::left << acc.event->eventName;
+		std::cout << std::left << acc->name;
 
 		std::cout.width(50);
-		std::cout << (acc.event->functionName + "()") << acc.event->locationName << std::endl;
+		std::cout << (acc->functionName + "()") << acc->locationName << std::endl;
 	}
 
 	std::cout << std::endl;
-
-	m_events.clear();
 }
 
-Tracer::Tracer() {}
-
-
-std::shared_ptr<AccumulatingTracer> AccumulatingTracer::s_instance;
-Id AccumulatingTracer::s_nextTraceId = 0;
-
-AccumulatingTracer* AccumulatingTracer::getInstance()
+void Tracer::clear()
 {
-	if (!s_instance)
-	{
-		s_instance = std::shared_ptr<AccumulatingTracer>(new AccumulatingTracer());
-	}
+	std::lock_guard<std::mutex> lock(m_mutex);
 
-	return s_instance.get();
+	// threads still holding a buffer of the previous generation replace it on their next event
+	m_threadBuffers.clear();
+	m_externalEvents.clear();
+	m_generation++;
 }
 
-std::shared_ptr<TraceEvent> AccumulatingTracer::startEvent(const std::string& eventName)
+size_t Tracer::getEventCount() const
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
-
-	const std::thread::id id = std::this_thread::get_id();
-
-	std::shared_ptr<TraceEvent> event = std::make_shared<TraceEvent>(
-		eventName, s_nextTraceId++, m_startedEvents[id].size());
-
-	m_startedEvents[id].push(event.get());
-
-	return event;
+	size_t eventCount = 0;
+	forEachEvent([&eventCount](const TraceEvent& event, size_t threadIndex) { eventCount++; });
+	return eventCount;
 }
 
-void AccumulatingTracer::finishEvent(std::shared_ptr<TraceEvent> event)
+std::string Tracer::escapeJson(const std::string& str)
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
-
-	const std::thread::id id = std::this_thread::get_id();
-
-	m_startedEvents[id].pop();
+	std::string escaped;
+	escaped.reserve(str.size());
 
-	const std::string name = event->eventName + event->functionName + event->locationName;
-
-	std::pair<std::map<std::string, AccumulatedTraceEvent>::iterator, bool> p =
-		m_accumulatedEvents.emplace(name, AccumulatedTraceEvent());
-
-	AccumulatedTraceEvent* acc = &p.first->second;
-	if (p.second)
-	{
-		acc->event = TraceEvent(*(event.get()));
-		acc->time = event->time;
-		acc->count = 1;
-	}
-	else
+	for (const char c: str)
 	{
-		acc->time += event->time;
-		acc->count++;
+		switch (c)
+		{
+		case '"':
+			escaped += "\\\"";
+			break;
+		case '\\':
+			escaped += "\\\\";
+			break;
+		case '\n':
+			escaped += "\\n";
+			break;
+		case '\t':
+			escaped += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				std::stringstream ss;
+				ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+				escaped += ss.str();
+			}
+			else
+			{
+				escaped += c;
+			}
+		}
 	}
+
+	return escaped;
 }
 
-void AccumulatingTracer::printTraces()
+std::string Tracer::serializeEvent(const TraceEvent& event, int processId, size_t threadIndex)
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
-
-	for (auto& p: m_startedEvents)
+	std::string name = event.name;
+	if (name.empty())
 	{
-		if (!p.second.empty())
-		{
-			std::cout << "TRACING: Trace events are still running." << std::endl;
-		}
+		name = *event.staticName ? event.staticName : event.functionName;
 	}
 
-	std::cout << "\nREPORT:\n\n";
-	std::cout << "    time      count      name                     function";
-	std::cout << "                                          location\n";
-	std::cout << "-----------------------------------------------------------------";
-	std::cout << "------------------------------------------------------------\n";
-
-	std::multiset<
-		AccumulatedTraceEvent,
-		std::function<bool(const AccumulatedTraceEvent&, const AccumulatedTraceEvent&)>>
-		sortedEvents([](const AccumulatedTraceEvent& a, const AccumulatedTraceEvent& b) {
-			return a.time > b.time;
-		});
+	std::stringstream ss;
+	ss << "{\"name\":\"" << escapeJson(name) << "\",\"cat\":\"" << event.category
+	   << "\",\"ph\":\"X\",\"ts\":" << event.startMicroseconds
+	   << ",\"dur\":" << event.durationMicroseconds << ",\"pid\":" << processId
+	   << ",\"tid\":" << threadIndex << ",\"args\":{";
 
-	for (const std::pair<std::string, AccumulatedTraceEvent>& p: m_accumulatedEvents)
+	bool hasArgs = false;
+	if (*event.functionName)
 	{
-		sortedEvents.insert(p.second);
+		ss << "\"function\":\"" << escapeJson(event.functionName) << "\",\"location\":\""
+		   << escapeJson(getFileName(event.fileName)) << ":" << event.lineNumber << "\"";
+		hasArgs = true;
 	}
 
-	for (const AccumulatedTraceEvent& acc: sortedEvents)
+	if (!event.detail.empty())
 	{
-		std::cout.width(8);
-		std::cout << std::right << std::setprecision(3) << std::fixed << acc.time;
+		ss << (hasArgs ? "," : "") << "\"detail\":\"" << escapeJson(event.detail) << "\"";
+	}
 
-		std::cout.width(10);
-		std::cout << acc.count << "       ";
+	ss << "}}";
+	return ss.str();
+}
 
-		std::cout.width(25);
-		std::cout << std::left << acc.event.eventName;
+std::string Tracer::serializeProcessName(int processId, const std::string& processName)
+{
+	return "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(processId) +
+		",\"args\":{\"name\":\"" + escapeJson(processName) + "\"}}";
+}
 
-		std::cout.width(50);
-		std::cout << (acc.event.functionName + "()") << acc.event.locationName << std::endl;
-	}
+Tracer::Tracer(): m_generation(0), m_nextThreadIndex(1) {}
 
-	std::cout << std::endl;
+Tracer::ThreadBuffer* Tracer::getThreadBuffer()
+{
+	thread_local std::shared_ptr<ThreadBuffer> threadBuffer;
+	thread_local const size_t threadIndex = m_nextThreadIndex++;
 
-	m_accumulatedEvents.clear();
+	if (!threadBuffer ||
+		threadBuffer->generation != m_generation.load(std::memory_order_relaxed))
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		threadBuffer = std::make_shared<ThreadBuffer>(threadIndex, m_generation.load());
+		m_threadBuffers.push_back(threadBuffer);
+	}
+
+	return threadBuffer.get();
 }
 
-AccumulatingTracer::AccumulatingTracer() {}
+std::vector<std::shared_ptr<Tracer::ThreadBuffer>> Tracer::getThreadBuffers() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_threadBuffers;
+}
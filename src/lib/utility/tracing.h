@@ -2,153 +2,162 @@
 #define TRACING_H
 
 
+// starts recording traces on startup and enables PRINT_TRACES()
 // #define TRACING_ENABLED
-// #define USE_ACCUMULATED_TRACING
 
 
+#include <atomic>
+#include <memory>
 #include <mutex>
-#include <stack>
-#include <thread>
+#include <string>
+#include <vector>
 
-#include "FilePath.h"
-#include "TimeStamp.h"
-#include "types.h"
-#include "utilityString.h"
+class FilePath;
 
 struct TraceEvent
 {
-public:
-	TraceEvent(): eventName(""), id(0), depth(0), time(0.0) {}
-
-	TraceEvent(const std::string& eventName, Id id, size_t depth)
-		: eventName(eventName), id(id), depth(depth), time(0.0)
-	{
-	}
-
-	std::string eventName;
-	Id id;
-	size_t depth;
+	const char* category = "";
+	const char* staticName = "";	// used if name is empty
+	std::string name;
+	std::string detail;
 
-	std::string functionName;
-	std::string locationName;
+	const char* functionName = "";
+	const char* fileName = "";
+	int lineNumber = 0;
 
-	double time;
+	long long startMicroseconds = 0;
+	long long durationMicroseconds = 0;
 };
 
 
+// Records trace events while enabled at runtime. Every thread appends to its own buffer, which is
+// only read by other threads up to the last published event, so recording takes no locks. Events
+// are exported in the Chrome trace event format, which can be opened with chrome://tracing or
+// ui.perfetto.dev.
 class Tracer
 {
 public:
 	static Tracer* getInstance();
 
-	std::shared_ptr<TraceEvent> startEvent(const std::string& eventName);
-	void finishEvent(std::shared_ptr<TraceEvent> event);
+	static bool isEnabled()
+	{
+		return s_enabled.load(std::memory_order_relaxed);
+	}
 
-	void printTraces();
+	// microseconds of a monotonic clock shared by all processes on this machine
+	static long long now();
 
-private:
-	static std::shared_ptr<Tracer> s_instance;
-	static Id s_nextTraceId;
+	void setEnabled(bool enabled);
 
-	Tracer();
-	Tracer(const Tracer&) = delete;
-	void operator=(const Tracer&) = delete;
+	void recordEvent(TraceEvent&& event);
 
-	std::map<std::thread::id, std::vector<std::shared_ptr<TraceEvent>>> m_events;
-	std::map<std::thread::id, std::stack<TraceEvent*>> m_startedEvents;
+	// events serialized by another process, e.g. an indexer process
+	void addChromeTraceEvents(std::vector<std::string> events);
 
-	std::mutex m_mutex;
-};
+	// serializes all events recorded so far, labeled with the given process id, and clears them
+	std::vector<std::string> takeChromeTraceEvents(int processId, const std::string& processName);
 
+	std::string getChromeTrace() const;
+	bool writeChromeTrace(const FilePath& filePath) const;
 
-class AccumulatingTracer
-{
-public:
-	static AccumulatingTracer* getInstance();
+	// prints the accumulated durations of all recorded events
+	void printTraces() const;
 
-	std::shared_ptr<TraceEvent> startEvent(const std::string& eventName);
-	void finishEvent(std::shared_ptr<TraceEvent> event);
+	void clear();
 
-	void printTraces();
+	size_t getEventCount() const;
 
 private:
-	struct AccumulatedTraceEvent
-	{
-		TraceEvent event;
-		size_t count;
-		double time;
-	};
+	struct EventChunk;
+	struct ThreadBuffer;
 
-	static std::shared_ptr<AccumulatingTracer> s_instance;
-	static Id s_nextTraceId;
+	static std::string escapeJson(const std::string& str);
+	static std::string serializeEvent(const TraceEvent& event, int processId, size_t threadIndex);
+	static std::string serializeProcessName(int processId, const std::string& processName);
+
+	static std::shared_ptr<Tracer> s_instance;
+	static std::atomic<bool> s_enabled;
+	static const size_t s_chunkSize;
+	static const size_t s_maxChunkCountPerThread;
+
+	Tracer();
+	Tracer(const Tracer&) = delete;
+	void operator=(const Tracer&) = delete;
 
-	AccumulatingTracer();
-	AccumulatingTracer(const AccumulatingTracer&) = delete;
-	void operator=(const AccumulatingTracer&) = delete;
+	ThreadBuffer* getThreadBuffer();
+	std::vector<std::shared_ptr<ThreadBuffer>> getThreadBuffers() const;
 
-	std::map<std::string, AccumulatedTraceEvent> m_accumulatedEvents;
-	std::map<std::thread::id, std::stack<TraceEvent*>> m_startedEvents;
+	template <typename FuncType>
+	void forEachEvent(FuncType func) const;
 
-	std::mutex m_mutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_threadBuffers;
+	std::vector<std::string> m_externalEvents;
+	std::atomic<size_t> m_generation;
+	std::atomic<size_t> m_nextThreadIndex;
+	mutable std::mutex m_mutex;
 };
 
 
-template <typename TracerType>
+// Records the lifetime of the scope as trace event, if tracing is enabled.
 class ScopedTrace
 {
 public:
 	ScopedTrace(
-		const std::string& eventName,
-		const std::string& fileName,
-		int lineNumber,
-		const std::string& functionName);
-	~ScopedTrace();
-
-private:
-	std::shared_ptr<TraceEvent> m_event;
-	TimeStamp m_timeStamp;
-};
-
-template <typename TracerType>
-ScopedTrace<TracerType>::ScopedTrace(
-	const std::string& eventName,
-	const std::string& fileName,
-	int lineNumber,
-	const std::string& functionName)
-{
-	m_event = TracerType::getInstance()->startEvent(eventName);
-	m_event->functionName = functionName;
-	m_event->locationName = utility::encodeToUtf8(FilePath(fileName).fileName()) + ":" +
-		std::to_string(lineNumber);
+		const char* category,
+		const char* name,
+		const char* fileName = "",
+		int lineNumber = 0,
+		const char* functionName = "")
+		: m_recording(Tracer::isEnabled())
+	{
+		if (m_recording)
+		{
+			m_event.category = category;
+			m_event.staticName = name;
+			m_event.fileName = fileName;
+			m_event.lineNumber = lineNumber;
+			m_event.functionName = functionName;
+			m_event.startMicroseconds = Tracer::now();
+		}
+	}
 
-	m_timeStamp = TimeStamp::now();
-}
+	~ScopedTrace()
+	{
+		if (m_recording)
+		{
+			m_event.durationMicroseconds = Tracer::now() - m_event.startMicroseconds;
+			Tracer::getInstance()->recordEvent(std::move(m_event));
+		}
+	}
 
-template <typename TracerType>
-ScopedTrace<TracerType>::~ScopedTrace()
-{
-	m_event->time = TimeStamp::durationSeconds(m_timeStamp);
-	TracerType::getInstance()->finishEvent(m_event);
-}
+	// check before building names and details, so disabled tracing costs nothing
+	bool isRecording() const
+	{
+		return m_recording;
+	}
 
+	void setName(const std::string& name)
+	{
+		m_event.name = name;
+	}
 
-#ifdef TRACING_ENABLED
-#	ifdef USE_ACCUMULATED_TRACING
-#		define TRACE(__name__)                                                                    \
-			ScopedTrace<AccumulatingTracer> __trace__(                                             \
-				std::string(__name__), __FILE__, __LINE__, __FUNCTION__)
+	void setDetail(const std::string& detail)
+	{
+		m_event.detail = detail;
+	}
 
-#		define PRINT_TRACES() AccumulatingTracer::getInstance()->printTraces()
-#	else
-#		define TRACE(__name__)                                                                    \
-			ScopedTrace<Tracer> __trace__(std::string(__name__), __FILE__, __LINE__, __FUNCTION__)
+private:
+	const bool m_recording;
+	TraceEvent m_event;
+};
 
-#		define PRINT_TRACES() Tracer::getInstance()->printTraces()
-#	endif
 
+#define TRACE(__name__)                                                                            \
+	ScopedTrace __trace__("trace", "" __name__, __FILE__, __LINE__, __FUNCTION__)
 
+#ifdef TRACING_ENABLED
+#	define PRINT_TRACES() Tracer::getInstance()->printTraces()
 #else
-#	define TRACE(__name__)
 #	define PRINT_TRACES()
 #endif
 
@@ -1,17 +1,26 @@
 #include "QtCodeFile.h"
 
+#include <QFontMetrics>
 #include <QStyle>
 #include <QVBoxLayout>
 
+#include "ApplicationSettings.h"
 #include "MessageChangeFileView.h"
 
 #include "QtCodeFileTitleBar.h"
 #include "QtCodeNavigator.h"
 #include "QtCodeSnippet.h"
 #include "SourceLocationFile.h"
+#include "TextCodec.h"
+#include "utilityString.h"
 
 QtCodeFile::QtCodeFile(const FilePath& filePath, QtCodeNavigator* navigator, bool isFirst)
-	: QFrame(), m_navigator(navigator), m_filePath(filePath), m_isWholeFile(false)
+	: QFrame()
+	, m_navigator(navigator)
+	, m_releasedSnippetsHeight(0)
+	, m_showsSnippets(false)
+	, m_filePath(filePath)
+	, m_isWholeFile(false)
 {
 	setObjectName(QStringLiteral("code_file"));
 	setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Fixed);
@@ -43,6 +52,10 @@ QtCodeFile::QtCodeFile(const FilePath& filePath, QtCodeNavigator* navigator, boo
 	m_snippetLayout->setSpacing(0);
 	layout->addLayout(m_snippetLayout);
 
+	m_snippetPlaceholder = new QWidget(this);
+	m_snippetPlaceholder->hide();
+	layout->addWidget(m_snippetPlaceholder);
+
 	setMinimized();
 	update();
 }
@@ -87,6 +100,16 @@ QtCodeSnippet* QtCodeFile::addCodeSnippet(const CodeSnippetParams& params)
 
 void QtCodeFile::updateSourceLocations(const CodeSnippetParams& params)
 {
+	for (CodeSnippetParams& snippetParams: m_snippetParams)
+	{
+		if ((m_isWholeFile && m_snippetParams.size() == 1) ||
+			(snippetParams.startLineNumber == params.startLineNumber &&
+			 snippetParams.endLineNumber == params.endLineNumber))
+		{
+			snippetParams.locationFile = params.locationFile;
+		}
+	}
+
 	if (m_isWholeFile && m_snippets.size() == 1)
 	{
 		m_snippets[0]->updateSourceLocations(params);
@@ -103,6 +126,69 @@ void QtCodeFile::updateSourceLocations(const CodeSnippetParams& params)
 	}
 }
 
+void QtCodeFile::setSnippetParams(const std::vector<CodeSnippetParams>& snippetParams)
+{
+	clearSnippets();
+
+	m_snippetParams = snippetParams;
+
+	for (const CodeSnippetParams& params: m_snippetParams)
+	{
+		if (params.locationFile->isWhole())
+		{
+			m_isWholeFile = true;
+		}
+	}
+
+	updateSnippetPlaceholder();
+}
+
+const std::vector<CodeSnippetParams>& QtCodeFile::getSnippetParams() const
+{
+	return m_snippetParams;
+}
+
+bool QtCodeFile::createSnippets()
+{
+	if (m_snippets.size() || m_snippetParams.empty())
+	{
+		return false;
+	}
+
+	for (const CodeSnippetParams& params: m_snippetParams)
+	{
+		addCodeSnippet(params);
+	}
+
+	updateSnippets();
+
+	for (QtCodeSnippet* snippet: m_snippets)
+	{
+		snippet->updateContent();
+		snippet->setVisible(m_showsSnippets);
+	}
+
+	m_snippetPlaceholder->hide();
+	return true;
+}
+
+bool QtCodeFile::releaseSnippets()
+{
+	if (m_snippets.empty() || hasFocus(m_navigator->getCurrentFocus()))
+	{
+		return false;
+	}
+
+	if (m_showsSnippets)
+	{
+		m_releasedSnippetsHeight = m_snippetLayout->sizeHint().height();
+	}
+
+	deleteSnippets();
+	updateSnippetPlaceholder();
+	return true;
+}
+
 const std::vector<QtCodeSnippet*>& QtCodeFile::getSnippets() const
 {
 	return m_snippets;
@@ -233,44 +319,42 @@ void QtCodeFile::toggleCollapsed()
 
 void QtCodeFile::setMinimized()
 {
+	m_showsSnippets = false;
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		snippet->hide();
 	}
 
+	m_snippetPlaceholder->hide();
 	m_titleBar->setMinimized();
 }
 
 void QtCodeFile::setSnippets()
 {
+	m_showsSnippets = true;
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		snippet->show();
 	}
 
+	updateSnippetPlaceholder();
 	m_titleBar->setSnippets();
 }
 
 bool QtCodeFile::hasSnippets() const
 {
-	return m_snippets.size() > 0;
+	return m_snippets.size() > 0 || m_snippetParams.size() > 0;
 }
 
 void QtCodeFile::clearSnippets()
 {
-	for (QtCodeSnippet* snippet: m_snippets)
-	{
-		m_snippetLayout->removeWidget(snippet);
-		snippet->hide();
-		snippet->deleteLater();
-	}
-
-	if (m_snippets.size())
-	{
-		m_navigator->clearSnippetReferences();
-	}
+	deleteSnippets();
 
-	m_snippets.clear();
+	m_snippetParams.clear();
+	m_releasedSnippetsHeight = 0;
+	m_snippetPlaceholder->hide();
 }
 
 void QtCodeFile::updateSnippets()
@@ -302,6 +386,22 @@ void QtCodeFile::updateTitleBar()
 void QtCodeFile::findScreenMatches(
 	const std::wstring& query, std::vector<std::pair<QtCodeArea*, Id>>* screenMatches)
 {
+	// snippets that were not created yet are searched in their params and created on a match
+	if (m_showsSnippets && m_snippets.empty() && !m_snippetParams.empty())
+	{
+		TextCodec codec(ApplicationSettings::getInstance()->getTextEncoding());
+		for (const CodeSnippetParams& params: m_snippetParams)
+		{
+			const std::wstring code = utility::toLowerCase(
+				codec.decode(utility::replace(params.code, "\r", "")));
+			if (code.find(query) != std::wstring::npos)
+			{
+				createSnippets();
+				break;
+			}
+		}
+	}
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		if (snippet->isVisible())
@@ -331,6 +431,15 @@ bool QtCodeFile::hasFocus(const CodeFocusHandler::Focus& focus) const
 
 bool QtCodeFile::setFocus(Id locationId)
 {
+	for (const CodeSnippetParams& params: m_snippetParams)
+	{
+		if (params.locationFile->getSourceLocationById(locationId))
+		{
+			createSnippets();
+			break;
+		}
+	}
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		if (snippet->setFocus(locationId))
@@ -344,6 +453,11 @@ bool QtCodeFile::setFocus(Id locationId)
 
 bool QtCodeFile::moveFocus(const CodeFocusHandler::Focus& focus, CodeFocusHandler::Direction direction)
 {
+	if (direction == CodeFocusHandler::Direction::DOWN && focus.file == this && !isCollapsed())
+	{
+		createSnippets();
+	}
+
 	if (direction == CodeFocusHandler::Direction::DOWN && focus.file == this && !isCollapsed() &&
 		m_snippets.size())
 	{
@@ -394,6 +508,11 @@ void QtCodeFile::focusTop()
 
 void QtCodeFile::focusBottom()
 {
+	if (!isCollapsed())
+	{
+		createSnippets();
+	}
+
 	if (!isCollapsed() && m_snippets.size())
 	{
 		m_snippets.back()->focusBottom();
@@ -483,3 +602,61 @@ void QtCodeFile::updateRefCount(int refCount)
 
 	m_titleBar->updateRefCount(refCount, hasErrors, fatalErrorCount);
 }
+
+void QtCodeFile::deleteSnippets()
+{
+	for (QtCodeSnippet* snippet: m_snippets)
+	{
+		m_snippetLayout->removeWidget(snippet);
+		snippet->hide();
+		snippet->deleteLater();
+	}
+
+	if (m_snippets.size())
+	{
+		m_navigator->clearSnippetReferences();
+	}
+
+	m_snippets.clear();
+}
+
+void QtCodeFile::updateSnippetPlaceholder()
+{
+	if (m_snippets.size() || m_snippetParams.empty() || !m_showsSnippets)
+	{
+		m_snippetPlaceholder->hide();
+		return;
+	}
+
+	int height = m_releasedSnippetsHeight;
+	if (!height)
+	{
+		// estimated by line count until the snippets were shown once
+		ApplicationSettings* appSettings = ApplicationSettings::getInstance().get();
+		QFont font(appSettings->getFontName().c_str());
+		font.setPixelSize(appSettings->getFontSize());
+		const int lineHeight = QFontMetrics(font).lineSpacing();
+
+		for (const CodeSnippetParams& params: m_snippetParams)
+		{
+			size_t lineCount = 1;
+			if (params.endLineNumber > params.startLineNumber)
+			{
+				lineCount += params.endLineNumber - params.startLineNumber;
+			}
+			if (!params.title.empty() && !params.isOverview)
+			{
+				lineCount++;
+			}
+			if (!params.footer.empty())
+			{
+				lineCount++;
+			}
+
+			height += static_cast<int>(lineCount) * lineHeight + 5;
+		}
+	}
+
+	m_snippetPlaceholder->setFixedHeight(height);
+	m_snippetPlaceholder->show();
+}
@@ -37,6 +37,13 @@ public:
 	QtCodeSnippet* addCodeSnippet(const CodeSnippetParams& params);
 	void updateSourceLocations(const CodeSnippetParams& params);
 
+	// The snippet widgets are only created while the file is close to the visible part of the
+	// list, otherwise a placeholder with the height of the snippets is shown.
+	void setSnippetParams(const std::vector<CodeSnippetParams>& snippetParams);
+	const std::vector<CodeSnippetParams>& getSnippetParams() const;
+	bool createSnippets();
+	bool releaseSnippets();
+
 	const std::vector<QtCodeSnippet*>& getSnippets() const;
 	std::vector<QtCodeSnippet*> getVisibleSnippets() const;
 	QtCodeSnippet* getSnippetForLocationId(Id locationId) const;
@@ -80,6 +87,8 @@ public slots:
 
 private:
 	void updateRefCount(int refCount);
+	void deleteSnippets();
+	void updateSnippetPlaceholder();
 
 	QtCodeNavigator* m_navigator;
 
@@ -87,6 +96,11 @@ private:
 
 	QVBoxLayout* m_snippetLayout;
 	std::vector<QtCodeSnippet*> m_snippets;
+	std::vector<CodeSnippetParams> m_snippetParams;
+
+	QWidget* m_snippetPlaceholder;
+	int m_releasedSnippetsHeight;
+	bool m_showsSnippets;
 
 	const FilePath m_filePath;
 	bool m_isWholeFile;
@@ -155,17 +155,17 @@ void QtCodeFileList::addFile(const CodeFileParams& params)
 	else
 	{
 		bool same = true;
-		const std::vector<QtCodeSnippet*> snippets = file->getSnippets();
-		if (params.snippetParams.size() != snippets.size())
+		const std::vector<CodeSnippetParams>& snippetParams = file->getSnippetParams();
+		if (params.snippetParams.size() != snippetParams.size())
 		{
 			same = false;
 		}
 		else
 		{
-			for (size_t i = 0; i < snippets.size(); i++)
+			for (size_t i = 0; i < snippetParams.size(); i++)
 			{
-				if (params.snippetParams[i].startLineNumber != snippets[i]->getStartLineNumber() ||
-					params.snippetParams[i].endLineNumber != snippets[i]->getEndLineNumber())
+				if (params.snippetParams[i].startLineNumber != snippetParams[i].startLineNumber ||
+					params.snippetParams[i].endLineNumber != snippetParams[i].endLineNumber)
 				{
 					same = false;
 					break;
@@ -183,12 +183,7 @@ void QtCodeFileList::addFile(const CodeFileParams& params)
 				focusedLocationId = currentFocus.locationId;
 			}
 
-			file->clearSnippets();
-
-			for (const CodeSnippetParams& snippetParams: params.snippetParams)
-			{
-				file->addCodeSnippet(snippetParams);
-			}
+			file->setSnippetParams(params.snippetParams);
 
 			if (focusedLocationId)
 			{
@@ -224,6 +219,8 @@ void QtCodeFileList::updateFiles()
 		file->show();
 	}
 
+	updateVisibleSnippets();
+
 	// Perform delayed so all widgets are already visible
 	QTimer::singleShot(100, this, &QtCodeFileList::updateSnippetTitleAndScrollBarSlot);
 }
@@ -243,6 +240,16 @@ void QtCodeFileList::scrollTo(
 		return;
 	}
 
+	if (file->createSnippets())
+	{
+		// scroll once the layout of the new snippets is done
+		QTimer::singleShot(0, this, [=]() {
+			scrollTo(
+				filePath, lineNumber, locationId, scopeLocationId, animated, target, focusTarget);
+		});
+		return;
+	}
+
 	QtCodeSnippet* snippet = nullptr;
 
 	Id targetLocationId = scopeLocationId ? scopeLocationId : locationId;
@@ -443,6 +450,8 @@ void QtCodeFileList::updateSnippetTitleAndScrollBarSlot()
 
 void QtCodeFileList::updateSnippetTitleAndScrollBar(int value)
 {
+	updateVisibleSnippets();
+
 	QtCodeFile* firstFile = nullptr;
 	QScrollBar* lastSnippetScrollBar = nullptr;
 	int fileTitleBarOffset = 0;
@@ -491,6 +500,43 @@ void QtCodeFileList::updateSnippetTitleAndScrollBar(int value)
 	updateLastSnippetScrollBar(lastSnippetScrollBar);
 }
 
+void QtCodeFileList::updateVisibleSnippets()
+{
+	const int viewportHeight = m_scrollArea->viewport()->height();
+	const int visibleTop = m_scrollArea->verticalScrollBar()->value();
+	const int visibleBottom = visibleTop + viewportHeight;
+
+	// snippets are created a bit ahead of scrolling and released only far away from the viewport
+	const int createMargin = viewportHeight / 2;
+	const int releaseMargin = viewportHeight * 3;
+
+	// screen matches keep pointers to the code areas of the snippets
+	const bool canRelease = !m_navigator->hasScreenMatches();
+
+	// the file positions are computed from the size hints, so they are known before the layout
+	int fileTop = 0;
+	for (QtCodeFile* file: m_files)
+	{
+		int fileBottom = fileTop + file->sizeHint().height();
+
+		if (fileBottom >= visibleTop - createMargin && fileTop <= visibleBottom + createMargin)
+		{
+			if (file->createSnippets())
+			{
+				fileBottom = fileTop + file->sizeHint().height();
+			}
+		}
+		else if (
+			canRelease &&
+			(fileBottom < visibleTop - releaseMargin || fileTop > visibleBottom + releaseMargin))
+		{
+			file->releaseSnippets();
+		}
+
+		fileTop = fileBottom;
+	}
+}
+
 void QtCodeFileList::scrollLastSnippet(int value)
 {
 	if (m_mirroredSnippetScrollBar && m_mirroredSnippetScrollBar->value() != value)
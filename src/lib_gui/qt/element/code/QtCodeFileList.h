@@ -75,6 +75,7 @@ protected:
 private slots:
 	void updateSnippetTitleAndScrollBarSlot();
 	void updateSnippetTitleAndScrollBar(int value = 0);
+	void updateVisibleSnippets();
 
 	void scrollLastSnippet(int value);
 	void scrollLastSnippetScrollBar(int value);
@@ -1,6 +1,9 @@
 #include "QtGraphicsView.h"
 
+#include <algorithm>
+
 #include <QDir>
+#include <QGraphicsScene>
 #include <QMouseEvent>
 #include <QScrollBar>
 #include <QTimer>
@@ -34,6 +37,10 @@
 #include "utilityApp.h"
 #include "utilityQt.h"
 
+const float QtGraphicsView::s_levelOfDetailZoomFactor = 0.35f;
+const int QtGraphicsView::s_levelOfDetailItemCount = 2000;
+const int QtGraphicsView::s_levelOfDetailPixmapSize = 4096;
+
 QtGraphicsView::QtGraphicsView(GraphFocusHandler* focusHandler, QWidget* parent)
 	: QGraphicsView(parent)
 	, m_focusHandler(focusHandler)
@@ -187,6 +194,19 @@ void QtGraphicsView::setSceneRect(const QRectF& rect)
 	scene()->setSceneRect(rect);
 	m_imageCached = toQImage();
 	m_tabId = TabId::currentTab();
+
+	// hover and focus changes repaint single items, which are rendered into the pixmap again
+	connect(
+		scene(),
+		&QGraphicsScene::changed,
+		this,
+		&QtGraphicsView::sceneChanged,
+		Qt::UniqueConnection);
+
+	m_sceneItemCount = scene()->items().size();
+	m_levelOfDetailPixmap = QPixmap();
+	m_levelOfDetailPixmapDirty = true;
+	updateLevelOfDetail();
 }
 
 QtGraphNode* QtGraphicsView::getNodeAtCursorPosition() const
@@ -289,6 +309,51 @@ void QtGraphicsView::resizeEvent(QResizeEvent* event)
 	emit resized();
 }
 
+void QtGraphicsView::drawItems(
+	QPainter* painter,
+	int numItems,
+	QGraphicsItem* items[],
+	const QStyleOptionGraphicsItem options[])
+{
+	// items are only routed here while the level of detail pixmap is used, see drawForeground
+	if (usesLevelOfDetail())
+	{
+		if (m_levelOfDetailPixmapDirty)
+		{
+			updateLevelOfDetailPixmap();
+		}
+
+		if (!m_levelOfDetailPixmap.isNull())
+		{
+			return;
+		}
+	}
+
+	QGraphicsView::drawItems(painter, numItems, items, options);
+}
+
+void QtGraphicsView::drawForeground(QPainter* painter, const QRectF& rect)
+{
+	if (usesLevelOfDetail())
+	{
+		if (m_levelOfDetailPixmapDirty)
+		{
+			updateLevelOfDetailPixmap();
+		}
+
+		if (!m_levelOfDetailPixmap.isNull())
+		{
+			painter->save();
+			painter->setRenderHint(QPainter::SmoothPixmapTransform);
+			painter->drawPixmap(
+				scene()->sceneRect(), m_levelOfDetailPixmap, QRectF(m_levelOfDetailPixmap.rect()));
+			painter->restore();
+		}
+	}
+
+	QGraphicsView::drawForeground(painter, rect);
+}
+
 void QtGraphicsView::mousePressEvent(QMouseEvent* event)
 {
 	if (event->button() == Qt::LeftButton && !itemAt(event->pos()))
@@ -829,6 +894,60 @@ void QtGraphicsView::legendClicked()
 	MessageActivateLegend().dispatch();
 }
 
+void QtGraphicsView::sceneChanged(const QList<QRectF>& region)
+{
+	if (m_levelOfDetailPixmapDirty || m_levelOfDetailPixmap.isNull())
+	{
+		return;
+	}
+
+	if (!usesLevelOfDetail())
+	{
+		// rendered again once zoomed out far enough
+		m_levelOfDetailPixmapDirty = true;
+		return;
+	}
+
+	// rendering the whole scene again is slower than painting the items, so only the changed
+	// rects are rendered into the pixmap
+	const QRectF sceneRect = scene()->sceneRect();
+	const qreal scaleX = m_levelOfDetailPixmap.width() / sceneRect.width();
+	const qreal scaleY = m_levelOfDetailPixmap.height() / sceneRect.height();
+
+	QPainter painter(&m_levelOfDetailPixmap);
+	painter.setRenderHints(renderHints());
+
+	for (const QRectF& rect: region)
+	{
+		const QRectF changedRect = rect.intersected(sceneRect);
+		if (changedRect.isEmpty())
+		{
+			continue;
+		}
+
+		const QRect target = QRectF(
+								 (changedRect.left() - sceneRect.left()) * scaleX,
+								 (changedRect.top() - sceneRect.top()) * scaleY,
+								 changedRect.width() * scaleX,
+								 changedRect.height() * scaleY)
+								 .toAlignedRect()
+								 .intersected(m_levelOfDetailPixmap.rect());
+		const QRectF source(
+			sceneRect.left() + target.left() / scaleX,
+			sceneRect.top() + target.top() / scaleY,
+			target.width() / scaleX,
+			target.height() / scaleY);
+
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+		painter.fillRect(target, Qt::transparent);
+		painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+		painter.setClipRect(target);
+		scene()->render(&painter, QRectF(target), source, Qt::IgnoreAspectRatio);
+		painter.setClipping(false);
+	}
+}
+
 bool QtGraphicsView::moves() const
 {
 	return m_up || m_down || m_left || m_right;
@@ -854,6 +973,55 @@ void QtGraphicsView::updateTransform()
 {
 	float zoomFactor = m_appZoomFactor * m_zoomFactor;
 	setTransform(QTransform(zoomFactor, 0, 0, zoomFactor, 0, 0));
+	updateLevelOfDetail();
+}
+
+bool QtGraphicsView::usesLevelOfDetail() const
+{
+	return m_sceneItemCount >= s_levelOfDetailItemCount &&
+		getZoomFactor() < s_levelOfDetailZoomFactor;
+}
+
+void QtGraphicsView::updateLevelOfDetail()
+{
+	// indirect painting routes all exposed items through drawItems, where painting them is skipped
+	const bool usesPixmap = usesLevelOfDetail();
+	if (bool(optimizationFlags() & QGraphicsView::IndirectPainting) != usesPixmap)
+	{
+		setOptimizationFlag(QGraphicsView::IndirectPainting, usesPixmap);
+		viewport()->update();
+	}
+}
+
+void QtGraphicsView::updateLevelOfDetailPixmap()
+{
+	m_levelOfDetailPixmapDirty = false;
+	m_levelOfDetailPixmap = QPixmap();
+
+	// rendered at the highest zoom level using it, so zooming out further only scales it down
+	const QRectF rect = scene()->sceneRect();
+	qreal scale = s_levelOfDetailZoomFactor * devicePixelRatioF();
+	const qreal maxSide = std::max(rect.width(), rect.height()) * scale;
+	if (maxSide > s_levelOfDetailPixmapSize)
+	{
+		scale *= s_levelOfDetailPixmapSize / maxSide;
+	}
+
+	const QSize size = (rect.size() * scale).toSize();
+	if (size.isEmpty())
+	{
+		return;
+	}
+
+	QPixmap pixmap(size);
+	pixmap.fill(Qt::transparent);
+
+	QPainter painter(&pixmap);
+	painter.setRenderHints(renderHints());
+	scene()->render(&painter, QRectF(QPointF(0, 0), QSizeF(size)), rect, Qt::IgnoreAspectRatio);
+	painter.end();
+
+	m_levelOfDetailPixmap = pixmap;
 }
 
 void QtGraphicsView::handleMessage(MessageSaveAsImage* message)
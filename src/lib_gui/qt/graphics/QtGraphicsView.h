@@ -4,6 +4,7 @@
 #include <memory>
 
 #include <QGraphicsView>
+#include <QPixmap>
 
 #include "types.h"
 #include "MessageListener.h"
@@ -44,6 +45,13 @@ public:
 protected:
 	void resizeEvent(QResizeEvent* event);
 
+	void drawItems(
+		QPainter* painter,
+		int numItems,
+		QGraphicsItem* items[],
+		const QStyleOptionGraphicsItem options[]) override;
+	void drawForeground(QPainter* painter, const QRectF& rect) override;
+
 	void mousePressEvent(QMouseEvent* event);
 	void mouseMoveEvent(QMouseEvent* event);
 	void mouseReleaseEvent(QMouseEvent* event);
@@ -92,12 +100,18 @@ private slots:
 
 	void legendClicked();
 
+	void sceneChanged(const QList<QRectF>& region);
+
 private:
 	bool moves() const;
 
 	void setZoomFactor(float zoomFactor);
 	void updateTransform();
 
+	bool usesLevelOfDetail() const;
+	void updateLevelOfDetail();
+	void updateLevelOfDetailPixmap();
+
 	void handleMessage(MessageSaveAsImage* message) override;
 
 	GraphFocusHandler* m_focusHandler;
@@ -154,6 +168,15 @@ private:
 
 	QImage m_imageCached;
 	Id m_tabId;
+
+	// at low zoom levels large scenes are drawn from a single pixmap instead of painting each item
+	static const float s_levelOfDetailZoomFactor;
+	static const int s_levelOfDetailItemCount;
+	static const int s_levelOfDetailPixmapSize;
+
+	QPixmap m_levelOfDetailPixmap;
+	bool m_levelOfDetailPixmapDirty = true;
+	int m_sceneItemCount = 0;
 };
 
 #endif	  // QT_GRAPHICS_VIEW_H
@@ -1,5 +1,8 @@
 #include "QtHighlighter.h"
 
+#include <algorithm>
+
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -17,6 +20,46 @@
 
 std::map<std::wstring, std::vector<QtHighlighter::HighlightingRule>> QtHighlighter::s_highlightingRules;
 std::map<QtHighlighter::HighlightType, QTextCharFormat> QtHighlighter::s_charFormats;
+std::list<QtHighlighter::RangesCacheEntry> QtHighlighter::s_rangesCache;
+size_t QtHighlighter::s_rangesCacheTextLength = 0;
+const size_t QtHighlighter::s_rangesCacheSize = 50;
+const size_t QtHighlighter::s_rangesCacheMaximumTextLength = 8 * 1024 * 1024;
+
+namespace
+{
+struct RuleMatch
+{
+	bool searched = false;
+	int start = -1;
+	int end = -1;
+
+	// part of the match that gets highlighted, differs from the match if the rule has a capture
+	int rangeStart = -1;
+	int rangeEnd = -1;
+};
+
+RuleMatch findMatch(QRegExp& expression, const QString& text, int offset)
+{
+	RuleMatch match;
+	match.searched = true;
+	match.start = expression.indexIn(text, offset);
+
+	if (match.start >= 0)
+	{
+		match.end = match.start + expression.matchedLength();
+		match.rangeStart = match.start;
+		match.rangeEnd = match.end;
+
+		if (expression.captureCount() > 0 && expression.pos(1) >= 0)
+		{
+			match.rangeStart = expression.pos(1);
+			match.rangeEnd = match.rangeStart + expression.cap(1).length();
+		}
+	}
+
+	return match;
+}
+}	 // namespace
 
 std::string QtHighlighter::highlightTypeToString(QtHighlighter::HighlightType type)
 {
@@ -149,10 +192,12 @@ void QtHighlighter::loadHighlightingRules()
 void QtHighlighter::clearHighlightingRules()
 {
 	s_highlightingRules.clear();
+	s_rangesCache.clear();
+	s_rangesCacheTextLength = 0;
 }
 
 QtHighlighter::QtHighlighter(QTextDocument* document, const std::wstring& language)
-	: m_document(document)
+	: m_document(document), m_language(language), m_ranges(std::make_shared<const Ranges>())
 {
 	if (!s_highlightingRules.size())
 	{
@@ -170,22 +215,7 @@ void QtHighlighter::highlightDocument()
 {
 	TRACE();
 
-	QTextDocument* doc = document();
-
-	int docStart = 0;
-	int docEnd = 0;
-	for (int i = 0; i < doc->blockCount(); i++)
-	{
-		docEnd += doc->findBlockByLineNumber(i).length();
-	}
-
-	if (docEnd > 0)
-	{
-		docEnd -= 1;
-	}
-
-	applyFormat(docStart, docEnd, s_charFormats[HighlightType::TEXT]);
-
+	// lines only get formatted once they become visible, see highlightRange()
 	m_highlightedLines.clear();
 	m_highlightedLines.resize(document()->blockCount(), false);
 
@@ -194,21 +224,38 @@ void QtHighlighter::highlightDocument()
 		return;
 	}
 
-	std::vector<HighlightingRule> singleLineRules;
-	for (const HighlightingRule& rule: m_highlightingRules)
+	const QString text = document()->toPlainText();
+	const RangesCacheKey key(m_language, text.size(), qHash(text));
+
+	for (auto it = s_rangesCache.begin(); it != s_rangesCache.end(); it++)
 	{
-		if (rule.priority && !rule.multiLine)
+		if (it->key == key && it->text == text)
 		{
-			singleLineRules.emplace_back(rule);
+			m_ranges = it->ranges;
+			s_rangesCache.splice(s_rangesCache.begin(), s_rangesCache, it);
+			return;
 		}
 	}
-	createRanges(doc, singleLineRules);
+
+	m_ranges = createRanges();
+
+	s_rangesCache.push_front({key, text, m_ranges});
+	s_rangesCacheTextLength += text.size();
+
+	// the newest entry is kept even if its text alone exceeds the maximum length
+	while (s_rangesCache.size() > 1 &&
+		   (s_rangesCache.size() > s_rangesCacheSize ||
+			s_rangesCacheTextLength > s_rangesCacheMaximumTextLength))
+	{
+		s_rangesCacheTextLength -= s_rangesCache.back().text.size();
+		s_rangesCache.pop_back();
+	}
 }
 
 void QtHighlighter::highlightRange(int startLine, int endLine)
 {
 	if (startLine < 0 || endLine < 0 || startLine > endLine ||
-		endLine > int(m_highlightedLines.size()))
+		endLine >= int(m_highlightedLines.size()))
 	{
 		return;
 	}
@@ -232,21 +279,6 @@ void QtHighlighter::highlightRange(int startLine, int endLine)
 	QTextBlock start = doc->findBlockByLineNumber(startLine);
 	QTextBlock end = doc->findBlockByLineNumber(endLine + 1);
 
-	const HighlightingRule* singleLineCommentRule = nullptr;
-	const HighlightingRule* quotationRule = nullptr;
-
-	for (const HighlightingRule& rule: m_highlightingRules)
-	{
-		if (rule.type == HighlightType::COMMENT && !rule.multiLine)
-		{
-			singleLineCommentRule = &rule;
-		}
-		else if (rule.type == HighlightType::QUOTATION)
-		{
-			quotationRule = &rule;
-		}
-	}
-
 	int index = startLine;
 	for (QTextBlock it = start; it != end; it = it.next())
 	{
@@ -257,25 +289,14 @@ void QtHighlighter::highlightRange(int startLine, int endLine)
 
 			for (const HighlightingRule& rule: m_highlightingRules)
 			{
-				if (rule.multiLine)
+				if (!rule.priority && !rule.multiLine)
 				{
-					continue;
-				}
-
-				if (rule.priority)
-				{
-					formatBlockIfInRange(it, rule.type, &m_singleLineRanges);
-				}
-				else
-				{
-					formatBlockForRule(it, rule, &m_singleLineRanges);
+					formatBlockForRule(it, rule);
 				}
 			}
 
-			if (m_multiLineRanges.size())
-			{
-				formatBlockIfInRange(it, &m_multiLineRanges);
-			}
+			// priority ranges are formatted last, so they override all other rules
+			formatBlockIfInRange(it);
 		}
 		index++;
 	}
@@ -312,185 +333,162 @@ QTextCharFormat QtHighlighter::getFormat(int startPosition, int endPosition) con
 	return cursor.charFormat();
 }
 
-void QtHighlighter::createRanges(QTextDocument* doc, const std::vector<HighlightingRule>& singleLineRules)
+QtHighlighter::HighlightingRule::HighlightingRule() {}
+
+QtHighlighter::HighlightingRule::HighlightingRule(
+	HighlightType type, const QRegExp& regExp, bool priority, bool multiLine)
+	: type(type), pattern(regExp), priority(priority), multiLine(multiLine)
+{
+}
+
+std::shared_ptr<const QtHighlighter::Ranges> QtHighlighter::createRanges() const
 {
-	m_singleLineRanges.clear();
-	m_multiLineRanges.clear();
+	TRACE();
 
-	for (QTextBlock it = doc->begin(); it != doc->end(); it = it.next())
+	// priority rules paired with the end rule of multi-line ranges
+	std::vector<std::pair<const HighlightingRule*, const HighlightingRule*>> rules;
+	for (const HighlightingRule& rule: m_highlightingRules)
 	{
-		for (const HighlightingRule& rule: singleLineRules)
+		if (!rule.priority)
 		{
-			utility::append(m_singleLineRanges, getRangesForRule(it, rule));
+			continue;
 		}
-	}
 
-	// remove ranges starting inside others
-	{
-		std::map<std::pair<int, int>, size_t> sortedRangesToIndex;
-		for (size_t i = 0; i < m_singleLineRanges.size(); i++)
+		if (!rule.multiLine)
 		{
-			const std::tuple<HighlightType, int, int>& range = m_singleLineRanges[i];
-			sortedRangesToIndex.emplace(std::make_pair(std::get<1>(range), std::get<2>(range)), i);
+			rules.emplace_back(&rule, nullptr);
 		}
-
-		std::set<size_t> indicesToErase;
-		const std::pair<int, int>* topRange = nullptr;
-		for (const auto& p: sortedRangesToIndex)
+		else if (rules.size() && rules.back().first->multiLine && !rules.back().second &&
+				 rules.back().first->type == rule.type)
 		{
-			if (topRange && p.first.first <= topRange->second)
-			{
-				indicesToErase.insert(p.second);
-			}
-			else
-			{
-				topRange = &p.first;
-			}
+			rules.back().second = &rule;
 		}
-
-		for (std::set<size_t>::const_reverse_iterator it = indicesToErase.rbegin();
-			 it != indicesToErase.rend();
-			 it++)
+		else
 		{
-			m_singleLineRanges.erase(m_singleLineRanges.begin() + *it);
+			rules.emplace_back(&rule, nullptr);
 		}
 	}
 
-	m_multiLineRanges = createMultiLineRanges(doc, &m_singleLineRanges);
-}
-
-std::vector<std::tuple<QtHighlighter::HighlightType, int, int>> QtHighlighter::createMultiLineRanges(
-	QTextDocument* doc, std::vector<std::tuple<HighlightType, int, int>>* ranges)
-{
-	std::vector<std::tuple<HighlightType, int, int>> multiLineRanges;
-
-	const HighlightingRule* startRule = nullptr;
-
-	for (const HighlightingRule& rule: m_highlightingRules)
+	std::vector<QRegExp> expressions;
+	for (const std::pair<const HighlightingRule*, const HighlightingRule*>& rule: rules)
 	{
-		if (rule.priority && rule.multiLine)
-		{
-			if (!startRule)
-			{
-				startRule = &rule;
-			}
-			else if (rule.type == startRule->type)
-			{
-				utility::append(
-					multiLineRanges, createMultiLineRangesForRules(doc, ranges, startRule, &rule));
-				startRule = nullptr;
-			}
-		}
+		expressions.push_back(rule.first->pattern);
 	}
 
-	return multiLineRanges;
-}
+	std::vector<bool> exhaustedRules(rules.size(), false);
+	std::vector<RuleMatch> matches(rules.size());
 
-std::vector<std::tuple<QtHighlighter::HighlightType, int, int>> QtHighlighter::createMultiLineRangesForRules(
-	QTextDocument* doc,
-	std::vector<std::tuple<HighlightType, int, int>>* ranges,
-	const HighlightingRule* startRule,
-	const HighlightingRule* endRule)
-{
-	std::vector<std::tuple<HighlightType, int, int>> multiLineRanges;
+	// Single pass over the document: at each position the earliest match of all priority rules is
+	// taken and scanning continues after it, so ranges are sorted and never overlap.
+	std::shared_ptr<Ranges> ranges = std::make_shared<Ranges>();
+	for (QTextBlock block = document()->begin(); block.isValid(); block = block.next())
+	{
+		QString text = block.text();
+		int index = 0;
 
-	QTextCursor cursorStart(doc);
-	QTextCursor cursorEnd(doc);
+		std::fill(matches.begin(), matches.end(), RuleMatch());
 
-	while (true)
-	{
-		while (true)
+		while (index < text.size())
 		{
-			cursorStart = document()->find(startRule->pattern, cursorStart);
-			if (cursorStart.isNull())
+			size_t firstRuleIndex = rules.size();
+			for (size_t i = 0; i < rules.size(); i++)
 			{
-				break;
+				if (exhaustedRules[i] || (rules[i].first->multiLine && !rules[i].second))
+				{
+					continue;
+				}
+
+				RuleMatch& match = matches[i];
+				if (!match.searched || (match.start >= 0 && match.start < index))
+				{
+					match = findMatch(expressions[i], text, index);
+				}
+
+				if (match.start >= 0 &&
+					(firstRuleIndex == rules.size() || match.start < matches[firstRuleIndex].start))
+				{
+					firstRuleIndex = i;
+				}
 			}
 
-			if (!isInRange(cursorStart.selectionEnd() - 1, *ranges))
+			if (firstRuleIndex == rules.size())
 			{
 				break;
 			}
-			else
+
+			const HighlightingRule* rule = rules[firstRuleIndex].first;
+			const HighlightingRule* endRule = rules[firstRuleIndex].second;
+			const RuleMatch match = matches[firstRuleIndex];
+
+			if (!endRule)
 			{
-				cursorStart.setPosition(cursorStart.selectionEnd() + 1);
+				ranges->emplace_back(
+					rule->type,
+					block.position() + match.rangeStart,
+					block.position() + match.rangeEnd);
+				index = std::max(match.end, match.start + 1);
+				continue;
 			}
-		}
 
-		if (cursorStart.isNull())
-		{
-			break;
-		}
-
-		cursorEnd = document()->find(endRule->pattern, cursorStart);
-		if (cursorEnd.isNull())
-		{
-			break;
-		}
+			QRegExp endExpression(endRule->pattern);
+			QTextBlock endBlock = block;
+			QString endText = text;
+			int endIndex = endExpression.indexIn(endText, match.end);
 
-		multiLineRanges.emplace_back(
-			std::make_tuple(startRule->type, cursorStart.selectionStart(), cursorEnd.position()));
+			while (endIndex < 0)
+			{
+				endBlock = endBlock.next();
+				if (!endBlock.isValid())
+				{
+					break;
+				}
 
-		cursorStart = cursorEnd;
-	}
+				endText = endBlock.text();
+				endIndex = endExpression.indexIn(endText);
+			}
 
-	return multiLineRanges;
-}
+			if (endIndex < 0)
+			{
+				// unterminated ranges are not highlighted
+				exhaustedRules[firstRuleIndex] = true;
+				continue;
+			}
 
-QtHighlighter::HighlightingRule::HighlightingRule() {}
+			const int endLength = endExpression.matchedLength();
+			ranges->emplace_back(
+				rule->type,
+				block.position() + match.start,
+				endBlock.position() + endIndex + endLength);
 
-QtHighlighter::HighlightingRule::HighlightingRule(
-	HighlightType type, const QRegExp& regExp, bool priority, bool multiLine)
-	: type(type), pattern(regExp), priority(priority), multiLine(multiLine)
-{
-}
+			if (endBlock != block)
+			{
+				block = endBlock;
+				text = endText;
+				std::fill(matches.begin(), matches.end(), RuleMatch());
+			}
 
-bool QtHighlighter::isInRange(int pos, const std::vector<std::tuple<HighlightType, int, int>>& ranges) const
-{
-	for (const std::tuple<HighlightType, int, int>& range: ranges)
-	{
-		if (pos >= std::get<1>(range) && pos <= std::get<2>(range))
-		{
-			return true;
+			index = endIndex + std::max(endLength, 1);
 		}
 	}
 
-	return false;
+	return ranges;
 }
 
-std::vector<std::tuple<QtHighlighter::HighlightType, int, int>> QtHighlighter::getRangesForRule(
-	const QTextBlock& block, const HighlightingRule& rule) const
+bool QtHighlighter::isInRange(int pos) const
 {
-	const int pos = block.position();
-	const QString text = block.text();
-	QRegExp expression(rule.pattern);
-	int index = expression.indexIn(text);
-
-	std::vector<std::tuple<HighlightType, int, int>> ranges;
-
-	while (index >= 0)
-	{
-		const int length = expression.matchedLength();
-		if (expression.capturedTexts().size() > 1)
-		{
-			const QString cap = expression.capturedTexts()[1];
-			const int start = text.indexOf(cap, index);
-			ranges.push_back(std::make_tuple(rule.type, pos + start, pos + start + cap.length()));
-		}
-		else
-		{
-			ranges.push_back(std::make_tuple(rule.type, pos + index, pos + index + length));
-		}
-		index = expression.indexIn(block.text(), index + length);
-	}
-
-	return ranges;
+	// ranges are sorted and don't overlap
+	const auto it = std::upper_bound(
+		m_ranges->begin(),
+		m_ranges->end(),
+		pos,
+		[](int pos, const std::tuple<HighlightType, int, int>& range) {
+			return pos < std::get<1>(range);
+		});
+
+	return it != m_ranges->begin() && pos <= std::get<2>(*(it - 1));
 }
 
-void QtHighlighter::formatBlockForRule(
-	const QTextBlock& block,
-	const HighlightingRule& rule,
-	std::vector<std::tuple<HighlightType, int, int>>* ranges)
+void QtHighlighter::formatBlockForRule(const QTextBlock& block, const HighlightingRule& rule)
 {
 	if (s_charFormats.find(rule.type) == s_charFormats.end())
 	{
@@ -507,7 +505,7 @@ void QtHighlighter::formatBlockForRule(
 	{
 		int length = expression.matchedLength();
 
-		if (!isInRange(pos + index, *ranges))
+		if (!isInRange(pos + index))
 		{
 			applyFormat(pos + index, pos + index + length, format);
 		}
@@ -516,45 +514,22 @@ void QtHighlighter::formatBlockForRule(
 	}
 }
 
-void QtHighlighter::formatBlockIfInRange(
-	const QTextBlock& block,
-	HighlightType type,
-	std::vector<std::tuple<HighlightType, int, int>>* ranges)
+void QtHighlighter::formatBlockIfInRange(const QTextBlock& block)
 {
 	int startPos = block.position();
 	int endPos = startPos + block.length() - 1;
 
-	if (s_charFormats.find(type) == s_charFormats.end())
-	{
-		return;
-	}
-
-	const QTextCharFormat& format = s_charFormats.find(type)->second;
-
-	for (auto range: *ranges)
-	{
-		if (type == std::get<0>(range))
-		{
-			int start = std::max(std::get<1>(range), startPos);
-			int end = std::min(std::get<2>(range), endPos);
-
-			if (start <= end)
-			{
-				applyFormat(start, end, format);
-			}
-		}
-	}
-}
-
-void QtHighlighter::formatBlockIfInRange(
-	const QTextBlock& block, std::vector<std::tuple<HighlightType, int, int>>* ranges)
-{
-	int startPos = block.position();
-	int endPos = startPos + block.length() - 1;
+	auto it = std::lower_bound(
+		m_ranges->begin(),
+		m_ranges->end(),
+		startPos,
+		[](const std::tuple<HighlightType, int, int>& range, int pos) {
+			return std::get<2>(range) < pos;
+		});
 
-	for (auto range: *ranges)
+	for (; it != m_ranges->end() && std::get<1>(*it) <= endPos; it++)
 	{
-		HighlightType type = std::get<0>(range);
+		HighlightType type = std::get<0>(*it);
 		if (s_charFormats.find(type) == s_charFormats.end())
 		{
 			continue;
@@ -562,8 +537,8 @@ void QtHighlighter::formatBlockIfInRange(
 
 		const QTextCharFormat& format = s_charFormats.find(type)->second;
 
-		int start = std::max(std::get<1>(range), startPos);
-		int end = std::min(std::get<2>(range), endPos);
+		int start = std::max(std::get<1>(*it), startPos);
+		int end = std::min(std::get<2>(*it), endPos);
 
 		if (start <= end)
 		{
@@ -1,6 +1,12 @@
 #ifndef QT_HIGHLIGHTER_H
 #define QT_HIGHLIGHTER_H
 
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
 #include <QTextCharFormat>
 
 class QTextBlock;
@@ -52,40 +58,40 @@ private:
 		bool multiLine = false;
 	};
 
-	void createRanges(QTextDocument* doc, const std::vector<HighlightingRule>& quotationRules);
-	std::vector<std::tuple<HighlightType, int, int>> createMultiLineRanges(
-		QTextDocument* doc, std::vector<std::tuple<HighlightType, int, int>>* ranges);
-	std::vector<std::tuple<QtHighlighter::HighlightType, int, int>> createMultiLineRangesForRules(
-		QTextDocument* doc,
-		std::vector<std::tuple<HighlightType, int, int>>* ranges,
-		const HighlightingRule* startRule,
-		const HighlightingRule* endRule);
-
-	bool isInRange(int index, const std::vector<std::tuple<HighlightType, int, int>>& ranges) const;
-	std::vector<std::tuple<HighlightType, int, int>> getRangesForRule(
-		const QTextBlock& block, const HighlightingRule& rule) const;
-
-	void formatBlockForRule(
-		const QTextBlock& block,
-		const HighlightingRule& rule,
-		std::vector<std::tuple<HighlightType, int, int>>* ranges);
-	void formatBlockIfInRange(
-		const QTextBlock& block,
-		HighlightType type,
-		std::vector<std::tuple<HighlightType, int, int>>* ranges);
-	void formatBlockIfInRange(
-		const QTextBlock& block, std::vector<std::tuple<HighlightType, int, int>>* ranges);
+	typedef std::tuple<std::wstring, int, uint> RangesCacheKey;
+	typedef std::vector<std::tuple<HighlightType, int, int>> Ranges;
+
+	struct RangesCacheEntry
+	{
+		RangesCacheKey key;
+		QString text;	 // compared on a key match, so hash collisions don't apply wrong ranges
+		std::shared_ptr<const Ranges> ranges;
+	};
+
+	std::shared_ptr<const Ranges> createRanges() const;
+
+	bool isInRange(int pos) const;
+
+	void formatBlockForRule(const QTextBlock& block, const HighlightingRule& rule);
+	void formatBlockIfInRange(const QTextBlock& block);
 
 	QTextDocument* document() const;
 
 	static std::map<std::wstring, std::vector<HighlightingRule>> s_highlightingRules;
 	static std::map<HighlightType, QTextCharFormat> s_charFormats;
 
+	// ranges of priority rules for recently highlighted texts, most recently used first
+	// bounded by entry count and by the total length of the kept texts
+	static std::list<RangesCacheEntry> s_rangesCache;
+	static size_t s_rangesCacheTextLength;
+	static const size_t s_rangesCacheSize;
+	static const size_t s_rangesCacheMaximumTextLength;
+
 	QTextDocument* m_document;
+	const std::wstring m_language;
 
 	std::vector<HighlightingRule> m_highlightingRules;
-	std::vector<std::tuple<HighlightType, int, int>> m_singleLineRanges;
-	std::vector<std::tuple<HighlightType, int, int>> m_multiLineRanges;
+	std::shared_ptr<const Ranges> m_ranges;
 	std::vector<bool> m_highlightedLines;
 };
 
@@ -236,6 +236,20 @@ void QtDialogView::updateIndexingDialog(
 	});
 }
 
+void QtDialogView::updateIndexingQueueStatus(
+	size_t queuedStorageCount, size_t spilledStorageCount, size_t queuedByteSize, size_t byteBudget)
+{
+	m_onQtThread([=]() {
+		QtIndexingProgressDialog* window = dynamic_cast<QtIndexingProgressDialog*>(
+			m_windowStack.getTopWindow());
+		if (window)
+		{
+			window->updateQueueStatus(
+				queuedStorageCount, spilledStorageCount, queuedByteSize, byteBudget);
+		}
+	});
+}
+
 void QtDialogView::updateCustomIndexingDialog(
 	size_t startedFileCount,
 	size_t finishedFileCount,
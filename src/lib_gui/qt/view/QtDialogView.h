@@ -50,6 +50,11 @@ public:
 		size_t finishedFileCount,
 		size_t totalFileCount,
 		const std::vector<FilePath>& sourcePaths) override;
+	void updateIndexingQueueStatus(
+		size_t queuedStorageCount,
+		size_t spilledStorageCount,
+		size_t queuedByteSize,
+		size_t byteBudget) override;
 	void updateCustomIndexingDialog(
 		size_t startedFileCount,
 		size_t finishedFileCount,
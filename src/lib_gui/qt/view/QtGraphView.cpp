@@ -46,6 +46,7 @@ QtGraphView::QtGraphView(ViewLayout* viewLayout)
 	, m_scrollToTop(false)
 	, m_restoreScroll(false)
 	, m_isIndexedList(false)
+	, m_rebuildGeneration(0)
 {
 	setWidgetWrapper(std::make_shared<QtViewWidgetWrapper>(new QFrame()));
 
@@ -322,7 +323,14 @@ void QtGraphView::rebuildGraph(
 	const std::vector<std::shared_ptr<DummyEdge>>& edges,
 	const GraphParams params)
 {
+	const size_t generation = ++m_rebuildGeneration;
+
 	m_onQtThread([=]() {
+		if (generation != m_rebuildGeneration)
+		{
+			return;
+		}
+
 		if (isTransitioning())
 		{
 			m_transition->stop();
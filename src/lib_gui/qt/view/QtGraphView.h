@@ -1,6 +1,7 @@
 #ifndef QT_GRAPH_VIEW_H
 #define QT_GRAPH_VIEW_H
 
+#include <atomic>
 #include <set>
 
 #include <QGraphicsView>
@@ -169,6 +170,9 @@ private:
 	Vec2i m_scrollValues;
 	bool m_isIndexedList;
 
+	// rebuilds that got superseded before reaching the Qt thread are skipped
+	std::atomic<size_t> m_rebuildGeneration;
+
 	std::shared_ptr<QSequentialAnimationGroup> m_transition;
 	QPointF m_sceneRectOffset;
 
@@ -6,7 +6,10 @@
 #include "MessageIndexingInterrupted.h"
 
 QtIndexingProgressDialog::QtIndexingProgressDialog(bool hideable, QWidget* parent)
-	: QtProgressBarDialog(0.38f, true, parent), m_filePathLabel(nullptr), m_errorWidget(nullptr)
+	: QtProgressBarDialog(0.38f, true, parent)
+	, m_filePathLabel(nullptr)
+	, m_queueLabel(nullptr)
+	, m_errorWidget(nullptr)
 {
 	setSizeGripStyle(false);
 
@@ -17,6 +20,12 @@ QtIndexingProgressDialog::QtIndexingProgressDialog(bool hideable, QWidget* paren
 	m_filePathLabel->setAlignment(Qt::AlignRight);
 	m_layout->addWidget(m_filePathLabel);
 
+	m_queueLabel = new QLabel();
+	m_queueLabel->setObjectName(QStringLiteral("queueStatus"));
+	m_queueLabel->setAlignment(Qt::AlignRight);
+	m_queueLabel->hide();
+	m_layout->addWidget(m_queueLabel);
+
 	m_layout->addSpacing(12);
 	m_errorWidget = QtIndexingDialog::createErrorWidget(m_layout);
 
@@ -94,6 +103,30 @@ void QtIndexingProgressDialog::updateErrorCount(size_t errorCount, size_t fatalC
 	}
 }
 
+void QtIndexingProgressDialog::updateQueueStatus(
+	size_t queuedStorageCount, size_t spilledStorageCount, size_t queuedByteSize, size_t byteBudget)
+{
+	if (!m_queueLabel)
+	{
+		return;
+	}
+
+	QString str = QString::number(queuedStorageCount) + " Queued";
+	if (spilledStorageCount)
+	{
+		str += " (" + QString::number(spilledStorageCount) + " on Disk)";
+	}
+
+	str += " - " + QString::number(queuedByteSize / 1048576) + " MB";
+	if (byteBudget)
+	{
+		str += " of " + QString::number(byteBudget / 1048576) + " MB";
+	}
+
+	m_queueLabel->setText(str);
+	m_queueLabel->show();
+}
+
 void QtIndexingProgressDialog::onHidePressed()
 {
 	emit visibleChanged(false);
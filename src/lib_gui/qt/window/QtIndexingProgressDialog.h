@@ -15,6 +15,11 @@ public:
 
 	void updateIndexingProgress(size_t fileCount, size_t totalFileCount, const FilePath& sourcePath);
 	void updateErrorCount(size_t errorCount, size_t fatalCount);
+	void updateQueueStatus(
+		size_t queuedStorageCount,
+		size_t spilledStorageCount,
+		size_t queuedByteSize,
+		size_t byteBudget);
 
 protected:
 	void closeEvent(QCloseEvent* event) override;
@@ -25,6 +30,7 @@ private:
 	void onStopPressed();
 
 	QLabel* m_filePathLabel;
+	QLabel* m_queueLabel;
 	QWidget* m_errorWidget;
 	QString m_sourcePath;
 };
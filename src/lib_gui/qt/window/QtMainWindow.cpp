@@ -1,5 +1,7 @@
 #include "QtMainWindow.h"
 
+#include <fstream>
+
 #include <QApplication>
 #include <QDesktopServices>
 #include <QDir>
@@ -14,6 +16,7 @@
 #include "ApplicationSettings.h"
 #include "Bookmark.h"
 #include "CompositeView.h"
+#include "FileLogger.h"
 #include "FileSystem.h"
 #include "MessageActivateBase.h"
 #include "MessageActivateOverview.h"
@@ -49,6 +52,7 @@
 #include "QtStartScreen.h"
 #include "QtViewWidgetWrapper.h"
 #include "ResourcePaths.h"
+#include "SqliteQueryStatistics.h"
 #include "TabbedView.h"
 #include "UserPaths.h"
 #include "View.h"
@@ -555,6 +559,71 @@ void QtMainWindow::showLogFolder()
 		QUrl::TolerantMode));
 }
 
+void QtMainWindow::showQueryStatistics()
+{
+	const FilePath logDirectoryPath = ApplicationSettings::getInstance()->getLogDirectoryPath();
+	if (!logDirectoryPath.exists())
+	{
+		FileSystem::createDirectory(logDirectoryPath);
+	}
+
+	const FilePath filePath = logDirectoryPath.getConcatenated(
+		FileLogger::generateDatedFileName(L"query_statistics") + L".txt");
+
+	std::ofstream stream(filePath.str(), std::ios::trunc);
+	stream << SqliteQueryStatistics::getInstance()->getReport();
+	stream.close();
+
+	if (stream.fail())
+	{
+		LOG_ERROR(L"Failed to write query statistics to: " + filePath.wstr());
+		return;
+	}
+
+	QDesktopServices::openUrl(
+		QUrl(QString::fromStdWString(L"file:///" + filePath.wstr()), QUrl::TolerantMode));
+}
+
+void QtMainWindow::toggleRecordQueryStatistics(bool enabled)
+{
+	if (enabled)
+	{
+		SqliteQueryStatistics::getInstance()->clear();
+		SqliteQueryStatistics::getInstance()->setEnabled(true);
+		return;
+	}
+
+	SqliteQueryStatistics::getInstance()->setEnabled(false);
+	showQueryStatistics();
+}
+
+void QtMainWindow::toggleRecordTrace(bool enabled)
+{
+	if (enabled)
+	{
+		Tracer::getInstance()->clear();
+		Tracer::getInstance()->setEnabled(true);
+		return;
+	}
+
+	Tracer::getInstance()->setEnabled(false);
+
+	const FilePath logDirectoryPath = ApplicationSettings::getInstance()->getLogDirectoryPath();
+	if (!logDirectoryPath.exists())
+	{
+		FileSystem::createDirectory(logDirectoryPath);
+	}
+
+	// can be opened with chrome://tracing or ui.perfetto.dev
+	if (Tracer::getInstance()->writeChromeTrace(logDirectoryPath.getConcatenated(
+			FileLogger::generateDatedFileName(L"trace") + L".json")))
+	{
+		showLogFolder();
+	}
+
+	Tracer::getInstance()->clear();
+}
+
 void QtMainWindow::openTab()
 {
 	MessageTabOpen().dispatch();
@@ -1103,6 +1172,21 @@ void QtMainWindow::setupHelpMenu()
 
 	menu->addAction(tr("Show Data Folder"), this, &QtMainWindow::showDataFolder);
 	menu->addAction(tr("Show Log Folder"), this, &QtMainWindow::showLogFolder);
+	menu->addAction(tr("Show Query Statistics"), this, &QtMainWindow::showQueryStatistics);
+
+	QAction* recordQueryStatisticsAction = menu->addAction(tr("Record Query Statistics"));
+	recordQueryStatisticsAction->setCheckable(true);
+	recordQueryStatisticsAction->setChecked(SqliteQueryStatistics::isEnabled());
+	connect(
+		recordQueryStatisticsAction,
+		&QAction::toggled,
+		this,
+		&QtMainWindow::toggleRecordQueryStatistics);
+
+	QAction* recordTraceAction = menu->addAction(tr("Record Trace"));
+	recordTraceAction->setCheckable(true);
+	recordTraceAction->setChecked(Tracer::isEnabled());
+	connect(recordTraceAction, &QAction::toggled, this, &QtMainWindow::toggleRecordTrace);
 }
 
 QtMainWindow::DockWidget* QtMainWindow::getDockWidgetForView(View* view)
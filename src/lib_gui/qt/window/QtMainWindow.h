@@ -109,6 +109,9 @@ public slots:
 
 	void showDataFolder();
 	void showLogFolder();
+	void showQueryStatistics();
+	void toggleRecordQueryStatistics(bool enabled);
+	void toggleRecordTrace(bool enabled);
 
 	void openTab();
 	void closeTab();
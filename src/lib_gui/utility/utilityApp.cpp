@@ -16,6 +16,16 @@
 
 #include <QThread>
 
+#if defined(_WIN32)
+#	include <windows.h>
+#	include <psapi.h>
+#elif defined(__APPLE__)
+#	include <mach/mach.h>
+#else
+#	include <fstream>
+#	include <unistd.h>
+#endif
+
 #include "ScopedFunctor.h"
 #include "logging.h"
 #include "utilityString.h"
@@ -223,6 +233,34 @@ int utility::getIdealThreadCount()
 	return std::max(1, threadCount);
 }
 
+size_t utility::getResidentMemorySize()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return counters.WorkingSetSize;
+	}
+#elif defined(__APPLE__)
+	mach_task_basic_info info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) ==
+		KERN_SUCCESS)
+	{
+		return info.resident_size;
+	}
+#else
+	std::ifstream statm("/proc/self/statm");
+	size_t totalPages = 0;
+	size_t residentPages = 0;
+	if (statm >> totalPages >> residentPages)
+	{
+		return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	}
+#endif
+	return 0;
+}
+
 std::string utility::getOsTypeString()
 {
 	// WARNING: Don't change these string. The server API relies on them.
@@ -32,6 +32,9 @@ void killRunningProcesses();
 
 int getIdealThreadCount();
 
+// returns the resident set size of the current process in bytes or 0 if it cannot be determined
+size_t getResidentMemorySize();
+
 constexpr OsType getOsType()
 {
 #if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
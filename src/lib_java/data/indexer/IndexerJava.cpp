@@ -1,12 +1,84 @@
 #include "IndexerJava.h"
 
+#include <algorithm>
+
+#include "IntermediateStorage.h"
 #include "JavaParser.h"
 
+const size_t IndexerJava::s_maximumBatchSize = 32;
+
 IndexerJava::~IndexerJava()
 {
 	JavaParser::clearCaches();
 }
 
+size_t IndexerJava::getMaximumBatchSize(const IndexerCommand& indexerCommand) const
+{
+	return s_maximumBatchSize;
+}
+
+bool IndexerJava::canBatch(const IndexerCommand& first, const IndexerCommand& other) const
+{
+	const IndexerCommandJava* firstJava = dynamic_cast<const IndexerCommandJava*>(&first);
+	const IndexerCommandJava* otherJava = dynamic_cast<const IndexerCommandJava*>(&other);
+
+	if (!firstJava || !otherJava ||
+		firstJava->getLanguageStandard() != otherJava->getLanguageStandard())
+	{
+		return false;
+	}
+
+	// compares the paths as strings, because comparing FilePaths accesses the file system
+	const std::vector<FilePath> firstClassPath = firstJava->getClassPath();
+	const std::vector<FilePath> otherClassPath = otherJava->getClassPath();
+	return std::equal(
+		firstClassPath.begin(),
+		firstClassPath.end(),
+		otherClassPath.begin(),
+		otherClassPath.end(),
+		[](const FilePath& a, const FilePath& b) { return a.wstr() == b.wstr(); });
+}
+
+void IndexerJava::indexBatch(
+	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands,
+	std::function<void(std::shared_ptr<IndexerCommand>)> onStarted,
+	std::function<void(std::shared_ptr<IndexerCommand>, std::shared_ptr<IntermediateStorage>)>
+		onIndexed)
+{
+	std::vector<std::shared_ptr<IndexerCommandJava>> javaCommands;
+	for (const std::shared_ptr<IndexerCommand>& indexerCommand: indexerCommands)
+	{
+		std::shared_ptr<IndexerCommandJava> javaCommand =
+			std::dynamic_pointer_cast<IndexerCommandJava>(indexerCommand);
+		if (javaCommand)
+		{
+			javaCommands.push_back(javaCommand);
+		}
+	}
+
+	if (javaCommands.size() < 2 || javaCommands.size() != indexerCommands.size())
+	{
+		IndexerBase::indexBatch(indexerCommands, onStarted, onIndexed);
+		return;
+	}
+
+	std::shared_ptr<IntermediateStorage> storage;
+
+	JavaParser parser(nullptr, getIndexerStateInfo());
+	parser.buildIndex(
+		javaCommands,
+		[&](size_t fileIndex) {
+			onStarted(indexerCommands[fileIndex]);
+			storage = std::make_shared<IntermediateStorage>();
+			return std::make_shared<ParserClientImpl>(storage.get());
+		},
+		[&](size_t fileIndex) {
+			std::shared_ptr<IndexerCommand> indexerCommand = indexerCommands[fileIndex];
+			onIndexed(indexerCommand, finishStorage(storage, indexerCommand));
+			storage.reset();
+		});
+}
+
 void IndexerJava::doIndex(
 	std::shared_ptr<IndexerCommandJava> indexerCommand,
 	std::shared_ptr<ParserClientImpl> parserClient,
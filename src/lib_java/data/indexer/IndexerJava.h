@@ -11,7 +11,19 @@ class IndexerJava: public Indexer<IndexerCommandJava>
 public:
 	virtual ~IndexerJava();
 
+	size_t getMaximumBatchSize(const IndexerCommand& indexerCommand) const override;
+	bool canBatch(const IndexerCommand& first, const IndexerCommand& other) const override;
+
+	// parses all commands with one JDT parser, so the class path is only resolved once per batch
+	void indexBatch(
+		const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands,
+		std::function<void(std::shared_ptr<IndexerCommand>)> onStarted,
+		std::function<void(std::shared_ptr<IndexerCommand>, std::shared_ptr<IntermediateStorage>)>
+			onIndexed) override;
+
 private:
+	static const size_t s_maximumBatchSize;
+
 	void doIndex(
 		std::shared_ptr<IndexerCommandJava> indexerCommand,
 		std::shared_ptr<ParserClientImpl> parserClient,
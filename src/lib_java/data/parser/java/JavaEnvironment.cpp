@@ -73,6 +73,39 @@ bool JavaEnvironment::callStaticVoidMethod(
 	return false;
 }
 
+bool JavaEnvironment::callStaticVoidMethod(
+	std::string className,
+	std::string methodName,
+	int arg1,
+	const std::vector<std::string>& arg2,
+	std::string arg3,
+	std::string arg4,
+	int arg5)
+{
+	jclass javaClass = getJavaClass(className);
+	jmethodID javaMethodId = getJavaStaticMethod(
+		javaClass, methodName, "(I[Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V");
+	if (javaMethodId != nullptr)
+	{
+		jint jarg1 = arg1;
+		jobjectArray jarg2 = m_env->NewObjectArray(
+			static_cast<jsize>(arg2.size()), m_env->FindClass("java/lang/String"), nullptr);
+		for (size_t i = 0; i < arg2.size(); i++)
+		{
+			jstring element = m_env->NewStringUTF(arg2[i].c_str());
+			m_env->SetObjectArrayElement(jarg2, static_cast<jsize>(i), element);
+			m_env->DeleteLocalRef(element);
+		}
+		jstring jarg3 = m_env->NewStringUTF(arg3.c_str());
+		jstring jarg4 = m_env->NewStringUTF(arg4.c_str());
+		jint jarg5 = arg5;
+		m_env->CallStaticVoidMethod(javaClass, javaMethodId, jarg1, jarg2, jarg3, jarg4, jarg5);
+		m_env->DeleteLocalRef(jarg2);
+		return true;
+	}
+	return false;
+}
+
 bool JavaEnvironment::callStaticStringMethod(
 	std::string className, std::string methodName, std::string& ret, const std::string& arg1)
 {
@@ -133,6 +166,11 @@ jstring JavaEnvironment::toJString(std::string s)
 	return m_env->NewStringUTF(s.c_str());
 }
 
+void* JavaEnvironment::getDirectBufferAddress(jobject buffer)
+{
+	return m_env->GetDirectBufferAddress(buffer);
+}
+
 void JavaEnvironment::registerNativeMethods(std::string className, std::vector<NativeMethod> methods)
 {
 	JNINativeMethod* jniMethods = new JNINativeMethod[methods.size()];
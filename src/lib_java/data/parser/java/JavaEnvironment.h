@@ -10,6 +10,9 @@ typedef JavaVM_ JavaVM;
 struct JNIEnv_;
 typedef JNIEnv_ JNIEnv;
 
+class _jobject;
+typedef _jobject* jobject;
+
 class _jclass;
 typedef _jclass* jclass;
 
@@ -48,6 +51,14 @@ public:
 		std::string arg4,
 		std::string arg5,
 		int arg6);
+	bool callStaticVoidMethod(
+		std::string className,
+		std::string methodName,
+		int arg1,
+		const std::vector<std::string>& arg2,
+		std::string arg3,
+		std::string arg4,
+		int arg5);
 	bool callStaticStringMethod(
 		std::string className, std::string methodName, std::string& ret, const std::string& arg1);
 	bool callStaticStringMethod(
@@ -60,6 +71,9 @@ public:
 	std::string toStdString(jstring s);
 	jstring toJString(std::string s);
 
+	// returns null if the object is not a direct java.nio.Buffer
+	void* getDirectBufferAddress(jobject buffer);
+
 	void registerNativeMethods(std::string className, std::vector<NativeMethod> methods);
 
 private:
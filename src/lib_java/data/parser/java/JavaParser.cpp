@@ -1,5 +1,7 @@
 #include "JavaParser.h"
 
+#include <cstring>
+
 #include <jni.h>
 
 #include "ApplicationSettings.h"
@@ -29,7 +31,11 @@ void JavaParser::clearCaches()
 
 JavaParser::JavaParser(
 	std::shared_ptr<ParserClient> client, std::shared_ptr<IndexerStateInfo> indexerStateInfo)
-	: Parser(client), m_indexerStateInfo(indexerStateInfo), m_id(s_nextParserId++), m_currentFileId(0)
+	: Parser(client)
+	, m_indexerStateInfo(indexerStateInfo)
+	, m_id(s_nextParserId++)
+	, m_currentFileId(0)
+	, m_currentBatchFileIndex(-1)
 {
 	const std::string errorString = utility::prepareJavaEnvironment();
 	if (!errorString.empty())
@@ -45,36 +51,12 @@ JavaParser::JavaParser(
 		std::vector<JavaEnvironment::NativeMethod> methods;
 
 		methods.push_back({"getInterrupted", "(I)Z", (void*)&JavaParser::GetInterrupted});
+		methods.push_back({"beginFile", "(II)V", (void*)&JavaParser::BeginFile});
 		methods.push_back({"logInfo", "(ILjava/lang/String;)V", (void*)&JavaParser::LogInfo});
 		methods.push_back({"logWarning", "(ILjava/lang/String;)V", (void*)&JavaParser::LogWarning});
 		methods.push_back({"logError", "(ILjava/lang/String;)V", (void*)&JavaParser::LogError});
 		methods.push_back(
-			{"recordSymbol", "(ILjava/lang/String;III)V", (void*)&JavaParser::RecordSymbol});
-		methods.push_back(
-			{"recordSymbolWithLocation",
-			 "(ILjava/lang/String;IIIIIII)V",
-			 (void*)&JavaParser::RecordSymbolWithLocation});
-		methods.push_back(
-			{"recordSymbolWithLocationAndScope",
-			 "(ILjava/lang/String;IIIIIIIIIII)V",
-			 (void*)&JavaParser::RecordSymbolWithLocationAndScope});
-		methods.push_back(
-			{"recordSymbolWithLocationAndScopeAndSignature",
-			 "(ILjava/lang/String;IIIIIIIIIIIIIII)V",
-			 (void*)&JavaParser::RecordSymbolWithLocationAndScopeAndSignature});
-		methods.push_back(
-			{"recordReference",
-			 "(IILjava/lang/String;Ljava/lang/String;IIII)V",
-			 (void*)&JavaParser::RecordReference});
-		methods.push_back(
-			{"recordQualifierLocation",
-			 "(ILjava/lang/String;IIII)V",
-			 (void*)&JavaParser::RecordQualifierLocation});
-		methods.push_back(
-			{"recordLocalSymbol", "(ILjava/lang/String;IIII)V", (void*)&JavaParser::RecordLocalSymbol});
-		methods.push_back({"recordComment", "(IIIII)V", (void*)&JavaParser::RecordComment});
-		methods.push_back(
-			{"recordError", "(ILjava/lang/String;IIIIII)V", (void*)&JavaParser::RecordError});
+			{"recordBatch", "(ILjava/nio/ByteBuffer;I)V", (void*)&JavaParser::RecordBatch});
 
 		m_javaEnvironment->registerNativeMethods("com/sourcetrail/JavaIndexer", methods);
 	}
@@ -91,17 +73,10 @@ JavaParser::~JavaParser()
 
 void JavaParser::buildIndex(std::shared_ptr<IndexerCommandJava> indexerCommand)
 {
-	std::string classPath = "";
-	for (const FilePath& path: indexerCommand->getClassPath())
-	{
-		// the separator used here should be the same as the one used in JavaIndexer.java
-		classPath += path.str() + ";";
-	}
-
 	buildIndex(
 		indexerCommand->getSourceFilePath(),
 		indexerCommand->getLanguageStandard(),
-		classPath,
+		getClassPathString(indexerCommand),
 		TextAccess::createFromFile(indexerCommand->getSourceFilePath()));
 }
 
@@ -118,6 +93,8 @@ void JavaParser::buildIndex(
 {
 	if (m_javaEnvironment)
 	{
+		clearStrings();
+
 		m_currentFilePath = sourceFilePath;
 		m_currentFileId = m_client->recordFile(sourceFilePath, true);
 		m_client->recordFileLanguage(m_currentFileId, L"java");
@@ -125,11 +102,6 @@ void JavaParser::buildIndex(
 		// remove tabs because they screw with javaparser's location resolver
 		std::string fileContent = utility::replace(textAccess->getText(), "\t", " ");
 
-		int verbose = ApplicationSettings::getInstance()->getLoggingEnabled() &&
-				ApplicationSettings::getInstance()->getVerboseIndexerLoggingEnabled()
-			? 1
-			: 0;
-
 		m_javaEnvironment->callStaticVoidMethod(
 			"com/sourcetrail/JavaIndexer",
 			"processFile",
@@ -138,8 +110,84 @@ void JavaParser::buildIndex(
 			fileContent,
 			utility::encodeToUtf8(languageStandard),
 			classPath,
-			verbose);
+			getVerbose());
+	}
+}
+
+void JavaParser::buildIndex(
+	const std::vector<std::shared_ptr<IndexerCommandJava>>& indexerCommands,
+	std::function<std::shared_ptr<ParserClient>(size_t)> onFileStarted,
+	std::function<void(size_t)> onFileFinished)
+{
+	if (!m_javaEnvironment || indexerCommands.empty())
+	{
+		return;
+	}
+
+	m_batchCommands = indexerCommands;
+	m_onBatchFileStarted = onFileStarted;
+	m_onBatchFileFinished = onFileFinished;
+	m_batchFilesStarted.assign(indexerCommands.size(), false);
+
+	std::vector<std::string> filePaths;
+	for (const std::shared_ptr<IndexerCommandJava>& indexerCommand: indexerCommands)
+	{
+		filePaths.push_back(indexerCommand->getSourceFilePath().str());
 	}
+
+	// the file contents are read on the Java side, which replaces tabs the same way
+	m_javaEnvironment->callStaticVoidMethod(
+		"com/sourcetrail/JavaIndexer",
+		"processFiles",
+		m_id,
+		filePaths,
+		utility::encodeToUtf8(indexerCommands.front()->getLanguageStandard()),
+		getClassPathString(indexerCommands.front()),
+		getVerbose());
+
+	finishBatchFile();
+
+	for (size_t i = 0; i < m_batchCommands.size(); i++)
+	{
+		if (!m_batchFilesStarted[i])
+		{
+			beginBatchFile(i);
+			if (!m_indexerStateInfo->indexingInterrupted)
+			{
+				m_client->recordError(
+					L"The file could not be parsed by the Java indexer.",
+					true,
+					false,
+					FilePath(),
+					ParseLocation(m_currentFileId, 1, 1));
+			}
+			finishBatchFile();
+		}
+	}
+
+	m_batchCommands.clear();
+	m_onBatchFileStarted = nullptr;
+	m_onBatchFileFinished = nullptr;
+	m_batchFilesStarted.clear();
+}
+
+std::string JavaParser::getClassPathString(std::shared_ptr<IndexerCommandJava> indexerCommand)
+{
+	std::string classPath = "";
+	for (const FilePath& path: indexerCommand->getClassPath())
+	{
+		// the separator used here should be the same as the one used in JavaIndexer.java
+		classPath += path.str() + ";";
+	}
+	return classPath;
+}
+
+int JavaParser::getVerbose()
+{
+	return ApplicationSettings::getInstance()->getLoggingEnabled() &&
+			ApplicationSettings::getInstance()->getVerboseIndexerLoggingEnabled()
+		? 1
+		: 0;
 }
 
 int JavaParser::s_nextParserId = 0;
@@ -156,6 +204,19 @@ bool JavaParser::doGetInterrupted()
 	return m_indexerStateInfo->indexingInterrupted;
 }
 
+void JavaParser::doBeginFile(jint jFileIndex)
+{
+	const size_t fileIndex = size_t(jFileIndex);
+	if (jFileIndex < 0 || fileIndex >= m_batchFilesStarted.size() ||
+		m_batchFilesStarted[fileIndex])
+	{
+		LOG_ERROR("Java indexer began unexpected file with index " + std::to_string(jFileIndex));
+		return;
+	}
+
+	beginBatchFile(fileIndex);
+}
+
 void JavaParser::doLogInfo(jstring jInfo)
 {
 	LOG_INFO_STREAM_BARE(<< "Indexer - " << m_javaEnvironment->toStdString(jInfo));
@@ -171,173 +232,263 @@ void JavaParser::doLogError(jstring jError)
 	LOG_ERROR_STREAM_BARE(<< "Indexer - " << m_javaEnvironment->toStdString(jError));
 }
 
-void JavaParser::doRecordSymbol(jstring jSymbolName, jint jSymbolKind, jint jAccess, jint jDefinitionKind)
+void JavaParser::doRecordBatch(jobject jBuffer, jint jByteCount)
 {
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
+	const char* data = static_cast<const char*>(m_javaEnvironment->getDirectBufferAddress(jBuffer));
+	if (!data || jByteCount < 0 || !m_client)
+	{
+		LOG_ERROR("Java indexer sent records without a valid buffer or file");
+		return;
+	}
 
-void JavaParser::doRecordSymbolWithLocation(
-	jstring jSymbolName,
-	jint jSymbolKind,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn,
-	jint jAccess,
-	jint jDefinitionKind)
-{
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::TOKEN);
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
+	if (!decodeRecords(data, size_t(jByteCount)))
+	{
+		LOG_ERROR("Java indexer sent malformed records for file: " + m_currentFilePath.str());
+	}
 }
 
-void JavaParser::doRecordSymbolWithLocationAndScope(
-	jstring jSymbolName,
-	jint jSymbolKind,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn,
-	jint scopeBeginLine,
-	jint scopeBeginColumn,
-	jint scopeEndLine,
-	jint scopeEndColumn,
-	jint jAccess,
-	jint jDefinitionKind)
+bool JavaParser::decodeRecords(const char* data, size_t byteCount)
 {
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::TOKEN);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, scopeBeginLine, scopeBeginColumn, scopeEndLine, scopeEndColumn),
-		ParseLocationType::SCOPE);
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
+	const char* const end = data + byteCount;
+	jint values[16];
 
-void JavaParser::doRecordSymbolWithLocationAndScopeAndSignature(
-	jstring jSymbolName,
-	jint jSymbolKind,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn,
-	jint scopeBeginLine,
-	jint scopeBeginColumn,
-	jint scopeEndLine,
-	jint scopeEndColumn,
-	jint signatureBeginLine,
-	jint signatureBeginColumn,
-	jint signatureEndLine,
-	jint signatureEndColumn,
-	jint jAccess,
-	jint jDefinitionKind)
-{
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::TOKEN);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, scopeBeginLine, scopeBeginColumn, scopeEndLine, scopeEndColumn),
-		ParseLocationType::SCOPE);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(
-			m_currentFileId, signatureBeginLine, signatureBeginColumn, signatureEndLine, signatureEndColumn),
-		ParseLocationType::SIGNATURE);
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
+	auto readValues = [&](size_t count) {
+		if (size_t(end - data) < count * sizeof(jint))
+		{
+			return false;
+		}
+		std::memcpy(values, data, count * sizeof(jint));
+		data += count * sizeof(jint);
+		return true;
+	};
+
+	auto location = [&](size_t index) {
+		return ParseLocation(
+			m_currentFileId,
+			values[index],
+			values[index + 1],
+			values[index + 2],
+			values[index + 3]);
+	};
+
+	while (data < end)
+	{
+		if (!readValues(1))
+		{
+			return false;
+		}
 
-void JavaParser::doRecordReference(
-	jint jReferenceKind,
-	jstring jReferencedName,
-	jstring jContextName,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn)
-{
-	m_client->recordReference(
-		intToReferenceKind(jReferenceKind),
-		getOrCreateSymbolId(jReferencedName),
-		getOrCreateSymbolId(jContextName),
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn));
+		const jint recordType = values[0];
+		switch (recordType)
+		{
+		case RECORD_STRING:
+		{
+			if (!readValues(1) || values[0] < 0)
+			{
+				return false;
+			}
+
+			// strings are padded to keep the following ints aligned
+			const size_t length = size_t(values[0]);
+			const size_t paddedLength = (length + 3) / 4 * 4;
+			if (size_t(end - data) < paddedLength)
+			{
+				return false;
+			}
+
+			m_strings.emplace_back(data, length);
+			m_stringSymbolIds.push_back(0);
+			data += paddedLength;
+			break;
+		}
+		case RECORD_SYMBOL:
+		{
+			Id symbolId = 0;
+			if (!readValues(4) || !(symbolId = getOrCreateSymbolId(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordSymbolKind(symbolId, intToSymbolKind(values[1]));
+			m_client->recordAccessKind(symbolId, intToAccessKind(values[2]));
+			m_client->recordDefinitionKind(symbolId, intToDefinitionKind(values[3]));
+			break;
+		}
+		case RECORD_SYMBOL_WITH_LOCATION:
+		{
+			Id symbolId = 0;
+			if (!readValues(8) || !(symbolId = getOrCreateSymbolId(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordSymbolKind(symbolId, intToSymbolKind(values[1]));
+			m_client->recordLocation(symbolId, location(2), ParseLocationType::TOKEN);
+			m_client->recordAccessKind(symbolId, intToAccessKind(values[6]));
+			m_client->recordDefinitionKind(symbolId, intToDefinitionKind(values[7]));
+			break;
+		}
+		case RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE:
+		{
+			Id symbolId = 0;
+			if (!readValues(12) || !(symbolId = getOrCreateSymbolId(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordSymbolKind(symbolId, intToSymbolKind(values[1]));
+			m_client->recordLocation(symbolId, location(2), ParseLocationType::TOKEN);
+			m_client->recordLocation(symbolId, location(6), ParseLocationType::SCOPE);
+			m_client->recordAccessKind(symbolId, intToAccessKind(values[10]));
+			m_client->recordDefinitionKind(symbolId, intToDefinitionKind(values[11]));
+			break;
+		}
+		case RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE:
+		{
+			Id symbolId = 0;
+			if (!readValues(16) || !(symbolId = getOrCreateSymbolId(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordSymbolKind(symbolId, intToSymbolKind(values[1]));
+			m_client->recordLocation(symbolId, location(2), ParseLocationType::TOKEN);
+			m_client->recordLocation(symbolId, location(6), ParseLocationType::SCOPE);
+			m_client->recordLocation(symbolId, location(10), ParseLocationType::SIGNATURE);
+			m_client->recordAccessKind(symbolId, intToAccessKind(values[14]));
+			m_client->recordDefinitionKind(symbolId, intToDefinitionKind(values[15]));
+			break;
+		}
+		case RECORD_REFERENCE:
+		{
+			Id referencedSymbolId = 0;
+			Id contextSymbolId = 0;
+			if (!readValues(7) || !(referencedSymbolId = getOrCreateSymbolId(values[1])) ||
+				!(contextSymbolId = getOrCreateSymbolId(values[2])))
+			{
+				return false;
+			}
+
+			m_client->recordReference(
+				intToReferenceKind(values[0]), referencedSymbolId, contextSymbolId, location(3));
+			break;
+		}
+		case RECORD_QUALIFIER_LOCATION:
+		{
+			Id symbolId = 0;
+			if (!readValues(5) || !(symbolId = getOrCreateSymbolId(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordLocation(symbolId, location(1), ParseLocationType::QUALIFIER);
+			break;
+		}
+		case RECORD_LOCAL_SYMBOL:
+		{
+			const std::string* symbolName = nullptr;
+			if (!readValues(5) || !(symbolName = getString(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordLocalSymbol(
+				NameHierarchy::deserialize(*symbolName).getQualifiedName(), location(1));
+			break;
+		}
+		case RECORD_COMMENT:
+		{
+			if (!readValues(4))
+			{
+				return false;
+			}
+
+			m_client->recordComment(location(0));
+			break;
+		}
+		case RECORD_ERROR:
+		{
+			const std::string* message = nullptr;
+			if (!readValues(7) || !(message = getString(values[0])))
+			{
+				return false;
+			}
+
+			m_client->recordError(
+				utility::decodeFromUtf8(*message),
+				values[1],
+				values[2],
+				FilePath(),
+				ParseLocation(m_currentFileId, values[3], values[4]));
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+
+	return true;
 }
 
-void JavaParser::doRecordQualifierLocation(
-	jstring jQualifierName, jint beginLine, jint beginColumn, jint endLine, jint endColumn)
+const std::string* JavaParser::getString(int stringIndex) const
 {
-	Id symbolId = getOrCreateSymbolId(jQualifierName);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::QUALIFIER);
+	if (stringIndex < 0 || size_t(stringIndex) >= m_strings.size())
+	{
+		return nullptr;
+	}
+	return &m_strings[stringIndex];
 }
 
-void JavaParser::doRecordLocalSymbol(
-	jstring jSymbolName, jint beginLine, jint beginColumn, jint endLine, jint endColumn)
+Id JavaParser::getOrCreateSymbolId(int stringIndex)
 {
-	m_client->recordLocalSymbol(
-		NameHierarchy::deserialize(
-			utility::decodeFromUtf8(m_javaEnvironment->toStdString(jSymbolName)))
-			.getQualifiedName(),
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn));
+	const std::string* name = getString(stringIndex);
+	if (!name)
+	{
+		return 0;
+	}
+
+	Id& symbolId = m_stringSymbolIds[stringIndex];
+	if (!symbolId)
+	{
+		symbolId = m_client->recordSymbol(NameHierarchy::deserialize(*name));
+	}
+	return symbolId;
 }
 
-void JavaParser::doRecordComment(jint beginLine, jint beginColumn, jint endLine, jint endColumn)
+void JavaParser::clearStrings()
 {
-	m_client->recordComment(
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn));
+	m_strings.clear();
+	m_stringSymbolIds.clear();
 }
 
-void JavaParser::doRecordError(
-	jstring jMessage,
-	jint jFatal,
-	jint jIndexed,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn)
+void JavaParser::beginBatchFile(size_t fileIndex)
 {
-	bool fatal = jFatal;
-	bool indexed = jIndexed;
-
-	m_client->recordError(
-		utility::decodeFromUtf8(m_javaEnvironment->toStdString(jMessage)),
-		fatal,
-		indexed,
-		FilePath(),
-		ParseLocation(m_currentFileId, beginLine, beginColumn));
+	finishBatchFile();
+
+	m_batchFilesStarted[fileIndex] = true;
+	m_currentBatchFileIndex = int(fileIndex);
+
+	// strings and symbol ids are only valid within a single file
+	clearStrings();
+
+	m_client = m_onBatchFileStarted(fileIndex);
+	m_currentFilePath = m_batchCommands[fileIndex]->getSourceFilePath();
+	m_currentFileId = m_client->recordFile(m_currentFilePath, true);
+	m_client->recordFileLanguage(m_currentFileId, L"java");
 }
 
-Id JavaParser::getOrCreateSymbolId(jstring jSymbolName)
+void JavaParser::finishBatchFile()
 {
-	std::string name = m_javaEnvironment->toStdString(jSymbolName);
-
-	auto it = m_symbolNameToIdMap.find(name);
-	if (it != m_symbolNameToIdMap.end())
+	if (m_currentBatchFileIndex < 0)
 	{
-		return it->second;
+		return;
 	}
 
-	Id symbolId = m_client->recordSymbol(NameHierarchy::deserialize(utility::decodeFromUtf8(name)));
+	const size_t fileIndex = size_t(m_currentBatchFileIndex);
+	m_currentBatchFileIndex = -1;
 
-	m_symbolNameToIdMap.emplace(name, symbolId);
-	return symbolId;
+	m_client.reset();
+	m_currentFileId = 0;
+
+	m_onBatchFileFinished(fileIndex);
 }
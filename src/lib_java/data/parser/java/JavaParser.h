@@ -1,9 +1,11 @@
 #ifndef JAVA_PARSER_H
 #define JAVA_PARSER_H
 
+#include <functional>
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "FilePath.h"
 #include "IndexerCommandJava.h"
@@ -42,7 +44,19 @@ public:
 	void buildIndex(std::shared_ptr<IndexerCommandJava> indexerCommand);
 	void buildIndex(const FilePath& filePath, std::shared_ptr<TextAccess> textAccess);
 
+	// Parses all files with one shared name environment on the Java side. The commands need to have
+	// the same class path and language standard. onFileStarted provides the client that records a
+	// file right before it is traversed, onFileFinished is called once it is done. Files that were
+	// not traversed are reported afterwards with a fatal error.
+	void buildIndex(
+		const std::vector<std::shared_ptr<IndexerCommandJava>>& indexerCommands,
+		std::function<std::shared_ptr<ParserClient>(size_t)> onFileStarted,
+		std::function<void(size_t)> onFileFinished);
+
 private:
+	static std::string getClassPathString(std::shared_ptr<IndexerCommandJava> indexerCommand);
+	static int getVerbose();
+
 	void buildIndex(
 		const FilePath& sourceFilePath,
 		const std::wstring& languageStandard,
@@ -188,48 +202,11 @@ private:
 		}                                                                                          \
 	}
 
+	DEF_RELAYING_METHOD_1(BeginFile, jint)
 	DEF_RELAYING_METHOD_1(LogInfo, jstring)
 	DEF_RELAYING_METHOD_1(LogWarning, jstring)
 	DEF_RELAYING_METHOD_1(LogError, jstring)
-	DEF_RELAYING_METHOD_4(RecordSymbol, jstring, jint, jint, jint)
-	DEF_RELAYING_METHOD_8(RecordSymbolWithLocation, jstring, jint, jint, jint, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_12(
-		RecordSymbolWithLocationAndScope,
-		jstring,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint)
-	DEF_RELAYING_METHOD_16(
-		RecordSymbolWithLocationAndScopeAndSignature,
-		jstring,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint)
-	DEF_RELAYING_METHOD_7(RecordReference, jint, jstring, jstring, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_5(RecordQualifierLocation, jstring, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_5(RecordLocalSymbol, jstring, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_4(RecordComment, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_7(RecordError, jstring, jint, jint, jint, jint, jint, jint)
+	DEF_RELAYING_METHOD_2(RecordBatch, jobject, jint)
 
 	static bool GetInterrupted(JNIEnv* env, jobject objectOrClass, jint parserId)
 	{
@@ -253,79 +230,40 @@ private:
 
 	bool doGetInterrupted();
 
+	void doBeginFile(jint jFileIndex);
+
 	void doLogInfo(jstring jInfo);
 
 	void doLogWarning(jstring jWarning);
 
 	void doLogError(jstring jError);
 
-	void doRecordSymbol(jstring jSymbolName, jint jSymbolKind, jint jAccess, jint jDefinitionKind);
-
-	void doRecordSymbolWithLocation(
-		jstring jSymbolName,
-		jint jSymbolKind,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn,
-		jint jAccess,
-		jint jDefinitionKind);
-
-	void doRecordSymbolWithLocationAndScope(
-		jstring jSymbolName,
-		jint jSymbolKind,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn,
-		jint scopeBeginLine,
-		jint scopeBeginColumn,
-		jint scopeEndLine,
-		jint scopeEndColumn,
-		jint jAccess,
-		jint jDefinitionKind);
-
-	void doRecordSymbolWithLocationAndScopeAndSignature(
-		jstring jSymbolName,
-		jint jSymbolKind,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn,
-		jint scopeBeginLine,
-		jint scopeBeginColumn,
-		jint scopeEndLine,
-		jint scopeEndColumn,
-		jint signatureBeginLine,
-		jint signatureBeginColumn,
-		jint signatureEndLine,
-		jint signatureEndColumn,
-		jint jAccess,
-		jint jDefinitionKind);
-
-	void doRecordReference(
-		jint jReferenceKind,
-		jstring jReferencedName,
-		jstring jContextName,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn);
-	void doRecordQualifierLocation(
-		jstring jQualifierName, jint beginLine, jint beginColumn, jint endLine, jint endColumn);
-	void doRecordLocalSymbol(
-		jstring jSymbolName, jint beginLine, jint beginColumn, jint endLine, jint endColumn);
-	void doRecordComment(jint beginLine, jint beginColumn, jint endLine, jint endColumn);
-	void doRecordError(
-		jstring jMessage,
-		jint jFatal,
-		jint jIndexed,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn);
-
-	Id getOrCreateSymbolId(jstring jSymbolName);
+	void doRecordBatch(jobject jBuffer, jint jByteCount);
+
+	// the record types need to match the ones defined in JavaIndexerAstVisitorClient.java
+	enum RecordType
+	{
+		RECORD_STRING = 0,
+		RECORD_SYMBOL = 1,
+		RECORD_SYMBOL_WITH_LOCATION = 2,
+		RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE = 3,
+		RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE = 4,
+		RECORD_REFERENCE = 5,
+		RECORD_QUALIFIER_LOCATION = 6,
+		RECORD_LOCAL_SYMBOL = 7,
+		RECORD_COMMENT = 8,
+		RECORD_ERROR = 9
+	};
+
+	// decodes records until the end of the data, returns false if the data is malformed
+	bool decodeRecords(const char* data, size_t byteCount);
+
+	const std::string* getString(int stringIndex) const;
+	Id getOrCreateSymbolId(int stringIndex);
+	void clearStrings();
+
+	void beginBatchFile(size_t fileIndex);
+	void finishBatchFile();
 
 	std::shared_ptr<JavaEnvironment> m_javaEnvironment;
 	std::shared_ptr<IndexerStateInfo> m_indexerStateInfo;
@@ -334,7 +272,15 @@ private:
 	FilePath m_currentFilePath;
 	Id m_currentFileId;
 
-	std::map<std::string, Id> m_symbolNameToIdMap;
+	// strings received from the Java side for the current file, referenced by index
+	std::vector<std::string> m_strings;
+	std::vector<Id> m_stringSymbolIds;
+
+	std::vector<std::shared_ptr<IndexerCommandJava>> m_batchCommands;
+	std::function<std::shared_ptr<ParserClient>(size_t)> m_onBatchFileStarted;
+	std::function<void(size_t)> m_onBatchFileFinished;
+	std::vector<bool> m_batchFilesStarted;
+	int m_currentBatchFileIndex;
 };
 
 #endif	  // JAVA_PARSER_H
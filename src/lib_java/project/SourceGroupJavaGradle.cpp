@@ -1,6 +1,7 @@
 #include "SourceGroupJavaGradle.h"
 
 #include "Application.h"
+#include "BuildToolCache.h"
 #include "DialogView.h"
 #include "FileSystem.h"
 #include "ScopedFunctor.h"
@@ -13,6 +14,7 @@
 SourceGroupJavaGradle::SourceGroupJavaGradle(std::shared_ptr<SourceGroupSettingsJavaGradle> settings)
 	: m_settings(settings)
 	, m_allSourcePathsCache(std::bind(&SourceGroupJavaGradle::doGetAllSourcePaths, this))
+	, m_buildToolCache(std::bind(&SourceGroupJavaGradle::createBuildToolCache, this))
 {
 }
 
@@ -73,6 +75,19 @@ bool SourceGroupJavaGradle::prepareGradleData()
 		const FilePath projectRootPath =
 			m_settings->getGradleProjectFilePathExpandedAndAbsolute().getParentDirectory();
 
+		// the copied dependencies only change with the build files
+		const std::string preparedKey = m_settings->getShouldIndexGradleTests()
+			? "prepared_with_tests"
+			: "prepared";
+		std::shared_ptr<BuildToolCache> cache = m_buildToolCache.getValue();
+		if (cache->getFlag(preparedKey) &&
+			m_settings->getGradleDependenciesDirectoryPath().exists())
+		{
+			LOG_INFO("Gradle build files unchanged, skipping exporting dependencies.");
+			return true;
+		}
+		cache->setFlag(preparedKey, false);
+
 		std::shared_ptr<DialogView> dialogView = Application::getInstance()->getDialogView(
 			DialogView::UseCase::PROJECT_SETUP);
 
@@ -86,6 +101,7 @@ bool SourceGroupJavaGradle::prepareGradleData()
 			m_settings->getGradleDependenciesDirectoryPath(),
 			m_settings->getShouldIndexGradleTests());
 
+		cache->setFlag(preparedKey, success);
 		return success;
 	}
 
@@ -97,6 +113,16 @@ std::vector<FilePath> SourceGroupJavaGradle::doGetAllSourcePaths() const
 	std::vector<FilePath> sourcePaths;
 	if (m_settings->getGradleProjectFilePathExpandedAndAbsolute().exists())
 	{
+		const std::string sourcePathsKey = m_settings->getShouldIndexGradleTests()
+			? "source_paths_with_tests"
+			: "source_paths";
+		std::shared_ptr<BuildToolCache> cache = m_buildToolCache.getValue();
+		if (cache->getPaths(sourcePathsKey, sourcePaths))
+		{
+			LOG_INFO("Gradle build files unchanged, using cached source directories.");
+			return sourcePaths;
+		}
+
 		std::shared_ptr<DialogView> dialogView = Application::getInstance()->getDialogView(
 			DialogView::UseCase::PROJECT_SETUP);
 		dialogView->showUnknownProgressDialog(
@@ -107,6 +133,12 @@ std::vector<FilePath> SourceGroupJavaGradle::doGetAllSourcePaths() const
 		sourcePaths = utility::gradleGetAllSourceDirectories(
 			projectRootPath, m_settings->getShouldIndexGradleTests());
 
+		// an empty result means Gradle failed
+		if (!sourcePaths.empty())
+		{
+			cache->setPaths(sourcePathsKey, sourcePaths);
+		}
+
 		dialogView->hideUnknownProgressDialog();
 	}
 	else
@@ -115,3 +147,15 @@ std::vector<FilePath> SourceGroupJavaGradle::doGetAllSourcePaths() const
 	}
 	return sourcePaths;
 }
+
+std::shared_ptr<BuildToolCache> SourceGroupJavaGradle::createBuildToolCache() const
+{
+	// the Gradle version is defined by the wrapper properties, which are part of the build files
+	return std::make_shared<BuildToolCache>(
+		m_settings->getSourceGroupDependenciesDirectoryPath().concatenate(L"gradle_cache.xml"),
+		BuildToolCache::getBuildFilesHash(
+			m_settings->getGradleProjectFilePathExpandedAndAbsolute().getParentDirectory(),
+			{L"gradle.properties", L"gradle-wrapper.properties", L"libs.versions.toml"},
+			{L".gradle", L".kts"},
+			"gradle"));
+}
@@ -7,6 +7,7 @@
 #include "SingleValueCache.h"
 #include "SourceGroupJava.h"
 
+class BuildToolCache;
 class SourceGroupSettingsJavaGradle;
 
 class SourceGroupJavaGradle: public SourceGroupJava
@@ -22,9 +23,11 @@ private:
 	std::shared_ptr<const SourceGroupSettings> getSourceGroupSettings() const override;
 	bool prepareGradleData();
 	std::vector<FilePath> doGetAllSourcePaths() const;
+	std::shared_ptr<BuildToolCache> createBuildToolCache() const;
 
 	std::shared_ptr<SourceGroupSettingsJavaGradle> m_settings;
 	mutable SingleValueCache<std::vector<FilePath>> m_allSourcePathsCache;
+	mutable SingleValueCache<std::shared_ptr<BuildToolCache>> m_buildToolCache;
 };
 
 #endif	  // SOURCE_GROUP_JAVA_GRADLE_H
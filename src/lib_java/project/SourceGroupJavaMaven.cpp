@@ -2,6 +2,7 @@
 
 #include "Application.h"
 #include "ApplicationSettings.h"
+#include "BuildToolCache.h"
 #include "DialogView.h"
 #include "FileSystem.h"
 #include "MessageStatus.h"
@@ -15,6 +16,7 @@
 SourceGroupJavaMaven::SourceGroupJavaMaven(std::shared_ptr<SourceGroupSettingsJavaMaven> settings)
 	: m_settings(settings)
 	, m_allSourcePathsCache(std::bind(&SourceGroupJavaMaven::doGetAllSourcePaths, this))
+	, m_buildToolCache(std::bind(&SourceGroupJavaMaven::createBuildToolCache, this))
 {
 }
 
@@ -77,6 +79,18 @@ bool SourceGroupJavaMaven::prepareMavenData()
 		const FilePath projectRootPath =
 			m_settings->getMavenProjectFilePathExpandedAndAbsolute().getParentDirectory();
 
+		// generated sources and dependencies only change with the build files
+		std::shared_ptr<BuildToolCache> cache = m_buildToolCache.getValue();
+		std::vector<FilePath> cachedSourcePaths;
+		if (cache->getFlag("prepared") &&
+			cache->getPaths(getSourcePathsCacheKey(), cachedSourcePaths) &&
+			m_settings->getMavenDependenciesDirectoryPath().exists())
+		{
+			LOG_INFO("Maven build files unchanged, skipping generating sources and dependencies.");
+			return true;
+		}
+		cache->setFlag("prepared", false);
+
 		std::shared_ptr<DialogView> dialogView = Application::getInstance()->getDialogView(
 			DialogView::UseCase::PROJECT_SETUP);
 		dialogView->showUnknownProgressDialog(
@@ -102,6 +116,7 @@ bool SourceGroupJavaMaven::prepareMavenData()
 			projectRootPath,
 			m_settings->getMavenDependenciesDirectoryPath());
 
+		cache->setFlag("prepared", success);
 		return success;
 	}
 
@@ -113,6 +128,13 @@ std::vector<FilePath> SourceGroupJavaMaven::doGetAllSourcePaths() const
 	std::vector<FilePath> sourcePaths;
 	if (m_settings && m_settings->getMavenProjectFilePathExpandedAndAbsolute().exists())
 	{
+		std::shared_ptr<BuildToolCache> cache = m_buildToolCache.getValue();
+		if (cache->getPaths(getSourcePathsCacheKey(), sourcePaths))
+		{
+			LOG_INFO("Maven build files unchanged, using cached source directories.");
+			return sourcePaths;
+		}
+
 		std::shared_ptr<DialogView> dialogView = Application::getInstance()->getDialogView(
 			DialogView::UseCase::PROJECT_SETUP);
 		dialogView->showUnknownProgressDialog(
@@ -130,7 +152,40 @@ std::vector<FilePath> SourceGroupJavaMaven::doGetAllSourcePaths() const
 			m_settings->getMavenDependenciesDirectoryPath(),
 			m_settings->getShouldIndexMavenTests());
 
+		// an empty result means Maven failed
+		if (!sourcePaths.empty())
+		{
+			cache->setPaths(getSourcePathsCacheKey(), sourcePaths);
+		}
+
 		dialogView->hideUnknownProgressDialog();
 	}
 	return sourcePaths;
 }
+
+std::shared_ptr<BuildToolCache> SourceGroupJavaMaven::createBuildToolCache() const
+{
+	const FilePath mavenPath = ApplicationSettings::getInstance()->getMavenPath();
+	const FilePath mavenSettingsPath = m_settings->getMavenSettingsFilePathExpandedAndAbsolute();
+	const FilePath projectRootPath =
+		m_settings->getMavenProjectFilePathExpandedAndAbsolute().getParentDirectory();
+
+	// identifies the Maven installation and the settings file, which also affect the results
+	std::string toolVersion = mavenPath.str() + ";" +
+		FileSystem::getLastWriteTime(mavenPath).toString();
+	if (!mavenSettingsPath.empty() && mavenSettingsPath.exists())
+	{
+		toolVersion += ";" + mavenSettingsPath.str() + ";" +
+			FileSystem::getLastWriteTime(mavenSettingsPath).toString();
+	}
+
+	return std::make_shared<BuildToolCache>(
+		m_settings->getSourceGroupDependenciesDirectoryPath().concatenate(L"maven_cache.xml"),
+		BuildToolCache::getBuildFilesHash(
+			projectRootPath, {L"pom.xml"}, {}, toolVersion));
+}
+
+std::string SourceGroupJavaMaven::getSourcePathsCacheKey() const
+{
+	return m_settings->getShouldIndexMavenTests() ? "source_paths_with_tests" : "source_paths";
+}
@@ -7,6 +7,7 @@
 #include "SingleValueCache.h"
 #include "SourceGroupJava.h"
 
+class BuildToolCache;
 class SourceGroupSettingsJavaMaven;
 
 class SourceGroupJavaMaven: public SourceGroupJava
@@ -22,9 +23,12 @@ private:
 	std::shared_ptr<const SourceGroupSettings> getSourceGroupSettings() const override;
 	bool prepareMavenData();
 	std::vector<FilePath> doGetAllSourcePaths() const;
+	std::shared_ptr<BuildToolCache> createBuildToolCache() const;
+	std::string getSourcePathsCacheKey() const;
 
 	std::shared_ptr<SourceGroupSettingsJavaMaven> m_settings;
 	mutable SingleValueCache<std::vector<FilePath>> m_allSourcePathsCache;
+	mutable SingleValueCache<std::shared_ptr<BuildToolCache>> m_buildToolCache;
 };
 
 #endif	  // SOURCE_GROUP_JAVA_MAVEN_H
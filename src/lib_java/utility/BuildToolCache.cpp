@@ -0,0 +1,174 @@
+#include "BuildToolCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <set>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "ConfigManager.h"
+#include "FileSystem.h"
+#include "TextAccess.h"
+#include "logging.h"
+
+namespace
+{
+// FNV-1a, because the hash is stored and needs to stay the same across builds and platforms
+void addToHash(unsigned long long& hash, const char* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211ull;
+	}
+}
+
+void addToHash(unsigned long long& hash, const std::string& str)
+{
+	addToHash(hash, str.data(), str.size() + 1);
+}
+
+bool isSkippedDirectory(const std::wstring& directoryName)
+{
+	static const std::set<std::wstring> skippedDirectoryNames = {
+		L"build", L"node_modules", L"out", L"target"};
+
+	return (!directoryName.empty() && directoryName[0] == L'.') ||
+		skippedDirectoryNames.find(directoryName) != skippedDirectoryNames.end();
+}
+}	 // namespace
+
+const std::string BuildToolCache::s_hashKey = "build_tool_cache/hash";
+
+std::string BuildToolCache::getBuildFilesHash(
+	const FilePath& projectDirectoryPath,
+	const std::vector<std::wstring>& buildFileNames,
+	const std::vector<std::wstring>& buildFileExtensions,
+	const std::string& toolVersion)
+{
+	const std::set<std::wstring> names(buildFileNames.begin(), buildFileNames.end());
+	const std::set<std::wstring> extensions(buildFileExtensions.begin(), buildFileExtensions.end());
+
+	std::vector<boost::filesystem::path> buildFilePaths;
+	if (projectDirectoryPath.isDirectory())
+	{
+		boost::system::error_code ec;
+		boost::filesystem::recursive_directory_iterator it(projectDirectoryPath.getPath(), ec);
+		boost::filesystem::recursive_directory_iterator endit;
+		for (; !ec && it != endit; it.increment(ec))
+		{
+			const boost::filesystem::path& path = it->path();
+			if (boost::filesystem::is_directory(it->status()))
+			{
+				if (isSkippedDirectory(path.filename().wstring()))
+				{
+					it.no_push();
+				}
+			}
+			else if (
+				names.find(path.filename().wstring()) != names.end() ||
+				extensions.find(path.extension().wstring()) != extensions.end())
+			{
+				buildFilePaths.push_back(path);
+			}
+		}
+	}
+
+	// the iteration order of directories is not defined
+	std::sort(buildFilePaths.begin(), buildFilePaths.end());
+
+	unsigned long long hash = 14695981039346656037ull;
+	addToHash(hash, toolVersion);
+
+	for (const boost::filesystem::path& path: buildFilePaths)
+	{
+		addToHash(hash, path.generic_string());
+
+		std::ifstream stream(path.string(), std::ios::binary);
+		const std::string content(
+			(std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		addToHash(hash, content);
+	}
+
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+	LOG_INFO(
+		"Hashed " + std::to_string(buildFilePaths.size()) + " build files in " +
+		projectDirectoryPath.str() + ": " + ss.str());
+
+	return ss.str();
+}
+
+BuildToolCache::BuildToolCache(const FilePath& cacheFilePath, const std::string& buildFilesHash)
+	: m_cacheFilePath(cacheFilePath)
+{
+	if (m_cacheFilePath.exists())
+	{
+		m_config = ConfigManager::createAndLoad(TextAccess::createFromFile(m_cacheFilePath));
+	}
+
+	if (!m_config || m_config->getValueOrDefault<std::string>(s_hashKey, "") != buildFilesHash)
+	{
+		if (m_config)
+		{
+			LOG_INFO("Build files changed, dropping cached build tool results.");
+		}
+
+		m_config = ConfigManager::createEmpty();
+		m_config->setValue(s_hashKey, buildFilesHash);
+	}
+}
+
+bool BuildToolCache::getFlag(const std::string& key) const
+{
+	return m_config->getValueOrDefault("build_tool_cache/" + key, false);
+}
+
+void BuildToolCache::setFlag(const std::string& key, bool value)
+{
+	m_config->setValue("build_tool_cache/" + key, value);
+	save();
+}
+
+bool BuildToolCache::getPaths(const std::string& key, std::vector<FilePath>& paths) const
+{
+	if (!getFlag(key + "/cached"))
+	{
+		return false;
+	}
+
+	std::vector<FilePath> cachedPaths;
+	m_config->getValues("build_tool_cache/" + key + "/path", cachedPaths);
+
+	for (const FilePath& path: cachedPaths)
+	{
+		if (!path.exists())
+		{
+			LOG_INFO(L"Cached path does not exist anymore: " + path.wstr());
+			return false;
+		}
+	}
+
+	paths = cachedPaths;
+	return true;
+}
+
+void BuildToolCache::setPaths(const std::string& key, const std::vector<FilePath>& paths)
+{
+	m_config->setValue("build_tool_cache/" + key + "/cached", true);
+	m_config->setValues("build_tool_cache/" + key + "/path", paths);
+	save();
+}
+
+void BuildToolCache::save()
+{
+	FileSystem::createDirectory(m_cacheFilePath.getParentDirectory());
+	if (!m_config->save(m_cacheFilePath.str()))
+	{
+		LOG_WARNING("Could not write build tool cache: " + m_cacheFilePath.str());
+	}
+}
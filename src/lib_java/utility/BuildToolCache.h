@@ -0,0 +1,44 @@
+#ifndef BUILD_TOOL_CACHE_H
+#define BUILD_TOOL_CACHE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FilePath.h"
+
+class ConfigManager;
+
+// Keeps the results of Maven and Gradle runs in a file within the user data of a source group.
+// The results stay valid as long as the hash of all build files and the build tool doesn't
+// change, so unchanged projects don't need to wait for the build tool on every refresh.
+class BuildToolCache
+{
+public:
+	// Hashes the tool version and the contents of all files below the project directory that have
+	// one of the given names or extensions. Build output and hidden directories are skipped.
+	static std::string getBuildFilesHash(
+		const FilePath& projectDirectoryPath,
+		const std::vector<std::wstring>& buildFileNames,
+		const std::vector<std::wstring>& buildFileExtensions,
+		const std::string& toolVersion);
+
+	BuildToolCache(const FilePath& cacheFilePath, const std::string& buildFilesHash);
+
+	bool getFlag(const std::string& key) const;
+	void setFlag(const std::string& key, bool value);
+
+	// fails if the paths were not cached or any of them no longer exists
+	bool getPaths(const std::string& key, std::vector<FilePath>& paths) const;
+	void setPaths(const std::string& key, const std::vector<FilePath>& paths);
+
+private:
+	static const std::string s_hashKey;
+
+	void save();
+
+	const FilePath m_cacheFilePath;
+	std::shared_ptr<ConfigManager> m_config;
+};
+
+#endif	  // BUILD_TOOL_CACHE_H
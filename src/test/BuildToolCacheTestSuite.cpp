@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include "language_packages.h"
+
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+
+#	include <fstream>
+
+#	include <boost/filesystem.hpp>
+
+#	include "BuildToolCache.h"
+#	include "FileSystem.h"
+
+namespace
+{
+void writeFile(const FilePath& filePath, const std::string& content)
+{
+	FileSystem::createDirectory(filePath.getParentDirectory());
+	std::ofstream stream(filePath.str(), std::ios::trunc);
+	stream << content;
+}
+
+std::string getPomHash(const FilePath& projectPath)
+{
+	return BuildToolCache::getBuildFilesHash(projectPath, {L"pom.xml"}, {}, "maven");
+}
+}	 // namespace
+
+TEST_CASE("build files hash changes with build files only")
+{
+	const FilePath projectPath(L"data/BuildToolCacheTestSuite/project");
+	writeFile(projectPath.getConcatenated(L"pom.xml"), "<project/>");
+	writeFile(projectPath.getConcatenated(L"module/pom.xml"), "<project/>");
+	writeFile(projectPath.getConcatenated(L"module/src/Main.java"), "class Main {}");
+
+	const std::string hash = getPomHash(projectPath);
+
+	writeFile(projectPath.getConcatenated(L"module/src/Main.java"), "class Main { int i; }");
+	writeFile(projectPath.getConcatenated(L"target/pom.xml"), "<generated/>");
+	const std::string hashAfterSourceChange = getPomHash(projectPath);
+
+	writeFile(projectPath.getConcatenated(L"module/pom.xml"), "<project><modules/></project>");
+	const std::string hashAfterBuildFileChange = getPomHash(projectPath);
+
+	const std::string hashOfOtherTool = BuildToolCache::getBuildFilesHash(
+		projectPath, {L"pom.xml"}, {}, "other maven");
+
+	boost::filesystem::remove_all(projectPath.getPath());
+
+	REQUIRE(hash == hashAfterSourceChange);
+	REQUIRE(hash != hashAfterBuildFileChange);
+	REQUIRE(hash != hashOfOtherTool);
+}
+
+TEST_CASE("build tool cache only returns results stored with the same hash")
+{
+	const FilePath cacheFilePath(L"data/BuildToolCacheTestSuite/cache/cache.xml");
+	const std::vector<FilePath> paths = {FilePath(L"data/BuildToolCacheTestSuite")};
+
+	{
+		BuildToolCache cache(cacheFilePath, "a");
+		cache.setFlag("prepared", true);
+		cache.setPaths("source_paths", paths);
+	}
+
+	std::vector<FilePath> cachedPaths;
+	std::vector<FilePath> pathsOfOtherHash;
+	bool prepared = false;
+	bool preparedOfOtherHash = true;
+	{
+		BuildToolCache cache(cacheFilePath, "a");
+		prepared = cache.getFlag("prepared");
+		cache.getPaths("source_paths", cachedPaths);
+	}
+	{
+		BuildToolCache cache(cacheFilePath, "b");
+		preparedOfOtherHash = cache.getFlag("prepared");
+		cache.getPaths("source_paths", pathsOfOtherHash);
+	}
+
+	boost::filesystem::remove_all(cacheFilePath.getParentDirectory().getPath());
+
+	REQUIRE(prepared);
+	REQUIRE(cachedPaths.size() == 1);
+	REQUIRE(cachedPaths[0].wstr() == paths[0].wstr());
+	REQUIRE(!preparedOfOtherHash);
+	REQUIRE(pathsOfOtherHash.empty());
+}
+
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
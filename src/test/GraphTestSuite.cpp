@@ -1,6 +1,11 @@
 #include "catch.hpp"
 
+#include <random>
+
+#include "DummyEdge.h"
+#include "DummyNode.h"
 #include "Graph.h"
+#include "TrailLayouter.h"
 
 namespace
 {
@@ -55,6 +60,106 @@ public:
 		return std::make_shared<Test2Component>(*this);
 	}
 };
+
+class TestTrail
+{
+public:
+	// the first node added is the active root of the trail
+	void addNode(Id id, bool visible = true)
+	{
+		m_graph.createNode(
+			id,
+			NodeType(NODE_FUNCTION),
+			NameHierarchy(std::to_wstring(id), NAME_DELIMITER_CXX),
+			DEFINITION_EXPLICIT);
+
+		std::shared_ptr<DummyNode> node = std::make_shared<DummyNode>(DummyNode::DUMMY_DATA);
+		node->tokenId = id;
+		node->name = std::to_wstring(id);
+		node->visible = visible;
+		node->active = m_nodes.empty();
+		node->size = Vec2i(100, 30);
+
+		m_nodes.push_back(node);
+		m_topLevelAncestorIds.emplace(id, id);
+	}
+
+	void addEdge(Id originId, Id targetId)
+	{
+		Edge* edge = m_graph.createEdge(
+			m_graph.getEdgeCount() + 1000000,
+			Edge::EDGE_CALL,
+			m_graph.getNodeById(originId),
+			m_graph.getNodeById(targetId));
+
+		std::shared_ptr<DummyEdge> dummyEdge = std::make_shared<DummyEdge>(
+			originId, targetId, edge);
+		dummyEdge->visible = true;
+		m_edges.push_back(dummyEdge);
+	}
+
+	void showAllNodes()
+	{
+		for (const std::shared_ptr<DummyNode>& node: m_nodes)
+		{
+			node->visible = true;
+		}
+	}
+
+	void layout(TrailLayouter::LayoutState* state)
+	{
+		std::vector<std::shared_ptr<DummyNode>> visibleNodes;
+		for (const std::shared_ptr<DummyNode>& node: m_nodes)
+		{
+			if (node->visible)
+			{
+				visibleNodes.push_back(node);
+			}
+		}
+
+		TrailLayouter layouter(TrailLayouter::LAYOUT_LEFT_RIGHT);
+		layouter.layoutGraph(visibleNodes, m_edges, m_topLevelAncestorIds, state);
+	}
+
+private:
+	Graph m_graph;
+	std::vector<std::shared_ptr<DummyNode>> m_nodes;
+	std::vector<std::shared_ptr<DummyEdge>> m_edges;
+	std::map<Id, Id> m_topLevelAncestorIds;
+};
+
+// call graph of depth 8, the nodes of the deepest level are hidden initially
+std::shared_ptr<TestTrail> createTestTrail(size_t nodeCount)
+{
+	const size_t depth = 8;
+	std::mt19937 random(42);
+
+	std::shared_ptr<TestTrail> trail = std::make_shared<TestTrail>();
+	trail->addNode(1);
+
+	Id levelStartId = 1;
+	Id levelEndId = 2;
+	for (size_t level = 1; level <= depth; level++)
+	{
+		const Id nextLevelEndId = static_cast<Id>(2 + (nodeCount - 1) * level / depth);
+		for (Id id = levelEndId; id < nextLevelEndId; id++)
+		{
+			trail->addNode(id, level < depth);
+
+			std::uniform_int_distribution<Id> callers(levelStartId, levelEndId - 1);
+			trail->addEdge(callers(random), id);
+			if (random() % 3 == 0)
+			{
+				trail->addEdge(callers(random), id);
+			}
+		}
+
+		levelStartId = levelEndId;
+		levelEndId = nextLevelEndId;
+	}
+
+	return trail;
+}
 }	 // namespace
 
 TEST_CASE("tokens save location ids")
@@ -324,3 +429,75 @@ TEST_CASE("graph removes nodes")
 
 	REQUIRE(1 == graph.getNodeCount());
 }
+
+TEST_CASE("trail layouter keeps placements of previous layout for grown trail")
+{
+	TestTrail trail;
+	for (Id id = 1; id <= 5; id++)
+	{
+		trail.addNode(id);
+	}
+	trail.addNode(6, false);
+	trail.addNode(7, false);
+
+	trail.addEdge(1, 2);
+	trail.addEdge(1, 3);
+	trail.addEdge(2, 4);
+	trail.addEdge(3, 5);
+	trail.addEdge(4, 6);
+	trail.addEdge(5, 7);
+	trail.addEdge(2, 7);
+
+	TrailLayouter::LayoutState state;
+	trail.layout(&state);
+
+	const std::map<Id, std::pair<int, size_t>> previousPlacements = state.nodePlacements;
+	REQUIRE(5 == previousPlacements.size());
+
+	trail.showAllNodes();
+	trail.layout(&state);
+
+	REQUIRE(7 == state.nodePlacements.size());
+	for (const std::pair<const Id, std::pair<int, size_t>>& p: previousPlacements)
+	{
+		REQUIRE(p.second.first == state.nodePlacements[p.first].first);
+	}
+
+	REQUIRE(
+		(previousPlacements.at(2).second < previousPlacements.at(3).second) ==
+		(state.nodePlacements[2].second < state.nodePlacements[3].second));
+	REQUIRE(
+		(previousPlacements.at(4).second < previousPlacements.at(5).second) ==
+		(state.nodePlacements[4].second < state.nodePlacements[5].second));
+
+	REQUIRE(state.nodePlacements[6].first > state.nodePlacements[4].first);
+	REQUIRE(state.nodePlacements[7].first > state.nodePlacements[5].first);
+}
+
+TEST_CASE("trail layouter benchmark", "[.benchmark]")
+{
+	for (size_t nodeCount: {1000, 5000, 20000, 50000})
+	{
+		std::shared_ptr<TestTrail> trail = createTestTrail(nodeCount);
+		TrailLayouter::LayoutState state;
+
+		BENCHMARK("layout trail with " + std::to_string(nodeCount) + " nodes")
+		{
+			state = TrailLayouter::LayoutState();
+			trail->layout(&state);
+		}
+
+		trail->showAllNodes();
+
+		BENCHMARK("layout grown trail with " + std::to_string(nodeCount) + " nodes")
+		{
+			TrailLayouter::LayoutState grownState = state;
+			trail->layout(&grownState);
+		}
+
+		BENCHMARK("layout grown trail with " + std::to_string(nodeCount) + " nodes from scratch")
+		{
+			trail->layout(nullptr);
+		}
+	}
+}
@@ -4,6 +4,7 @@
 
 #if BUILD_PYTHON_LANGUAGE_PACKAGE
 
+#	include <functional>
 #	include <memory>
 #	include <fstream>
 
@@ -29,7 +30,59 @@ void deleteAllContents(const FilePath& tempPath)
 	}
 }
 
-std::shared_ptr<TestStorage> parseCode(std::string code)
+void indexCode(
+	const std::string& code,
+	const FilePath& rootPath,
+	const FilePath& sourceFilePath,
+	const FilePath& databaseFilePath)
+{
+	{
+		std::ofstream codeFile;
+		codeFile.open(sourceFilePath.str());
+		codeFile << code;
+		codeFile.close();
+	}
+
+	std::vector<std::wstring> args;
+	args.push_back(L"index");
+	args.push_back(L"--source-file-path");
+	args.push_back(L"%{SOURCE_FILE_PATH}");
+	args.push_back(L"--database-file-path");
+	args.push_back(L"%{DATABASE_FILE_PATH}");
+	args.push_back(L"--shallow");
+
+	std::shared_ptr<IndexerCommandCustom> indexerCommand = std::make_shared<IndexerCommandCustom>(
+		INDEXER_COMMAND_PYTHON,
+		FilePath("../app")
+			.getConcatenated(ResourcePaths::getPythonIndexerFilePath())
+			.makeAbsolute()
+			.makeCanonical()
+			.wstr(),
+		args,
+		rootPath,
+		databaseFilePath,
+		std::to_wstring(SqliteIndexStorage::getStorageVersion()),
+		sourceFilePath,
+		true);
+
+	const utility::ProcessOutput out = utility::executeProcess(
+		indexerCommand->getCommand(), indexerCommand->getArguments(), rootPath, false, -1, true);
+
+	if (!out.error.empty())
+	{
+		FAIL(
+			"Error occurred while running the indexer: \"" + utility::encodeToUtf8(out.error) +
+			"\". Process output was: \"" + utility::encodeToUtf8(out.output) + "\"");
+	}
+	REQUIRE(out.exitCode == 0);
+}
+
+void postProcessAllFiles(PersistentStorage& storage, const FilePath& sourceFilePath)
+{
+	TaskExecuteCustomCommands::runPythonPostProcessing(storage);
+}
+
+FilePath getRootPath()
 {
 	const FilePath rootPath = FilePath(L"data/PythonIndexerTestSuite/temp/").makeAbsolute();
 
@@ -39,56 +92,18 @@ std::shared_ptr<TestStorage> parseCode(std::string code)
 	}
 
 	deleteAllContents(rootPath);
+	return rootPath;
+}
 
+std::shared_ptr<TestStorage> parseCode(
+	std::string code,
+	std::function<void(PersistentStorage&, const FilePath&)> postProcess = postProcessAllFiles)
+{
+	const FilePath rootPath = getRootPath();
 	const FilePath sourceFilePath = rootPath.getConcatenated(L"test.py");
 	const FilePath tempDbPath = rootPath.getConcatenated(L"temp.srctrldb");
 
-	{
-		std::ofstream codeFile;
-		codeFile.open(sourceFilePath.str());
-		codeFile << code;
-		codeFile.close();
-	}
-
-	{
-		const std::set<FilePath> indexedPaths = {rootPath};
-		const std::set<FilePathFilter> excludeFilters;
-		const std::set<FilePathFilter> includeFilters;
-		const FilePath workingDirectory(L".");
-
-		std::vector<std::wstring> args;
-		args.push_back(L"index");
-		args.push_back(L"--source-file-path");
-		args.push_back(L"%{SOURCE_FILE_PATH}");
-		args.push_back(L"--database-file-path");
-		args.push_back(L"%{DATABASE_FILE_PATH}");
-		args.push_back(L"--shallow");
-
-		std::shared_ptr<IndexerCommandCustom> indexerCommand = std::make_shared<IndexerCommandCustom>(
-			INDEXER_COMMAND_PYTHON,
-			FilePath("../app")
-				.getConcatenated(ResourcePaths::getPythonIndexerFilePath())
-				.makeAbsolute()
-				.makeCanonical()
-				.wstr(),
-			args,
-			rootPath,
-			tempDbPath,
-			std::to_wstring(SqliteIndexStorage::getStorageVersion()),
-			sourceFilePath,
-			true);
-
-		const utility::ProcessOutput out = utility::executeProcess(
-			indexerCommand->getCommand(), indexerCommand->getArguments(), rootPath, false, -1, true);
-
-		if (!out.error.empty())
-		{
-			FAIL(
-				"Error occurred while running the indexer: \"" + utility::encodeToUtf8(out.error) +
-				"\". Process output was: \"" + utility::encodeToUtf8(out.output) + "\"");
-		}
-		REQUIRE(out.exitCode == 0);
-	}
+	indexCode(code, rootPath, sourceFilePath, tempDbPath);
 
 	std::shared_ptr<TestStorage> testStorage;
 	{
@@ -96,7 +111,7 @@ std::shared_ptr<TestStorage> parseCode(std::string code)
 			tempDbPath, FilePath());
 		persistentStorage->setup();
 		persistentStorage->buildCaches();
-		TaskExecuteCustomCommands::runPythonPostProcessing(*(persistentStorage.get()));
+		postProcess(*(persistentStorage.get()), sourceFilePath);
 
 		testStorage = TestStorage::create(persistentStorage);
 	}
@@ -156,4 +171,97 @@ TEST_CASE("python post processing regards super() in call context when adding am
 		storage->calls, L"test.A1.__init__ -> test.B.__init__"));
 }
 
+TEST_CASE("python post processing of indexed files regards class name in call context")
+{
+	std::shared_ptr<TestStorage> storage = parseCode(
+		"class A:\n"
+		"	def __init__(self):\n"
+		"		pass\n"
+		"\n"
+		"class A1(A):\n"
+		"	def __init__(self):\n"
+		"		A.__init__()\n"
+		"\n"
+		"class B:\n"
+		"	def __init__(self):\n"
+		"		pass\n",
+		[](PersistentStorage& storage, const FilePath& sourceFilePath) {
+			TaskExecuteCustomCommands::runPythonPostProcessing(storage, {sourceFilePath}, 0);
+		});
+
+	REQUIRE(storage->calls.size() == 1);
+	REQUIRE(utility::containsElement<std::wstring>(
+		storage->calls, L"test.A1.__init__ -> test.A.__init__"));
+}
+
+TEST_CASE(
+	"python post processing of indexed files ignores unsolved locations of other files that don't "
+	"refer to added nodes")
+{
+	std::shared_ptr<TestStorage> storage = parseCode(
+		"class A:\n"
+		"	def __init__(self):\n"
+		"		pass\n"
+		"\n"
+		"class A1(A):\n"
+		"	def __init__(self):\n"
+		"		A.__init__()\n",
+		[](PersistentStorage& storage, const FilePath& sourceFilePath) {
+			TaskExecuteCustomCommands::runPythonPostProcessing(
+				storage,
+				{sourceFilePath.getParentDirectory().getConcatenated(L"other.py")},
+				storage.getLastElementId());
+		});
+
+	REQUIRE(!utility::containsElement<std::wstring>(
+		storage->calls, L"test.A1.__init__ -> test.A.__init__"));
+}
+
+TEST_CASE(
+	"python post processing of indexed files regards unsolved locations of other files that refer "
+	"to added nodes")
+{
+	const FilePath rootPath = getRootPath();
+	const FilePath callerFilePath = rootPath.getConcatenated(L"caller.py");
+	const FilePath calleeFilePath = rootPath.getConcatenated(L"callee.py");
+	const FilePath tempDbPath = rootPath.getConcatenated(L"temp.srctrldb");
+
+	indexCode(
+		"def call():\n"
+		"	greet()\n",
+		rootPath,
+		callerFilePath,
+		tempDbPath);
+
+	Id lastPreviousElementId = 0;
+	{
+		PersistentStorage persistentStorage(tempDbPath, FilePath());
+		lastPreviousElementId = persistentStorage.getLastElementId();
+	}
+
+	// only the file defining the called function is indexed again
+	indexCode(
+		"def greet():\n"
+		"	pass\n",
+		rootPath,
+		calleeFilePath,
+		tempDbPath);
+
+	std::shared_ptr<TestStorage> storage;
+	{
+		std::shared_ptr<PersistentStorage> persistentStorage = std::make_shared<PersistentStorage>(
+			tempDbPath, FilePath());
+		persistentStorage->setup();
+		persistentStorage->buildCaches();
+		TaskExecuteCustomCommands::runPythonPostProcessing(
+			*(persistentStorage.get()), {calleeFilePath}, lastPreviousElementId);
+
+		storage = TestStorage::create(persistentStorage);
+	}
+
+	deleteAllContents(rootPath);
+
+	REQUIRE(utility::containsElement<std::wstring>(storage->calls, L"caller.call -> callee.greet"));
+}
+
 #endif	  // BUILD_PYTHON_LANGUAGE_PACKAGE
@@ -7,7 +7,7 @@
 TEST_CASE("search index finds id of element added")
 {
 	SearchIndex index;
-	index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo\tsvoid\tp() const").getQualifiedName());
+	index.addNode(1, NameHierarchy::deserialize("::\tmfoo\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	std::vector<SearchResult> results = index.search(L"oo", NodeTypeSet::all(), 0);
 
@@ -19,7 +19,7 @@ TEST_CASE("search index finds id of element added")
 TEST_CASE("search index finds correct indices for query")
 {
 	SearchIndex index;
-	index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo\tsvoid\tp() const").getQualifiedName());
+	index.addNode(1, NameHierarchy::deserialize("::\tmfoo\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	std::vector<SearchResult> results = index.search(L"oo", NodeTypeSet::all(), 0);
 
@@ -32,8 +32,8 @@ TEST_CASE("search index finds correct indices for query")
 TEST_CASE("search index finds ids for ambiguous query")
 {
 	SearchIndex index;
-	index.addNode(1, NameHierarchy::deserialize(L"::\tmfor\tsvoid\tp() const").getQualifiedName());
-	index.addNode(2, NameHierarchy::deserialize(L"::\tmfos\tsvoid\tp() const").getQualifiedName());
+	index.addNode(1, NameHierarchy::deserialize("::\tmfor\tsvoid\tp() const").getQualifiedName());
+	index.addNode(2, NameHierarchy::deserialize("::\tmfos\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	std::vector<SearchResult> results = index.search(L"fo", NodeTypeSet::all(), 0);
 
@@ -47,7 +47,7 @@ TEST_CASE("search index finds ids for ambiguous query")
 TEST_CASE("search index does not find anything after clear")
 {
 	SearchIndex index;
-	index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo\tsvoid\tp() const").getQualifiedName());
+	index.addNode(1, NameHierarchy::deserialize("::\tmfoo\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	index.clear();
 	std::vector<SearchResult> results = index.search(L"oo", NodeTypeSet::all(), 0);
@@ -58,8 +58,8 @@ TEST_CASE("search index does not find anything after clear")
 TEST_CASE("search index does not find all results when max amount is limited")
 {
 	SearchIndex index;
-	index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo1\tsvoid\tp() const").getQualifiedName());
-	index.addNode(2, NameHierarchy::deserialize(L"::\tmfoo2\tsvoid\tp() const").getQualifiedName());
+	index.addNode(1, NameHierarchy::deserialize("::\tmfoo1\tsvoid\tp() const").getQualifiedName());
+	index.addNode(2, NameHierarchy::deserialize("::\tmfoo2\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	std::vector<SearchResult> results = index.search(L"oo", NodeTypeSet::all(), 1);
 
@@ -69,8 +69,8 @@ TEST_CASE("search index does not find all results when max amount is limited")
 TEST_CASE("search index query is case insensitive")
 {
 	SearchIndex index;
-	index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo1\tsvoid\tp() const").getQualifiedName());
-	index.addNode(2, NameHierarchy::deserialize(L"::\tmFOO2\tsvoid\tp() const").getQualifiedName());
+	index.addNode(1, NameHierarchy::deserialize("::\tmfoo1\tsvoid\tp() const").getQualifiedName());
+	index.addNode(2, NameHierarchy::deserialize("::\tmFOO2\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	std::vector<SearchResult> results = index.search(L"oo", NodeTypeSet::all(), 0);
 
@@ -81,9 +81,9 @@ TEST_CASE("search index rates higher on consecutive letters")
 {
 	SearchIndex index;
 	index.addNode(
-		1, NameHierarchy::deserialize(L"::\tmoaabbcc\tsvoid\tp() const").getQualifiedName());
+		1, NameHierarchy::deserialize("::\tmoaabbcc\tsvoid\tp() const").getQualifiedName());
 	index.addNode(
-		2, NameHierarchy::deserialize(L"::\tmocbcabc\tsvoid\tp() const").getQualifiedName());
+		2, NameHierarchy::deserialize("::\tmocbcabc\tsvoid\tp() const").getQualifiedName());
 	index.finishSetup();
 	std::vector<SearchResult> results = index.search(L"abc", NodeTypeSet::all(), 0);
 
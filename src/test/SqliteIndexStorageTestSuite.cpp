@@ -1,7 +1,13 @@
 #include "catch.hpp"
 
+#include <fstream>
+#include <thread>
+
 #include "FileSystem.h"
+#include "NameHierarchy.h"
 #include "SqliteIndexStorage.h"
+#include "SqliteQueryStatistics.h"
+#include "TextAccess.h"
 
 TEST_CASE("storage adds node successfully")
 {
@@ -11,7 +17,7 @@ TEST_CASE("storage adds node successfully")
 		SqliteIndexStorage storage(databasePath);
 		storage.setup();
 		storage.beginTransaction();
-		storage.addNode(StorageNodeData(0, L"a"));
+		storage.addNode(StorageNodeData(0, "a"));
 		storage.commitTransaction();
 		nodeCount = storage.getNodeCount();
 	}
@@ -28,7 +34,7 @@ TEST_CASE("storage removes node successfully")
 		SqliteIndexStorage storage(databasePath);
 		storage.setup();
 		storage.beginTransaction();
-		Id nodeId = storage.addNode(StorageNodeData(0, L"a"));
+		Id nodeId = storage.addNode(StorageNodeData(0, "a"));
 		storage.removeElement(nodeId);
 		storage.commitTransaction();
 		nodeCount = storage.getNodeCount();
@@ -46,8 +52,8 @@ TEST_CASE("storage adds edge successfully")
 		SqliteIndexStorage storage(databasePath);
 		storage.setup();
 		storage.beginTransaction();
-		Id sourceNodeId = storage.addNode(StorageNodeData(0, L"a"));
-		Id targetNodeId = storage.addNode(StorageNodeData(0, L"b"));
+		Id sourceNodeId = storage.addNode(StorageNodeData(0, "a"));
+		Id targetNodeId = storage.addNode(StorageNodeData(0, "b"));
 		storage.addEdge(StorageEdgeData(0, sourceNodeId, targetNodeId));
 		storage.commitTransaction();
 		edgeCount = storage.getEdgeCount();
@@ -65,8 +71,8 @@ TEST_CASE("storage removes edge successfully")
 		SqliteIndexStorage storage(databasePath);
 		storage.setup();
 		storage.beginTransaction();
-		Id sourceNodeId = storage.addNode(StorageNodeData(0, L"a"));
-		Id targetNodeId = storage.addNode(StorageNodeData(0, L"b"));
+		Id sourceNodeId = storage.addNode(StorageNodeData(0, "a"));
+		Id targetNodeId = storage.addNode(StorageNodeData(0, "b"));
 		Id edgeId = storage.addEdge(StorageEdgeData(0, sourceNodeId, targetNodeId));
 		storage.removeElement(edgeId);
 		storage.commitTransaction();
@@ -76,3 +82,282 @@ TEST_CASE("storage removes edge successfully")
 
 	REQUIRE(0 == edgeCount);
 }
+
+TEST_CASE("storage maps non ascii node names to the same node")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const std::vector<std::wstring> names = {L"n\u00e4me", L"\u6587\u5b57"};
+	const std::string serializedName = NameHierarchy::serialize(
+		NameHierarchy(names, NAME_DELIMITER_CXX));
+	Id firstId = 0;
+	Id secondId = 0;
+	StorageNode node;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, "a"));
+		firstId = storage.addNode(StorageNodeData(0, serializedName));
+		secondId = storage.addNode(StorageNodeData(1, serializedName));
+		storage.commitTransaction();
+		node = storage.getNodeBySerializedName(serializedName);
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(firstId == secondId);
+	REQUIRE(node.id == firstId);
+	REQUIRE(node.type == 1);
+	REQUIRE(
+		NameHierarchy::deserialize(node.serializedName).getQualifiedName() ==
+		L"n\u00e4me::\u6587\u5b57");
+}
+
+TEST_CASE("storage merges database and maps existing nodes and edges")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	FilePath sourceDatabasePath(L"data/SQLiteTestSuite/test_source.sqlite");
+	bool success = false;
+	int nodeCount = -1;
+	int edgeCount = -1;
+	int mergedNodeType = -1;
+	{
+		SqliteIndexStorage sourceStorage(sourceDatabasePath);
+		sourceStorage.setup();
+		sourceStorage.beginTransaction();
+		Id aId = sourceStorage.addNode(StorageNodeData(2, "a"));
+		Id bId = sourceStorage.addNode(StorageNodeData(0, "b"));
+		Id cId = sourceStorage.addNode(StorageNodeData(0, "c"));
+		sourceStorage.addEdge(StorageEdgeData(0, aId, bId));
+		sourceStorage.addEdge(StorageEdgeData(0, aId, cId));
+		sourceStorage.commitTransaction();
+	}
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, "x"));
+		Id aId = storage.addNode(StorageNodeData(1, "a"));
+		Id bId = storage.addNode(StorageNodeData(0, "b"));
+		storage.addEdge(StorageEdgeData(0, aId, bId));
+		storage.commitTransaction();
+
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_MERGE);
+		success = storage.mergeDatabase(sourceDatabasePath);
+		nodeCount = storage.getNodeCount();
+		edgeCount = storage.getEdgeCount();
+		mergedNodeType = storage.getNodeBySerializedName("a").type;
+	}
+	FileSystem::remove(databasePath);
+	FileSystem::remove(sourceDatabasePath);
+
+	REQUIRE(success);
+	REQUIRE(4 == nodeCount);
+	REQUIRE(2 == edgeCount);
+	REQUIRE(2 == mergedNodeType);
+}
+
+TEST_CASE("storage keeps shared file content when one of the files is removed")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const std::vector<FilePath> filePaths = {
+		FilePath(L"data/SQLiteTestSuite/vendor_a.h").makeAbsolute(),
+		FilePath(L"data/SQLiteTestSuite/vendor_b.h").makeAbsolute()};
+	const std::string content = "#pragma once\nint a();\n";
+	for (const FilePath& filePath: filePaths)
+	{
+		std::ofstream stream(filePath.str(), std::ios::binary | std::ios::trunc);
+		stream << content;
+	}
+
+	std::string remainingContent;
+	bool hasContent = false;
+	bool hasRemovedContent = true;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		std::vector<Id> fileIds;
+		for (const FilePath& filePath: filePaths)
+		{
+			fileIds.push_back(storage.addNode(StorageNodeData(0, filePath.str())));
+			storage.addFile(StorageFile(fileIds.back(), filePath.wstr(), L"cpp", "", true, true));
+		}
+		storage.removeElement(fileIds[0]);
+		storage.commitTransaction();
+
+		remainingContent = storage.getFileContentById(fileIds[1])->getText();
+		hasContent = storage.hasFileContentForPath(filePaths[1].wstr());
+		hasRemovedContent = storage.hasFileContentForPath(filePaths[0].wstr());
+	}
+	FileSystem::remove(databasePath);
+	for (const FilePath& filePath: filePaths)
+	{
+		FileSystem::remove(filePath);
+	}
+
+	REQUIRE(remainingContent == content);
+	REQUIRE(hasContent);
+	REQUIRE(!hasRemovedContent);
+}
+
+TEST_CASE("storage gets elements for more ids than can be bound to a single statement")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	std::vector<Id> nodeIds;
+	std::vector<StorageNode> nodes;
+	std::vector<StorageEdge> edges;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+
+		std::vector<StorageNode> nodesToAdd;
+		for (size_t i = 0; i < 2500; i++)
+		{
+			nodesToAdd.emplace_back(0, 0, "node_" + std::to_string(i));
+		}
+		nodeIds = storage.addNodes(nodesToAdd);
+
+		std::vector<StorageEdge> edgesToAdd;
+		for (size_t i = 1; i < nodeIds.size(); i++)
+		{
+			edgesToAdd.emplace_back(0, 0, nodeIds[i - 1], nodeIds[i]);
+		}
+		storage.addEdges(edgesToAdd);
+		storage.commitTransaction();
+
+		std::vector<Id> queriedIds = nodeIds;
+		queriedIds.push_back(nodeIds.front());
+		nodes = storage.getAllByIds<StorageNode>(queriedIds);
+		edges = storage.getEdgesBySourceIds(nodeIds);
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(nodeIds.size() == nodes.size());
+	REQUIRE(nodeIds.size() - 1 == edges.size());
+}
+
+TEST_CASE("storage reads uncommitted data only on the thread of the transaction")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	size_t readConnectionCount = 0;
+	int transactionThreadNodeCount = -1;
+	int otherThreadNodeCountBeforeCommit = -1;
+	int otherThreadNodeCountAfterCommit = -1;
+	int nodeCountWithoutReadConnections = -1;
+	int nodeCountWithReopenedReadConnections = -1;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setWriteAheadLogEnabled(true);
+		storage.setReadConnectionCount(2);
+		readConnectionCount = storage.getReadConnectionCount();
+
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, "a"));
+		transactionThreadNodeCount = storage.getNodeCount();
+		std::thread([&]() { otherThreadNodeCountBeforeCommit = storage.getNodeCount(); }).join();
+		storage.commitTransaction();
+
+		std::thread([&]() { otherThreadNodeCountAfterCommit = storage.getNodeCount(); }).join();
+
+		storage.setReadConnectionCount(0);
+		std::thread([&]() { nodeCountWithoutReadConnections = storage.getNodeCount(); }).join();
+
+		storage.setReadConnectionCount(1);
+		std::thread([&]() { nodeCountWithReopenedReadConnections = storage.getNodeCount(); })
+			.join();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(2 == readConnectionCount);
+	REQUIRE(1 == transactionThreadNodeCount);
+	REQUIRE(0 == otherThreadNodeCountBeforeCommit);
+	REQUIRE(1 == otherThreadNodeCountAfterCommit);
+	REQUIRE(1 == nodeCountWithoutReadConnections);
+	REQUIRE(1 == nodeCountWithReopenedReadConnections);
+}
+
+TEST_CASE("query statistics group statements that only differ in literals")
+{
+	REQUIRE(
+		SqliteQueryStatistics::normalizeStatement(
+			"SELECT * FROM node WHERE id IN (1, 2, 3) AND serialized_name == 'a''b';") ==
+		"SELECT * FROM node WHERE id IN (?) AND serialized_name == ?;");
+	REQUIRE(
+		SqliteQueryStatistics::normalizeStatement("SELECT id FROM edge WHERE id IN (?,?)") ==
+		SqliteQueryStatistics::normalizeStatement("SELECT id FROM edge WHERE id IN (42)"));
+	REQUIRE(
+		SqliteQueryStatistics::normalizeStatement("SELECT line_2 FROM t2") ==
+		"SELECT line_2 FROM t2");
+}
+
+TEST_CASE("query statistics count executed statements and rows")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	std::string report;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, "a"));
+		storage.addNode(StorageNodeData(0, "b"));
+		storage.commitTransaction();
+
+		SqliteQueryStatistics::getInstance()->clear();
+		SqliteQueryStatistics::getInstance()->setEnabled(true);
+		storage.getAll<StorageNode>();
+		storage.getAll<StorageNode>();
+		SqliteQueryStatistics::getInstance()->setEnabled(false);
+		storage.getAll<StorageNode>();
+		report = SqliteQueryStatistics::getInstance()->getReport();
+		SqliteQueryStatistics::getInstance()->clear();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(report.find("2 calls") != std::string::npos);
+	REQUIRE(report.find("4 rows") != std::string::npos);
+	REQUIRE(report.find("FROM node") != std::string::npos);
+}
+
+TEST_CASE("storage id lookup benchmark", "[.benchmark]")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+
+		std::vector<StorageNode> nodesToAdd;
+		for (size_t i = 0; i < 1000000; i++)
+		{
+			nodesToAdd.emplace_back(0, 0, "node_" + std::to_string(i));
+		}
+		const std::vector<Id> nodeIds = storage.addNodes(nodesToAdd);
+
+		std::vector<StorageEdge> edgesToAdd;
+		for (size_t i = 1; i < nodeIds.size(); i++)
+		{
+			edgesToAdd.emplace_back(0, 0, nodeIds[i - 1], nodeIds[i]);
+		}
+		storage.addEdges(edgesToAdd);
+		storage.commitTransaction();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+		for (size_t idCount: {100000, 1000000})
+		{
+			const std::vector<Id> ids(nodeIds.begin(), nodeIds.begin() + idCount);
+
+			BENCHMARK("get " + std::to_string(idCount) + " nodes by ids")
+			{
+				storage.getAllByIds<StorageNode>(ids);
+			}
+
+			BENCHMARK("get edges of " + std::to_string(idCount) + " source ids")
+			{
+				storage.getEdgesBySourceIds(ids);
+			}
+		}
+	}
+	FileSystem::remove(databasePath);
+}
@@ -1,10 +1,14 @@
 #include "catch.hpp"
 
+#include "ExternalStorageMerger.h"
+#include "FileSystem.h"
 #include "utilityString.h"
 
 #include "IntermediateStorage.h"
+#include "IntermediateStorageFile.h"
 #include "ParseLocation.h"
 #include "PersistentStorage.h"
+#include "StorageProvider.h"
 
 namespace
 {
@@ -74,6 +78,178 @@ TEST_CASE("storage saves file")
 	REQUIRE(storage.getNodeTypeForNodeWithId(id).isFile());
 }
 
+TEST_CASE("intermediate storage file restores written storage")
+{
+	const FilePath filePath(L"data/StorageTestSuite_intermediate_storage");
+	const std::wstring sourceFilePath = L"path/to/test.h";
+
+	IntermediateStorage storage;
+	Id fileId = storage
+					.addNode(StorageNodeData(
+						nodeKindToInt(NODE_FILE),
+						NameHierarchy::serialize(NameHierarchy(sourceFilePath, NAME_DELIMITER_FILE))))
+					.first;
+	storage.addFile(StorageFile(fileId, sourceFilePath, L"someLanguage", "someTime", true, true));
+	Id typeId = storage
+					.addNode(StorageNodeData(
+						nodeKindToInt(NODE_TYPEDEF), NameHierarchy::serialize(createNameHierarchy(L"type"))))
+					.first;
+	storage.addSymbol(StorageSymbol(typeId, DEFINITION_EXPLICIT));
+	Id locationId = storage.addSourceLocation(StorageSourceLocationData(fileId, 3, 7, 4, 2, 0));
+	storage.addOccurrence(StorageOccurrence(typeId, locationId));
+	storage.addCompletedTranslationUnits({L"path/to/test.cpp"});
+
+	for (bool compressed: {false, true})
+	{
+		REQUIRE(IntermediateStorageFile::write(storage, filePath, compressed));
+
+		std::shared_ptr<IntermediateStorage> restored = IntermediateStorageFile::read(filePath);
+		FileSystem::remove(filePath);
+
+		REQUIRE(restored);
+		REQUIRE(restored->getStorageNodes().size() == 2);
+		REQUIRE(restored->getStorageFiles().size() == 1);
+		REQUIRE(restored->getStorageFiles()[0].filePath == sourceFilePath);
+		REQUIRE(restored->getStorageSymbols().size() == 1);
+		REQUIRE(restored->getStorageSymbols()[0].id == typeId);
+		REQUIRE(restored->getStorageSourceLocations().size() == 1);
+		REQUIRE(restored->getStorageSourceLocations().begin()->endLine == 4);
+		REQUIRE(restored->getStorageOccurrences().size() == 1);
+		REQUIRE(restored->getCompletedTranslationUnits().size() == 1);
+		REQUIRE(restored->getByteSize(1) == storage.getByteSize(1));
+	}
+}
+
+TEST_CASE("merged shard databases get the same ids independent of the shard order")
+{
+	const FilePath shardAPath(L"data/StorageTestSuite_shard_1_of_2.srctrldb");
+	const FilePath shardBPath(L"data/StorageTestSuite_shard_2_of_2.srctrldb");
+	const FilePath mergedPath(L"data/StorageTestSuite_merged.srctrldb");
+
+	for (const std::pair<FilePath, std::string>& shard:
+		 {std::make_pair(shardAPath, std::string("a")),
+		  std::make_pair(shardBPath, std::string("b"))})
+	{
+		SqliteIndexStorage storage(shard.first);
+		storage.setup();
+		storage.setVersion(storage.getStaticVersion());
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, shard.second));
+		storage.addNode(StorageNodeData(0, "shared_header"));
+		storage.commitTransaction();
+	}
+
+	std::vector<int> nodeCounts;
+	std::vector<Id> sharedNodeIds;
+	for (const std::vector<FilePath>& shardPaths:
+		 {std::vector<FilePath>{shardAPath, shardBPath},
+		  std::vector<FilePath>{shardBPath, shardAPath}})
+	{
+		REQUIRE(PersistentStorage::mergeDatabases(shardPaths, mergedPath));
+
+		SqliteIndexStorage storage(mergedPath);
+		nodeCounts.push_back(storage.getNodeCount());
+		sharedNodeIds.push_back(storage.getNodeBySerializedName("shared_header").id);
+	}
+
+	FileSystem::remove(shardAPath);
+	FileSystem::remove(shardBPath);
+	FileSystem::remove(mergedPath);
+
+	REQUIRE(nodeCounts[0] == 3);
+	REQUIRE(nodeCounts[1] == 3);
+	REQUIRE(sharedNodeIds[0] == sharedNodeIds[1]);
+}
+
+TEST_CASE("storage injection keeps completed translation units")
+{
+	IntermediateStorage storage;
+	storage.addCompletedTranslationUnits({L"a.cpp"});
+
+	IntermediateStorage injected;
+	injected.addCompletedTranslationUnits({L"a.cpp", L"b.cpp"});
+
+	storage.inject(&injected);
+
+	REQUIRE(storage.getCompletedTranslationUnits().size() == 2);
+	REQUIRE(storage.getCompletedTranslationUnits().count(L"b.cpp") == 1);
+}
+
+TEST_CASE("storage provider spills storages exceeding byte budget")
+{
+	StorageProvider provider;
+	provider.setSpillDirectoryPath(FilePath(L"data/StorageTestSuite_spill"));
+
+	for (int i = 0; i < 3; i++)
+	{
+		std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+		storage->addNode(StorageNodeData(
+			nodeKindToInt(NODE_TYPEDEF),
+			NameHierarchy::serialize(createNameHierarchy(L"type" + std::to_wstring(i)))));
+		provider.insert(storage);
+	}
+
+	provider.setByteBudget(1);
+
+	REQUIRE(provider.getStorageCount() == 3);
+	REQUIRE(provider.getSpilledStorageCount() == 2);
+
+	int consumedCount = 0;
+	while (std::shared_ptr<IntermediateStorage> storage = provider.consumeLargestStorage())
+	{
+		REQUIRE(storage->getStorageNodes().size() == 1);
+		consumedCount++;
+	}
+
+	REQUIRE(consumedCount == 3);
+	REQUIRE(provider.getSpilledStorageCount() == 0);
+}
+
+TEST_CASE("external storage merger merges nodes of all runs")
+{
+	ExternalStorageMerger merger(FilePath(L"data/StorageTestSuite_runs"), 1);
+
+	for (int i = 0; i < 3; i++)
+	{
+		std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+		Id aId = storage
+					 ->addNode(StorageNodeData(
+						 nodeKindToInt(NODE_STRUCT),
+						 NameHierarchy::serialize(createNameHierarchy(L"Struct"))))
+					 .first;
+		Id bId = storage
+					 ->addNode(StorageNodeData(
+						 nodeKindToInt(NODE_FIELD),
+						 NameHierarchy::serialize(
+							 createNameHierarchy(L"Struct::m_field" + std::to_wstring(i)))))
+					 .first;
+		storage->addEdge(StorageEdgeData(Edge::typeToInt(Edge::EDGE_MEMBER), aId, bId));
+		merger.addStorage(storage);
+	}
+
+	REQUIRE(merger.getRunCount() == 3);
+
+	IntermediateStorage target;
+	REQUIRE(merger.mergeInto(&target));
+	REQUIRE(merger.getRunCount() == 0);
+
+	REQUIRE(target.getStorageNodes().size() == 4);
+	REQUIRE(target.getStorageEdges().size() == 3);
+
+	Id structId = 0;
+	for (const StorageNode& node: target.getStorageNodes())
+	{
+		if (node.type == nodeKindToInt(NODE_STRUCT))
+		{
+			structId = node.id;
+		}
+	}
+	for (const StorageEdge& edge: target.getStorageEdges())
+	{
+		REQUIRE(edge.sourceNodeId == structId);
+	}
+}
+
 TEST_CASE("storage saves node")
 {
 	NameHierarchy a = createNameHierarchy(L"type");
@@ -146,6 +322,29 @@ TEST_CASE("storage saves method static")
 	// TS_ASSERT(node->getComponent<TokenComponentStatic>());
 }
 
+TEST_CASE("storage snapshot caches data injected after previous update")
+{
+	TestStorage storage;
+	PersistentStorage snapshot(FilePath(L"data/test.sqlite"), FilePath(L"data/testBookmarks.sqlite"));
+	snapshot.setup();
+
+	for (size_t i = 1; i <= 2; i++)
+	{
+		IntermediateStorage intermediateStorage;
+		Id id = intermediateStorage
+					.addNode(StorageNodeData(
+						nodeKindToInt(NODE_CLASS),
+						NameHierarchy::serialize(createNameHierarchy(L"Type" + std::to_wstring(i)))))
+					.first;
+		intermediateStorage.addSymbol(StorageSymbol(id, DEFINITION_EXPLICIT));
+		storage.inject(&intermediateStorage);
+
+		snapshot.updateCaches();
+
+		REQUIRE(snapshot.getAutocompletionMatches(L"Type", NodeTypeSet::all(), false).size() == i);
+	}
+}
+
 TEST_CASE("storage clears single file data of single file storage")
 {
 	/*
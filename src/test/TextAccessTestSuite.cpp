@@ -1,5 +1,8 @@
 #include "catch.hpp"
 
+#include <fstream>
+
+#include "FileSystem.h"
 #include "TextAccess.h"
 
 namespace
@@ -148,3 +151,36 @@ TEST_CASE("textAccessFile get filePath")
 
 	REQUIRE(textAccess->getFilePath() == filePath);
 }
+
+TEST_CASE("textAccessFile normalizes line endings of large files")
+{
+	FilePath filePath(L"data/TextAccessTestSuite/large_text.txt");
+	{
+		std::ofstream stream(filePath.str(), std::ios::binary | std::ios::trunc);
+		for (int i = 0; i < 10000; i++)
+		{
+			stream << "line " << i << "\r\n";
+		}
+		stream << "last line";
+	}
+
+	std::shared_ptr<TextAccess> textAccess = TextAccess::createFromFile(filePath);
+	const unsigned int lineCount = textAccess->getLineCount();
+	const std::string firstLine = textAccess->getLine(1);
+	const std::string lastLine = std::string(textAccess->getLineView(lineCount));
+	FileSystem::remove(filePath);
+
+	REQUIRE(lineCount == 10001);
+	REQUIRE(firstLine == "line 0\n");
+	REQUIRE(lastLine == "last line\n");
+}
+
+TEST_CASE("textAccessLines keeps lines that contain line breaks")
+{
+	std::shared_ptr<TextAccess> textAccess = TextAccess::createFromLines({"a\nb\n", "", "c"});
+
+	REQUIRE(textAccess->getLineCount() == 3);
+	REQUIRE(textAccess->getLineView(1) == "a\nb\n");
+	REQUIRE(textAccess->getLineView(2).empty());
+	REQUIRE(textAccess->getTextView() == "a\nb\nc");
+}
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include <thread>
+
+#include "tracing.h"
+
+namespace
+{
+void recordTraces(size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		TRACE("test trace");
+	}
+}
+}	 // namespace
+
+TEST_CASE("tracer does not record events while disabled")
+{
+	Tracer::getInstance()->clear();
+	Tracer::getInstance()->setEnabled(false);
+
+	recordTraces(10);
+
+	REQUIRE(Tracer::getInstance()->getEventCount() == 0);
+}
+
+TEST_CASE("tracer records events of all threads")
+{
+	Tracer::getInstance()->clear();
+	Tracer::getInstance()->setEnabled(true);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < 4; i++)
+	{
+		threads.emplace_back(recordTraces, 3000);
+	}
+
+	for (std::thread& thread: threads)
+	{
+		thread.join();
+	}
+
+	Tracer::getInstance()->setEnabled(false);
+
+	REQUIRE(Tracer::getInstance()->getEventCount() == 12000);
+
+	Tracer::getInstance()->clear();
+	REQUIRE(Tracer::getInstance()->getEventCount() == 0);
+}
+
+TEST_CASE("tracer exports events of other processes in chrome trace format")
+{
+	Tracer::getInstance()->clear();
+	Tracer::getInstance()->setEnabled(true);
+
+	{
+		ScopedTrace trace("indexer", "index file");
+		trace.setDetail("C:\\src\\\"main\".cpp");
+	}
+
+	const std::vector<std::string> events = Tracer::getInstance()->takeChromeTraceEvents(
+		2, "indexer 2");
+	Tracer::getInstance()->addChromeTraceEvents(events);
+	Tracer::getInstance()->setEnabled(false);
+
+	const std::string trace = Tracer::getInstance()->getChromeTrace();
+	Tracer::getInstance()->clear();
+
+	REQUIRE(events.size() == 2);
+	REQUIRE(
+		trace.find("\"name\":\"index file\",\"cat\":\"indexer\",\"ph\":\"X\"") !=
+		std::string::npos);
+	REQUIRE(trace.find("\"pid\":2") != std::string::npos);
+	REQUIRE(trace.find("\"detail\":\"C:\\\\src\\\\\\\"main\\\".cpp\"") != std::string::npos);
+	REQUIRE(trace.find("\"args\":{\"name\":\"indexer 2\"}") != std::string::npos);
+}
@@ -1,5 +1,6 @@
 #include "catch.hpp"
 
+#include "LruCache.h"
 #include "utility.h"
 
 TEST_CASE("trim blank spaces of string")
@@ -11,3 +12,22 @@ TEST_CASE("trim blank spaces of wstring")
 {
 	REQUIRE(utility::trim(L" foo  ") == L"foo");
 }
+
+TEST_CASE("lru cache drops least recently used value")
+{
+	LruCache<int, std::string> cache(2);
+	cache.setValue(1, "a");
+	cache.setValue(2, "b");
+
+	std::string value;
+	REQUIRE(cache.getValue(1, &value));
+	REQUIRE(value == "a");
+
+	cache.setValue(3, "c");
+
+	REQUIRE(cache.size() == 2);
+	REQUIRE(!cache.getValue(2, &value));
+	REQUIRE(cache.getValue(1, &value));
+	REQUIRE(cache.getValue(3, &value));
+	REQUIRE(value == "c");
+}